@@ -0,0 +1,233 @@
+/***********************************************************************
+* @file      ClockSync.h
+*
+*    Synchronized, timestamped LightControl commands.
+*
+*    A command that is carried to hundreds of nodes over cellular links
+*    arrives at each of them after a different, and varying, delay; acted
+*    upon on receipt, the lights of one group visibly switch over the
+*    course of a second or more. Instead the controller can stamp the
+*    command with the time, on its own clock, at which it is to take
+*    effect ("x:" in LightControlCodec.h), a little ahead of now, and
+*    every node executes it at that same instant on its local clock.
+*
+*    For that each node estimates the offset of the controller's clock
+*    from its own, NTP-style, from the request/reply exchanges it already
+*    makes: a request asks to be stamped ("c:0000000000"), and the reply
+*    carries the controller's clock as it replied. Assuming symmetric
+*    delays, the controller stamped it half a round trip before it came
+*    back. The exchange with the shortest round trip among the last few
+*    is the one least disturbed by queueing and is the one used, as NTP's
+*    clock filter does; half its round trip bounds the error.
+*
+*    Controller times are in milliseconds modulo 2^32, and are only ever
+*    compared by their signed difference, so they wrap around after 49.7
+*    days without consequence as long as commands are scheduled less
+*    than 24.8 days ahead.
+*
+* @brief
+*
+* @note    Deliberately free of any Mbed OS dependency so that the
+*          switching skew simulation (host/SwitchingSkewSimulator.cpp)
+*          runs the very same estimator as the device.
+*
+* @warning Not thread-safe. ExecutionSchedule in particular is shared by
+*          the consuming thread and the timer ISR, under a critical section.
+*
+* @author  Nuertey Odzeyem
+*
+* @date    May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace LightControl
+{
+    // Exchanges the estimate is chosen from, as in NTP's clock filter.
+    static constexpr std::size_t CLOCK_SAMPLE_COUNT{8};
+
+    class ClockOffsetEstimator
+    {
+        struct Sample_t
+        {
+            uint64_t m_LocalMicroseconds{0};   // Local time the controller stamped at.
+            uint32_t m_ControllerMilliseconds{0};
+            uint32_t m_RoundTripMicroseconds{0};
+        };
+
+    public:
+        // A reply stamped by the controller arrived at local time
+        // receivedMicroseconds, roundTripMicroseconds after its request left.
+        constexpr void OnExchange(uint64_t receivedMicroseconds, uint32_t roundTripMicroseconds,
+                                  uint32_t controllerMilliseconds) noexcept
+        {
+            m_Samples[m_Next] = Sample_t{receivedMicroseconds - (roundTripMicroseconds / 2),
+                                         controllerMilliseconds, roundTripMicroseconds};
+            m_Next = (m_Next + 1) % CLOCK_SAMPLE_COUNT;
+            m_Count = (m_Count < CLOCK_SAMPLE_COUNT) ? (m_Count + 1) : m_Count;
+            ++m_Exchanges;
+
+            // Newest wins a tie, for it has drifted the least since.
+            m_Best = 0;
+            for (std::size_t age = 0; age < m_Count; ++age)
+            {
+                const auto index = (m_Next + CLOCK_SAMPLE_COUNT - 1 - age) % CLOCK_SAMPLE_COUNT;
+                if ((age == 0) || (m_Samples[index].m_RoundTripMicroseconds
+                                   < m_Samples[m_Best].m_RoundTripMicroseconds))
+                {
+                    m_Best = index;
+                }
+            }
+        }
+
+        constexpr bool IsSynchronized() const noexcept { return (m_Count > 0); }
+
+        // Local time, in microseconds, that corresponds to this controller time.
+        constexpr std::optional<uint64_t> LocalTimeOf(uint32_t controllerMilliseconds) const noexcept
+        {
+            if (!IsSynchronized())
+            {
+                return std::nullopt;
+            }
+            const auto & reference = m_Samples[m_Best];
+            const auto ahead = static_cast<int32_t>(controllerMilliseconds - reference.m_ControllerMilliseconds);
+            return static_cast<uint64_t>(static_cast<int64_t>(reference.m_LocalMicroseconds)
+                                       + (static_cast<int64_t>(ahead) * 1000));
+        }
+
+        // Controller time, in milliseconds, that corresponds to this local time.
+        constexpr std::optional<uint32_t> ControllerTimeOf(uint64_t localMicroseconds) const noexcept
+        {
+            if (!IsSynchronized())
+            {
+                return std::nullopt;
+            }
+            const auto & reference = m_Samples[m_Best];
+            const auto elapsed = static_cast<int64_t>(localMicroseconds - reference.m_LocalMicroseconds);
+            return static_cast<uint32_t>(reference.m_ControllerMilliseconds
+                                       + static_cast<uint32_t>(elapsed / 1000));
+        }
+
+        // Bound on the error of the estimate, from its round trip alone.
+        constexpr uint32_t DispersionMicroseconds() const noexcept
+        {
+            return IsSynchronized() ? (m_Samples[m_Best].m_RoundTripMicroseconds / 2) : 0;
+        }
+
+        constexpr uint32_t Exchanges() const noexcept { return m_Exchanges; }
+
+        constexpr void Reset() noexcept { *this = ClockOffsetEstimator{}; }
+
+    private:
+        std::array<Sample_t, CLOCK_SAMPLE_COUNT> m_Samples{};
+        std::size_t                              m_Next{0};
+        std::size_t                              m_Count{0};
+        std::size_t                              m_Best{0};
+        uint32_t                                 m_Exchanges{0};
+    };
+
+    // Commands awaiting their execution time, earliest first. Fixed
+    // capacity, and no allocation, so that the timer ISR can pop from it.
+    template <typename Payload_t, std::size_t CAPACITY>
+    class ExecutionSchedule
+    {
+    public:
+        struct Entry_t
+        {
+            uint64_t  m_DueMicroseconds{0};
+            Payload_t m_Payload{};
+        };
+
+        // False, and no change, when full. Equal due times keep their order.
+        constexpr bool Insert(uint64_t dueMicroseconds, const Payload_t & payload) noexcept
+        {
+            if (m_Count == CAPACITY)
+            {
+                return false;
+            }
+            auto position = m_Count;
+            while ((position > 0) && (m_Entries[position - 1].m_DueMicroseconds > dueMicroseconds))
+            {
+                m_Entries[position] = m_Entries[position - 1];
+                --position;
+            }
+            m_Entries[position] = Entry_t{dueMicroseconds, payload};
+            ++m_Count;
+            return true;
+        }
+
+        constexpr std::optional<uint64_t> EarliestDue() const noexcept
+        {
+            if (m_Count == 0)
+            {
+                return std::nullopt;
+            }
+            return m_Entries[0].m_DueMicroseconds;
+        }
+
+        // Removes and returns the earliest entry, should it be due by now.
+        constexpr std::optional<Entry_t> PopDue(uint64_t nowMicroseconds) noexcept
+        {
+            if ((m_Count == 0) || (m_Entries[0].m_DueMicroseconds > nowMicroseconds))
+            {
+                return std::nullopt;
+            }
+            const auto entry = m_Entries[0];
+            for (std::size_t i = 1; i < m_Count; ++i)
+            {
+                m_Entries[i - 1] = m_Entries[i];
+            }
+            --m_Count;
+            return entry;
+        }
+
+        constexpr void Clear() noexcept { m_Count = 0; }
+
+        constexpr std::size_t Size() const noexcept { return m_Count; }
+
+    private:
+        std::array<Entry_t, CAPACITY> m_Entries{};
+        std::size_t                   m_Count{0};
+    };
+
+    // A device 5 s behind the controller, over links of 40 ms then 10 ms
+    // round trip, settles on the latter, and maps controller time back to
+    // local time across the 2^32 ms wrap-around.
+    constexpr bool EstimatesOffsetAcrossWrapAround()
+    {
+        ClockOffsetEstimator estimator;
+        constexpr uint32_t CONTROLLER_MS{4294967000u}; // 296 ms before it wraps.
+        estimator.OnExchange(20000 + 20000, 40000, CONTROLLER_MS + 5000 + 15);
+        estimator.OnExchange(30000 + 5000,  10000, CONTROLLER_MS + 5000 + 20 + 3);
+        estimator.OnExchange(40000 + 30000, 60000, CONTROLLER_MS + 5000 + 40);
+
+        // Stamped 3 ms late on its way back, by the second exchange.
+        return estimator.IsSynchronized()
+            && (estimator.DispersionMicroseconds() == 5000)
+            && (estimator.LocalTimeOf(CONTROLLER_MS + 5000 + 1023) == 1030000u)
+            && (estimator.ControllerTimeOf(1030000u) == CONTROLLER_MS + 5000 + 1023)
+            && (estimator.LocalTimeOf(CONTROLLER_MS + 5000 + 23) == 30000u);
+    }
+
+    constexpr bool SchedulesEarliestFirst()
+    {
+        ExecutionSchedule<int, 3> schedule;
+        const bool inserted = schedule.Insert(300, 3) && schedule.Insert(100, 1)
+                           && schedule.Insert(200, 2) && !schedule.Insert(50, 0);
+        const auto early = schedule.PopDue(99);
+        const auto first = schedule.PopDue(250);
+        const auto second = schedule.PopDue(250);
+        const auto third = schedule.PopDue(250);
+        return inserted && !early && first && (first->m_Payload == 1) && second && (second->m_Payload == 2)
+            && !third && (schedule.EarliestDue() == 300u) && (schedule.Size() == 1);
+    }
+
+    static_assert(EstimatesOffsetAcrossWrapAround());
+    static_assert(SchedulesEarliestFirst());
+} // end of namespace
@@ -0,0 +1,279 @@
+/***********************************************************************
+* @file      DatagramReliability.h
+*
+*    Lightweight reliability for the datagram transports, UDP and 3GPP
+*    Non-IP (NIDD), so that they can be used on cellular without paying
+*    for TCP's handshake and ACKs, yet survive the odd lost datagram.
+*
+*    Every LightControl message carries its 8-bit sequence number, and
+*    the peer's reply to it is its acknowledgement. Each message that is
+*    not acknowledged within the retransmission timeout (RTO) is resent
+*    on its own (selective retransmission); the others are left be.
+*
+*    The RTO adapts to the link as per RFC 6298: smoothed RTT plus four
+*    times its variation, doubled on every expiry, and with Karn's rule
+*    of never sampling the RTT of a message that has been retransmitted.
+*
+*    A retransmitted message may well be acknowledged twice, and the
+*    network may duplicate a datagram of its own accord. A reply to a
+*    message already acknowledged is recognized as a duplicate, so that
+*    it is never acted upon again; a stale light state could otherwise be
+*    applied over a newer one.
+*
+*    Only the messages that can be outstanding at once, a window's worth,
+*    are kept, each in slot sequence % WINDOW; and times are kept as 32-bit
+*    millisecond counts, compared modulo 2^32, so that a slot is 44 bytes.
+*
+* @brief
+*
+* @note    Deliberately free of any Mbed OS dependency; times are handed
+*          in as milliseconds on whichever clock the caller uses.
+*
+* @warning Not thread-safe; owned by the context that runs the exchange.
+*          No more than WINDOW messages may be outstanding at once, and
+*          WINDOW must stay within half of the sequence space (128), as the
+*          pipeline window already does.
+*
+* @author  Nuertey Odzeyem
+*
+* @date    May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+#include "LightControlCodec.h"
+
+namespace LightControl
+{
+    // RFC 6298, in integer milliseconds.
+    class RetransmissionTimeout
+    {
+    public:
+        constexpr RetransmissionTimeout(std::chrono::milliseconds minimum, std::chrono::milliseconds maximum) noexcept
+            : m_Minimum(minimum)
+            , m_Maximum(std::max(maximum, minimum))
+            , m_Value(std::clamp(INITIAL, m_Minimum, m_Maximum))
+        {
+        }
+
+        constexpr void Sample(std::chrono::milliseconds rtt) noexcept
+        {
+            if (!m_HasSample)
+            {
+                m_Smoothed = rtt;
+                m_Variation = rtt / 2;
+                m_HasSample = true;
+            }
+            else
+            {
+                const auto error = (m_Smoothed > rtt) ? (m_Smoothed - rtt) : (rtt - m_Smoothed);
+                m_Variation = ((3 * m_Variation) + error) / 4;
+                m_Smoothed = ((7 * m_Smoothed) + rtt) / 8;
+            }
+            m_Value = std::clamp(m_Smoothed + std::max(GRANULARITY, 4 * m_Variation), m_Minimum, m_Maximum);
+        }
+
+        constexpr void Backoff() noexcept { m_Value = std::min(2 * m_Value, m_Maximum); }
+
+        constexpr std::chrono::milliseconds Value() const noexcept { return m_Value; }
+        constexpr std::chrono::milliseconds Smoothed() const noexcept { return m_Smoothed; }
+
+    private:
+        static constexpr std::chrono::milliseconds INITIAL{1000};
+        static constexpr std::chrono::milliseconds GRANULARITY{1};
+
+        std::chrono::milliseconds m_Minimum;
+        std::chrono::milliseconds m_Maximum;
+        std::chrono::milliseconds m_Value;
+        std::chrono::milliseconds m_Smoothed{0};
+        std::chrono::milliseconds m_Variation{0};
+        bool                      m_HasSample{false};
+    };
+
+    enum class Acknowledged_t : uint8_t
+    {
+        ACKNOWLEDGED,
+        DUPLICATE, // Of a reply already received.
+        UNKNOWN    // Of no message sent on this connection.
+    };
+
+    template <std::size_t WINDOW>
+    class DatagramReliability
+    {
+        static constexpr std::size_t SEQUENCE_SPACE{256};
+
+        static_assert((WINDOW > 0) && (WINDOW <= (SEQUENCE_SPACE / 2)) && ((WINDOW & (WINDOW - 1)) == 0),
+                      "WINDOW must be a power of 2 within half of the sequence space.");
+
+        struct Slot_t
+        {
+            Message_t m_Message{};
+            uint32_t  m_SentAt{0};   // Latest (re)transmission, in ms.
+            uint32_t  m_Deadline{0}; // In ms.
+            uint8_t   m_Sequence{0};
+            uint8_t   m_Retransmissions{0};
+        };
+
+        static constexpr uint32_t Ticks(std::chrono::milliseconds time) noexcept
+        {
+            return static_cast<uint32_t>(time.count());
+        }
+
+        // Negative once the deadline has passed.
+        static constexpr int32_t Remaining(const Slot_t & slot, uint32_t now) noexcept
+        {
+            return static_cast<int32_t>(slot.m_Deadline - now);
+        }
+
+    public:
+        constexpr DatagramReliability(std::chrono::milliseconds minimumRto, std::chrono::milliseconds maximumRto,
+                                      uint8_t maximumRetransmissions) noexcept
+            : m_Rto(minimumRto, maximumRto)
+            , m_MaximumRetransmissions(maximumRetransmissions)
+        {
+            // Every slot holds a sequence number of its own residue, and so
+            // its outstanding bit, from the start.
+            for (std::size_t index = 0; index < WINDOW; ++index)
+            {
+                m_Slots[index].m_Sequence = static_cast<uint8_t>(index);
+            }
+        }
+
+        // For a new connection; the RTT estimate is that of the same path,
+        // so it is kept.
+        void Reset() noexcept
+        {
+            m_Outstanding.reset();
+            m_Acknowledged.reset();
+        }
+
+        void OnSent(uint8_t sequence, const Message_t & message, std::chrono::milliseconds now) noexcept
+        {
+            auto & slot = m_Slots[sequence % WINDOW];
+            if (slot.m_Sequence != sequence)
+            {
+                // Given up on, should it be outstanding still; the window was overrun.
+                m_Outstanding.reset(slot.m_Sequence);
+            }
+            slot.m_Message = message;
+            slot.m_SentAt = Ticks(now);
+            slot.m_Deadline = Ticks(now + m_Rto.Value());
+            slot.m_Sequence = sequence;
+            slot.m_Retransmissions = 0;
+            m_Outstanding.set(sequence);
+            m_Acknowledged.reset(sequence);
+
+            // Half the sequence space on, a reply is no longer recognizable
+            // as a duplicate but would be taken for that of a new message.
+            m_Acknowledged.reset(static_cast<uint8_t>(sequence + (SEQUENCE_SPACE / 2)));
+        }
+
+        Acknowledged_t OnReply(uint8_t sequence, std::chrono::milliseconds now) noexcept
+        {
+            if (m_Outstanding.test(sequence))
+            {
+                const auto & slot = m_Slots[sequence % WINDOW];
+                if (slot.m_Retransmissions == 0)
+                {
+                    m_Rto.Sample(std::chrono::milliseconds(Ticks(now) - slot.m_SentAt));
+                }
+                m_Outstanding.reset(sequence);
+                m_Acknowledged.set(sequence);
+                return Acknowledged_t::ACKNOWLEDGED;
+            }
+            return m_Acknowledged.test(sequence) ? Acknowledged_t::DUPLICATE : Acknowledged_t::UNKNOWN;
+        }
+
+        bool IsDuplicate(uint8_t sequence) const noexcept
+        {
+            return !m_Outstanding.test(sequence) && m_Acknowledged.test(sequence);
+        }
+
+        // Earliest retransmission deadline of any message outstanding, on
+        // the clock of now; in the past should one be due already.
+        std::optional<std::chrono::milliseconds> NextDeadline(std::chrono::milliseconds now) const noexcept
+        {
+            std::optional<int32_t> earliest;
+            for (const auto & slot : m_Slots)
+            {
+                if (m_Outstanding.test(slot.m_Sequence))
+                {
+                    const auto remaining = Remaining(slot, Ticks(now));
+                    earliest = earliest ? std::min(*earliest, remaining) : remaining;
+                }
+            }
+            if (!earliest)
+            {
+                return std::nullopt;
+            }
+            return now + std::chrono::milliseconds(*earliest);
+        }
+
+        // Hands each message outstanding past its deadline to resend(),
+        // which returns whether it did get sent; one that did not is left
+        // due. The RTO is backed off once per expiry, not once per message.
+        // Returns how many were resent, or nothing once any one message has
+        // used up its retransmissions, i.e. when the link ought to be given up on.
+        template <typename Resend>
+        std::optional<std::size_t> RetransmitDue(std::chrono::milliseconds now, Resend && resend)
+        {
+            std::size_t resent = 0;
+            for (auto & slot : m_Slots)
+            {
+                if (!m_Outstanding.test(slot.m_Sequence) || (Remaining(slot, Ticks(now)) > 0))
+                {
+                    continue;
+                }
+                if (slot.m_Retransmissions >= m_MaximumRetransmissions)
+                {
+                    return std::nullopt;
+                }
+                if (!resend(slot.m_Sequence, static_cast<const Message_t &>(slot.m_Message)))
+                {
+                    break;
+                }
+                if (resent++ == 0)
+                {
+                    m_Rto.Backoff();
+                }
+                ++slot.m_Retransmissions;
+                slot.m_SentAt = Ticks(now);
+                slot.m_Deadline = Ticks(now + m_Rto.Value());
+            }
+            return resent;
+        }
+
+        const RetransmissionTimeout & Rto() const noexcept { return m_Rto; }
+
+    private:
+        RetransmissionTimeout                m_Rto;
+        uint8_t                              m_MaximumRetransmissions;
+        std::array<Slot_t, WINDOW>           m_Slots{};
+        std::bitset<SEQUENCE_SPACE>          m_Outstanding;
+        std::bitset<SEQUENCE_SPACE>          m_Acknowledged;
+    };
+
+    static_assert(RetransmissionTimeout(std::chrono::milliseconds(200), std::chrono::milliseconds(30000)).Value()
+                  == std::chrono::milliseconds(1000));
+    static_assert([]()
+    {
+        RetransmissionTimeout rto(std::chrono::milliseconds(200), std::chrono::milliseconds(30000));
+        rto.Sample(std::chrono::milliseconds(100));
+        return rto.Value(); // 100 + 4 * 50
+    }() == std::chrono::milliseconds(300));
+    static_assert([]()
+    {
+        RetransmissionTimeout rto(std::chrono::milliseconds(200), std::chrono::milliseconds(3000));
+        rto.Backoff();
+        rto.Backoff();
+        return rto.Value();
+    }() == std::chrono::milliseconds(3000));
+} // end of namespace
@@ -0,0 +1,208 @@
+/***********************************************************************
+* @file      DeferredLog.h
+*
+*    Deferred, lock-free logger for the LightControl message hot path.
+*
+*    At platform.stdio-baud-rate 9600 a single printf of a typical line
+*    holds up the event queue for tens of milliseconds. Record() instead
+*    only stores a log point ID, a timestamp and a few integer arguments
+*    into a single-producer/single-consumer ring of fixed-size records,
+*    which costs a handful of loads and stores and never blocks. A low
+*    priority thread drains the ring to the console in the background.
+*
+*    When the ring is full the record is dropped, and counted; the drain
+*    thread reports how many were dropped once it has caught up.
+*
+*    The drain thread either formats records as text, or writes them out
+*    raw, for host/LogDecoder.cpp to format on the host (see LogCatalog.h).
+*    It holds the console's mutex, if given one, for each batch drained,
+*    so that no other thread's printf() output lands in between records.
+*
+* @brief
+*
+* @note    Raw output is binary; the console must not translate newlines
+*          (platform.stdio-convert-newlines false) for it to decode.
+*
+* @warning Record() must only ever be called from one thread at a time,
+*          i.e. from the shared event queue that runs the exchange.
+*
+* @author  Nuertey Odzeyem
+*
+* @date    May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <array>
+#include <type_traits>
+
+#include "mbed.h"
+
+#include "LogCatalog.h"
+
+namespace LightControl
+{
+    template <std::size_t CAPACITY>
+    class DeferredLog
+    {
+        static_assert((CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of 2.");
+
+        static constexpr std::size_t MASK{CAPACITY - 1};
+        static constexpr auto        DRAIN_PERIOD{20ms};
+
+    public:
+        DeferredLog() = default;
+
+        DeferredLog(const DeferredLog&) = delete;
+        DeferredLog& operator=(const DeferredLog&) = delete;
+
+        ~DeferredLog()
+        {
+            Stop();
+        }
+
+        template <typename... Args>
+        void Record(LogPoint_t point, Args... arguments) noexcept
+        {
+            static_assert(sizeof...(Args) <= MAXIMUM_LOG_ARGUMENTS, "Too many log arguments.");
+            static_assert((std::is_integral_v<Args> && ...), "Log arguments must be integers.");
+
+            const auto tail = m_Tail.load(std::memory_order_relaxed);
+            if ((tail - m_Head.load(std::memory_order_acquire)) == CAPACITY)
+            {
+                m_DroppedCount.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            auto & record = m_Records[tail & MASK];
+            record.m_ArgumentCount = sizeof...(Args);
+            record.m_LogPoint = static_cast<uint16_t>(point);
+            record.m_TimestampMilliseconds = static_cast<uint32_t>(
+                Kernel::Clock::now().time_since_epoch().count());
+            std::size_t index = 0;
+            ((record.m_Arguments[index++] = static_cast<int32_t>(arguments)), ...);
+
+            m_Tail.store(tail + 1, std::memory_order_release);
+        }
+
+        // Formats, or writes out raw, every record logged so far. Called
+        // by the drain thread; may be called directly if there is none.
+        std::size_t Drain(FILE * stream, bool isRaw)
+        {
+            std::size_t drained = 0;
+            auto head = m_Head.load(std::memory_order_relaxed);
+
+            while (head != m_Tail.load(std::memory_order_acquire))
+            {
+                Emit(stream, isRaw, m_Records[head & MASK]);
+                m_Head.store(++head, std::memory_order_release);
+                ++drained;
+            }
+
+            const auto dropped = m_DroppedCount.load(std::memory_order_relaxed);
+            if (dropped != m_ReportedDroppedCount)
+            {
+                LogRecord_t record;
+                record.m_ArgumentCount = 1;
+                record.m_LogPoint = static_cast<uint16_t>(LogPoint_t::RECORDS_DROPPED);
+                record.m_TimestampMilliseconds = static_cast<uint32_t>(
+                    Kernel::Clock::now().time_since_epoch().count());
+                record.m_Arguments[0] = static_cast<int32_t>(dropped - m_ReportedDroppedCount);
+                Emit(stream, isRaw, record);
+                m_ReportedDroppedCount = dropped;
+            }
+
+            if (drained > 0)
+            {
+                fflush(stream);
+            }
+            return drained;
+        }
+
+        // The mutex, if any, is the one that every other writer to the
+        // stream takes.
+        void Start(FILE * stream, bool isRaw, PlatformMutex * pStreamMutex = nullptr)
+        {
+            if (m_IsRunning.exchange(true))
+            {
+                return;
+            }
+
+            m_pStream = stream;
+            m_IsRaw = isRaw;
+            m_pStreamMutex = pStreamMutex;
+            [[maybe_unused]] auto status = m_DrainThread.start(mbed::callback(this, &DeferredLog::DrainForever));
+            MBED_ASSERT(status == osOK);
+        }
+
+        // Drains whatever is still outstanding before returning.
+        void Stop()
+        {
+            if (m_IsRunning.exchange(false))
+            {
+                m_DrainThread.join();
+            }
+        }
+
+        uint32_t GetDroppedCount() const noexcept { return m_DroppedCount.load(std::memory_order_relaxed); }
+
+    private:
+        void DrainForever()
+        {
+            while (m_IsRunning.load(std::memory_order_relaxed))
+            {
+                DrainBatch();
+                ThisThread::sleep_for(DRAIN_PERIOD);
+            }
+            DrainBatch();
+        }
+
+        void DrainBatch()
+        {
+            // Nothing to write, and so no need to hold up the other writers.
+            if ((m_Head.load(std::memory_order_relaxed) == m_Tail.load(std::memory_order_acquire))
+                && (m_DroppedCount.load(std::memory_order_relaxed) == m_ReportedDroppedCount))
+            {
+                return;
+            }
+
+            if (m_pStreamMutex)
+            {
+                m_pStreamMutex->lock();
+            }
+            Drain(m_pStream, m_IsRaw);
+            if (m_pStreamMutex)
+            {
+                m_pStreamMutex->unlock();
+            }
+        }
+
+        static void Emit(FILE * stream, bool isRaw, const LogRecord_t & record)
+        {
+            if (isRaw)
+            {
+                fwrite(&record, sizeof(record), 1, stream);
+            }
+            else
+            {
+                Print(stream, record);
+            }
+        }
+
+        std::array<LogRecord_t, CAPACITY> m_Records{};
+
+        // Free-running indices; only the producer writes m_Tail and only
+        // the consumer writes m_Head.
+        std::atomic<uint32_t>             m_Tail{0};
+        std::atomic<uint32_t>             m_Head{0};
+        std::atomic<uint32_t>             m_DroppedCount{0};
+        uint32_t                          m_ReportedDroppedCount{0};
+
+        std::atomic<bool>                 m_IsRunning{false};
+        FILE *                            m_pStream{nullptr};
+        bool                              m_IsRaw{false};
+        PlatformMutex *                   m_pStreamMutex{nullptr};
+        rtos::Thread                      m_DrainThread{osPriorityLow};
+    };
+} // end of namespace
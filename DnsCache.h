@@ -0,0 +1,188 @@
+/***********************************************************************
+* @file      DnsCache.h
+*
+*    Persistent cache of the resolved address of the echo/control server.
+*
+*    Over LTE Cat-M1 a DNS round trip can add seconds to every (re)connect,
+*    and wakes the radio for an extra exchange besides. The address that
+*    the server's domain name last resolved to is therefore kept, with an
+*    expiry time, both in RAM and in KVStore so that it survives reboots.
+*    A connect uses the cached address straight away, whatever its age;
+*    it is merely refreshed, in the background, once expired.
+*
+*    Mbed OS does not hand the DNS record's TTL up to the application, so
+*    the expiry is that of a configured TTL (dns-cache-ttl-seconds).
+*
+* @brief
+*
+* @note    Nothing sets the RTC on this firmware, so expiry is kept in
+*          monotonic Kernel::Clock time, for the current boot. The record
+*          persisted also carries an RTC (time()) expiry, which carries
+*          over a reboot should the RTC have been set; otherwise a cached
+*          address loaded at boot is refreshed once, in the background.
+*          A refresh that finds the same address does not write KVStore.
+*
+* @warning Not thread-safe; owned by whichever context (re)connects.
+*
+* @author  Nuertey Odzeyem
+*
+* @date    May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <optional>
+#include <string>
+
+#include "mbed.h"
+#include "kvstore_global_api.h"
+
+class DnsCache
+{
+    static constexpr uint32_t    RECORD_VERSION{1};
+    static constexpr std::size_t MAXIMUM_HOSTNAME_SIZE{64};
+
+    // Any RTC reading before this (2022-01-01) means that it was never set.
+    static constexpr std::time_t EARLIEST_VALID_TIME{1640995200};
+
+    // Persisted as is.
+    struct Record_t
+    {
+        uint32_t    m_Version;
+        char        m_HostName[MAXIMUM_HOSTNAME_SIZE];
+        char        m_Address[NSAPI_IP_SIZE];
+        int64_t     m_ExpiresAt; // time() seconds; 0 when unknown.
+    };
+
+    static bool IsRealTimeSet(std::time_t now) { return (now >= EARLIEST_VALID_TIME); }
+
+public:
+    // A KVStore key such as "/kv/lcdns", or nullptr to cache in RAM only.
+    DnsCache(const char * pKey, std::chrono::seconds ttl)
+        : m_pKey(pKey)
+        , m_TimeToLive(ttl)
+        , m_Record{}
+        , m_RefreshAt(std::nullopt)
+        , m_IsLoaded(false)
+    {
+    }
+
+    DnsCache(const DnsCache&) = delete;
+    DnsCache& operator=(const DnsCache&) = delete;
+
+    // The cached address of hostName, however old, if there is one.
+    std::optional<SocketAddress> Lookup(const std::string & hostName)
+    {
+        Load();
+
+        if ((m_Record.m_Version != RECORD_VERSION) || (hostName != m_Record.m_HostName))
+        {
+            return std::nullopt;
+        }
+
+        SocketAddress address;
+        if (!address.set_ip_address(m_Record.m_Address))
+        {
+            return std::nullopt;
+        }
+        return address;
+    }
+
+    // Whether the cached address ought to be refreshed.
+    bool IsExpired() const
+    {
+        return !m_RefreshAt || (Kernel::Clock::now() >= *m_RefreshAt);
+    }
+
+    void Store(const std::string & hostName, const SocketAddress & address)
+    {
+        const char * pAddress = address.get_ip_address();
+        if (!pAddress || (hostName.size() >= MAXIMUM_HOSTNAME_SIZE))
+        {
+            return;
+        }
+
+        Load();
+
+        const auto now = std::time(nullptr);
+        m_RefreshAt = Kernel::Clock::now() + m_TimeToLive;
+
+        // Flash is only worn when the address has actually changed.
+        const bool isUnchanged = (m_Record.m_Version == RECORD_VERSION) && (hostName == m_Record.m_HostName)
+                              && (std::strcmp(pAddress, m_Record.m_Address) == 0);
+        if (isUnchanged)
+        {
+            return;
+        }
+
+        Record_t record{};
+        record.m_Version = RECORD_VERSION;
+        std::strncpy(record.m_HostName, hostName.c_str(), sizeof(record.m_HostName) - 1);
+        std::strncpy(record.m_Address, pAddress, sizeof(record.m_Address) - 1);
+        record.m_ExpiresAt = IsRealTimeSet(now) ? static_cast<int64_t>(now + m_TimeToLive.count()) : 0;
+
+        m_Record = record;
+
+        if (m_pKey)
+        {
+            int rc = kv_set(m_pKey, &m_Record, sizeof(m_Record), 0);
+            if (rc != MBED_SUCCESS)
+            {
+                printf("Error! Persisting the DNS cache failed: [%d]\r\n", rc);
+            }
+        }
+    }
+
+    // For when the cached address turned out not to be reachable.
+    void Invalidate()
+    {
+        m_Record = Record_t{};
+        m_RefreshAt.reset();
+        m_IsLoaded = true;
+
+        if (m_pKey)
+        {
+            [[maybe_unused]] auto rc = kv_remove(m_pKey);
+        }
+    }
+
+private:
+    void Load()
+    {
+        if (m_IsLoaded)
+        {
+            return;
+        }
+        m_IsLoaded = true;
+
+        if (m_pKey)
+        {
+            Record_t record{};
+            std::size_t actualSize = 0;
+            int rc = kv_get(m_pKey, &record, sizeof(record), &actualSize);
+            if ((rc == MBED_SUCCESS) && (actualSize == sizeof(record)) && (record.m_Version == RECORD_VERSION))
+            {
+                record.m_HostName[sizeof(record.m_HostName) - 1] = '\0';
+                record.m_Address[sizeof(record.m_Address) - 1] = '\0';
+                m_Record = record;
+
+                // What is left of its TTL, if the RTC can tell.
+                const auto now = std::time(nullptr);
+                if (IsRealTimeSet(now) && (record.m_ExpiresAt > now))
+                {
+                    m_RefreshAt = Kernel::Clock::now() + std::chrono::seconds(record.m_ExpiresAt - now);
+                }
+            }
+        }
+    }
+
+    const char *          m_pKey;
+    std::chrono::seconds  m_TimeToLive;
+    Record_t              m_Record;
+    std::optional<Kernel::Clock::time_point> m_RefreshAt; // Monotonic; this boot only.
+    bool                  m_IsLoaded;
+};
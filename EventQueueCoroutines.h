@@ -0,0 +1,538 @@
+/***********************************************************************
+* @file      EventQueueCoroutines.h
+*
+*    C++20 coroutines driven by the shared Mbed OS EventQueue, so that a
+*    connection's session logic can be written as straight-line code that
+*    co_awaits a DNS lookup, a connect, a send, a receive with a timeout,
+*    or a sleep, without blocking the event queue's thread, or any other.
+*
+*    Every awaitable resumes its coroutine from an event on the queue,
+*    whichever context (network stack, DNS, interrupt) the completion was
+*    signalled from; the coroutines themselves thus only ever run on the
+*    queue's thread, exactly like any other event handler.
+*
+*    Coroutine frames never come from the heap. Task<T>'s promise takes
+*    them from a CoroutineFrameArena, a fixed number of fixed-size slots
+*    in storage handed over by the owner. Should no slot be free, or the
+*    frame not fit one, the Task comes back empty instead (the compiler's
+*    get_return_object_on_allocation_failure() path), which the caller
+*    checks for, as it would a failed socket open().
+*
+* @brief
+*
+* @note    The sigio() callback of a socket "may be called in an interrupt
+*          context"; all that AsyncSocket does in it is to post one event.
+*
+* @warning Not thread-safe; coroutines are created, resumed and destroyed
+*          on the event queue's thread only. An AsyncSocket, and the frame
+*          arena, must outlive every event they have posted.
+*
+* @author  Nuertey Odzeyem
+*
+* @date    May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <span>
+#include <utility>
+
+#include "mbed.h"
+#include "mbed_events.h"
+
+// A fixed number of fixed-size slots, carved out of caller-provided storage.
+class CoroutineFrameArena
+{
+public:
+    static constexpr std::size_t MAXIMUM_SLOTS{32};
+
+    static CoroutineFrameArena & Instance()
+    {
+        static CoroutineFrameArena theInstance;
+        return theInstance;
+    }
+
+    // Slots must be a multiple of alignof(std::max_align_t) in size.
+    void Provide(std::span<std::byte> storage, std::size_t slotSize)
+    {
+        MBED_ASSERT((slotSize % alignof(std::max_align_t)) == 0);
+        m_pStorage = storage.data();
+        m_SlotSize = slotSize;
+        m_SlotCount = std::min(storage.size() / slotSize, MAXIMUM_SLOTS);
+        m_InUse = 0;
+    }
+
+    void * Allocate(std::size_t size) noexcept
+    {
+        const uint32_t available = ~m_InUse & ((m_SlotCount < 32) ? ((1u << m_SlotCount) - 1) : ~0u);
+        if ((size > m_SlotSize) || (available == 0))
+        {
+            ++m_Failures;
+            return nullptr;
+        }
+        const auto slot = static_cast<std::size_t>(std::countr_zero(available));
+        m_InUse |= (1u << slot);
+        m_HighWater = std::max(m_HighWater, static_cast<std::size_t>(std::popcount(m_InUse)));
+        m_LargestFrame = std::max(m_LargestFrame, size);
+        return m_pStorage + (slot * m_SlotSize);
+    }
+
+    void Free(void * pFrame) noexcept
+    {
+        const auto slot = static_cast<std::size_t>(static_cast<std::byte *>(pFrame) - m_pStorage) / m_SlotSize;
+        m_InUse &= ~(1u << slot);
+    }
+
+    std::size_t InUse() const { return static_cast<std::size_t>(std::popcount(m_InUse)); }
+    std::size_t HighWater() const { return m_HighWater; }
+    std::size_t LargestFrame() const { return m_LargestFrame; }
+    uint32_t    Failures() const { return m_Failures; }
+
+private:
+    CoroutineFrameArena() = default;
+
+    std::byte * m_pStorage{nullptr};
+    std::size_t m_SlotSize{0};
+    std::size_t m_SlotCount{0};
+    uint32_t    m_InUse{0};
+    std::size_t m_HighWater{0};
+    std::size_t m_LargestFrame{0};
+    uint32_t    m_Failures{0};
+};
+
+template <typename T>
+class Task;
+
+namespace CoroutineDetail
+{
+    struct PromiseBase
+    {
+        static void * operator new(std::size_t size) noexcept
+        {
+            return CoroutineFrameArena::Instance().Allocate(size);
+        }
+
+        static void operator delete(void * pFrame) noexcept
+        {
+            CoroutineFrameArena::Instance().Free(pFrame);
+        }
+
+        // Lazily started; by co_await, or by Detach().
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter
+        {
+            bool await_ready() noexcept { return false; }
+
+            template <typename Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+            {
+                auto & promise = handle.promise();
+                if (promise.m_IsDetached)
+                {
+                    // Nobody is left to destroy it; the frame goes back now.
+                    handle.destroy();
+                    return std::noop_coroutine();
+                }
+                return promise.m_Continuation ? promise.m_Continuation : std::noop_coroutine();
+            }
+
+            void await_resume() noexcept {}
+        };
+
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        // Built without exceptions on target; nothing is ever thrown.
+        void unhandled_exception() noexcept { std::terminate(); }
+
+        std::coroutine_handle<> m_Continuation{};
+        bool                    m_IsDetached{false};
+    };
+
+    template <typename T>
+    struct Promise : PromiseBase
+    {
+        Task<T> get_return_object() noexcept;
+        static Task<T> get_return_object_on_allocation_failure() noexcept { return Task<T>(); }
+
+        void return_value(T value) noexcept { m_Value = std::move(value); }
+
+        T m_Value{};
+    };
+
+    template <>
+    struct Promise<void> : PromiseBase
+    {
+        Task<void> get_return_object() noexcept;
+        static Task<void> get_return_object_on_allocation_failure() noexcept;
+
+        void return_void() noexcept {}
+    };
+} // end of namespace CoroutineDetail
+
+// A coroutine whose result is co_awaited by another coroutine, or which
+// is Detach()ed to run on its own, as the root of a session.
+template <typename T = void>
+class [[nodiscard]] Task
+{
+public:
+    using promise_type = CoroutineDetail::Promise<T>;
+
+    Task() = default;
+    explicit Task(std::coroutine_handle<promise_type> handle) : m_Handle(handle) {}
+
+    Task(Task && other) noexcept : m_Handle(std::exchange(other.m_Handle, {})) {}
+    Task & operator=(Task && other) noexcept
+    {
+        if (this != &other)
+        {
+            Destroy();
+            m_Handle = std::exchange(other.m_Handle, {});
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() { Destroy(); }
+
+    // False should no frame have been available for it.
+    explicit operator bool() const { return static_cast<bool>(m_Handle); }
+
+    // Starts it, here and now, up to its first suspension; its frame
+    // returns to the arena by itself once it has run to completion.
+    void Detach()
+    {
+        MBED_ASSERT(m_Handle);
+        auto handle = std::exchange(m_Handle, {});
+        handle.promise().m_IsDetached = true;
+        handle.resume();
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept
+    {
+        MBED_ASSERT(m_Handle);
+        m_Handle.promise().m_Continuation = caller;
+        return m_Handle;
+    }
+
+    T await_resume() noexcept
+    {
+        if constexpr (!std::is_void_v<T>)
+        {
+            return std::move(m_Handle.promise().m_Value);
+        }
+    }
+
+private:
+    void Destroy()
+    {
+        if (m_Handle)
+        {
+            m_Handle.destroy();
+            m_Handle = {};
+        }
+    }
+
+    std::coroutine_handle<promise_type> m_Handle{};
+};
+
+namespace CoroutineDetail
+{
+    template <typename T>
+    Task<T> Promise<T>::get_return_object() noexcept
+    {
+        return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+    }
+
+    inline Task<void> Promise<void>::get_return_object() noexcept
+    {
+        return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+    }
+
+    inline Task<void> Promise<void>::get_return_object_on_allocation_failure() noexcept
+    {
+        return Task<void>();
+    }
+} // end of namespace CoroutineDetail
+
+// co_await SleepFor(queue, 100ms); a duration of zero merely lets every
+// event already due on the queue run first.
+class SleepFor
+{
+public:
+    SleepFor(events::EventQueue & queue, std::chrono::milliseconds duration)
+        : m_Queue(queue), m_Duration(duration)
+    {
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        m_Handle = handle;
+        m_Queue.call_in(m_Duration, this, &SleepFor::Resume);
+    }
+
+    void await_resume() const noexcept {}
+
+private:
+    void Resume() { m_Handle.resume(); }
+
+    events::EventQueue &      m_Queue;
+    std::chrono::milliseconds m_Duration;
+    std::coroutine_handle<>   m_Handle{};
+};
+
+// co_await ResolveAsync(queue, pInterface, "echo.example.com"), over
+// NetworkInterface::gethostbyname_async().
+class ResolveAsync
+{
+public:
+    struct Resolved_t
+    {
+        nsapi_value_or_error_t m_Result;
+        SocketAddress          m_Address;
+    };
+
+    ResolveAsync(events::EventQueue & queue, NetworkInterface * pInterface, const char * pHostName)
+        : m_Queue(queue), m_pInterface(pInterface), m_pHostName(pHostName)
+    {
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> handle)
+    {
+        m_Handle = handle;
+        const auto rc = m_pInterface->gethostbyname_async(m_pHostName,
+                            mbed::callback(this, &ResolveAsync::OnResolved));
+        if (rc < 0)
+        {
+            // Failed outright; the callback is never called.
+            m_Resolved.m_Result = rc;
+            return false;
+        }
+        return true;
+    }
+
+    Resolved_t await_resume() const { return m_Resolved; }
+
+private:
+    // In the DNS client's context; possibly from within await_suspend().
+    void OnResolved(nsapi_value_or_error_t result, SocketAddress * pAddress)
+    {
+        m_Resolved.m_Result = result;
+        if ((result >= 0) && pAddress)
+        {
+            m_Resolved.m_Address = *pAddress;
+        }
+        m_Queue.call(this, &ResolveAsync::Resume);
+    }
+
+    void Resume() { m_Handle.resume(); }
+
+    events::EventQueue &    m_Queue;
+    NetworkInterface *      m_pInterface;
+    const char *            m_pHostName;
+    Resolved_t              m_Resolved{NSAPI_ERROR_DNS_FAILURE, SocketAddress()};
+    std::coroutine_handle<> m_Handle{};
+};
+
+// Non-blocking socket operations, awaited rather than polled. An attempt
+// that would block suspends the coroutine until the socket's next sigio,
+// when it is attempted again, or until the timeout, when it completes
+// with NSAPI_ERROR_WOULD_BLOCK, just as a blocking call would have.
+class AsyncSocket
+{
+    // One operation is awaited at a time; the one awaiting is registered.
+    struct Pending_t
+    {
+        virtual bool Retry() = 0; // True once it has its result.
+        virtual void Complete(nsapi_size_or_error_t rc) = 0;
+
+        std::coroutine_handle<> m_Handle{};
+    };
+
+    static constexpr bool IsPending(nsapi_size_or_error_t rc)
+    {
+        return (rc == NSAPI_ERROR_WOULD_BLOCK) || (rc == NSAPI_ERROR_IN_PROGRESS) || (rc == NSAPI_ERROR_ALREADY);
+    }
+
+    template <typename Attempt>
+    class Operation : Pending_t
+    {
+    public:
+        Operation(AsyncSocket & socket, Attempt attempt, std::chrono::milliseconds timeout)
+            : m_Socket(socket), m_Attempt(std::move(attempt)), m_Timeout(timeout)
+        {
+        }
+
+        bool await_ready()
+        {
+            m_Result = m_Attempt();
+            return !IsPending(m_Result);
+        }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            m_Handle = handle;
+            m_Socket.Await(this, m_Timeout);
+        }
+
+        nsapi_size_or_error_t await_resume() const { return m_Result; }
+
+    private:
+        bool Retry() override
+        {
+            m_Result = m_Attempt();
+            return !IsPending(m_Result);
+        }
+
+        void Complete(nsapi_size_or_error_t rc) override { m_Result = rc; }
+
+        AsyncSocket &             m_Socket;
+        Attempt                   m_Attempt;
+        std::chrono::milliseconds m_Timeout;
+        nsapi_size_or_error_t     m_Result{NSAPI_ERROR_WOULD_BLOCK};
+    };
+
+public:
+    explicit AsyncSocket(events::EventQueue & queue) : m_Queue(queue) {}
+
+    AsyncSocket(const AsyncSocket&) = delete;
+    AsyncSocket& operator=(const AsyncSocket&) = delete;
+
+    // Puts an open socket into non-blocking mode and takes over its sigio.
+    void Attach(Socket * pSocket)
+    {
+        m_pSocket = pSocket;
+        m_pSocket->set_blocking(false);
+        m_pSocket->sigio(mbed::callback(this, &AsyncSocket::OnSigio));
+    }
+
+    // Any operation still awaited completes with NSAPI_ERROR_NO_SOCKET,
+    // from an event of its own, i.e. not from within this call. Another
+    // operation may be awaited straight away.
+    void Abort()
+    {
+        if (m_pSocket)
+        {
+            m_pSocket->sigio(nullptr);
+        }
+        if (m_pPending)
+        {
+            CancelTimeout();
+            auto * pAborted = std::exchange(m_pPending, nullptr);
+            pAborted->Complete(NSAPI_ERROR_NO_SOCKET);
+            m_Queue.call([handle = pAborted->m_Handle]() { handle.resume(); });
+        }
+    }
+
+    // Attempts the given operation, nsapi_size_or_error_t attempt(), for
+    // as long as it would block, or until the timeout.
+    template <typename Attempt>
+    Operation<Attempt> Perform(Attempt attempt, std::chrono::milliseconds timeout)
+    {
+        return Operation<Attempt>(*this, std::move(attempt), timeout);
+    }
+
+    auto Connect(const SocketAddress & address, std::chrono::milliseconds timeout)
+    {
+        return Perform([this, address]()
+        {
+            const auto rc = m_pSocket->connect(address);
+            return (rc == NSAPI_ERROR_IS_CONNECTED) ? NSAPI_ERROR_OK : rc;
+        }, timeout);
+    }
+
+    auto Send(const void * pData, nsapi_size_t size, std::chrono::milliseconds timeout)
+    {
+        return Perform([this, pData, size]() { return m_pSocket->send(pData, size); }, timeout);
+    }
+
+    auto Receive(void * pData, nsapi_size_t size, std::chrono::milliseconds timeout)
+    {
+        return Perform([this, pData, size]() { return m_pSocket->recv(pData, size); }, timeout);
+    }
+
+    // Completes with NSAPI_ERROR_OK on the socket's next sigio, for a
+    // caller that attempts its own operations.
+    auto WhenReady(std::chrono::milliseconds timeout)
+    {
+        return Perform([isFirst = true]() mutable
+        {
+            return std::exchange(isFirst, false) ? NSAPI_ERROR_WOULD_BLOCK : NSAPI_ERROR_OK;
+        }, timeout);
+    }
+
+private:
+    void Await(Pending_t * pPending, std::chrono::milliseconds timeout)
+    {
+        MBED_ASSERT(!m_pPending);
+        m_pPending = pPending;
+        m_TimeoutEventId = m_Queue.call_in(timeout, this, &AsyncSocket::OnTimeout);
+    }
+
+    // In the network stack's context.
+    void OnSigio()
+    {
+        if (!m_IsReadyPosted.exchange(true))
+        {
+            m_Queue.call(this, &AsyncSocket::OnReady);
+        }
+    }
+
+    void OnReady()
+    {
+        m_IsReadyPosted = false;
+        if (m_pPending && m_pPending->Retry())
+        {
+            Resume();
+        }
+    }
+
+    void OnTimeout()
+    {
+        m_TimeoutEventId = 0;
+        if (m_pPending)
+        {
+            m_pPending->Complete(NSAPI_ERROR_WOULD_BLOCK);
+            Resume();
+        }
+    }
+
+    void CancelTimeout()
+    {
+        if (m_TimeoutEventId)
+        {
+            m_Queue.cancel(m_TimeoutEventId);
+            m_TimeoutEventId = 0;
+        }
+    }
+
+    void Resume()
+    {
+        CancelTimeout();
+        const auto handle = std::exchange(m_pPending, nullptr)->m_Handle;
+        handle.resume();
+    }
+
+    events::EventQueue & m_Queue;
+    Socket *             m_pSocket{nullptr};
+    Pending_t *          m_pPending{nullptr};
+    int                  m_TimeoutEventId{0};
+    std::atomic<bool>    m_IsReadyPosted{false};
+};
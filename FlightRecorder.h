@@ -0,0 +1,258 @@
+/***********************************************************************
+* @file      FlightRecorder.h
+*
+*    Crash-persistent flight recorder of cellular and LightControl events.
+*
+*    mbed-trace formats every line with snprintf into a static buffer,
+*    under a mutex, and so is disabled in production; which leaves nothing
+*    to look at when a unit in the field hangs or faults. Instead, the
+*    events that matter after the fact (boots and their reset reason, the
+*    fault before a reset, network status changes, cellular events, socket
+*    errors, reply timeouts, reconnects and parse failures) are recorded,
+*    always, as fixed-size 16-byte records into a ring in RAM: a log point
+*    ID from LogCatalog.h, a timestamp and two integer arguments. That is
+*    a handful of stores and a hash, inside a critical section, from any
+*    context, interrupts included.
+*
+*    The ring lives in a no-init RAM section that the startup code neither
+*    zeroes nor initializes, so that it survives a reset, watchdog and
+*    fault resets included. On boot, an intact ring is carried on with
+*    (and its boot count advanced), else started afresh. Each record
+*    carries a check of its own, so that one torn by a reset mid-write is
+*    told apart and skipped, rather than the whole ring being lost.
+*
+*    The ring is retrieved as one raw image, FlightRecorderImage_t: dumped
+*    to the console on boot (flight-recorder-dump-on-boot), or read from
+*    the RAM of a hung unit with a debugger. host/FlightRecorderDecoder.cpp
+*    finds the image in either, and formats its records, oldest first,
+*    with the very format strings of LogCatalog.h.
+*
+* @brief
+*
+* @note    Deliberately free of any Mbed OS dependency so that the host
+*          decoder shares this very layout. LEDLightControl.h places the
+*          image, times the records and takes the critical section.
+*
+* @warning The image is a wire format, in the target's (little-endian)
+*          byte order; append fields to FlightRecord_t never. The .noinit
+*          section is defined by the linker scripts in linker/ only; check
+*          in the map file that it lies outside of .data and .bss.
+*
+* @author  Nuertey Odzeyem
+*
+* @date    May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+#include "LogCatalog.h"
+
+namespace LightControl
+{
+    static constexpr uint32_t    FLIGHT_RECORDER_MAGIC{0x31544C46}; // "FLT1"
+    static constexpr std::size_t FLIGHT_RECORD_ARGUMENTS{2};
+
+    // No default member initializers, so that the image stays trivial and
+    // is left alone by the startup code; value-initialize it on the host.
+    struct FlightRecord_t
+    {
+        uint32_t m_TimestampMilliseconds;
+        uint16_t m_LogPoint;
+        uint16_t m_Check;
+        int32_t  m_Arguments[FLIGHT_RECORD_ARGUMENTS];
+    };
+
+    static_assert(sizeof(FlightRecord_t) == 16, "FlightRecord_t is a wire format; keep it packed.");
+
+    template <std::size_t CAPACITY>
+    struct FlightRecorderImage_t
+    {
+        uint32_t m_Magic;
+        uint32_t m_Capacity;
+        uint32_t m_BootCount;
+        uint32_t m_HeaderCheck; // Of the 3 above.
+        uint32_t m_Next;        // Free-running; records are only ever appended.
+        uint32_t m_Reserved;
+        std::array<FlightRecord_t, CAPACITY> m_Records;
+    };
+
+    // The header of any image, whatever its capacity; what a decoder
+    // scans its input for.
+    static constexpr std::size_t FLIGHT_RECORDER_HEADER_SIZE{6 * sizeof(uint32_t)};
+    static_assert(offsetof(FlightRecorderImage_t<1>, m_Records) == FLIGHT_RECORDER_HEADER_SIZE);
+
+    // FNV-1a, a word at a time. Never 0 over an all-zero record, so that
+    // cleared and never written slots do not pass for records either.
+    constexpr uint16_t FlightRecordCheck(const FlightRecord_t & record) noexcept
+    {
+        uint32_t hash = 2166136261u;
+        for (const uint32_t word : {record.m_TimestampMilliseconds, static_cast<uint32_t>(record.m_LogPoint),
+                                    static_cast<uint32_t>(record.m_Arguments[0]),
+                                    static_cast<uint32_t>(record.m_Arguments[1])})
+        {
+            hash = (hash ^ word) * 16777619u;
+        }
+        return static_cast<uint16_t>(hash ^ (hash >> 16));
+    }
+
+    constexpr uint32_t FlightRecorderHeaderCheck(uint32_t magic, uint32_t capacity, uint32_t bootCount) noexcept
+    {
+        return ((magic ^ (capacity * 2654435761u)) ^ (bootCount * 40503u)) ^ 0x5A5A5A5Au;
+    }
+
+    constexpr bool IsValid(const FlightRecord_t & record) noexcept
+    {
+        return (record.m_LogPoint < static_cast<uint16_t>(LogPoint_t::COUNT))
+            && (record.m_Check == FlightRecordCheck(record));
+    }
+
+    // Hands every intact record of a ring to onRecord, oldest first, and
+    // returns the number of torn, or never written, slots skipped.
+    template <typename OnRecord>
+    constexpr std::size_t ForEachFlightRecord(std::span<const FlightRecord_t> records, uint32_t next,
+                                              OnRecord && onRecord)
+    {
+        const auto count = (next < records.size()) ? next : static_cast<uint32_t>(records.size());
+        std::size_t skipped = 0;
+        for (auto index = next - count; index != next; ++index)
+        {
+            const auto & record = records[index % records.size()];
+            if (IsValid(record))
+            {
+                onRecord(record);
+            }
+            else
+            {
+                ++skipped;
+            }
+        }
+        return skipped;
+    }
+
+    template <std::size_t CAPACITY>
+    class FlightRecorder
+    {
+        static_assert((CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of 2.");
+
+        static constexpr std::size_t MASK{CAPACITY - 1};
+
+    public:
+        using Image_t = FlightRecorderImage_t<CAPACITY>;
+
+        constexpr explicit FlightRecorder(Image_t & image) noexcept
+            : m_Image(image)
+        {
+        }
+
+        FlightRecorder(const FlightRecorder&) = delete;
+        FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+        // Once per boot, before anything is recorded. Carries on with the
+        // ring as the previous boot left it, should it be intact, and then
+        // returns true; else clears it. Either way the boot is counted.
+        constexpr bool Boot() noexcept
+        {
+            const bool isIntact = (m_Image.m_Magic == FLIGHT_RECORDER_MAGIC) && (m_Image.m_Capacity == CAPACITY)
+                && (m_Image.m_HeaderCheck == FlightRecorderHeaderCheck(m_Image.m_Magic, m_Image.m_Capacity,
+                                                                       m_Image.m_BootCount));
+            if (!isIntact)
+            {
+                m_Image = Image_t{};
+                m_Image.m_Magic = FLIGHT_RECORDER_MAGIC;
+                m_Image.m_Capacity = CAPACITY;
+            }
+            ++m_Image.m_BootCount;
+            m_Image.m_HeaderCheck = FlightRecorderHeaderCheck(m_Image.m_Magic, m_Image.m_Capacity,
+                                                              m_Image.m_BootCount);
+            return isIntact;
+        }
+
+        // Overwrites the oldest record once full. The caller serializes.
+        template <typename... Args>
+        constexpr void Record(uint32_t timestampMilliseconds, LogPoint_t point, Args... arguments) noexcept
+        {
+            static_assert(sizeof...(Args) <= FLIGHT_RECORD_ARGUMENTS, "Too many flight record arguments.");
+            static_assert((std::is_integral_v<Args> && ...), "Flight record arguments must be integers.");
+
+            FlightRecord_t record{timestampMilliseconds, static_cast<uint16_t>(point), 0, {}};
+            std::size_t index = 0;
+            ((record.m_Arguments[index++] = static_cast<int32_t>(arguments)), ...);
+            record.m_Check = FlightRecordCheck(record);
+
+            // The record first, then the index; a reset in between loses it.
+            const auto next = m_Image.m_Next;
+            m_Image.m_Records[next & MASK] = record;
+            m_Image.m_Next = next + 1;
+        }
+
+        constexpr uint32_t BootCount() const noexcept { return m_Image.m_BootCount; }
+
+        // Records kept, at most CAPACITY of them.
+        constexpr std::size_t Size() const noexcept
+        {
+            return (m_Image.m_Next < CAPACITY) ? m_Image.m_Next : CAPACITY;
+        }
+
+        constexpr const Image_t & Image() const noexcept { return m_Image; }
+
+        template <typename OnRecord>
+        constexpr std::size_t ForEach(OnRecord && onRecord) const
+        {
+            return ForEachFlightRecord(m_Image.m_Records, m_Image.m_Next, onRecord);
+        }
+
+    private:
+        Image_t & m_Image;
+    };
+
+    // Garbage RAM is cleared; an intact ring survives a "reset" and wraps
+    // around oldest first; and a record torn mid-write is skipped alone.
+    constexpr bool SurvivesReset()
+    {
+        FlightRecorderImage_t<4> image{};
+        image.m_Magic = FLIGHT_RECORDER_MAGIC;
+        image.m_Next = 12345;
+        image.m_Records[1].m_Check = 1;
+
+        uint32_t before = 0;
+        {
+            FlightRecorder<4> recorder(image);
+            if (recorder.Boot() || (recorder.Size() != 0) || (recorder.ForEach([](const auto &) {}) != 0))
+            {
+                return false;
+            }
+            recorder.Record(100, LogPoint_t::BOOTED, recorder.BootCount(), 0);
+            recorder.Record(200, LogPoint_t::SOCKET_ERROR, 2, -3005);
+            before = recorder.BootCount();
+        }
+
+        FlightRecorder<4> recorder(image);
+        if (!recorder.Boot() || (recorder.BootCount() != (before + 1)))
+        {
+            return false;
+        }
+        recorder.Record(10, LogPoint_t::BOOTED, recorder.BootCount(), 3);
+        recorder.Record(20, LogPoint_t::NETWORK_STATUS, 1);
+        recorder.Record(30, LogPoint_t::REPLY_TIMEOUT, 60000);
+
+        // Torn: the ring wrapped, but the oldest record's check is off.
+        image.m_Records[1].m_Arguments[1] = 0;
+
+        uint32_t timestamps = 0;
+        const auto skipped = recorder.ForEach([&](const FlightRecord_t & record)
+        {
+            timestamps = (timestamps * 1000) + record.m_TimestampMilliseconds;
+        });
+        return (skipped == 1) && (timestamps == ((((10 * 1000) + 20) * 1000) + 30))
+            && (recorder.Size() == 4) && (FlightRecordCheck(FlightRecord_t{}) != 0);
+    }
+
+    static_assert(SurvivesReset());
+} // end of namespace
@@ -28,6 +28,8 @@
 ***********************************************************************/
 #pragma once
 
+#include <variant>
+
 #include "mbed.h"
 #include "mbed_assert.h"
 #include "mbed_events.h"
@@ -42,6 +44,22 @@
 #include "cellular_demo_tracing.h"
 
 #include "Utilities.h"
+#include "LightControlCodec.h"
+#include "LightControlFramer.h"
+#include "LightControlGroups.h"
+#include "LightOutputDriver.h"
+#include "DeferredLog.h"
+#include "LinkStatistics.h"
+#include "DnsCache.h"
+#include "ReconnectBackoff.h"
+#include "TrafficScheduler.h"
+#include "DatagramReliability.h"
+#include "LightControlPubSub.h"
+#include "EventQueueCoroutines.h"
+#include "ClockSync.h"
+#include "TimerWheel.h"
+#include "LightDimmer.h"
+#include "FlightRecorder.h"
 
 // TBD Nuertey Odzeyem; confirm if the below holds for both 
 // MTS_DRAGONFLY_L471QG and the NUCLEO_F767ZI targets:
@@ -76,6 +94,250 @@ enum class TransportSocket_t : uint8_t
 static constexpr char ECHO_HOSTNAME[] = MBED_CONF_APP_ECHO_SERVER_HOSTNAME;
 static constexpr int ECHO_PORT = MBED_CONF_APP_ECHO_SERVER_PORT; // Same value holds for TCP and UDP.
 
+#ifdef MBED_CONF_APP_PIPELINE_WINDOW
+static constexpr std::size_t PIPELINE_WINDOW = MBED_CONF_APP_PIPELINE_WINDOW;
+#else
+static constexpr std::size_t PIPELINE_WINDOW = 1;
+#endif
+
+#ifdef MBED_CONF_APP_NON_BLOCKING_SOCKET
+static constexpr bool NON_BLOCKING_SOCKET = MBED_CONF_APP_NON_BLOCKING_SOCKET;
+#else
+static constexpr bool NON_BLOCKING_SOCKET = false;
+#endif
+
+#ifdef MBED_CONF_APP_PREFER_BINARY_WIRE_FORMAT
+static constexpr bool PREFER_BINARY_WIRE_FORMAT = MBED_CONF_APP_PREFER_BINARY_WIRE_FORMAT;
+#else
+static constexpr bool PREFER_BINARY_WIRE_FORMAT = false;
+#endif
+
+// GPIO port, and channels thereof, driven by MY_LIGHT_CONTROL_GROUP. By
+// default just the user LED, i.e. LED1: PA_0 on the MTS_DRAGONFLY_L471QG.
+#ifdef MBED_CONF_APP_LIGHT_OUTPUT_PORT
+static constexpr PortName LIGHT_OUTPUT_PORT = MBED_CONF_APP_LIGHT_OUTPUT_PORT;
+#else
+static constexpr PortName LIGHT_OUTPUT_PORT = PortA;
+#endif
+
+#ifdef MBED_CONF_APP_LIGHT_OUTPUT_MASK
+static constexpr uint32_t LIGHT_OUTPUT_MASK = MBED_CONF_APP_LIGHT_OUTPUT_MASK;
+#else
+static constexpr uint32_t LIGHT_OUTPUT_MASK = 0x1;
+#endif
+
+// Records; each is sizeof(LightControl::LogRecord_t), i.e. 20 bytes.
+#ifdef MBED_CONF_APP_DEFERRED_LOG_CAPACITY
+static constexpr std::size_t DEFERRED_LOG_CAPACITY = MBED_CONF_APP_DEFERRED_LOG_CAPACITY;
+#else
+static constexpr std::size_t DEFERRED_LOG_CAPACITY = 64;
+#endif
+
+#ifdef MBED_CONF_APP_DEFERRED_LOG_RAW
+static constexpr bool DEFERRED_LOG_RAW = MBED_CONF_APP_DEFERRED_LOG_RAW;
+#else
+static constexpr bool DEFERRED_LOG_RAW = false;
+#endif
+
+// How long a resolved echo server address is trusted before it is
+// refreshed (in the background; the cached address is used meanwhile).
+#ifdef MBED_CONF_APP_DNS_CACHE_TTL_SECONDS
+static constexpr uint32_t DNS_CACHE_TTL_SECONDS = MBED_CONF_APP_DNS_CACHE_TTL_SECONDS;
+#else
+static constexpr uint32_t DNS_CACHE_TTL_SECONDS = 3600;
+#endif
+
+// Whether the DNS cache is also kept in KVStore, across reboots.
+#ifdef MBED_CONF_APP_DNS_CACHE_PERSISTENT
+static constexpr bool DNS_CACHE_PERSISTENT = MBED_CONF_APP_DNS_CACHE_PERSISTENT;
+#else
+static constexpr bool DNS_CACHE_PERSISTENT = false;
+#endif
+
+// 0 disables the periodic dump of GetStats() onto the console.
+#ifdef MBED_CONF_APP_STATS_DUMP_PERIOD_SECONDS
+static constexpr uint32_t STATS_DUMP_PERIOD_SECONDS = MBED_CONF_APP_STATS_DUMP_PERIOD_SECONDS;
+#else
+static constexpr uint32_t STATS_DUMP_PERIOD_SECONDS = 0;
+#endif
+
+// Reconnect backoff: the delay ceiling doubles from the initial value up
+// to the maximum with every consecutive failed attempt. See ReconnectBackoff.h.
+#ifdef MBED_CONF_APP_RECONNECT_BACKOFF_INITIAL_MILLISECONDS
+static constexpr uint32_t RECONNECT_BACKOFF_INITIAL_MILLISECONDS = MBED_CONF_APP_RECONNECT_BACKOFF_INITIAL_MILLISECONDS;
+#else
+static constexpr uint32_t RECONNECT_BACKOFF_INITIAL_MILLISECONDS = 1000;
+#endif
+
+#ifdef MBED_CONF_APP_RECONNECT_BACKOFF_MAXIMUM_MILLISECONDS
+static constexpr uint32_t RECONNECT_BACKOFF_MAXIMUM_MILLISECONDS = MBED_CONF_APP_RECONNECT_BACKOFF_MAXIMUM_MILLISECONDS;
+#else
+static constexpr uint32_t RECONNECT_BACKOFF_MAXIMUM_MILLISECONDS = 60000;
+#endif
+
+// Radio wake windows (PSM/eDRX). 0 sends back-to-back, as ever; otherwise
+// outgoing messages are queued, and flushed in one burst per window. See
+// TrafficScheduler.h. Implies the non-blocking exchange.
+#ifdef MBED_CONF_APP_WAKE_WINDOW_PERIOD_MILLISECONDS
+static constexpr uint32_t WAKE_WINDOW_PERIOD_MILLISECONDS = MBED_CONF_APP_WAKE_WINDOW_PERIOD_MILLISECONDS;
+#else
+static constexpr uint32_t WAKE_WINDOW_PERIOD_MILLISECONDS = 0;
+#endif
+
+#ifdef MBED_CONF_APP_WAKE_WINDOW_LENGTH_MILLISECONDS
+static constexpr uint32_t WAKE_WINDOW_LENGTH_MILLISECONDS = MBED_CONF_APP_WAKE_WINDOW_LENGTH_MILLISECONDS;
+#else
+static constexpr uint32_t WAKE_WINDOW_LENGTH_MILLISECONDS = 10000;
+#endif
+
+// With wake windows, how often the LED blink queues its next toggle.
+#ifdef MBED_CONF_APP_BLINK_PERIOD_MILLISECONDS
+static constexpr uint32_t BLINK_PERIOD_MILLISECONDS = MBED_CONF_APP_BLINK_PERIOD_MILLISECONDS;
+#else
+static constexpr uint32_t BLINK_PERIOD_MILLISECONDS = 60000;
+#endif
+
+// Sequence numbers, acknowledgement by reply, selective retransmission
+// with an adaptive RTO, and duplicate suppression over UDP and NIDD. See
+// DatagramReliability.h.
+#ifdef MBED_CONF_APP_DATAGRAM_RELIABILITY
+static constexpr bool DATAGRAM_RELIABILITY = MBED_CONF_APP_DATAGRAM_RELIABILITY;
+#else
+static constexpr bool DATAGRAM_RELIABILITY = true;
+#endif
+
+#ifdef MBED_CONF_APP_DATAGRAM_MINIMUM_RTO_MILLISECONDS
+static constexpr uint32_t DATAGRAM_MINIMUM_RTO_MILLISECONDS = MBED_CONF_APP_DATAGRAM_MINIMUM_RTO_MILLISECONDS;
+#else
+static constexpr uint32_t DATAGRAM_MINIMUM_RTO_MILLISECONDS = 200;
+#endif
+
+#ifdef MBED_CONF_APP_DATAGRAM_MAXIMUM_RTO_MILLISECONDS
+static constexpr uint32_t DATAGRAM_MAXIMUM_RTO_MILLISECONDS = MBED_CONF_APP_DATAGRAM_MAXIMUM_RTO_MILLISECONDS;
+#else
+static constexpr uint32_t DATAGRAM_MAXIMUM_RTO_MILLISECONDS = 30000;
+#endif
+
+#ifdef MBED_CONF_APP_DATAGRAM_MAXIMUM_RETRANSMISSIONS
+static constexpr uint8_t DATAGRAM_MAXIMUM_RETRANSMISSIONS = MBED_CONF_APP_DATAGRAM_MAXIMUM_RETRANSMISSIONS;
+#else
+static constexpr uint8_t DATAGRAM_MAXIMUM_RETRANSMISSIONS = 5;
+#endif
+
+// Publish/subscribe transport mode over UDP and NIDD; see LightControlPubSub.h.
+// The echo server hostname and port then name the broker instead.
+#ifdef MBED_CONF_APP_PUBSUB_MODE
+static constexpr bool PUBSUB_MODE = MBED_CONF_APP_PUBSUB_MODE;
+#else
+static constexpr bool PUBSUB_MODE = false;
+#endif
+
+#ifdef MBED_CONF_APP_PUBSUB_KEEP_ALIVE_SECONDS
+static constexpr uint16_t PUBSUB_KEEP_ALIVE_SECONDS = MBED_CONF_APP_PUBSUB_KEEP_ALIVE_SECONDS;
+#else
+static constexpr uint16_t PUBSUB_KEEP_ALIVE_SECONDS = 60;
+#endif
+
+// QoS that group topics are subscribed with: 0 or 1.
+#ifdef MBED_CONF_APP_PUBSUB_QOS
+static constexpr uint8_t PUBSUB_QOS = MBED_CONF_APP_PUBSUB_QOS;
+#else
+static constexpr uint8_t PUBSUB_QOS = 0;
+#endif
+
+// The exchange as one straight-line coroutine per connection, resumed by
+// the shared event queue; see EventQueueCoroutines.h. Its frames come from
+// a fixed arena of this many slots of this many bytes, never the heap.
+#ifdef MBED_CONF_APP_COROUTINE_SESSION
+static constexpr bool COROUTINE_SESSION = MBED_CONF_APP_COROUTINE_SESSION;
+#else
+static constexpr bool COROUTINE_SESSION = false;
+#endif
+
+#ifdef MBED_CONF_APP_COROUTINE_FRAMES
+static constexpr std::size_t COROUTINE_FRAMES = MBED_CONF_APP_COROUTINE_FRAMES;
+#else
+static constexpr std::size_t COROUTINE_FRAMES = 4;
+#endif
+
+#ifdef MBED_CONF_APP_COROUTINE_FRAME_BYTES
+static constexpr std::size_t COROUTINE_FRAME_BYTES = MBED_CONF_APP_COROUTINE_FRAME_BYTES;
+#else
+static constexpr std::size_t COROUTINE_FRAME_BYTES = 512;
+#endif
+
+// Every request asks the controller to stamp its reply, so that commands
+// carrying an execution time ("x:") are executed at that time from a
+// hardware timer, rather than on receipt; see ClockSync.h. Commands due
+// further ahead than this are presumed mistaken, and applied on receipt.
+#ifdef MBED_CONF_APP_CLOCK_SYNC
+static constexpr bool CLOCK_SYNC = MBED_CONF_APP_CLOCK_SYNC;
+#else
+static constexpr bool CLOCK_SYNC = false;
+#endif
+
+#ifdef MBED_CONF_APP_MAXIMUM_EXECUTE_AHEAD_MILLISECONDS
+static constexpr uint32_t MAXIMUM_EXECUTE_AHEAD_MILLISECONDS = MBED_CONF_APP_MAXIMUM_EXECUTE_AHEAD_MILLISECONDS;
+#else
+static constexpr uint32_t MAXIMUM_EXECUTE_AHEAD_MILLISECONDS = 60000;
+#endif
+
+// Light actions scheduled by the application (on/off schedules, delayed
+// offs, ...) are kept in one hierarchical timer wheel of this many 12-byte
+// entries, rather than as event queue events; see TimerWheel.h. Delays are
+// rounded up to whole ticks, and can be up to 2^24 ticks long.
+//
+// The wheel is a member of LEDLightControl, and so comes out of the heap
+// along with it, next to the cellular stack: 12 bytes an entry plus 512
+// bytes of slot heads, i.e. 3.5 KiB at the default of 256, which fits the
+// 128 KiB of the L471 (Dragonfly); and 24.5 KiB at the 2048 that the
+// NUCLEO_F767ZI, with 512 KiB, is configured for. LightControlHost reports
+// what it comes to, in "memory:".
+#ifdef MBED_CONF_APP_TIMER_WHEEL_TICK_MILLISECONDS
+static constexpr uint32_t TIMER_WHEEL_TICK_MILLISECONDS = MBED_CONF_APP_TIMER_WHEEL_TICK_MILLISECONDS;
+#else
+static constexpr uint32_t TIMER_WHEEL_TICK_MILLISECONDS = 10;
+#endif
+
+#ifdef MBED_CONF_APP_TIMER_WHEEL_CAPACITY
+static constexpr std::size_t TIMER_WHEEL_CAPACITY = MBED_CONF_APP_TIMER_WHEEL_CAPACITY;
+#else
+static constexpr std::size_t TIMER_WHEEL_CAPACITY = 256;
+#endif
+
+// Dimmable lights are PwmOut channels, mapped to groups like the switched
+// ones. Commands dim them to their level ("l:"), fading there over their
+// transition time ("d:") one step per hardware timer interrupt of this
+// period; see LightDimmer.h. NC leaves this node's group switched only.
+#ifdef MBED_CONF_APP_LIGHT_PWM_PIN
+static constexpr PinName LIGHT_PWM_PIN = MBED_CONF_APP_LIGHT_PWM_PIN;
+#else
+static constexpr PinName LIGHT_PWM_PIN = NC;
+#endif
+
+#ifdef MBED_CONF_APP_FADE_STEP_MICROSECONDS
+static constexpr uint32_t FADE_STEP_MICROSECONDS = MBED_CONF_APP_FADE_STEP_MICROSECONDS;
+#else
+static constexpr uint32_t FADE_STEP_MICROSECONDS = 10000;
+#endif
+
+// Events worth looking at after a hang or a fault (see FlightRecorder.h)
+// are always recorded into a ring of this many 16-byte records, in RAM
+// that survives a reset. On boot, the ring as the previous boot left it
+// can be dumped raw to the console, for host/FlightRecorderDecoder.cpp;
+// that console must then not translate newlines, as for raw deferred logs.
+#ifdef MBED_CONF_APP_FLIGHT_RECORDER_CAPACITY
+static constexpr std::size_t FLIGHT_RECORDER_CAPACITY = MBED_CONF_APP_FLIGHT_RECORDER_CAPACITY;
+#else
+static constexpr std::size_t FLIGHT_RECORDER_CAPACITY = 256;
+#endif
+
+#ifdef MBED_CONF_APP_FLIGHT_RECORDER_DUMP_ON_BOOT
+static constexpr bool FLIGHT_RECORDER_DUMP_ON_BOOT = MBED_CONF_APP_FLIGHT_RECORDER_DUMP_ON_BOOT;
+#else
+static constexpr bool FLIGHT_RECORDER_DUMP_ON_BOOT = false;
+#endif
+
 using namespace std::chrono_literals;
 
 // Intrinsically enforce our requirements with C++20 Concepts.
@@ -89,10 +351,36 @@ concept IsValidTransportType = (((transport == TransportScheme_t::CELLULAR_4G_LT
                              || ((transport == TransportScheme_t::MESH_NETWORK_Wi_SUNMODE_4)
     && (socket == TransportSocket_t::UDP)));
 
+// The concrete Mbed OS socket class of each socket type, so that the
+// socket is owned, opened and driven without heap allocation nor RTTI.
+template <TransportSocket_t socket>
+using TransportSocketClass_t = std::conditional_t<(socket == TransportSocket_t::TCP), TCPSocket,
+                               std::conditional_t<(socket == TransportSocket_t::UDP), UDPSocket, 
+                                                  CellularNonIPSocket>>;
+
+template <TransportSocket_t socket>
+constexpr const char * TransportSocketClassName() noexcept
+{
+    if constexpr (socket == TransportSocket_t::TCP)
+    {
+        return "TCPSocket";
+    }
+    else if constexpr (socket == TransportSocket_t::UDP)
+    {
+        return "UDPSocket";
+    }
+    else
+    {
+        return "CellularNonIPSocket";
+    }
+}
+
 // Per both potential MCU specs, common LED 'in situ' on the MCU:        
 // Target = MTS_DRAGONFLY_L471QG: UNO pin D3 (i.e. STM32 pin PA_0).
-// Target = NUCLEO_F767ZI: Green LED
-DigitalOut g_UserLED(LED1);
+// Target = NUCLEO_F767ZI: Green LED (i.e. STM32 pin PB_0).
+//
+// It is driven, along with any other channels, by LEDLightControl's
+// LightOutputDriver. See LIGHT_OUTPUT_PORT and LIGHT_OUTPUT_MASK.
 bool       g_UserLEDState{false};  // Logically, the board will bootup with the LED off.
 
 // Protect the platform STDIO object so it is shared politely between 
@@ -101,6 +389,85 @@ bool       g_UserLEDState{false};  // Logically, the board will bootup with the
 // ensure our output does not come out garbled on the serial terminal.
 PlatformMutex g_STDIOMutex; 
 
+// Per-message logging on the hot path is deferred to a low priority 
+// thread rather than printf'ed, at 9600 baud, from the event queue.
+LightControl::DeferredLog<DEFERRED_LOG_CAPACITY> g_DeferredLog;
+
+// Neither zeroed nor initialized by the startup code, so that it survives
+// a reset. A debugger reads a hung unit's out by this very symbol. Only the
+// linker scripts in linker/ (target.linker_script) define the .noinit
+// section, at a fixed address right after the crash capture data; the
+// bounds of which are weak, so that a build with any other linker script
+// still links, and is then told apart on boot.
+MBED_SECTION(".noinit") LightControl::FlightRecorderImage_t<FLIGHT_RECORDER_CAPACITY> g_FlightRecorderImage;
+LightControl::FlightRecorder<FLIGHT_RECORDER_CAPACITY> g_FlightRecorder{g_FlightRecorderImage};
+
+#if defined(TOOLCHAIN_GCC_ARM)
+extern "C" __attribute__((weak)) char __noinit_start__[];
+extern "C" __attribute__((weak)) char __noinit_end__[];
+#endif
+
+bool IsFlightRecorderPersistent()
+{
+#if defined(TOOLCHAIN_GCC_ARM)
+    const auto pImage = reinterpret_cast<const char *>(&g_FlightRecorderImage);
+    return (__noinit_start__ != nullptr) && (pImage >= __noinit_start__)
+        && ((pImage + sizeof(g_FlightRecorderImage)) <= __noinit_end__);
+#else
+    return true; // Nothing to lose across a host "reset"; the image is a file.
+#endif
+}
+
+// From any context, interrupts included.
+template <typename... Args>
+void RecordFlight(LightControl::LogPoint_t point, Args... arguments)
+{
+    const auto now = static_cast<uint32_t>(Kernel::Clock::now().time_since_epoch().count());
+    CriticalSectionLock lock;
+    g_FlightRecorder.Record(now, point, arguments...);
+}
+
+void BootFlightRecorder()
+{
+    if (!IsFlightRecorderPersistent())
+    {
+        printf("Error! The flight recorder is not in a .noinit section and will not survive a reset; "
+               "link with the linker script in linker/ for this target.\r\n");
+    }
+    
+    const bool isIntact = g_FlightRecorder.Boot();
+    printf("Flight recorder: boot %lu, %u records kept across the reset, at %p.\r\n", 
+        static_cast<unsigned long>(g_FlightRecorder.BootCount()), 
+        static_cast<unsigned>(isIntact ? g_FlightRecorder.Size() : 0), 
+        static_cast<const void *>(&g_FlightRecorderImage));
+    
+    if (isIntact && FLIGHT_RECORDER_DUMP_ON_BOOT)
+    {
+        g_STDIOMutex.lock();
+        fwrite(&g_FlightRecorder.Image(), sizeof(g_FlightRecorder.Image()), 1, stdout);
+        fflush(stdout);
+        g_STDIOMutex.unlock();
+    }
+    
+#if DEVICE_RESET_REASON
+    const auto resetReason = static_cast<int>(ResetReason::get());
+#else
+    const auto resetReason = -1;
+#endif
+    RecordFlight(LightControl::LogPoint_t::BOOTED, g_FlightRecorder.BootCount(), resetReason);
+    
+#if MBED_CONF_PLATFORM_CRASH_CAPTURE_ENABLED
+    // Only once; the next boot after this one is not a fault's.
+    mbed_error_ctx context;
+    if (mbed_get_reboot_error_info(&context) == MBED_SUCCESS)
+    {
+        RecordFlight(LightControl::LogPoint_t::FAULTED, 
+            static_cast<int>(context.error_status), context.error_address);
+        mbed_reset_reboot_error_info();
+    }
+#endif
+}
+
 // OPTION 1: (DO NOT USE THIS OPTION AS YOU WILL EXHAUST THE STACK AND CRASH!!!)
 //
 // "Use static EventQueue to prevent your program from failing due to 
@@ -128,10 +495,75 @@ class LEDLightControl
     // 1 minute of failing to exchange packets with the EchoServer ought
     // to be enough to tell us that there is something wrong with the socket.
     static constexpr int32_t BLOCKING_SOCKET_TIMEOUT_MILLISECONDS{60000};
-    static constexpr uint8_t MASTER_LIGHT_CONTROL_GROUP{0};
-    static constexpr uint8_t     MY_LIGHT_CONTROL_GROUP{1};
+    
+    // A peer that has not answered the wire format negotiation within this
+    // long is presumed not to understand it, and we fall back to text.
+    static constexpr int32_t NEGOTIATION_TIMEOUT_MILLISECONDS{5000};
+    static constexpr uint16_t MASTER_LIGHT_CONTROL_GROUP{LightControl::MASTER_GROUP_ID};
+    static constexpr uint16_t     MY_LIGHT_CONTROL_GROUP{1};
     static constexpr uint32_t STANDARD_BUFFER_SIZE{40}; // 1K ought to cover all our cases.
     
+    // Replies arrive coalesced, or split, on TCP. The reassembly ring is
+    // sized so that one recv() can drain a few dozen messages at once.
+    static constexpr uint32_t RECEIVE_BUFFER_SIZE{1024};
+    
+    // Half of the 8-bit sequence number space, so that a late reply can
+    // never be mistaken for the reply to a newer message.
+    static constexpr std::size_t MAXIMUM_PIPELINE_WINDOW{128};
+    
+    // Upper bound on socket operations performed by one Step() event, so
+    // that every other event on the shared queue gets its turn promptly.
+    static constexpr uint32_t MAXIMUM_OPERATIONS_PER_STEP{8};
+    
+    // Synchronized commands awaiting their execution time.
+    static constexpr std::size_t SCHEDULED_COMMAND_CAPACITY{8};
+    
+    struct ScheduledCommand_t
+    {
+        LightControl::ChannelSet_t m_Channels{};
+        uint32_t                   m_PwmChannels{0};
+        bool                       m_State{false};
+        uint8_t                    m_Level{0};
+        uint16_t                   m_FadeSteps{0};
+    };
+    
+    // Packed into 2 bytes, for the timer wheel's entries to be 12 bytes.
+    struct TimedAction_t
+    {
+        uint16_t m_Group : 15 {0};
+        uint16_t m_State : 1  {0};
+    };
+    static_assert(sizeof(TimedAction_t) == sizeof(uint16_t));
+    
+    static constexpr auto TIMER_WHEEL_TICK = std::chrono::milliseconds(TIMER_WHEEL_TICK_MILLISECONDS);
+    
+    // Dimmable channels, at a PWM frequency of 1 kHz, well clear of flicker.
+    static constexpr std::size_t MAXIMUM_PWM_CHANNELS{8};
+    static constexpr int PWM_PERIOD_MICROSECONDS{1000};
+    static constexpr auto FADE_STEP = std::chrono::microseconds(FADE_STEP_MICROSECONDS);
+    
+    // Non-blocking mode has no blocking call to time out, so timeouts are
+    // instead enforced by a periodic supervision event.
+    static constexpr auto SUPERVISION_PERIOD{1s};
+    
+    // Outgoing messages awaiting the next wake window; one per group at most.
+    static constexpr std::size_t OUTBOUND_QUEUE_CAPACITY{32};
+    
+    enum class IOResult_t : uint8_t
+    {
+        COMPLETED,
+        WOULD_BLOCK, // Only ever in non-blocking mode; try again on sigio.
+        FAILED
+    };
+    
+    enum class ExchangeState_t : uint8_t
+    {
+        IDLE,
+        NEGOTIATING,
+        SUBSCRIBING, // Publish/subscribe mode only; until every SUBACK is in.
+        EXCHANGING
+    };
+    
 public:
     LEDLightControl();
 
@@ -145,6 +577,58 @@ public:
     void Setup();
     
     void ConnectToSocket();
+    
+    // Dispatched on NSAPI_STATUS_DISCONNECTED; see ScheduleReconnect().
+    void OnLinkLost();
+    
+    // Number of LightControl messages allowed to be in flight at once.
+    // 1, the default, is the original strictly lock-step Send()/Receive().
+    void SetPipelineWindow(std::size_t window);
+    
+    // When set, the exchange runs as short sigio-driven steps on the shared
+    // event queue instead of the blocking Run() loop, so that the queue is
+    // never monopolized by the socket. Takes effect on the next connection.
+    void SetNonBlocking(bool nonBlocking);
+    
+    // When set, the exchange is instead one coroutine per connection that
+    // co_awaits its DNS lookup, connect and replies on the shared event
+    // queue; see RunSession(). Takes effect on the next connection.
+    void SetCoroutineSession(bool isCoroutine);
+    
+    // When set, requests ask to be stamped with the controller's clock;
+    // see ClockSync.h. Takes effect on the next message sent.
+    void SetClockSync(bool isClockSync);
+    
+    // Runtime group membership; MY_LIGHT_CONTROL_GROUP to begin with. The
+    // master group is always obeyed and need not be subscribed to. In
+    // publish/subscribe mode, takes effect on the next connection.
+    bool SubscribeGroup(uint16_t group);
+    void UnsubscribeGroup(uint16_t group);
+    
+    // Queues a LightControl message, for the next wake window when those
+    // are enabled. Queued messages go out ahead of the LED blink's own. In
+    // publish/subscribe mode, it is published to its group's topic instead.
+    LightControl::Enqueued_t QueueLightControl(uint16_t group, bool state);
+    
+    // Switches the channels of the group (or of every subscribed group for
+    // the master group) after the delay, from the timer wheel. Nothing when
+    // the wheel is full or the delay out of range. Call from the shared
+    // event queue, i.e. from the context that runs the exchange.
+    std::optional<LightControl::TimerHandle_t> ScheduleLightControl(uint16_t group, bool state, 
+                                                                    std::chrono::milliseconds delay);
+    bool CancelLightControl(const LightControl::TimerHandle_t & handle);
+    
+    // For mapping further groups onto further relay/LED channels.
+    LightControl::LightOutputDriver & LightOutputs() { return m_LightOutputs; }
+    
+    // Maps the group onto a further dimmable channel, off to begin with.
+    // False when out of channels. Call before the exchange is started.
+    bool AddPwmChannel(PinName pin, uint16_t group);
+    
+    // Snapshot of the link instrumentation. Call from the shared event 
+    // queue, i.e. from the context that runs the exchange.
+    LightControl::LinkStatistics_t GetStats() const;
+    void DumpStats();
 
 protected:
     template <TransportScheme_t transport, TransportSocket_t socket>
@@ -153,10 +637,119 @@ protected:
 
     void Run();
     
-    [[nodiscard]] bool Send();
-    [[nodiscard]] bool Receive();
+    // Non-blocking counterpart of Run(), see SetNonBlocking().
+    void UpdateExchangeMode();
+    void StartExchange();
+    void StopExchange();
+    void OnSocketSigio();
+    void PostStep();
+    void Step();
+    void SuperviseExchange();
+    void ResetExchange();
+    
+    // Reconnect engine. Whatever ends an exchange, or fails to start one,
+    // schedules a Reconnect() after a jittered exponential backoff. Only
+    // the socket is reopened while the interface stays up; the interface
+    // itself is only asked to connect() again once it has gone down.
+    void ScheduleReconnect();
+    void Reconnect();
+    void OnReplyTimeout();
+    [[nodiscard]] nsapi_error_t OpenSocket() { return (this->*m_pOpenSocket)(); }
+    
+    // Wake windows; see TrafficScheduler.h.
+    void QueueBlink();
+    void ScheduleFlush();
+    void BeginFlush();
+    bool IsSendDue() const;
+    
+    [[nodiscard]] IOResult_t Send();
+    [[nodiscard]] IOResult_t Receive();
+    
+    // Datagram reliability; see DatagramReliability.h.
+    [[nodiscard]] IOResult_t Retransmit();
+    void ArmRetransmitTimer();
+    void OnRetransmitTimer();
+    void SetReceiveTimeoutToNextDeadline();
+    bool IsDuplicateReply(const std::optional<uint8_t> & sequence) const;
+    static std::chrono::milliseconds Uptime();
+    
+    // Timer wheel; one event on the shared queue, for the next slot due.
+    void ArmTimerWheel();
+    void OnTimerWheelTick();
+    
+    // Publish/subscribe mode; see LightControlPubSub.h.
+    void StartPubSub();
+    void StepPubSub();
+    void SupervisePubSub();
+    void SubscribeGroupTopics();
+    [[nodiscard]] IOResult_t ReceivePubSub();
+    [[nodiscard]] IOResult_t Publish();
+    [[nodiscard]] bool SendPubSub(const LightControl::PubSubPacket_t & packet);
+    
+    // Coroutine session mode; see EventQueueCoroutines.h. A session only
+    // carries on for as long as its generation is the current one.
+    void StartSession();
+    Task<nsapi_error_t> OpenSession(uint32_t generation);
+    Task<> RunSession(uint32_t generation);
+    
+    // Uses the cached address of the echo server when allowed, and there is
+    // one; only otherwise does it wait for a DNS lookup.
+    [[nodiscard]] bool ResolveEchoServerAddress(bool isCacheAllowed);
+    void RefreshEchoServerAddress();
+    void OnEchoServerAddressRefreshed(nsapi_value_or_error_t rc, SocketAddress address);
+    
+    void NegotiateWireFormat();
+    [[nodiscard]] bool SendNegotiationRequest();
+    void AcceptNegotiationReply(nsapi_size_or_error_t rc, const char * pReply);
+    
+    // Single place where the connection-oriented vs. connection-less 
+    // distinction between send()/recv() and sendto()/recvfrom() is made.
+    // Bound to the socket type once, in ConnectToNetworkInterface(), so
+    // that the hot path neither branches on it nor casts at run time.
+    nsapi_size_or_error_t SendRaw(const void * pData, nsapi_size_t size) 
+    { 
+        return (this->*m_pSendRaw)(pData, size); 
+    }
+    nsapi_size_or_error_t ReceiveRaw(void * pData, nsapi_size_t size) 
+    { 
+        return (this->*m_pReceiveRaw)(pData, size); 
+    }
+    
+    template <TransportSocket_t socket>
+    nsapi_error_t OpenSocketAs();
+    template <TransportSocket_t socket>
+    nsapi_size_or_error_t SendRawAs(const void * pData, nsapi_size_t size);
+    template <TransportSocket_t socket>
+    nsapi_size_or_error_t ReceiveRawAs(void * pData, nsapi_size_t size);
+    
+    [[nodiscard]] IOResult_t ConsumeReceivedMessages(bool isStream);
+    [[nodiscard]] std::pair<IOResult_t, std::size_t> ConsumeReceivedMessage(std::string_view message);
+    
+    LightControl::ParseResult_t ParseAndConsumeLightControlMessage(std::string_view message);
     
-    bool ParseAndConsumeLightControlMessage(std::string& s, const std::string& delimiter);
+    bool RetireInFlightMessage(const LightControl::Message_t & reply);
+    void RecordTimeToFirstMessage();
+    
+    // Applies the command now, or schedules it should it carry an execution
+    // time. Returns the port writes made now, or nothing when scheduled.
+    std::optional<std::size_t> ExecuteLightControl(const LightControl::Message_t & command);
+    void ArmExecutionTimeout(uint64_t nowMicroseconds);
+    void OnExecutionTimeout(); // Interrupt context.
+    
+    // Switches, and dims or starts fading, the command's channels. Inside
+    // a critical section, or in interrupt context. Returns the writes made.
+    std::size_t ApplyLightControl(const ScheduledCommand_t & command);
+    uint32_t PwmChannels(uint16_t group) const;
+    void WritePwm(std::size_t channel, uint16_t duty);
+    void OnFadeStep(); // Interrupt context.
+    
+    // Rounded up, so that a fade never ends early.
+    static constexpr uint16_t FadeSteps(std::optional<uint16_t> transitionMilliseconds)
+    {
+        const auto microseconds = static_cast<uint64_t>(transitionMilliseconds.value_or(0)) * 1000;
+        return static_cast<uint16_t>(std::min<uint64_t>(UINT16_MAX, 
+            (microseconds + FADE_STEP_MICROSECONDS - 1) / FADE_STEP_MICROSECONDS));
+    }
     
 private:
     TransportScheme_t          m_TheTransportSchemeType;
@@ -166,9 +759,15 @@ private:
     // To enable soft_power_off/on(), shutdown(), hard_power_on/off(), and such functions.
     CellularDevice *           m_pTheCellularDevice;   
     
+    // The same object as m_pNetworkInterface, when on cellular; as known
+    // by construction, rather than by a dynamic_cast.
+    CellularContext *          m_pTheCellularContext;
+    
     std::string                m_EchoServerDomainName; // Domain name will always exist.
     std::optional<std::string> m_EchoServerAddress;    // However IP Address might not always exist...
     uint16_t                   m_EchoServerPort;
+    DnsCache                   m_EchoServerAddressCache;
+    bool                       m_IsRefreshingEchoServerAddress;
     
     // Portable Socket class interface for handling all the 3 possible
     // socket types. Ergo:
@@ -176,25 +775,193 @@ private:
     // TCP - Connection-oriented IP.
     // UDP - Connection-less IP.
     // CellularNonIP - 3GPP non-IP datagrams (NIDD) using the cellular IoT feature.
+    //
+    // The socket object itself lives in m_TheSocketStorage, i.e. within this
+    // object rather than on the heap; m_pTheSocket refers to it as a Socket.
+    std::variant<std::monostate, TCPSocket, UDPSocket, CellularNonIPSocket> m_TheSocketStorage;
     Socket *                  m_pTheSocket;
     SocketAddress             m_TheSocketAddress;
+    
+    nsapi_error_t             (LEDLightControl::*m_pOpenSocket)();
+    nsapi_size_or_error_t     (LEDLightControl::*m_pSendRaw)(const void *, nsapi_size_t);
+    nsapi_size_or_error_t     (LEDLightControl::*m_pReceiveRaw)(void *, nsapi_size_t);
+    
+    // Negotiated per connection in ConnectToSocket(); text is the fallback.
+    LightControl::WireFormat_t m_WireFormat;
+    
+    // Pipelining; replies are matched back to requests by sequence number.
+    std::size_t               m_PipelineWindow;
+    std::size_t               m_InFlightCount;
+    uint8_t                   m_NextSequence;
+    std::bitset<256>          m_OutstandingSequences;
+    
+    LightControl::GroupSet    m_SubscribedGroups;
+    LightControl::LightOutputDriver m_LightOutputs;
+    
+    // Instrumentation; send times are indexed by sequence number.
+    LightControl::LinkStatistics_t m_Statistics;
+    std::array<uint32_t, 256> m_SendTimesMicroseconds;
+    std::optional<Kernel::Clock::time_point> m_ConnectStartTime; // Until the first reply.
+    
+    // Partially received messages are carried over to the next Receive().
+    LightControl::StreamFramer<RECEIVE_BUFFER_SIZE> m_ReceiveFramer;
+    
+    // Non-blocking mode; as asked for by SetNonBlocking(), and in effect,
+    // which wake windows, publish/subscribe and coroutine sessions force.
+    bool                      m_IsNonBlockingRequested;
+    bool                      m_IsNonBlocking;
+    ExchangeState_t           m_ExchangeState;
+    std::atomic<bool>         m_IsStepPending; // Set from sigio, possibly in IRQ context.
+    int                       m_SupervisionEventId;
+    Kernel::Clock::time_point m_LastProgressTime;
+    
+    // Reconnect engine.
+    LightControl::ReconnectBackoff m_ReconnectBackoff;
+    int                       m_ReconnectEventId;
+    std::optional<Kernel::Clock::time_point> m_LinkLossTime; // Until the next reply.
+    
+    // Wake windows.
+    LightControl::TrafficScheduler<OUTBOUND_QUEUE_CAPACITY> m_TrafficScheduler;
+    int                       m_FlushEventId;
+    bool                      m_IsFlushing;
+    
+    // Datagram reliability; only ever for UDP and NIDD.
+    bool                      m_IsReliable;
+    LightControl::DatagramReliability<MAXIMUM_PIPELINE_WINDOW> m_Reliability;
+    int                       m_RetransmitEventId;
+    
+    // Publish/subscribe mode; only ever for UDP and NIDD.
+    bool                      m_IsPubSub;
+    char                      m_PubSubClientId[12];   // "lc-xxxxxxxx"
+    uint16_t                  m_PubSubMessageId;
+    std::size_t               m_PendingSubscriptions;
+    Kernel::Clock::time_point m_LastPingTime;
+    
+    // Coroutine session mode; the frames are handed to CoroutineFrameArena.
+    bool                      m_IsCoroutineSessionRequested;
+    bool                      m_IsCoroutineSession;
+    uint32_t                  m_SessionGeneration;
+    AsyncSocket               m_AsyncSocket;
+    alignas(std::max_align_t) std::array<std::byte, COROUTINE_FRAMES * COROUTINE_FRAME_BYTES> m_CoroutineFrames;
+    
+    // Synchronized commands; the schedule is shared with the timer ISR
+    // and only ever touched inside a critical section.
+    bool                      m_IsClockSync;
+    LightControl::ClockOffsetEstimator m_ClockOffset;
+    LightControl::ExecutionSchedule<ScheduledCommand_t, SCHEDULED_COMMAND_CAPACITY> m_ExecutionSchedule;
+    mbed::Timeout             m_ExecutionTimeout;
+    
+    // Application scheduled light actions; the wheel's Now() is at uptime
+    // m_TimerWheelTime, and its event, if any, is due at m_TimerWheelDue.
+    LightControl::TimerWheel<TimedAction_t, TIMER_WHEEL_CAPACITY> m_TimerWheel;
+    std::chrono::milliseconds m_TimerWheelTime;
+    std::chrono::milliseconds m_TimerWheelDue;
+    int                       m_TimerWheelEventId;
+    
+    // Dimmable channels; the fades are shared with the fade timer ISR and
+    // only ever started inside a critical section.
+    std::array<std::optional<mbed::PwmOut>, MAXIMUM_PWM_CHANNELS> m_PwmOutputs;
+    std::array<uint16_t, MAXIMUM_PWM_CHANNELS> m_PwmGroups;
+    std::size_t               m_PwmChannelCount;
+    LightControl::FadeEngine<MAXIMUM_PWM_CHANNELS> m_Fades;
+    mbed::Timeout             m_FadeTimeout;
 };
 
 LEDLightControl::LEDLightControl()
-    : m_EchoServerDomainName(ECHO_HOSTNAME)
+    : m_pNetworkInterface(nullptr)
+    , m_pTheCellularDevice(nullptr)
+    , m_pTheCellularContext(nullptr)
+    , m_EchoServerDomainName(ECHO_HOSTNAME)
     , m_EchoServerAddress(std::nullopt)
     , m_EchoServerPort(ECHO_PORT) 
+    , m_EchoServerAddressCache((DNS_CACHE_PERSISTENT ? "/kv/lcdns" : nullptr), 
+                               std::chrono::seconds(DNS_CACHE_TTL_SECONDS))
+    , m_IsRefreshingEchoServerAddress(false)
+    , m_TheSocketStorage()
+    , m_pTheSocket(nullptr)
+    , m_pOpenSocket(&LEDLightControl::OpenSocketAs<TransportSocket_t::TCP>)
+    , m_pSendRaw(&LEDLightControl::SendRawAs<TransportSocket_t::TCP>)
+    , m_pReceiveRaw(&LEDLightControl::ReceiveRawAs<TransportSocket_t::TCP>)
+    , m_WireFormat(LightControl::WireFormat_t::TEXT)
+    , m_PipelineWindow(1)
+    , m_InFlightCount(0)
+    , m_NextSequence(0)
+    , m_SendTimesMicroseconds{}
+    , m_IsNonBlockingRequested(NON_BLOCKING_SOCKET)
+    , m_IsNonBlocking(NON_BLOCKING_SOCKET || (WAKE_WINDOW_PERIOD_MILLISECONDS > 0))
+    , m_ExchangeState(ExchangeState_t::IDLE)
+    , m_IsStepPending(false)
+    , m_SupervisionEventId(0)
+    , m_ReconnectBackoff(std::chrono::milliseconds(RECONNECT_BACKOFF_INITIAL_MILLISECONDS), 
+                         std::chrono::milliseconds(RECONNECT_BACKOFF_MAXIMUM_MILLISECONDS))
+    , m_ReconnectEventId(0)
+    , m_LinkLossTime(std::nullopt)
+    , m_TrafficScheduler({std::chrono::milliseconds(WAKE_WINDOW_PERIOD_MILLISECONDS), 
+                          std::chrono::milliseconds(WAKE_WINDOW_LENGTH_MILLISECONDS)})
+    , m_FlushEventId(0)
+    , m_IsFlushing(false)
+    , m_IsReliable(false)
+    , m_Reliability(std::chrono::milliseconds(DATAGRAM_MINIMUM_RTO_MILLISECONDS), 
+                    std::chrono::milliseconds(DATAGRAM_MAXIMUM_RTO_MILLISECONDS), 
+                    DATAGRAM_MAXIMUM_RETRANSMISSIONS)
+    , m_RetransmitEventId(0)
+    , m_IsPubSub(false)
+    , m_PubSubClientId{}
+    , m_PubSubMessageId(0)
+    , m_PendingSubscriptions(0)
+    , m_IsCoroutineSessionRequested(false)
+    , m_IsCoroutineSession(false)
+    , m_SessionGeneration(0)
+    , m_AsyncSocket(*g_pSharedEventQueue)
+    , m_IsClockSync(CLOCK_SYNC)
+    , m_TimerWheelTime(0)
+    , m_TimerWheelDue(0)
+    , m_TimerWheelEventId(0)
+    , m_PwmGroups{}
+    , m_PwmChannelCount(0)
 {
+    SetPipelineWindow(PIPELINE_WINDOW);
+    SetCoroutineSession(COROUTINE_SESSION);
+    CoroutineFrameArena::Instance().Provide(m_CoroutineFrames, COROUTINE_FRAME_BYTES);
+    
+    [[maybe_unused]] auto subscribed = SubscribeGroup(MY_LIGHT_CONTROL_GROUP);
+    MBED_ASSERT(subscribed);
+    
+    const auto port = m_LightOutputs.AddPort(LIGHT_OUTPUT_PORT, LIGHT_OUTPUT_MASK);
+    MBED_ASSERT(port);
+    [[maybe_unused]] auto mapped = m_LightOutputs.MapGroup(MY_LIGHT_CONTROL_GROUP, *port, LIGHT_OUTPUT_MASK);
+    MBED_ASSERT(mapped);
+    
+    if (LIGHT_PWM_PIN != NC)
+    {
+        [[maybe_unused]] auto dimmable = AddPwmChannel(LIGHT_PWM_PIN, MY_LIGHT_CONTROL_GROUP);
+        MBED_ASSERT(dimmable);
+    }
 }
 
 LEDLightControl::~LEDLightControl()
 {
     // Proper housekeeping...
+    m_ExecutionTimeout.detach();
+    m_FadeTimeout.detach();
+    
+    if (m_TimerWheelEventId)
+    {
+        g_pSharedEventQueue->cancel(m_TimerWheelEventId);
+        m_TimerWheelEventId = 0;
+    }
+    
+    if (m_ReconnectEventId)
+    {
+        g_pSharedEventQueue->cancel(m_ReconnectEventId);
+        m_ReconnectEventId = 0;
+    }
+    
     if (m_pTheSocket)
     {
         [[maybe_unused]] auto unused_return_1 = m_pTheSocket->close();
-        delete m_pTheSocket;
         
+        // The socket object itself goes along with m_TheSocketStorage.
         // Per issues discussed in MbedOS forums, proactively ensuring
         // that I don't run into any issues with MbedOS.  
         m_pTheSocket = nullptr; 
@@ -210,9 +977,79 @@ LEDLightControl::~LEDLightControl()
         g_pSharedEventQueue->break_dispatch();
     }
     
+    g_DeferredLog.Stop();
     trace_close();
 }
 
+void LEDLightControl::SetPipelineWindow(std::size_t window)
+{
+    m_PipelineWindow = std::clamp(window, static_cast<std::size_t>(1), MAXIMUM_PIPELINE_WINDOW);
+}
+
+void LEDLightControl::SetNonBlocking(bool nonBlocking)
+{
+    m_IsNonBlockingRequested = nonBlocking;
+    UpdateExchangeMode();
+}
+
+void LEDLightControl::SetCoroutineSession(bool isCoroutine)
+{
+    m_IsCoroutineSessionRequested = isCoroutine;
+    UpdateExchangeMode();
+}
+
+// From what was asked for, every time, so that a mode forced on by another
+// one is dropped again along with it.
+void LEDLightControl::UpdateExchangeMode()
+{
+    // Neither wake windows nor publish/subscribe are written as sessions.
+    m_IsCoroutineSession = m_IsCoroutineSessionRequested && !m_TrafficScheduler.Schedule().IsEnabled() 
+                        && !m_IsPubSub;
+    
+    // Waiting for a wake window, or for a publish, is only possible off the
+    // blocking Run(). A session's Send() and Receive() report, rather than
+    // wait out, a socket that would block; the session co_awaits it instead.
+    m_IsNonBlocking = m_IsNonBlockingRequested || m_TrafficScheduler.Schedule().IsEnabled() || m_IsPubSub 
+                   || m_IsCoroutineSession;
+}
+
+LightControl::LinkStatistics_t LEDLightControl::GetStats() const
+{
+    // The timer ISR updates the execution lateness.
+    auto statistics = [this]
+    {
+        CriticalSectionLock lock;
+        return m_Statistics;
+    }();
+    statistics.m_RetransmissionTimeoutMilliseconds = static_cast<uint32_t>(m_Reliability.Rto().Value().count());
+    statistics.m_SmoothedRoundTripMilliseconds = static_cast<uint32_t>(m_Reliability.Rto().Smoothed().count());
+    statistics.m_ClockExchanges = m_ClockOffset.Exchanges();
+    statistics.m_ClockDispersionMicroseconds = m_ClockOffset.DispersionMicroseconds();
+    return statistics;
+}
+
+void LEDLightControl::SetClockSync(bool isClockSync)
+{
+    m_IsClockSync = isClockSync;
+}
+
+void LEDLightControl::DumpStats()
+{
+    g_STDIOMutex.lock();
+    GetStats().Print(stdout);
+    g_STDIOMutex.unlock();
+}
+
+bool LEDLightControl::SubscribeGroup(uint16_t group)
+{
+    return m_SubscribedGroups.Subscribe(group);
+}
+
+void LEDLightControl::UnsubscribeGroup(uint16_t group)
+{
+    m_SubscribedGroups.Unsubscribe(group);
+}
+
 template <TransportScheme_t transport, TransportSocket_t socket>
     requires IsValidTransportType<transport, socket>
 void LEDLightControl::Setup()
@@ -222,6 +1059,24 @@ void LEDLightControl::Setup()
     randLIB_seed_random();
     trace_open();
     
+    // One client ID per boot; the broker tells clients apart by it.
+    snprintf(m_PubSubClientId, sizeof(m_PubSubClientId), "lc-%08lx", 
+             static_cast<unsigned long>(randLIB_get_32bit()));
+    g_DeferredLog.Start(stdout, DEFERRED_LOG_RAW, &g_STDIOMutex);
+    BootFlightRecorder();
+    
+    if constexpr (STATS_DUMP_PERIOD_SECONDS > 0)
+    {
+        g_pSharedEventQueue->call_every(std::chrono::seconds(STATS_DUMP_PERIOD_SECONDS), 
+                                        this, &LEDLightControl::DumpStats);
+    }
+    
+    if constexpr (WAKE_WINDOW_PERIOD_MILLISECONDS > 0)
+    {
+        g_pSharedEventQueue->call_every(std::chrono::milliseconds(BLINK_PERIOD_MILLISECONDS), 
+                                        this, &LEDLightControl::QueueBlink);
+    }
+    
     if constexpr (transport == TransportScheme_t::CELLULAR_4G_LTE) 
     {
         // "Non-IP cellular socket: Send and receive 3GPP non-IP datagrams (NIDD)
@@ -232,12 +1087,13 @@ void LEDLightControl::Setup()
         // https://os.mbed.com/docs/mbed-os/v6.15/apis/network-interface-apis.html
         if constexpr (socket == TransportSocket_t::CELLULAR_NON_IP) 
         {
-            m_pNetworkInterface = CellularContext::get_default_nonip_instance();
+            m_pTheCellularContext = CellularContext::get_default_nonip_instance();
         }
         else
         {
-            m_pNetworkInterface = CellularContext::get_default_instance();
+            m_pTheCellularContext = CellularContext::get_default_instance();
         }
+        m_pNetworkInterface = m_pTheCellularContext;
         
         // SIM PIN, APN, credentials and possible PLMN are extracted automagically
         // from the mbed_app.json when using NetworkInterface::set_default_parameters():
@@ -306,6 +1162,17 @@ void LEDLightControl::ConnectToNetworkInterface()
     // within the class itself for later ::NetworkStatusCallbacks() to operate on.
     m_TheTransportSchemeType = transport;
     m_TheTransportSocketType = socket;    
+    m_pOpenSocket = &LEDLightControl::OpenSocketAs<socket>;
+    m_pSendRaw = &LEDLightControl::SendRawAs<socket>;
+    m_pReceiveRaw = &LEDLightControl::ReceiveRawAs<socket>;
+    m_IsPubSub = PUBSUB_MODE && (socket != TransportSocket_t::TCP);
+    m_IsReliable = DATAGRAM_RELIABILITY && (socket != TransportSocket_t::TCP) && !m_IsPubSub;
+    UpdateExchangeMode();
+    
+    if (PUBSUB_MODE && !m_IsPubSub)
+    {
+        printf("Warning! Publish/subscribe mode needs a datagram transport; exchanging with the EchoServer instead.\r\n");
+    }
 
     // "Asynchronous operation
     // 
@@ -351,6 +1218,25 @@ void LEDLightControl::ConnectToSocket()
 {    
     printf("Running LEDLightControl::ConnectToSocket() ... \r\n");
     
+    if (m_Statistics.m_Connections++ > 0)
+    {
+        ++m_Statistics.m_Reconnects;
+    }
+    else if (m_pTheCellularDevice && m_TrafficScheduler.Schedule().IsEnabled())
+    {
+        // Once attached, have the modem sleep in PSM in between windows:
+        // a periodic TAU of one window period, an active time of one window.
+        nsapi_error_t rc = m_pTheCellularDevice->set_power_save_mode(
+                               static_cast<int>(WAKE_WINDOW_PERIOD_MILLISECONDS / 1000), 
+                               static_cast<int>(WAKE_WINDOW_LENGTH_MILLISECONDS / 1000));
+        if (rc != NSAPI_ERROR_OK)
+        {
+            printf("Error! CellularDevice.set_power_save_mode() returned: \
+                [%d] -> %s\r\n", rc, ToString(rc));
+        }
+    }
+    m_ConnectStartTime = Kernel::Clock::now();
+    
     // Show the particular NetworkInterface addresses to encourage Debug. 
     // Don't forget that this class object is being designed to handle 
     // several NetworkInterfaces--primarily Cellular, yes?, but also Ethernet
@@ -363,96 +1249,41 @@ void LEDLightControl::ConnectToSocket()
     printf("Particular Network Interface Gateway: %s\n", gateway.value_or("(null)"));
     printf("Particular Network Interface MAC Address: %s\n", mac.value_or("(null)"));
         
-    // Opens:
-    // - UDP or TCP socket with the given echo server and performs an echo
-    //   transaction retrieving current message.
-    //
-    // - Cellular Non-IP socket for which the data delivery path is decided
-    //   by network's control plane CIoT optimisation setup, for the given APN.
-    if (m_TheTransportSocketType == TransportSocket_t::TCP)
+    // A connection that is still being exchanged upon (e.g. on a repeated
+    // GLOBAL_UP) is superseded, as is any reconnect attempt still pending.
+    if (m_ExchangeState != ExchangeState_t::IDLE)
     {
-        // Portable way of using the Abstract base class Socket to refer
-        // to any particular derived socket type.
-        m_pTheSocket = new TCPSocket();
-        
-        nsapi_error_t rc = dynamic_cast<TCPSocket *>(m_pTheSocket)->open(m_pNetworkInterface);
-        if (rc != NSAPI_ERROR_OK)
-        {
-            printf("Error! TCPSocket.open() returned: \
-                [%d] -> %s\r\n", rc, ToString(rc).c_str());
-
-            // Abandon attempting to connect to the socket. Subsequent 
-            // NetworkStatusCallbacks() will dispatch the ConnectToSocket()
-            // event again should network conditions become better favorable.                
-            return;
-        }
+        StopExchange();
     }
-    else if (m_TheTransportSocketType == TransportSocket_t::UDP)
+    
+    if (m_ReconnectEventId)
     {
-        m_pTheSocket = new UDPSocket();
-        
-        nsapi_error_t rc = dynamic_cast<UDPSocket *>(m_pTheSocket)->open(m_pNetworkInterface);
-        if (rc != NSAPI_ERROR_OK)
-        {
-            printf("Error! UDPSocket.open() returned: \
-                [%d] -> %s\r\n", rc, ToString(rc).c_str());
-
-            // Abandon attempting to connect to the socket. Subsequent 
-            // NetworkStatusCallbacks() will dispatch the ConnectToSocket()
-            // event again should network conditions become better favorable.                
-            return;
-        }
+        g_pSharedEventQueue->cancel(m_ReconnectEventId);
+        m_ReconnectEventId = 0;
     }
-    else if (m_TheTransportSocketType == TransportSocket_t::CELLULAR_NON_IP)
+    
+    if (m_IsCoroutineSession)
     {
-        m_pTheSocket = new CellularNonIPSocket();
-        
-        nsapi_error_t rc = dynamic_cast<CellularNonIPSocket *>(m_pTheSocket)->open(dynamic_cast<CellularContext *>(m_pNetworkInterface));
-        if (rc != NSAPI_ERROR_OK)
-        {
-            printf("Error! CellularNonIPSocket.open() returned: \
-                [%d] -> %s\r\n", rc, ToString(rc).c_str());
-
-            // Abandon attempting to connect to the socket. Subsequent 
-            // NetworkStatusCallbacks() will dispatch the ConnectToSocket()
-            // event again should network conditions become better favorable.                
-            return;
-        }
-    }  
+        // Returns at the session's first co_await; it carries on from there.
+        StartSession();
+        return;
+    }
     
-    // Set timeout on blocking socket operations.
-    //
-    // Initially all sockets have unbounded timeouts. NSAPI_ERROR_WOULD_BLOCK
-    // is returned if a blocking operation takes longer than the specified timeout.
-    //
-    // Also, extrapolate from the following rule:
-    //
-    // "If using network sockets as streams, a timeout should be set to 
-    //  stop denial of service attacks."
-    m_pTheSocket->set_blocking(true);
-    m_pTheSocket->set_timeout(BLOCKING_SOCKET_TIMEOUT_MILLISECONDS);
+    if (OpenSocket() != NSAPI_ERROR_OK)
+    {
+        // Abandon attempting to connect to the socket, and try again later.
+        ScheduleReconnect();
+        return;
+    }
     
     if (m_TheTransportSocketType != TransportSocket_t::CELLULAR_NON_IP)
     {
-        auto ipAddress = Utilities::ResolveAddressIfDomainName(m_EchoServerDomainName
-                                                             , m_pNetworkInterface
-                                                             , &m_TheSocketAddress);
-        
-        if (ipAddress)
-        {
-            std::swap(m_EchoServerAddress, ipAddress);
-        }
-        else
+        if (!ResolveEchoServerAddress(true))
         {
-            printf("Error! Utility::ResolveAddressIfDomainName() failed.\r\n");
-
-            // Abandon attempting to connect to the socket. Subsequent 
-            // NetworkStatusCallbacks() will dispatch the ConnectToSocket()
-            // event again should network conditions become better favorable.                
+            // Abandon attempting to connect to the socket, and try again later.
+            ScheduleReconnect();
             return; 
         }
-        
-        m_TheSocketAddress.set_port(m_EchoServerPort);
 
         if (m_TheTransportSocketType == TransportSocket_t::TCP)
         {
@@ -462,15 +1293,30 @@ void LEDLightControl::ConnectToSocket()
                 m_EchoServerPort);
                 
             nsapi_error_t rc = m_pTheSocket->connect(m_TheSocketAddress);
+            
+            // The server may since have moved; only now pay for a lookup.
+            if ((rc != NSAPI_ERROR_OK) && Utilities::IsDomainNameAddress(m_EchoServerDomainName))
+            {
+                printf("Warning! Connecting to the cached address failed: [%d]; looking \"%s\" up afresh ...\n",
+                    rc, m_EchoServerDomainName.c_str());
+                
+                m_EchoServerAddressCache.Invalidate();
+                // A socket whose connect failed cannot be connected again.
+                if (ResolveEchoServerAddress(false) && ((rc = OpenSocket()) == NSAPI_ERROR_OK))
+                {
+                    rc = m_pTheSocket->connect(m_TheSocketAddress);
+                }
+            }
 
             if (rc != NSAPI_ERROR_OK)
             {
+                RecordFlight(LightControl::LogPoint_t::SOCKET_ERROR, 
+                    static_cast<int>(LightControl::SocketOperation_t::CONNECT), rc);
                 printf("Error! TCPSocket.connect() to EchoServer returned:\
-                    [%d] -> %s\n", rc, ToString(rc).c_str());
+                    [%d] -> %s\n", rc, ToString(rc));
                     
-                // Abandon attempting to connect to the socket. Subsequent 
-                // NetworkStatusCallbacks() will dispatch the ConnectToSocket()
-                // event again should network conditions become better favorable.                
+                // Abandon attempting to connect to the socket, and try again later.
+                ScheduleReconnect();
                 return;
             }
             else
@@ -481,256 +1327,1779 @@ void LEDLightControl::ConnectToSocket()
         }
     }
     
-    Run();
-}
-
-void LEDLightControl::Run()
-{    
-    printf("Running LEDLightControl::Run() ... \r\n");
+    if (m_IsNonBlocking)
+    {
+        // Returns straight away; the exchange carries on in Step() events.
+        StartExchange();
+    }
+    else
+    {
+        NegotiateWireFormat();
+        
+        Run();
+    }
+}
+
+template <TransportSocket_t socket>
+nsapi_error_t LEDLightControl::OpenSocketAs()
+{
+    using SocketClass_t = TransportSocketClass_t<socket>;
+    
+    // One socket object is constructed in place on the first connect, and
+    // reused by every reconnect thereafter; only the stack's resources 
+    // behind it are released by close() and acquired anew by open().
+    if (m_pTheSocket)
+    {
+        m_pTheSocket->sigio(nullptr);
+        [[maybe_unused]] auto unused_return = m_pTheSocket->close();
+    }
+    else
+    {
+        // Portable way of using the Abstract base class Socket to refer
+        // to any particular derived socket type.
+        m_pTheSocket = &m_TheSocketStorage.template emplace<SocketClass_t>();
+    }
+    
+    // Known by construction; no dynamic_cast needed.
+    auto * pTheSocket = static_cast<SocketClass_t *>(m_pTheSocket);
+    
+    // Opens:
+    // - UDP or TCP socket with the given echo server and performs an echo
+    //   transaction retrieving current message.
+    //
+    // - Cellular Non-IP socket for which the data delivery path is decided
+    //   by network's control plane CIoT optimisation setup, for the given APN.
+    nsapi_error_t rc;
+    if constexpr (socket == TransportSocket_t::CELLULAR_NON_IP)
+    {
+        rc = pTheSocket->open(m_pTheCellularContext);
+    }
+    else
+    {
+        rc = pTheSocket->open(m_pNetworkInterface);
+    }
+    
+    if (rc != NSAPI_ERROR_OK)
+    {
+        RecordFlight(LightControl::LogPoint_t::SOCKET_ERROR, 
+            static_cast<int>(LightControl::SocketOperation_t::OPEN), rc);
+        printf("Error! %s.open() returned: \
+            [%d] -> %s\r\n", TransportSocketClassName<socket>(), rc, ToString(rc));
+        return rc;
+    }
+    
+    // Set timeout on blocking socket operations.
+    //
+    // Initially all sockets have unbounded timeouts. NSAPI_ERROR_WOULD_BLOCK
+    // is returned if a blocking operation takes longer than the specified timeout.
+    //
+    // Also, extrapolate from the following rule:
+    //
+    // "If using network sockets as streams, a timeout should be set to 
+    //  stop denial of service attacks."
+    m_pTheSocket->set_blocking(true);
+    m_pTheSocket->set_timeout(BLOCKING_SOCKET_TIMEOUT_MILLISECONDS);
+    
+    return rc;
+}
+
+bool LEDLightControl::ResolveEchoServerAddress(bool isCacheAllowed)
+{
+    const bool isDomainName = Utilities::IsDomainNameAddress(m_EchoServerDomainName);
+    std::optional<SocketAddress> cached(std::nullopt);
+    
+    if (isCacheAllowed && isDomainName)
+    {
+        cached = m_EchoServerAddressCache.Lookup(m_EchoServerDomainName);
+    }
+    
+    if (cached)
+    {
+        printf("Using cached DNS lookup for : \"%s\" -> \"%s\"\n", 
+            m_EchoServerDomainName.c_str(), cached->get_ip_address());
+        
+        m_TheSocketAddress = *cached;
+        m_EchoServerAddress = cached->get_ip_address();
+        
+        if (m_EchoServerAddressCache.IsExpired())
+        {
+            RefreshEchoServerAddress();
+        }
+    }
+    else
+    {
+        auto ipAddress = Utilities::ResolveAddressIfDomainName(m_EchoServerDomainName
+                                                             , m_pNetworkInterface
+                                                             , &m_TheSocketAddress);
+        if (!ipAddress)
+        {
+            printf("Error! Utility::ResolveAddressIfDomainName() failed.\r\n");
+            return false;
+        }
+        
+        std::swap(m_EchoServerAddress, ipAddress);
+        
+        if (isDomainName)
+        {
+            m_EchoServerAddressCache.Store(m_EchoServerDomainName, m_TheSocketAddress);
+        }
+    }
+    
+    m_TheSocketAddress.set_port(m_EchoServerPort);
+    return true;
+}
+
+void LEDLightControl::RefreshEchoServerAddress()
+{
+    if (m_IsRefreshingEchoServerAddress)
+    {
+        return;
+    }
+    
+    // The lookup completes in another context; its result is handed over
+    // to the shared event queue, whichever context that may be.
+    nsapi_value_or_error_t rc = m_pNetworkInterface->gethostbyname_async(m_EchoServerDomainName.c_str(), 
+        [this](nsapi_value_or_error_t result, SocketAddress * pAddress)
+        {
+            // Mbed OS hands over no address at all on failure.
+            g_pSharedEventQueue->call(this, &LEDLightControl::OnEchoServerAddressRefreshed, 
+                                      result, ((result >= 0) && pAddress) ? *pAddress : SocketAddress());
+        });
+    
+    if (rc < 0)
+    {
+        printf("Error! Background DNS refresh returned: [%d] -> %s\n", rc, ToString(rc));
+    }
+    else
+    {
+        m_IsRefreshingEchoServerAddress = true;
+    }
+}
+
+void LEDLightControl::OnEchoServerAddressRefreshed(nsapi_value_or_error_t rc, SocketAddress address)
+{
+    m_IsRefreshingEchoServerAddress = false;
+    
+    if (rc < 0)
+    {
+        // Keep on using the address we have.
+        printf("Error! Background DNS refresh returned: [%d] -> %s\n", rc, ToString(rc));
+    }
+    else
+    {
+        // Used from the next (re)connect on; this connection is left be.
+        m_EchoServerAddressCache.Store(m_EchoServerDomainName, address);
+    }
+}
+
+void LEDLightControl::NegotiateWireFormat()
+{
+    // Every connection starts out on the text encoding, and only moves to
+    // the compact binary encoding once the peer has accepted it.
+    m_WireFormat = LightControl::WireFormat_t::TEXT;
+    
+    if (SendNegotiationRequest())
+    {
+        char rawBuffer[STANDARD_BUFFER_SIZE];
+        
+        m_pTheSocket->set_timeout(NEGOTIATION_TIMEOUT_MILLISECONDS);
+        nsapi_size_or_error_t rc = ReceiveRaw(rawBuffer, sizeof(rawBuffer));
+        m_pTheSocket->set_timeout(BLOCKING_SOCKET_TIMEOUT_MILLISECONDS);
+        
+        if (rc == NSAPI_ERROR_WOULD_BLOCK)
+        {
+            ++m_Statistics.m_Timeouts;
+        }
+        AcceptNegotiationReply(rc, rawBuffer);
+    }
+    
+    printf("LightControl wire format for this connection: %s\n", 
+        LightControl::ToString(m_WireFormat));
+}
+
+bool LEDLightControl::SendNegotiationRequest()
+{
+    auto result = false;
+    
+    if constexpr (PREFER_BINARY_WIRE_FORMAT)
+    {
+        char rawBuffer[STANDARD_BUFFER_SIZE];
+        
+        const auto lengthWritten = LightControl::EncodeNegotiation(
+                                       LightControl::WireFormat_t::BINARY, rawBuffer);
+        MBED_ASSERT(lengthWritten > 0);
+        
+        nsapi_size_or_error_t rc = SendRaw(rawBuffer, lengthWritten);
+        if (rc < 0)
+        {
+            RecordFlight(LightControl::LogPoint_t::SOCKET_ERROR, 
+                static_cast<int>(LightControl::SocketOperation_t::SEND), rc);
+            printf("Error! Wire format negotiation send returned:\
+                [%d] -> %s\n", rc, ToString(rc));
+        }
+        else
+        {
+            result = true;
+        }
+    }
+    
+    return result;
+}
+
+void LEDLightControl::AcceptNegotiationReply(nsapi_size_or_error_t rc, const char * pReply)
+{
+    if (rc > 0)
+    {
+        auto accepted = LightControl::ParseNegotiation(std::string_view(pReply, rc));
+        if (accepted)
+        {
+            m_WireFormat = *accepted;
+        }
+    }
+}
+
+template <TransportSocket_t socket>
+nsapi_size_or_error_t LEDLightControl::SendRawAs(const void * pData, nsapi_size_t size)
+{
+    using SocketClass_t = TransportSocketClass_t<socket>;
+    
+    // Qualified, hence non-virtual, calls on the concrete socket class.
+    nsapi_size_or_error_t rc;
+    if constexpr (socket == TransportSocket_t::UDP)
+    {
+        rc = static_cast<SocketClass_t *>(m_pTheSocket)->SocketClass_t::sendto(m_TheSocketAddress, pData, size);
+    }
+    else
+    {
+        rc = static_cast<SocketClass_t *>(m_pTheSocket)->SocketClass_t::send(pData, size);
+    }
+    
+    if (rc > 0)
+    {
+        m_Statistics.m_BytesSent += rc;
+    }
+    
+    // A non-blocking stream socket may take only the head of a message.
+    // The peer's framer would then glue it to the next message, so the
+    // stream is beyond repair; fail the send, and hence the connection.
+    if ((rc >= 0) && (static_cast<nsapi_size_t>(rc) < size))
+    {
+        printf("Error! Socket send to EchoServer took only %d of %u bytes.\n", 
+            rc, static_cast<unsigned>(size));
+        rc = NSAPI_ERROR_CONNECTION_LOST;
+    }
+    return rc;
+}
+
+template <TransportSocket_t socket>
+nsapi_size_or_error_t LEDLightControl::ReceiveRawAs(void * pData, nsapi_size_t size)
+{
+    using SocketClass_t = TransportSocketClass_t<socket>;
+    
+    nsapi_size_or_error_t rc;
+    if constexpr (socket == TransportSocket_t::UDP)
+    {
+        rc = static_cast<SocketClass_t *>(m_pTheSocket)->SocketClass_t::recvfrom(&m_TheSocketAddress, pData, size);
+    }
+    else
+    {
+        rc = static_cast<SocketClass_t *>(m_pTheSocket)->SocketClass_t::recv(pData, size);
+    }
+    
+    if (rc > 0)
+    {
+        m_Statistics.m_BytesReceived += rc;
+    }
+    return rc;
+}
+
+void LEDLightControl::Run()
+{    
+    printf("Running LEDLightControl::Run() ... \r\n");
+    
+    ResetExchange();
+    
+    auto healthy = true;
+    
+    while (healthy && g_IsConnected)
+    {
+        // Keep the window full so that throughput is bounded by bandwidth
+        // rather than by the round-trip time of the cellular link. With a
+        // window of 1 this is the original lock-step Send()/Receive().
+        while (healthy && (m_InFlightCount < m_PipelineWindow))
+        {
+            healthy = (Send() == IOResult_t::COMPLETED);
+        }
+        
+        if (healthy)
+        {
+            if (m_IsReliable)
+            {
+                SetReceiveTimeoutToNextDeadline();
+            }
+            
+            auto received = Receive();
+            if (received == IOResult_t::WOULD_BLOCK)
+            {
+                received = Retransmit();
+            }
+            healthy = (received == IOResult_t::COMPLETED);
+        }
+    }
+    
+    // Abandon exchanging packets with the EchoServer, and reconnect once
+    // network conditions have, hopefully, become more favorable.
+    ScheduleReconnect();
+}
+
+void LEDLightControl::ResetExchange()
+{
+    // Nothing carries over from a previous connection.
+    m_InFlightCount = 0;
+    m_OutstandingSequences.reset();
+    m_ReceiveFramer.Clear();
+    m_Reliability.Reset();
+    m_PendingSubscriptions = 0;
+    m_LastProgressTime = Kernel::Clock::now();
+    m_LastPingTime = m_LastProgressTime;
+}
+
+void LEDLightControl::StartExchange()
+{
+    printf("Running LEDLightControl::StartExchange() ... \r\n");
+    
+    ResetExchange();
+    m_WireFormat = LightControl::WireFormat_t::TEXT;
+    
+    // "The callback may be called in an interrupt context and should not
+    // perform expensive operations such as recv/send calls." Hence all
+    // that OnSocketSigio() does is to post a Step() onto the event queue.
+    m_pTheSocket->set_blocking(false);
+    m_pTheSocket->sigio(callback(this, &LEDLightControl::OnSocketSigio));
+    
+    if (m_IsPubSub)
+    {
+        StartPubSub();
+        return;
+    }
+    
+    m_ExchangeState = SendNegotiationRequest() ? ExchangeState_t::NEGOTIATING 
+                                               : ExchangeState_t::EXCHANGING;
+    
+    if (m_ExchangeState == ExchangeState_t::EXCHANGING)
+    {
+        printf("LightControl wire format for this connection: %s\n", 
+            LightControl::ToString(m_WireFormat));
+    }
+    
+    m_SupervisionEventId = g_pSharedEventQueue->call_every(SUPERVISION_PERIOD, this, 
+                                                   &LEDLightControl::SuperviseExchange);
+    ScheduleFlush();
+    PostStep();
+}
+
+void LEDLightControl::StopExchange()
+{
+    printf("Running LEDLightControl::StopExchange() ... \r\n");
+    
+    m_ExchangeState = ExchangeState_t::IDLE;
+    m_pTheSocket->sigio(nullptr);
+    
+    if (m_SupervisionEventId)
+    {
+        g_pSharedEventQueue->cancel(m_SupervisionEventId);
+        m_SupervisionEventId = 0;
+    }
+    
+    // Whatever is still queued waits for the next connection's windows.
+    if (m_FlushEventId)
+    {
+        g_pSharedEventQueue->cancel(m_FlushEventId);
+        m_FlushEventId = 0;
+    }
+    m_IsFlushing = false;
+    
+    if (m_RetransmitEventId)
+    {
+        g_pSharedEventQueue->cancel(m_RetransmitEventId);
+        m_RetransmitEventId = 0;
+    }
+    
+    if (m_IsCoroutineSession)
+    {
+        // The session, wherever it is suspended, is resumed only to find
+        // that it is no longer current, and so to end without further ado.
+        ++m_SessionGeneration;
+        m_AsyncSocket.Abort();
+    }
+    
+    // Abandon exchanging packets with the EchoServer. Whoever stopped the
+    // exchange on failure schedules the reconnect, see ScheduleReconnect().
+}
+
+void LEDLightControl::OnSocketSigio()
+{
+    PostStep();
+}
+
+void LEDLightControl::PostStep()
+{
+    // Coalesce bursts of sigio into a single pending Step().
+    if (!m_IsStepPending.exchange(true))
+    {
+        g_pSharedEventQueue->call(this, &LEDLightControl::Step);
+    }
+}
+
+void LEDLightControl::Step()
+{
+    m_IsStepPending = false;
+    
+    if (m_ExchangeState == ExchangeState_t::IDLE)
+    {
+        return;
+    }
+    
+    if (!g_IsConnected)
+    {
+        StopExchange();
+        ScheduleReconnect();
+        return;
+    }
+    
+    if (m_IsPubSub)
+    {
+        StepPubSub();
+        return;
+    }
+    
+    if (m_ExchangeState == ExchangeState_t::NEGOTIATING)
+    {
+        char rawBuffer[STANDARD_BUFFER_SIZE];
+        
+        nsapi_size_or_error_t rc = ReceiveRaw(rawBuffer, sizeof(rawBuffer));
+        if (rc == NSAPI_ERROR_WOULD_BLOCK)
+        {
+            return;
+        }
+        
+        AcceptNegotiationReply(rc, rawBuffer);
+        m_ExchangeState = ExchangeState_t::EXCHANGING;
+        
+        printf("LightControl wire format for this connection: %s\n", 
+            LightControl::ToString(m_WireFormat));
+    }
+    
+    auto result = IOResult_t::COMPLETED;
+    auto budget = MAXIMUM_OPERATIONS_PER_STEP;
+    
+    // Drain replies first, as each one frees up a slot in the window...
+    while ((budget > 0) && (m_InFlightCount > 0) 
+        && ((result = Receive()) == IOResult_t::COMPLETED))
+    {
+        --budget;
+    }
+    
+    // ...then refill the window.
+    while ((result != IOResult_t::FAILED) && (budget > 0) && (m_InFlightCount < m_PipelineWindow)
+        && IsSendDue() && ((result = Send()) == IOResult_t::COMPLETED))
+    {
+        --budget;
+    }
+    
+    if (result == IOResult_t::FAILED)
+    {
+        StopExchange();
+        ScheduleReconnect();
+    }
+    else if (budget == 0)
+    {
+        // Work remains, but yield to the other events on the queue first.
+        PostStep();
+    }
+    else if (m_IsFlushing && m_TrafficScheduler.IsEmpty() && (m_InFlightCount == 0))
+    {
+        // Burst complete; the radio may go back to sleep until the next
+        // window that there is anything to send in.
+        m_IsFlushing = false;
+    }
+}
+
+void LEDLightControl::SuperviseExchange()
+{
+    if (!g_IsConnected)
+    {
+        StopExchange();
+        ScheduleReconnect();
+        return;
+    }
+    
+    if (m_IsPubSub)
+    {
+        SupervisePubSub();
+        return;
+    }
+    
+    const auto idle = Kernel::Clock::now() - m_LastProgressTime;
+    
+    if ((m_ExchangeState == ExchangeState_t::NEGOTIATING) 
+        && (idle >= std::chrono::milliseconds(NEGOTIATION_TIMEOUT_MILLISECONDS)))
+    {
+        // No answer; the peer stays on the text encoding.
+        ++m_Statistics.m_Timeouts;
+        m_ExchangeState = ExchangeState_t::EXCHANGING;
+        m_LastProgressTime = Kernel::Clock::now();
+        
+        printf("LightControl wire format for this connection: %s\n", 
+            LightControl::ToString(m_WireFormat));
+        PostStep();
+    }
+    else if ((m_ExchangeState == ExchangeState_t::EXCHANGING) && (m_InFlightCount > 0)
+        && (idle >= std::chrono::milliseconds(BLOCKING_SOCKET_TIMEOUT_MILLISECONDS)))
+    {
+        OnReplyTimeout();
+        RecordFlight(LightControl::LogPoint_t::REPLY_TIMEOUT, BLOCKING_SOCKET_TIMEOUT_MILLISECONDS);
+        printf("Error! No LightControl reply within %d ms.\r\n", 
+            static_cast<int>(BLOCKING_SOCKET_TIMEOUT_MILLISECONDS));
+        StopExchange();
+        ScheduleReconnect();
+    }
+}
+
+void LEDLightControl::StartSession()
+{
+    auto session = RunSession(++m_SessionGeneration);
+    if (!session)
+    {
+        printf("Error! No coroutine frame left for the session: %u of %u in use.\r\n", 
+            static_cast<unsigned>(CoroutineFrameArena::Instance().InUse()), 
+            static_cast<unsigned>(COROUTINE_FRAMES));
+        ScheduleReconnect();
+        return;
+    }
+    
+    // Not IDLE, so that whatever stops the exchange stops the session too.
+    m_ExchangeState = ExchangeState_t::NEGOTIATING;
+    session.Detach();
+}
+
+Task<nsapi_error_t> LEDLightControl::OpenSession(uint32_t generation)
+{
+    nsapi_error_t rc = OpenSocket();
+    if (rc != NSAPI_ERROR_OK)
+    {
+        co_return rc;
+    }
+    m_AsyncSocket.Attach(m_pTheSocket);
+    
+    const bool isDomainName = Utilities::IsDomainNameAddress(m_EchoServerDomainName);
+    
+    if (m_TheTransportSocketType != TransportSocket_t::CELLULAR_NON_IP)
+    {
+        if (isDomainName && !m_EchoServerAddressCache.Lookup(m_EchoServerDomainName))
+        {
+            const auto resolved = co_await ResolveAsync(*g_pSharedEventQueue, m_pNetworkInterface, 
+                                                        m_EchoServerDomainName.c_str());
+            if (generation != m_SessionGeneration)
+            {
+                co_return NSAPI_ERROR_NO_SOCKET;
+            }
+            if (resolved.m_Result < 0)
+            {
+                printf("Error! DNS lookup of \"%s\" returned: [%d] -> %s\n", 
+                    m_EchoServerDomainName.c_str(), resolved.m_Result, ToString(resolved.m_Result));
+                co_return resolved.m_Result;
+            }
+            m_EchoServerAddressCache.Store(m_EchoServerDomainName, resolved.m_Address);
+        }
+        
+        // A cache hit, or an IP address literal, by now; neither blocks.
+        if (!ResolveEchoServerAddress(true))
+        {
+            co_return NSAPI_ERROR_DNS_FAILURE;
+        }
+        
+        if (m_TheTransportSocketType == TransportSocket_t::TCP)
+        {
+            printf("Connecting to \"%s\" as resolved to: \"%s:%d\" ...\n",
+                m_EchoServerDomainName.c_str(), m_EchoServerAddress.value().c_str(), m_EchoServerPort);
+            
+            rc = co_await m_AsyncSocket.Connect(m_TheSocketAddress, 
+                     std::chrono::milliseconds(BLOCKING_SOCKET_TIMEOUT_MILLISECONDS));
+            if (generation != m_SessionGeneration)
+            {
+                co_return NSAPI_ERROR_NO_SOCKET;
+            }
+            if (rc != NSAPI_ERROR_OK)
+            {
+                RecordFlight(LightControl::LogPoint_t::SOCKET_ERROR, 
+                    static_cast<int>(LightControl::SocketOperation_t::CONNECT), rc);
+                printf("Error! TCPSocket.connect() to EchoServer returned:\
+                    [%d] -> %s\n", rc, ToString(rc));
+                
+                // The server may since have moved; the next attempt looks it up afresh.
+                if (isDomainName)
+                {
+                    m_EchoServerAddressCache.Invalidate();
+                }
+                co_return rc;
+            }
+            printf("Success! Connected to EchoServer at \"%s\" as resolved to: \"%s:%d\"\n", 
+                m_EchoServerDomainName.c_str(), m_EchoServerAddress.value().c_str(), m_EchoServerPort);
+        }
+    }
+    
+    m_WireFormat = LightControl::WireFormat_t::TEXT;
+    
+    if (SendNegotiationRequest())
+    {
+        char rawBuffer[STANDARD_BUFFER_SIZE];
+        
+        const auto deadline = Kernel::Clock::now() + std::chrono::milliseconds(NEGOTIATION_TIMEOUT_MILLISECONDS);
+        
+        nsapi_size_or_error_t received = ReceiveRaw(rawBuffer, sizeof(rawBuffer));
+        while ((received == NSAPI_ERROR_WOULD_BLOCK) && (Kernel::Clock::now() < deadline))
+        {
+            const auto ready = co_await m_AsyncSocket.WhenReady(
+                std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Kernel::Clock::now()));
+            if (generation != m_SessionGeneration)
+            {
+                co_return NSAPI_ERROR_NO_SOCKET;
+            }
+            received = (ready == NSAPI_ERROR_OK) ? ReceiveRaw(rawBuffer, sizeof(rawBuffer)) : ready;
+        }
+        
+        if (received == NSAPI_ERROR_WOULD_BLOCK)
+        {
+            ++m_Statistics.m_Timeouts;
+        }
+        AcceptNegotiationReply(received, rawBuffer);
+    }
+    
+    printf("LightControl wire format for this connection: %s\n", 
+        LightControl::ToString(m_WireFormat));
+    co_return NSAPI_ERROR_OK;
+}
+
+Task<> LEDLightControl::RunSession(uint32_t generation)
+{
+    printf("Running LEDLightControl::RunSession() ... \r\n");
+    
+    nsapi_error_t rc = NSAPI_ERROR_NO_MEMORY;
+    
+    auto opening = OpenSession(generation);
+    if (opening)
+    {
+        rc = co_await opening;
+    }
+    else
+    {
+        printf("Error! No coroutine frame left for opening the session.\r\n");
+    }
+    
+    if (generation != m_SessionGeneration)
+    {
+        // Stopped, and perhaps superseded by another session, meanwhile.
+        co_return;
+    }
+    
+    auto result = (rc == NSAPI_ERROR_OK) ? IOResult_t::COMPLETED : IOResult_t::FAILED;
+    auto budget = MAXIMUM_OPERATIONS_PER_STEP;
+    
+    ResetExchange();
+    m_ExchangeState = ExchangeState_t::EXCHANGING;
+    
+    // The same exchange as Run()'s, but where Run() would block, the
+    // session co_awaits the socket instead and the event queue carries on.
+    while ((result != IOResult_t::FAILED) && g_IsConnected)
+    {
+        result = (m_InFlightCount < m_PipelineWindow) ? Send() : Receive();
+        
+        if (result == IOResult_t::WOULD_BLOCK)
+        {
+            const auto idle = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                  Kernel::Clock::now() - m_LastProgressTime);
+            const auto timeout = std::max(std::chrono::milliseconds(BLOCKING_SOCKET_TIMEOUT_MILLISECONDS) - idle, 
+                                          std::chrono::milliseconds(1));
+            
+            // Retransmissions, when reliable, go out from their own timer.
+            const auto ready = co_await m_AsyncSocket.WhenReady(timeout);
+            if (generation != m_SessionGeneration)
+            {
+                co_return;
+            }
+            if (ready == NSAPI_ERROR_WOULD_BLOCK)
+            {
+                OnReplyTimeout();
+                RecordFlight(LightControl::LogPoint_t::REPLY_TIMEOUT, BLOCKING_SOCKET_TIMEOUT_MILLISECONDS);
+                printf("Error! No LightControl reply within %d ms.\r\n", 
+                    static_cast<int>(BLOCKING_SOCKET_TIMEOUT_MILLISECONDS));
+                result = IOResult_t::FAILED;
+            }
+            budget = MAXIMUM_OPERATIONS_PER_STEP;
+        }
+        else if (--budget == 0)
+        {
+            // Work remains, but yield to the other events on the queue first.
+            co_await SleepFor(*g_pSharedEventQueue, 0ms);
+            if (generation != m_SessionGeneration)
+            {
+                co_return;
+            }
+            budget = MAXIMUM_OPERATIONS_PER_STEP;
+        }
+    }
+    
+    // Abandon exchanging packets with the EchoServer, and reconnect once
+    // network conditions have, hopefully, become more favorable.
+    StopExchange();
+    ScheduleReconnect();
+}
+
+void LEDLightControl::StartPubSub()
+{
+    // Subscribers decode either encoding, so nothing is negotiated; the
+    // preference only decides how our own publishes are encoded.
+    m_WireFormat = PREFER_BINARY_WIRE_FORMAT ? LightControl::WireFormat_t::BINARY 
+                                             : LightControl::WireFormat_t::TEXT;
+    m_ExchangeState = ExchangeState_t::SUBSCRIBING;
+    
+    printf("Connecting to LightControl broker as \"%s\" ...\r\n", m_PubSubClientId);
+    
+    // Should the CONNECT get lost, SupervisePubSub() times the attempt out.
+    [[maybe_unused]] auto sent = SendPubSub({LightControl::PubSubType_t::CONNECT, 
+        LightControl::PUBSUB_FLAG_CLEAN_SESSION, 0, 0, PUBSUB_KEEP_ALIVE_SECONDS, 
+        LightControl::PubSubReturnCode_t::ACCEPTED, m_PubSubClientId});
+    
+    m_SupervisionEventId = g_pSharedEventQueue->call_every(SUPERVISION_PERIOD, this, 
+                                                   &LEDLightControl::SuperviseExchange);
+    PostStep();
+}
+
+void LEDLightControl::StepPubSub()
+{
+    auto result = IOResult_t::COMPLETED;
+    auto budget = MAXIMUM_OPERATIONS_PER_STEP;
+    
+    while ((budget > 0) && ((result = ReceivePubSub()) == IOResult_t::COMPLETED))
+    {
+        --budget;
+    }
+    
+    // Publish whatever is queued, once subscribed; i.e. once the broker
+    // has proven to be there.
+    while ((result != IOResult_t::FAILED) && (budget > 0) 
+        && (m_ExchangeState == ExchangeState_t::EXCHANGING)
+        && !m_TrafficScheduler.IsEmpty() && IsSendDue() 
+        && ((result = Publish()) == IOResult_t::COMPLETED))
+    {
+        --budget;
+    }
+    
+    if (result == IOResult_t::FAILED)
+    {
+        StopExchange();
+        ScheduleReconnect();
+    }
+    else if (budget == 0)
+    {
+        PostStep();
+    }
+    else if (m_IsFlushing && m_TrafficScheduler.IsEmpty())
+    {
+        m_IsFlushing = false;
+    }
+}
+
+void LEDLightControl::SupervisePubSub()
+{
+    const auto now = Kernel::Clock::now();
+    const auto idle = now - m_LastProgressTime;
+    const auto keepAlive = std::chrono::seconds(PUBSUB_KEEP_ALIVE_SECONDS);
+    
+    if ((m_ExchangeState == ExchangeState_t::SUBSCRIBING)
+        && (idle >= std::chrono::milliseconds(NEGOTIATION_TIMEOUT_MILLISECONDS)))
+    {
+        OnReplyTimeout();
+        printf("Error! No answer from the LightControl broker within %d ms.\r\n", 
+            static_cast<int>(NEGOTIATION_TIMEOUT_MILLISECONDS));
+        StopExchange();
+        ScheduleReconnect();
+    }
+    else if ((m_ExchangeState == ExchangeState_t::EXCHANGING) && (idle >= (2 * keepAlive)))
+    {
+        // Three PINGREQs in a row went unanswered.
+        OnReplyTimeout();
+        printf("Error! Nothing from the LightControl broker within %d s.\r\n", 
+            static_cast<int>(2 * PUBSUB_KEEP_ALIVE_SECONDS));
+        StopExchange();
+        ScheduleReconnect();
+    }
+    else if ((m_ExchangeState == ExchangeState_t::EXCHANGING) && (idle >= (keepAlive / 2)) 
+        && ((now - m_LastPingTime) >= (keepAlive / 2)))
+    {
+        // Well within the broker's 1.5 times the keep alive, and ahead of
+        // most NAT bindings expiring on an idle cellular link.
+        m_LastPingTime = now;
+        [[maybe_unused]] auto sent = SendPubSub({LightControl::PubSubType_t::PINGREQ});
+    }
+}
+
+void LEDLightControl::SubscribeGroupTopics()
+{
+    m_PendingSubscriptions = 0;
+    
+    // The master group is a topic of its own, which every device is on.
+    const auto subscribe = [this](uint16_t group)
+    {
+        if (SendPubSub(LightControl::MakeSubscribe(group, PUBSUB_QOS, ++m_PubSubMessageId)))
+        {
+            ++m_PendingSubscriptions;
+        }
+    };
+    
+    subscribe(MASTER_LIGHT_CONTROL_GROUP);
+    m_SubscribedGroups.ForEachTarget(MASTER_LIGHT_CONTROL_GROUP, subscribe);
+}
+
+LEDLightControl::IOResult_t LEDLightControl::ReceivePubSub()
+{
+    char rawBuffer[LightControl::PUBSUB_MAXIMUM_PACKET_SIZE];
+    
+    nsapi_size_or_error_t rc = ReceiveRaw(rawBuffer, sizeof(rawBuffer));
+    if (rc == NSAPI_ERROR_WOULD_BLOCK)
+    {
+        return IOResult_t::WOULD_BLOCK;
+    }
+    else if (rc <= 0)
+    {
+        ++m_Statistics.m_ReceiveFailures;
+        RecordFlight(LightControl::LogPoint_t::SOCKET_ERROR, 
+            static_cast<int>(LightControl::SocketOperation_t::RECEIVE), rc);
+        printf("Error! Socket receive from LightControl broker returned:\
+            [%d] -> %s\n", rc, ToString(rc));
+        return IOResult_t::FAILED;
+    }
+    
+    g_DeferredLog.Record(LightControl::LogPoint_t::RECEIVED, rc);
+    m_LastProgressTime = Kernel::Clock::now();
+    
+    const auto packet = LightControl::DecodePubSub(std::string_view(rawBuffer, rc));
+    if (!packet)
+    {
+        ++m_Statistics.m_ParseFailures[static_cast<std::size_t>(LightControl::ParseError_t::TYPE_FIELD_INVALID)];
+        g_DeferredLog.Record(LightControl::LogPoint_t::PARSE_FAILED, 
+            static_cast<int>(LightControl::ParseError_t::TYPE_FIELD_INVALID));
+        RecordFlight(LightControl::LogPoint_t::PARSE_FAILED, 
+            static_cast<int>(LightControl::ParseError_t::TYPE_FIELD_INVALID));
+        return IOResult_t::COMPLETED;
+    }
+    
+    switch (packet->m_Type)
+    {
+        case LightControl::PubSubType_t::CONNACK:
+            if (packet->m_ReturnCode != LightControl::PubSubReturnCode_t::ACCEPTED)
+            {
+                printf("Error! LightControl broker rejected the connection: [%d]\r\n", 
+                    static_cast<int>(packet->m_ReturnCode));
+                return IOResult_t::FAILED;
+            }
+            SubscribeGroupTopics();
+            break;
+            
+        case LightControl::PubSubType_t::SUBACK:
+            if (packet->m_ReturnCode != LightControl::PubSubReturnCode_t::ACCEPTED)
+            {
+                printf("Warning! LightControl broker rejected the subscription to topic %u: [%d]\r\n", 
+                    packet->m_TopicId, static_cast<int>(packet->m_ReturnCode));
+            }
+            if ((m_ExchangeState == ExchangeState_t::SUBSCRIBING) && (m_PendingSubscriptions > 0) 
+                && (--m_PendingSubscriptions == 0))
+            {
+                printf("Success! Subscribed to the LightControl group topics at the broker.\r\n");
+                
+                // The connection has proven itself; the next loss starts afresh.
+                m_ExchangeState = ExchangeState_t::EXCHANGING;
+                m_ReconnectBackoff.Reset();
+                ScheduleFlush();
+            }
+            break;
+            
+        case LightControl::PubSubType_t::PUBLISH:
+            // The message's own group is what it is acted upon by, exactly
+            // as for the echo exchange; the topic only got it here.
+            if (ParseAndConsumeLightControlMessage(packet->m_Payload) && packet->IsQoS1())
+            {
+                [[maybe_unused]] auto sent = SendPubSub(LightControl::MakePubAck(*packet));
+            }
+            break;
+            
+        case LightControl::PubSubType_t::DISCONNECT:
+            printf("Error! LightControl broker disconnected us.\r\n");
+            return IOResult_t::FAILED;
+            
+        default:
+            // PINGRESP, and the PUBACK to a publish of ours, only prove
+            // that the broker is still there.
+            break;
+    }
+    
+    return IOResult_t::COMPLETED;
+}
+
+LEDLightControl::IOResult_t LEDLightControl::Publish()
+{
+    char rawBuffer[LightControl::PUBSUB_MAXIMUM_PACKET_SIZE];
+    
+    // Always QoS 0. A light state is absolute, and superseded by the next
+    // one for its group anyway; see TrafficScheduler.h.
+    const auto lengthWritten = LightControl::EncodePublish(m_WireFormat, m_TrafficScheduler.Front(), 
+                                                           0, ++m_PubSubMessageId, rawBuffer);
+    MBED_ASSERT(lengthWritten > 0);
+    
+    nsapi_size_or_error_t rc = SendRaw(rawBuffer, lengthWritten);
+    if (rc == NSAPI_ERROR_WOULD_BLOCK)
+    {
+        return IOResult_t::WOULD_BLOCK;
+    }
+    else if (rc < 0)
+    {
+        ++m_Statistics.m_SendFailures;
+        RecordFlight(LightControl::LogPoint_t::SOCKET_ERROR, 
+            static_cast<int>(LightControl::SocketOperation_t::SEND), rc);
+        printf("Error! Socket publish to LightControl broker returned:\
+            [%d] -> %s\n", rc, ToString(rc));
+        return IOResult_t::FAILED;
+    }
+    
+    m_TrafficScheduler.Pop();
+    ++m_Statistics.m_MessagesSent;
+    return IOResult_t::COMPLETED;
+}
+
+bool LEDLightControl::SendPubSub(const LightControl::PubSubPacket_t & packet)
+{
+    char rawBuffer[LightControl::PUBSUB_MAXIMUM_PACKET_SIZE];
+    
+    const auto lengthWritten = LightControl::EncodePubSub(packet, rawBuffer);
+    MBED_ASSERT(lengthWritten > 0);
+    
+    nsapi_size_or_error_t rc = SendRaw(rawBuffer, lengthWritten);
+    if (rc < 0)
+    {
+        ++m_Statistics.m_SendFailures;
+        RecordFlight(LightControl::LogPoint_t::SOCKET_ERROR, 
+            static_cast<int>(LightControl::SocketOperation_t::SEND), rc);
+        printf("Error! Socket send to LightControl broker returned:\
+            [%d] -> %s\n", rc, ToString(rc));
+        return false;
+    }
+    return true;
+}
+
+void LEDLightControl::OnLinkLost()
+{
+    // The exchange would notice g_IsConnected by itself, on its next step;
+    // but there may be no step to come, e.g. when nothing is in flight.
+    if (m_ExchangeState != ExchangeState_t::IDLE)
+    {
+        StopExchange();
+    }
+    ScheduleReconnect();
+}
+
+void LEDLightControl::OnReplyTimeout()
+{
+    ++m_Statistics.m_Timeouts;
+    
+    // A datagram to a stale address fails silently, so unlike a TCP
+    // connect(), the reconnect would not notice it; look it up afresh.
+    if (m_TheTransportSocketType == TransportSocket_t::UDP)
+    {
+        m_EchoServerAddressCache.Invalidate();
+    }
+}
+
+void LEDLightControl::ScheduleReconnect()
+{
+    // Recovery is timed from the first sign of trouble, not from the
+    // latest of the attempts to recover from it.
+    if (!m_LinkLossTime)
+    {
+        m_LinkLossTime = Kernel::Clock::now();
+    }
+    
+    if (m_ReconnectEventId)
+    {
+        return;
+    }
+    
+    const auto delay = m_ReconnectBackoff.Next(randLIB_get_32bit());
+    
+    RecordFlight(LightControl::LogPoint_t::RECONNECT_SCHEDULED, 
+        static_cast<int>(delay.count()), m_ReconnectBackoff.Attempts());
+    printf("Reconnecting in %d ms (attempt %lu) ...\r\n", static_cast<int>(delay.count()),
+        static_cast<unsigned long>(m_ReconnectBackoff.Attempts()));
+    
+    m_ReconnectEventId = g_pSharedEventQueue->call_in(delay, this, &LEDLightControl::Reconnect);
+}
+
+void LEDLightControl::Reconnect()
+{
+    m_ReconnectEventId = 0;
+    ++m_Statistics.m_ReconnectAttempts;
+    
+    if (g_IsConnected)
+    {
+        // Only the socket was lost. The interface, and with it the modem's
+        // registration and PDP context, is left be; re-initializing it
+        // would only add an attach procedure to the recovery time.
+        ConnectToSocket();
+    }
+    else
+    {
+        // Asynchronous; its GLOBAL_UP dispatches ConnectToSocket(), just
+        // as on boot. Should it not come up, the next attempt asks again.
+        nsapi_error_t rc = m_pNetworkInterface->connect();
+        if ((rc != NSAPI_ERROR_OK) && (rc != NSAPI_ERROR_IS_CONNECTED) 
+            && (rc != NSAPI_ERROR_ALREADY) && (rc != NSAPI_ERROR_BUSY))
+        {
+            printf("Error! NetworkInterface.connect() returned: \
+                [%d] -> %s\r\n", rc, ToString(rc));
+        }
+        ScheduleReconnect();
+    }
+}
+
+LightControl::Enqueued_t LEDLightControl::QueueLightControl(uint16_t group, bool state)
+{
+    const auto enqueued = m_TrafficScheduler.Enqueue({group, state});
+    
+    if (enqueued == LightControl::Enqueued_t::COALESCED)
+    {
+        ++m_Statistics.m_CoalescedMessages;
+    }
+    else if (enqueued == LightControl::Enqueued_t::FULL)
+    {
+        ++m_Statistics.m_DroppedMessages;
+    }
+    
+    if (m_IsFlushing)
+    {
+        // The radio is on anyway; have it go out in this very burst.
+        PostStep();
+    }
+    else
+    {
+        ScheduleFlush();
+    }
+    return enqueued;
+}
+
+void LEDLightControl::QueueBlink()
+{
+    g_UserLEDState = !g_UserLEDState;
+    [[maybe_unused]] auto enqueued = QueueLightControl(MY_LIGHT_CONTROL_GROUP, g_UserLEDState);
+}
+
+void LEDLightControl::ScheduleFlush()
+{
+    if (m_IsFlushing || m_FlushEventId || (m_ExchangeState == ExchangeState_t::IDLE))
+    {
+        return;
+    }
+    
+    const auto now = Uptime();
+    const auto flush = m_TrafficScheduler.NextFlush(now);
+    
+    if (flush)
+    {
+        m_FlushEventId = g_pSharedEventQueue->call_in(*flush - now, this, &LEDLightControl::BeginFlush);
+    }
+}
+
+void LEDLightControl::BeginFlush()
+{
+    m_FlushEventId = 0;
+    m_IsFlushing = true;
+    ++m_Statistics.m_WakeBursts;
+    PostStep();
+}
+
+bool LEDLightControl::IsSendDue() const
+{
+    if (!m_TrafficScheduler.Schedule().IsEnabled())
+    {
+        return true;
+    }
+    return (m_IsFlushing && !m_TrafficScheduler.IsEmpty());
+}
+
+LEDLightControl::IOResult_t LEDLightControl::Send()
+{    
+    //printf("Running LEDLightControl::Send() ... \r\n");
+    
+    auto result = IOResult_t::FAILED;
+    char rawBuffer[STANDARD_BUFFER_SIZE];
+    
+    // Simulate LED blinking through LightControl protocol messages sent 
+    // on the various supported socket transport protocols. The toggle is
+    // only committed once the message is actually on its way. Anything 
+    // queued goes out first though; with wake windows, that is all there
+    // is, as then the blink queues its toggles too (see QueueBlink()).
+    const bool isQueued = !m_TrafficScheduler.IsEmpty();
+    const bool nextLEDState = !g_UserLEDState;
+    
+    // Protocol for LightControl message is a NUL terminated string of 
+    // semicolon separated <field identifier>:<value> pairs.
+    // 
+    // LightControl protocol message format:
+    //
+    // t:lights;g:<group_id>;s:<1|0>;\0
+    // 
+    // ...or its 3-byte binary equivalent, should the peer have accepted
+    // that encoding during negotiation. See LightControlCodec.h.
+    LightControl::Message_t message = isQueued ? m_TrafficScheduler.Front() 
+                                               : LightControl::Message_t{MY_LIGHT_CONTROL_GROUP, nextLEDState};
+    
+    // Sequence numbers are only put on the wire when pipelining, or for
+    // datagrams to be acknowledged by, so the lock-step exchange over TCP
+    // keeps its original message size.
+    if ((m_PipelineWindow > 1) || m_IsReliable)
+    {
+        message.m_Sequence = m_NextSequence;
+    }
+    
+    // Asks for the reply to be stamped; an echo server merely echoes it.
+    if (m_IsClockSync)
+    {
+        message.m_ControllerTime = LightControl::CONTROLLER_TIME_REQUEST;
+    }
+    
+    const auto lengthWritten = LightControl::Encode(m_WireFormat, message, rawBuffer);
+    
+    MBED_ASSERT(lengthWritten > 0);
+    
+    nsapi_size_or_error_t rc = SendRaw(rawBuffer, lengthWritten);
+    
+    if ((rc == NSAPI_ERROR_WOULD_BLOCK) && m_IsNonBlocking)
+    {
+        result = IOResult_t::WOULD_BLOCK;
+    }
+    else if (rc < 0)
+    {
+        ++m_Statistics.m_SendFailures;
+        RecordFlight(LightControl::LogPoint_t::SOCKET_ERROR, 
+            static_cast<int>(LightControl::SocketOperation_t::SEND), rc);
+        printf("Error! Socket send to EchoServer returned:\
+            [%d] -> %s\n", rc, ToString(rc));
+    }
+    else
+    {
+        if (isQueued)
+        {
+            m_TrafficScheduler.Pop();
+        }
+        else
+        {
+            g_UserLEDState = nextLEDState;
+        }
+        ++m_Statistics.m_MessagesSent;
+        m_SendTimesMicroseconds[m_NextSequence] = static_cast<uint32_t>(
+            HighResClock::now().time_since_epoch().count());
+        if (m_IsReliable)
+        {
+            m_Reliability.OnSent(m_NextSequence, message, Uptime());
+            ArmRetransmitTimer();
+        }
+        m_OutstandingSequences.set(m_NextSequence++);
+        ++m_InFlightCount;
+        result = IOResult_t::COMPLETED;
+    }
     
-    while (g_IsConnected)
-    {
-        if (Send())
+    return result;
+}
+
+LEDLightControl::IOResult_t LEDLightControl::Retransmit()
+{
+    char rawBuffer[STANDARD_BUFFER_SIZE];
+    auto result = IOResult_t::COMPLETED;
+    
+    const auto resent = m_Reliability.RetransmitDue(Uptime(), 
+        [this, &rawBuffer, &result](uint8_t sequence, const LightControl::Message_t & message)
         {
-            if (Receive())
+            const auto lengthWritten = LightControl::Encode(m_WireFormat, message, rawBuffer);
+            MBED_ASSERT(lengthWritten > 0);
+            
+            nsapi_size_or_error_t rc = SendRaw(rawBuffer, lengthWritten);
+            if ((rc == NSAPI_ERROR_WOULD_BLOCK) && m_IsNonBlocking)
             {
-                continue;
+                // Left due; the next expiry of the timer tries again.
+                return false;
             }
-            else
+            else if (rc < 0)
             {
-                break;
+                ++m_Statistics.m_SendFailures;
+                RecordFlight(LightControl::LogPoint_t::SOCKET_ERROR, 
+                    static_cast<int>(LightControl::SocketOperation_t::SEND), rc);
+                printf("Error! Socket retransmission to EchoServer returned:\
+                    [%d] -> %s\n", rc, ToString(rc));
+                result = IOResult_t::FAILED;
+                return false;
             }
-        }
-        else
+            
+            ++m_Statistics.m_Retransmissions;
+            g_DeferredLog.Record(LightControl::LogPoint_t::RETRANSMITTED, 
+                static_cast<int>(sequence), static_cast<int>(m_Reliability.Rto().Value().count()));
+            return true;
+        });
+    
+    if (!resent)
+    {
+        OnReplyTimeout();
+        printf("Error! No LightControl reply despite %d retransmissions.\r\n", 
+            static_cast<int>(DATAGRAM_MAXIMUM_RETRANSMISSIONS));
+        result = IOResult_t::FAILED;
+    }
+    
+    return result;
+}
+
+void LEDLightControl::ArmRetransmitTimer()
+{
+    // The blocking Run() times its receives out at the deadline instead.
+    if (!m_IsNonBlocking || m_RetransmitEventId)
+    {
+        return;
+    }
+    
+    const auto now = Uptime();
+    const auto deadline = m_Reliability.NextDeadline(now);
+    if (deadline)
+    {
+        m_RetransmitEventId = g_pSharedEventQueue->call_in(std::max(*deadline - now, 
+            std::chrono::milliseconds(1)), this, &LEDLightControl::OnRetransmitTimer);
+    }
+}
+
+void LEDLightControl::OnRetransmitTimer()
+{
+    m_RetransmitEventId = 0;
+    
+    if (m_ExchangeState != ExchangeState_t::EXCHANGING)
+    {
+        return;
+    }
+    
+    if (Retransmit() == IOResult_t::FAILED)
+    {
+        StopExchange();
+        ScheduleReconnect();
+        return;
+    }
+    ArmRetransmitTimer();
+}
+
+void LEDLightControl::SetReceiveTimeoutToNextDeadline()
+{
+    auto timeout = std::chrono::milliseconds(BLOCKING_SOCKET_TIMEOUT_MILLISECONDS);
+    
+    const auto now = Uptime();
+    const auto deadline = m_Reliability.NextDeadline(now);
+    if (deadline)
+    {
+        timeout = std::clamp(*deadline - now, std::chrono::milliseconds(1), timeout);
+    }
+    m_pTheSocket->set_timeout(static_cast<int>(timeout.count()));
+}
+
+bool LEDLightControl::IsDuplicateReply(const std::optional<uint8_t> & sequence) const
+{
+    return m_IsReliable && sequence && m_Reliability.IsDuplicate(*sequence);
+}
+
+std::chrono::milliseconds LEDLightControl::Uptime()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(Kernel::Clock::now().time_since_epoch());
+}
+
+std::optional<LightControl::TimerHandle_t> LEDLightControl::ScheduleLightControl(uint16_t group, bool state, 
+                                                                                 std::chrono::milliseconds delay)
+{
+    if (group > LightControl::MAXIMUM_GROUP_ID)
+    {
+        return std::nullopt;
+    }
+    
+    const auto now = Uptime();
+    if (m_TimerWheel.IsEmpty())
+    {
+        // Nothing pending, so the wheel's time may as well start afresh.
+        m_TimerWheelTime = now;
+    }
+    
+    // From the wheel's time, which trails now by up to a tick, and rounded
+    // up; never early, at most a tick late.
+    const auto fromWheelTime = (now - m_TimerWheelTime) + std::max(delay, std::chrono::milliseconds(0));
+    const auto ticks = (fromWheelTime + TIMER_WHEEL_TICK - std::chrono::milliseconds(1)) / TIMER_WHEEL_TICK;
+    
+    const auto handle = (ticks <= decltype(m_TimerWheel)::MAXIMUM_DELAY)
+        ? m_TimerWheel.Schedule(static_cast<uint32_t>(ticks), TimedAction_t{group, state}) : std::nullopt;
+    if (!handle)
+    {
+        ++m_Statistics.m_TimedActionsRejected;
+        return std::nullopt;
+    }
+    
+    ArmTimerWheel();
+    return handle;
+}
+
+bool LEDLightControl::CancelLightControl(const LightControl::TimerHandle_t & handle)
+{
+    // Should the wheel be left empty, its event merely finds nothing due.
+    return m_TimerWheel.Cancel(handle);
+}
+
+bool LEDLightControl::AddPwmChannel(PinName pin, uint16_t group)
+{
+    if ((pin == NC) || (group > LightControl::MAXIMUM_GROUP_ID) || (m_PwmChannelCount == MAXIMUM_PWM_CHANNELS))
+    {
+        return false;
+    }
+    
+    auto & output = m_PwmOutputs[m_PwmChannelCount].emplace(pin);
+    output.period_us(PWM_PERIOD_MICROSECONDS);
+    output.write(0.0f);
+    m_PwmGroups[m_PwmChannelCount++] = group;
+    return true;
+}
+
+void LEDLightControl::ArmTimerWheel()
+{
+    const auto ticks = m_TimerWheel.TicksToNextSlot();
+    if (!ticks)
+    {
+        return;
+    }
+    
+    const auto due = m_TimerWheelTime + (*ticks * TIMER_WHEEL_TICK);
+    if (m_TimerWheelEventId)
+    {
+        if (m_TimerWheelDue <= due)
         {
-            break;
+            return;
         }
+        g_pSharedEventQueue->cancel(m_TimerWheelEventId);
     }
     
-    // Abandon exchanging packets with the EchoServer. Subsequent 
-    // NetworkStatusCallbacks() will dispatch the ConnectToSocket()
-    // event again should network conditions become better favorable. 
+    m_TimerWheelDue = due;
+    m_TimerWheelEventId = g_pSharedEventQueue->call_in(std::max(due - Uptime(), std::chrono::milliseconds(0)), 
+                                                       this, &LEDLightControl::OnTimerWheelTick);
 }
 
-bool LEDLightControl::Send()
-{    
-    //printf("Running LEDLightControl::Send() ... \r\n");
+void LEDLightControl::OnTimerWheelTick()
+{
+    m_TimerWheelEventId = 0;
     
-    auto result = false;
-    char rawBuffer[STANDARD_BUFFER_SIZE];
-    int lengthWritten{0};    
+    // However late the event was dispatched, every tick up to now is run.
+    const auto elapsed = (Uptime() - m_TimerWheelTime) / TIMER_WHEEL_TICK;
+    m_TimerWheelTime += elapsed * TIMER_WHEEL_TICK;
     
-    memset(rawBuffer, 0, sizeof(rawBuffer));
+    m_TimerWheel.Advance(static_cast<uint32_t>(elapsed), [this](const TimedAction_t & action)
+    {
+        const auto writes = ExecuteLightControl(LightControl::Message_t{action.m_Group, action.m_State != 0});
+        ++m_Statistics.m_TimedActionsExecuted;
+        g_DeferredLog.Record(LightControl::LogPoint_t::LIGHTS_SWITCHED, 
+            action.m_Group, action.m_State, writes.value_or(0));
+    });
     
-    // Simulate LED blinking through LightControl protocol messages sent 
-    // on the various supported socket transport protocols:
-    g_UserLEDState = !g_UserLEDState;
+    ArmTimerWheel();
+}
+
+LEDLightControl::IOResult_t LEDLightControl::Receive()
+{
+    //printf("Running LEDLightControl::Receive() ... \r\n");
     
-    // Protocol for LightControl message is a NUL terminated string of 
-    // semicolon separated <field identifier>:<value> pairs.
-    // 
-    // LightControl protocol message format:
-    //
-    // t:lights;g:<group_id>;s:<1|0>;\0
-    // 
-    lengthWritten = std::snprintf(rawBuffer, 
-                                  sizeof(rawBuffer), 
-                                  "t:lights;g:%03d;s:%s;", 
-                                  MY_LIGHT_CONTROL_GROUP, 
-                                  (g_UserLEDState ? "1" : "0")) + 1;
+    auto result = IOResult_t::FAILED;
     
-    MBED_ASSERT(lengthWritten > 0);
-    MBED_ASSERT(lengthWritten < sizeof(rawBuffer));
+    // Only TCP is a byte stream. Every UDP and NIDD datagram is delivered
+    // whole, so nothing is ever carried over from one to the next.
+    const bool isStream = (m_TheTransportSocketType == TransportSocket_t::TCP);
+    if (!isStream)
+    {
+        m_ReceiveFramer.Clear();
+    }
     
-    //printf("After MBED_ASSERT on lengthWritten. lengthWritten = %d\n%s\r\n", lengthWritten, rawBuffer);
-
-    if (m_TheTransportSocketType != TransportSocket_t::UDP)
-    {        
-        nsapi_size_or_error_t rc = m_pTheSocket->send(rawBuffer, lengthWritten);
+    // recv() straight into the reassembly ring; no intermediate copy.
+    auto writable = m_ReceiveFramer.WritableSpan();
+    char * pReceived = writable.data();
+    nsapi_size_or_error_t rc = ReceiveRaw(pReceived, writable.size());
+    
+    if (rc > 0)
+    {
+        g_DeferredLog.Record(LightControl::LogPoint_t::RECEIVED, rc);
         
-        if (rc < 0)
+        // Some data received of length rc so it is reasonable to
+        // presume that the socket is still functioning properly. Whether
+        // we carry on is then down to the messages themselves.
+        m_ReceiveFramer.Commit(rc);
+        m_LastProgressTime = Kernel::Clock::now();
+        result = ConsumeReceivedMessages(isStream);
+    }
+    else if ((rc == NSAPI_ERROR_WOULD_BLOCK) && (m_IsNonBlocking || m_IsReliable))
+    {
+        // For a blocking receive, that a retransmission deadline has passed.
+        result = IOResult_t::WOULD_BLOCK;
+    }
+    else if (rc < 0)
+    {
+        // A blocking receive only ever would block once it has timed out.
+        if (rc == NSAPI_ERROR_WOULD_BLOCK)
         {
-            printf("Error! Connection-oriented Socket->send() to EchoServer returned:\
-                [%d] -> %s\n", rc, ToString(rc).c_str());
+            OnReplyTimeout();
         }
         else
         {
-            result = true;
+            ++m_Statistics.m_ReceiveFailures;
         }
+        RecordFlight(LightControl::LogPoint_t::SOCKET_ERROR, 
+            static_cast<int>(LightControl::SocketOperation_t::RECEIVE), rc);
+        printf("Error! Socket receive returned:\
+            [%d] -> %s\n", rc, ToString(rc));
     }
     else
     {
-        nsapi_size_or_error_t rc = dynamic_cast<UDPSocket *>(m_pTheSocket)->sendto(m_TheSocketAddress, rawBuffer, lengthWritten);
+        ++m_Statistics.m_ReceiveFailures;
+        RecordFlight(LightControl::LogPoint_t::SOCKET_ERROR, 
+            static_cast<int>(LightControl::SocketOperation_t::RECEIVE), rc);
+        printf("Error! Socket receive indicated :\n\t\
+            \"No data available to be received and the peer has \
+            performed an orderly shutdown.\"\n");
+    }
+    
+    return result;
+}
+
+LEDLightControl::IOResult_t LEDLightControl::ConsumeReceivedMessages(bool isStream)
+{
+    auto result = IOResult_t::COMPLETED;
+    
+    if (isStream)
+    {
+        // Pull every complete message out of what has been received so far;
+        // a partial one at the end stays in the ring for the next recv().
+        std::string_view frame;
+        auto status = LightControl::FrameStatus_t::FRAME;
         
-        if (rc < 0)
+        while ((result == IOResult_t::COMPLETED)
+            && ((status = m_ReceiveFramer.Peek(frame)) == LightControl::FrameStatus_t::FRAME))
         {
-            printf("Error! UDPSocket->sendto() to EchoServer returned:\
-                [%d] -> %s\n", rc, ToString(rc).c_str());
+            result = ConsumeReceivedMessage(frame).first;
+            m_ReceiveFramer.Consume(frame.size());
         }
-        else
+        
+        if (status == LightControl::FrameStatus_t::OVERSIZED)
         {
-            result = true;
+            printf("Error! No LightControl message found in %u received bytes.\r\n", 
+                static_cast<unsigned>(m_ReceiveFramer.Size()));
+            result = IOResult_t::FAILED;
+        }
+    }
+    else
+    {
+        // A datagram is delivered whole, so it is parsed as is.
+        std::string_view pending = m_ReceiveFramer.ReadableView();
+        
+        while ((result == IOResult_t::COMPLETED) && !pending.empty())
+        {
+            // Text message NUL terminators carry no information of their own.
+            if (pending.front() == '\0')
+            {
+                pending.remove_prefix(1);
+                continue;
+            }
+            
+            std::size_t consumed;
+            std::tie(result, consumed) = ConsumeReceivedMessage(pending);
+            pending.remove_prefix(consumed);
         }
     }
     
+    if (result != IOResult_t::COMPLETED)
+    {
+        m_ReceiveFramer.Clear();
+    }
+    
     return result;
 }
 
-bool LEDLightControl::Receive()
+std::pair<LEDLightControl::IOResult_t, std::size_t> 
+LEDLightControl::ConsumeReceivedMessage(std::string_view message)
 {
-    //printf("Running LEDLightControl::Receive() ... \r\n");
+    // The peer's answer to a negotiation that has since timed out and
+    // fallen back to text; no LightControl message, but no fault either.
+    if (LightControl::ParseNegotiation(message))
+    {
+        ++m_Statistics.m_LateNegotiationReplies;
+        return {IOResult_t::COMPLETED, std::min(message.find('\0'), message.size())};
+    }
     
-    auto result = false;
-    char receiveBuffer[STANDARD_BUFFER_SIZE];
+    const auto parsed = ParseAndConsumeLightControlMessage(message);
+    if (!parsed)
+    {
+        return {IOResult_t::FAILED, 0};
+    }
+    
+    if (!RetireInFlightMessage(parsed.m_Message) && !IsDuplicateReply(parsed.m_Message.m_Sequence))
+    {
+        ++m_Statistics.m_UnmatchedReplies;
+        g_DeferredLog.Record(LightControl::LogPoint_t::UNMATCHED_REPLY);
+    }
+    
+    return {IOResult_t::COMPLETED, parsed.m_Consumed};
+}
+
+bool LEDLightControl::RetireInFlightMessage(const LightControl::Message_t & reply)
+{
+    if (m_InFlightCount == 0)
+    {
+        return false;
+    }
+    
+    // Replies without a sequence number (lock-step) retire the oldest.
+    const uint8_t retiring = reply.m_Sequence.value_or(static_cast<uint8_t>(m_NextSequence - m_InFlightCount));
+    
+    if (!m_OutstandingSequences.test(retiring))
+    {
+        return false;
+    }
+    
+    m_OutstandingSequences.reset(retiring);
+    --m_InFlightCount;
+    
+    if (m_IsReliable)
+    {
+        [[maybe_unused]] auto acknowledged = m_Reliability.OnReply(retiring, Uptime());
+    }
+    
+    const auto now = static_cast<uint64_t>(HighResClock::now().time_since_epoch().count());
+    const auto roundTrip = static_cast<uint32_t>(now) - m_SendTimesMicroseconds[retiring];
+    m_Statistics.m_RoundTripTime.Record(roundTrip);
+    
+    // Stamped by the controller on its way back; see ClockSync.h.
+    if (reply.m_ControllerTime && (*reply.m_ControllerTime != LightControl::CONTROLLER_TIME_REQUEST))
+    {
+        m_ClockOffset.OnExchange(now, roundTrip, *reply.m_ControllerTime);
+    }
+    return true;
+}
 
-    memset(receiveBuffer, 0, sizeof(receiveBuffer));
+void LEDLightControl::RecordTimeToFirstMessage()
+{
+    const auto now = Kernel::Clock::now();
+    
+    m_Statistics.m_ConnectToFirstMessageMilliseconds = static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(now - *m_ConnectStartTime).count());
+    
+    if (m_Statistics.m_Connections == 1)
+    {
+        m_Statistics.m_BootToFirstMessageMilliseconds = static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count());
+    }
     
-    if (m_TheTransportSocketType != TransportSocket_t::UDP)
+    if (m_LinkLossTime)
     {
-        nsapi_size_or_error_t rc = m_pTheSocket->recv(receiveBuffer, 
-                                                    sizeof(receiveBuffer) - 1);
+        const auto recovery = static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(now - *m_LinkLossTime).count());
         
+        ++m_Statistics.m_Recoveries;
+        m_Statistics.m_RecoveryMillisecondsTotal += recovery;
+        m_Statistics.m_RecoveryMillisecondsMaximum = std::max(m_Statistics.m_RecoveryMillisecondsMaximum, recovery);
+        m_LinkLossTime.reset();
+    }
+    
+    // The connection has proven itself; the next loss starts afresh.
+    m_ReconnectBackoff.Reset();
+    m_ConnectStartTime.reset();
+}
+
+LightControl::ParseResult_t LEDLightControl::ParseAndConsumeLightControlMessage(std::string_view message)
+{    
+    //printf("Running LEDLightControl::ParseAndConsumeLightControlMessage() ... \r\n");
+    
+    // Parsed in place, straight from the receive buffer. No std::string
+    // is constructed, hence no heap allocation on the event-queue thread.
+    auto result = LightControl::Decode(message);
+    
+    if (!result)
+    {
+        ++m_Statistics.m_ParseFailures[static_cast<std::size_t>(result.m_Error)];
+        g_DeferredLog.Record(LightControl::LogPoint_t::PARSE_FAILED, 
+            static_cast<int>(result.m_Error));
+        RecordFlight(LightControl::LogPoint_t::PARSE_FAILED, static_cast<int>(result.m_Error));
+    }
+    else if (!m_SubscribedGroups.Accepts(result.m_Message.m_Group))
+    {
+        result.m_Error = LightControl::ParseError_t::GROUP_NOT_SUBSCRIBED;
+        ++m_Statistics.m_ParseFailures[static_cast<std::size_t>(result.m_Error)];
         
-        if (rc > 0)
-        {
-            // Some data received of length rc so it is reasonable to
-            // presume that the socket is still functioning properly.
-            result = true;
-                        
-            std::string s(receiveBuffer, rc);
-            std::string delimiter = ";";
-            
-            printf("Success! m_pTheSocket->recv() returned:\
-                [%d] -> %s\n", rc, s.c_str());
-                        
-            result = ParseAndConsumeLightControlMessage(s, delimiter);
-        }
-        else if (rc < 0)
-        {
-            printf("Error! m_pTheSocket->recv() returned:\
-                [%d] -> %s\n", rc, ToString(rc).c_str());
-        }
-        else
-        {
-            printf("Error! m_pTheSocket->recv() indicated :\n\t\
-                \"No data available to be received and the peer has \
-                performed an orderly shutdown.\"\n");
-        }
+        g_DeferredLog.Record(LightControl::LogPoint_t::GROUP_NOT_SUBSCRIBED, 
+            result.m_Message.m_Group, m_SubscribedGroups.Count());
+    }
+    else if (IsDuplicateReply(result.m_Message.m_Sequence))
+    {
+        // Acted upon once already. A retransmission's second reply, or the
+        // network's own duplicate, might otherwise roll the lights back.
+        ++m_Statistics.m_DuplicateReplies;
+        g_DeferredLog.Record(LightControl::LogPoint_t::DUPLICATE_REPLY, 
+            static_cast<int>(*result.m_Message.m_Sequence));
     }
     else
     {
-        nsapi_size_or_error_t rc = dynamic_cast<UDPSocket *>(m_pTheSocket)->recvfrom(&m_TheSocketAddress, 
-                                                        receiveBuffer, 
-                                                        sizeof(receiveBuffer) - 1);
-        
-        if (rc > 0)
-        {
-            // Some data received of length rc so it is reasonable to
-            // presume that the socket is still functioning properly.
-            result = true;
-                        
-            std::string s(receiveBuffer, rc);
-            std::string delimiter = ";";
-                        
-            printf("Success! m_pTheSocket->recvfrom() returned:\
-                [%d] -> %s\n", rc, s.c_str());
-                        
-            result = ParseAndConsumeLightControlMessage(s, delimiter);
-        }
-        else if (rc < 0)
+        ++m_Statistics.m_MessagesReceived;
+        if (m_ConnectStartTime)
         {
-            printf("Error! m_pTheSocket->recvfrom() returned:\
-                [%d] -> %s\n", rc, ToString(rc).c_str());
+            RecordTimeToFirstMessage();
         }
-        else
+        const auto writes = ExecuteLightControl(result.m_Message);
+        if (writes)
         {
-            printf("Error! m_pTheSocket->recvfrom() indicated :\n\t\
-                \"No data available to be received and the peer has \
-                performed an orderly shutdown.\"\n");
+            g_DeferredLog.Record(LightControl::LogPoint_t::LIGHTS_SWITCHED, 
+                result.m_Message.m_Group, result.m_Message.m_State, *writes);
         }
     }
     
     return result;
 }
 
-bool LEDLightControl::ParseAndConsumeLightControlMessage(std::string& s, 
-                                           const std::string& delimiter)
-{    
-    //printf("Running LEDLightControl::ParseAndConsumeLightControlMessage() ... \r\n");
+std::optional<std::size_t> LEDLightControl::ExecuteLightControl(const LightControl::Message_t & command)
+{
+    const ScheduledCommand_t channels{m_LightOutputs.Channels(command.m_Group, m_SubscribedGroups),
+        PwmChannels(command.m_Group), command.m_State, 
+        command.m_Level.value_or(command.m_State ? LightControl::MAXIMUM_LEVEL : 0),
+        FadeSteps(command.m_TransitionMilliseconds)};
     
-    auto result = true;
-    size_t pos = 0;
-    std::string token;
-    if ((pos = s.find(delimiter)) != std::string::npos)
+    if (command.m_ExecuteAt)
     {
-        token = s.substr(0, pos);
-        if (!token.compare("t:lights"))
+        const auto now = static_cast<uint64_t>(HighResClock::now().time_since_epoch().count());
+        const auto due = m_ClockOffset.LocalTimeOf(*command.m_ExecuteAt);
+        
+        if (due && (*due <= now))
         {
-            s.erase(0, pos + delimiter.length());
-            
-            if ((pos = s.find(delimiter)) != std::string::npos)
+            // Overdue already; the sooner the better.
+            ++m_Statistics.m_LateCommands;
+        }
+        else if (due && ((*due - now) <= (static_cast<uint64_t>(MAXIMUM_EXECUTE_AHEAD_MILLISECONDS) * 1000)))
+        {
+            CriticalSectionLock lock;
+            if (m_ExecutionSchedule.Insert(*due, channels))
             {
-                token = s.substr(0, pos);
-                if (!token.compare("g:001")) // MY_LIGHT_CONTROL_GROUP
+                if (m_ExecutionSchedule.EarliestDue() == *due)
                 {
-                    s.erase(0, pos + delimiter.length());
-                    
-                    if ((pos = s.find(delimiter)) != std::string::npos)
-                    {
-                        token = s.substr(0, pos);
-                        if (!token.compare("s:0"))
-                        {
-                            printf("Successfully parsed LightControl message. Turning LED OFF ... \r\n");
-                            g_UserLED = LED_OFF;
-                        }
-                        else if (!token.compare("s:1"))
-                        {
-                            printf("Successfully parsed LightControl message. Turning LED ON ... \r\n");
-                            g_UserLED = LED_ON;
-                        }
-                        else
-                        {
-                            printf("Error! \"s:<1|0>\" comparison failed. \
-                                We rather parsed: \"%s\"\r\n", token.c_str());
-                            result = false;
-                        }
-                    }
-                    else
-                    {
-                        printf("Error! 3rd occurrence of LightControl \
-                            message delimiter parsing failed.\r\n");
-                        result = false;
-                    }
-                }
-                else
-                {
-                    printf("Error! \"g:001\" comparison failed. \
-                        We rather parsed: \"%s\"\r\n", token.c_str());
-                    result = false;
+                    ArmExecutionTimeout(now);
                 }
+                ++m_Statistics.m_ScheduledCommands;
+                g_DeferredLog.Record(LightControl::LogPoint_t::COMMAND_SCHEDULED, command.m_Group, 
+                    command.m_State, static_cast<int>((*due - now) / 1000));
+                return std::nullopt;
             }
-            else
-            {
-                printf("Error! 2nd occurrence of LightControl \
-                    message delimiter parsing failed.\r\n");
-                result = false;
-            }
+            ++m_Statistics.m_UnscheduledCommands;
         }
         else
         {
-            printf("Error! \"t:lights\" comparison failed. \
-                We rather parsed: \"%s\"\r\n", token.c_str());
-            result = false;
+            ++m_Statistics.m_UnscheduledCommands;
         }
     }
-    else
+    
+    // The timer ISRs may be writing the very same ports otherwise.
+    CriticalSectionLock lock;
+    return ApplyLightControl(channels);
+}
+
+void LEDLightControl::ArmExecutionTimeout(uint64_t nowMicroseconds)
+{
+    const auto due = m_ExecutionSchedule.EarliestDue();
+    if (due)
+    {
+        m_ExecutionTimeout.attach(callback(this, &LEDLightControl::OnExecutionTimeout), 
+            std::chrono::microseconds((*due > nowMicroseconds) ? (*due - nowMicroseconds) : 0));
+    }
+}
+
+void LEDLightControl::OnExecutionTimeout()
+{
+    // Interrupt context: no printf, no mutexes and no deferred log, just
+    // the port writes and a plain counter.
+    const auto now = static_cast<uint64_t>(HighResClock::now().time_since_epoch().count());
+    
+    while (const auto entry = m_ExecutionSchedule.PopDue(now))
     {
-        printf("Error! 1st occurrence of LightControl \
-            message delimiter parsing failed.\r\n");
-        result = false;
+        ApplyLightControl(entry->m_Payload);
+        m_Statistics.m_ExecutionLatenessMaximumMicroseconds = std::max(
+            m_Statistics.m_ExecutionLatenessMaximumMicroseconds, 
+            static_cast<uint32_t>(now - entry->m_DueMicroseconds));
     }
     
-    return result;
+    ArmExecutionTimeout(now);
+}
+
+std::size_t LEDLightControl::ApplyLightControl(const ScheduledCommand_t & command)
+{
+    // All switched channels of the group, or of every subscribed group for
+    // a master group broadcast, switch together in one write per port.
+    auto writes = m_LightOutputs.Apply(command.m_Channels, command.m_State);
+    if (command.m_PwmChannels == 0)
+    {
+        return writes;
+    }
+    
+    const bool wasFading = m_Fades.IsActive();
+    writes += m_Fades.Start(command.m_PwmChannels, command.m_Level, command.m_FadeSteps, 
+        [this](std::size_t channel, uint16_t duty) { WritePwm(channel, duty); });
+    if (command.m_FadeSteps > 0)
+    {
+        ++m_Statistics.m_FadesStarted;
+    }
+    
+    // One timer for every fade under way; stepping them costs no CPU at
+    // all in between, and none once they are all done.
+    if (!wasFading && m_Fades.IsActive())
+    {
+        m_FadeTimeout.attach(callback(this, &LEDLightControl::OnFadeStep), FADE_STEP);
+    }
+    return writes;
+}
+
+uint32_t LEDLightControl::PwmChannels(uint16_t group) const
+{
+    const bool isBroadcast = m_SubscribedGroups.IsBroadcast(group);
+    uint32_t channels = 0;
+    for (std::size_t channel = 0; channel < m_PwmChannelCount; ++channel)
+    {
+        if (isBroadcast ? m_SubscribedGroups.IsSubscribed(m_PwmGroups[channel]) : (m_PwmGroups[channel] == group))
+        {
+            channels |= (1u << channel);
+        }
+    }
+    return channels;
+}
+
+void LEDLightControl::WritePwm(std::size_t channel, uint16_t duty)
+{
+    m_PwmOutputs[channel]->write(static_cast<float>(duty) / static_cast<float>(LightControl::MAXIMUM_DUTY));
+}
+
+void LEDLightControl::OnFadeStep()
+{
+    // Interrupt context, as for OnExecutionTimeout().
+    m_Fades.Step([this](std::size_t channel, uint16_t duty) { WritePwm(channel, duty); });
+    ++m_Statistics.m_FadeSteps;
+    
+    if (m_Fades.IsActive())
+    {
+        m_FadeTimeout.attach(callback(this, &LEDLightControl::OnFadeStep), FADE_STEP);
+    }
 }
 
 // Create a user allocated event to be later bound:
@@ -743,6 +3112,16 @@ void NetworkStatusCallback(nsapi_event_t statusEvent, intptr_t parameterPointerD
     // is needed, and if it is here, will it negatively affect the "workings"
     // of the Cellular network.
     //assert(statusEvent == NSAPI_EVENT_CONNECTION_STATUS_CHANGE);
+    
+    if (statusEvent == NSAPI_EVENT_CONNECTION_STATUS_CHANGE)
+    {
+        RecordFlight(LightControl::LogPoint_t::NETWORK_STATUS, static_cast<int>(parameterPointerData));
+    }
+    else if ((statusEvent >= NSAPI_EVENT_CELLULAR_STATUS_BASE) && (statusEvent <= NSAPI_EVENT_CELLULAR_STATUS_END))
+    {
+        RecordFlight(LightControl::LogPoint_t::CELLULAR_EVENT, static_cast<int>(statusEvent), 
+            static_cast<int>(reinterpret_cast<cell_callback_data_t *>(parameterPointerData)->error));
+    }
 
     switch (parameterPointerData)
     {
@@ -782,7 +3161,11 @@ void NetworkStatusCallback(nsapi_event_t statusEvent, intptr_t parameterPointerD
             g_IsConnected = false;
             g_STDIOMutex.unlock();
             
-            //tr_debug("Network Status Event Callback: %d, \t\r\nparameterPointerData: %d", \
+            // Have the interface brought back up, after backing off.
+            g_pSharedEventQueue->call(g_pLEDLightControlManager, 
+                                       &LEDLightControl::OnLinkLost);
+            
+            //tr_debug("Network Status Event Callback: %d, \t\r\nparameterPointerData: %d",
             //    statusEvent, parameterPointerData);
                 
             if (statusEvent == NSAPI_EVENT_CONNECTION_STATUS_CHANGE) //&& parameterPointerData == NSAPI_STATUS_DISCONNECTED)
@@ -812,8 +3195,9 @@ void NetworkStatusCallback(nsapi_event_t statusEvent, intptr_t parameterPointerD
             {
                 cell_callback_data_t *ptr_data = (cell_callback_data_t *)parameterPointerData;
                 
-                tr_debug("Network Status Event Callback: %d, \t\r\nptr_data->error: %d, \t\r\nptr_data->status_data: %d", \
-                    statusEvent, ptr_data->error, ptr_data->status_data);
+                tr_debug("Network Status Event Callback: %d -> %s, \t\r\nptr_data->error: %d -> %s, \t\r\nptr_data->status_data: %d %s", \
+                    statusEvent, CellularEventToString(statusEvent), ptr_data->error, ToString(ptr_data->error), 
+                    ptr_data->status_data, CellularStatusToString(statusEvent, ptr_data->status_data));
                 
                 cellular_connection_status_t cellEvent = static_cast<cellular_connection_status_t>(statusEvent);
                 
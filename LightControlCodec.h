@@ -0,0 +1,699 @@
+/***********************************************************************
+* @file      LightControlCodec.h
+*
+*    Allocation-free encoding and decoding of LightControl protocol
+*    messages, shared by the device (LEDLightControl.h) and any host-side
+*    tooling that needs to speak the same protocol.
+*
+*    LightControl protocol message format (text encoding):
+*
+*    t:lights;g:<group_id>;s:<1|0>;[q:<sequence>;][l:<level>;][d:<transition>;]
+*        [x:<execute at>;][c:<controller time>;]\0
+*
+*    The optional "q:" field only appears when messages are pipelined,
+*    so that replies can be matched back to their requests.
+*
+*    The optional "l:" field dims the group to a level, 000 to 255, on
+*    a perceptual scale; it must be 000 exactly when "s:0". Without it
+*    "s:1" is full brightness. The optional "d:" field, 00000 to 65535,
+*    is the time in milliseconds over which to fade there from wherever
+*    the lights are; without it they switch at once. See LightDimmer.h.
+*
+*    The optional "x:" and "c:" fields are timestamps on the controller's
+*    clock, in milliseconds modulo 2^32, always 10 digits. "x:" asks for
+*    the command to take effect at that time rather than on receipt. "c:"
+*    in a request asks the controller to stamp its reply, and in a reply
+*    is the controller's clock as it replied; see ClockSync.h. A peer
+*    that knows neither simply echoes "c:0000000000" back unchanged.
+*
+*    The parser below operates in place on the bytes handed to it by
+*    recv()/recvfrom(). It never allocates, never copies and validates
+*    the "t:", "g:" and "s:" fields in one single forward pass.
+*
+*    LightControl protocol message format (binary encoding):
+*
+*    byte 0 : 0xB0 | <message type>   (high nibble is the binary marker)
+*    byte 1 : <state:1><has sequence:1><has execute at:1><has controller time:1>
+*             <has level:1><has transition:1><group bits 9..8:2>
+*    byte 2 : <group bits 7..0>
+*    byte 3 : <sequence number>        (only present if flagged in byte 1)
+*    then   : <level:8>                (only present if flagged)
+*    then   : <transition:16>          (big-endian, only present if flagged)
+*    then   : <execute at:32>          (big-endian, only present if flagged)
+*    then   : <controller time:32>     (big-endian, only present if flagged)
+*
+*    The binary marker can never collide with the leading 't' of the text
+*    encoding, so a decoder can always tell the two apart from byte 0.
+*
+*    Which of the two encodings is used on a connection is negotiated at
+*    connect time with the text message "t:wire;f:<t|b>;". A peer that
+*    echoes (or answers with) "f:b" accepts binary; anything else, or no
+*    answer at all, leaves the connection on the text encoding.
+*
+* @brief
+*
+* @note    Deliberately free of any Mbed OS dependency so that it can be
+*          compiled and exercised on a Linux host just as well.
+*
+* @warning
+*
+* @author  Nuertey Odzeyem
+*
+* @date    May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace LightControl
+{
+    static constexpr uint16_t MAXIMUM_GROUP_ID{999}; // "g:%03d"
+
+    enum class WireFormat_t : uint8_t
+    {
+        TEXT,    // Human readable; always supported, hence the fallback.
+        BINARY   // 3 bytes, or 4 bytes with a sequence number.
+    };
+
+    enum class MessageType_t : uint8_t
+    {
+        LIGHTS = 0x0
+    };
+
+    static constexpr uint8_t  BINARY_MARKER_MASK{0xF0};
+    static constexpr uint8_t  BINARY_MARKER{0xB0};
+    static constexpr uint8_t  BINARY_STATE_FLAG{0x80};
+    static constexpr uint8_t  BINARY_SEQUENCE_FLAG{0x40};
+    static constexpr uint8_t  BINARY_EXECUTE_AT_FLAG{0x20};
+    static constexpr uint8_t  BINARY_CONTROLLER_TIME_FLAG{0x10};
+    static constexpr uint8_t  BINARY_LEVEL_FLAG{0x08};
+    static constexpr uint8_t  BINARY_TRANSITION_FLAG{0x04};
+    static constexpr uint8_t  BINARY_GROUP_HIGH_MASK{0x03};
+    static constexpr std::size_t BINARY_HEADER_SIZE{3};
+    static constexpr std::size_t BINARY_TIMESTAMP_SIZE{4};
+    static constexpr std::size_t BINARY_TRANSITION_SIZE{2};
+
+    // "t:lights;g:NNN;s:N;" plus the NUL terminator that has always been
+    // sent along with it, the optional "q:NNN;" sequence number field and
+    // the optional "l:NNN;" and "d:NNNNN;" dimming fields and the optional
+    // "x:NNNNNNNNNN;" and "c:NNNNNNNNNN;" timestamp fields.
+    static constexpr std::size_t TEXT_MESSAGE_SIZE{20};
+    static constexpr std::size_t TEXT_SEQUENCE_FIELD_SIZE{6};
+    static constexpr std::size_t TEXT_LEVEL_FIELD_SIZE{6};
+    static constexpr std::size_t TEXT_TRANSITION_FIELD_SIZE{8};
+    static constexpr std::size_t TEXT_TIMESTAMP_FIELD_SIZE{13};
+    static constexpr std::size_t MAXIMUM_ENCODED_SIZE{TEXT_MESSAGE_SIZE + TEXT_SEQUENCE_FIELD_SIZE 
+                                                    + TEXT_LEVEL_FIELD_SIZE + TEXT_TRANSITION_FIELD_SIZE
+                                                    + (2 * TEXT_TIMESTAMP_FIELD_SIZE)};
+
+    // "c:" in a request; never a controller's answer, see ClockSync.h.
+    static constexpr uint32_t CONTROLLER_TIME_REQUEST{0};
+
+    enum class ParseError_t : uint8_t
+    {
+        NONE,
+        TRUNCATED,             // Input ended before a complete message was seen.
+        TYPE_FIELD_INVALID,    // "t:lights;" not matched.
+        GROUP_FIELD_INVALID,   // "g:<3 decimal digits>;" not matched.
+        STATE_FIELD_INVALID,   // "s:<1|0>;" not matched.
+        SEQUENCE_FIELD_INVALID,// "q:<000-255>;" present but not matched.
+        GROUP_NOT_SUBSCRIBED,  // Well-formed, but not addressed to us. Set by the consumer, never by Parse().
+        TIMESTAMP_FIELD_INVALID,// "x:" or "c:<10 decimal digits>;" present but not matched, or out of range.
+        LEVEL_FIELD_INVALID,   // "l:<000-255>;" present but not matched, or at odds with "s:".
+        TRANSITION_FIELD_INVALID// "d:<00000-65535>;" present but not matched.
+    };
+
+    struct Message_t
+    {
+        uint16_t                m_Group{0};
+        bool                    m_State{false};
+        std::optional<uint8_t>  m_Sequence{std::nullopt}; // Only when pipelining.
+        std::optional<uint32_t> m_ExecuteAt{std::nullopt};      // Controller time, in ms.
+        std::optional<uint32_t> m_ControllerTime{std::nullopt}; // Only for clock synchronization.
+        std::optional<uint8_t>  m_Level{std::nullopt};          // Perceptual, 0 exactly when off.
+        std::optional<uint16_t> m_TransitionMilliseconds{std::nullopt}; // Fade time.
+    };
+
+    struct ParseResult_t
+    {
+        ParseError_t m_Error{ParseError_t::TRUNCATED};
+        Message_t    m_Message{};
+
+        // Number of bytes of the input that the message occupied. Only
+        // meaningful when m_Error == ParseError_t::NONE.
+        std::size_t  m_Consumed{0};
+
+        constexpr explicit operator bool() const noexcept
+        {
+            return (m_Error == ParseError_t::NONE);
+        }
+    };
+
+    constexpr const char * ToString(const ParseError_t & error) noexcept
+    {
+        switch (error)
+        {
+            case ParseError_t::NONE:                 return "\"no error\"";
+            case ParseError_t::TRUNCATED:            return "\"message truncated\"";
+            case ParseError_t::TYPE_FIELD_INVALID:   return "\"t:lights field invalid\"";
+            case ParseError_t::GROUP_FIELD_INVALID:  return "\"g:<group_id> field invalid\"";
+            case ParseError_t::STATE_FIELD_INVALID:  return "\"s:<1|0> field invalid\"";
+            case ParseError_t::SEQUENCE_FIELD_INVALID: return "\"q:<sequence> field invalid\"";
+            case ParseError_t::GROUP_NOT_SUBSCRIBED: return "\"group not subscribed\"";
+            case ParseError_t::TIMESTAMP_FIELD_INVALID: return "\"x: or c:<timestamp> field invalid\"";
+            case ParseError_t::LEVEL_FIELD_INVALID:  return "\"l:<level> field invalid\"";
+            case ParseError_t::TRANSITION_FIELD_INVALID: return "\"d:<transition> field invalid\"";
+        }
+        return "\"unknown LightControl parse error\"";
+    }
+
+    constexpr const char * ToString(const WireFormat_t & format) noexcept
+    {
+        return (format == WireFormat_t::BINARY) ? "\"binary\"" : "\"text\"";
+    }
+
+    constexpr bool IsBinaryEncoded(std::string_view input) noexcept
+    {
+        return (!input.empty() 
+            && ((static_cast<uint8_t>(input[0]) & BINARY_MARKER_MASK) == BINARY_MARKER));
+    }
+
+    constexpr std::size_t EncodedSize(WireFormat_t format, const Message_t & message) noexcept
+    {
+        const std::size_t timestamps = (message.m_ExecuteAt ? 1 : 0) + (message.m_ControllerTime ? 1 : 0);
+        if (format == WireFormat_t::BINARY)
+        {
+            return BINARY_HEADER_SIZE + (message.m_Sequence ? 1 : 0) + (message.m_Level ? 1 : 0)
+                 + (message.m_TransitionMilliseconds ? BINARY_TRANSITION_SIZE : 0)
+                 + (timestamps * BINARY_TIMESTAMP_SIZE);
+        }
+        return TEXT_MESSAGE_SIZE + (message.m_Sequence ? TEXT_SEQUENCE_FIELD_SIZE : 0) 
+             + (message.m_Level ? TEXT_LEVEL_FIELD_SIZE : 0)
+             + (message.m_TransitionMilliseconds ? TEXT_TRANSITION_FIELD_SIZE : 0)
+             + (timestamps * TEXT_TIMESTAMP_FIELD_SIZE);
+    }
+
+    // Encodes the message into the caller's buffer and returns the number
+    // of bytes to put on the wire, or 0 should the buffer be too small.
+    // Replaces snprintf("t:lights;g:%03d;s:%s;") on the send path.
+    constexpr std::size_t Encode(WireFormat_t format, const Message_t & message, 
+                                 std::span<char> output) noexcept
+    {
+        const auto length = EncodedSize(format, message);
+        if ((output.size() < length) || (message.m_Group > MAXIMUM_GROUP_ID))
+        {
+            return 0;
+        }
+
+        if (format == WireFormat_t::BINARY)
+        {
+            output[0] = static_cast<char>(BINARY_MARKER | static_cast<uint8_t>(MessageType_t::LIGHTS));
+            output[1] = static_cast<char>((message.m_State ? BINARY_STATE_FLAG : 0)
+                                        | (message.m_Sequence ? BINARY_SEQUENCE_FLAG : 0)
+                                        | (message.m_ExecuteAt ? BINARY_EXECUTE_AT_FLAG : 0)
+                                        | (message.m_ControllerTime ? BINARY_CONTROLLER_TIME_FLAG : 0)
+                                        | (message.m_Level ? BINARY_LEVEL_FLAG : 0)
+                                        | (message.m_TransitionMilliseconds ? BINARY_TRANSITION_FLAG : 0)
+                                        | ((message.m_Group >> 8) & BINARY_GROUP_HIGH_MASK));
+            output[2] = static_cast<char>(message.m_Group & 0xFF);
+            std::size_t pos = BINARY_HEADER_SIZE;
+            if (message.m_Sequence)
+            {
+                output[pos++] = static_cast<char>(*message.m_Sequence);
+            }
+            if (message.m_Level)
+            {
+                output[pos++] = static_cast<char>(*message.m_Level);
+            }
+            if (message.m_TransitionMilliseconds)
+            {
+                output[pos++] = static_cast<char>((*message.m_TransitionMilliseconds >> 8) & 0xFF);
+                output[pos++] = static_cast<char>(*message.m_TransitionMilliseconds & 0xFF);
+            }
+            for (const auto & timestamp : {message.m_ExecuteAt, message.m_ControllerTime})
+            {
+                if (timestamp)
+                {
+                    for (int shift = 24; shift >= 0; shift -= 8)
+                    {
+                        output[pos++] = static_cast<char>((*timestamp >> shift) & 0xFF);
+                    }
+                }
+            }
+        }
+        else
+        {
+            constexpr std::string_view prefix{"t:lights;g:"};
+            std::size_t pos = 0;
+            for (const char c : prefix)
+            {
+                output[pos++] = c;
+            }
+            output[pos++] = static_cast<char>('0' + (message.m_Group / 100));
+            output[pos++] = static_cast<char>('0' + ((message.m_Group / 10) % 10));
+            output[pos++] = static_cast<char>('0' + (message.m_Group % 10));
+            output[pos++] = ';';
+            output[pos++] = 's';
+            output[pos++] = ':';
+            output[pos++] = (message.m_State ? '1' : '0');
+            output[pos++] = ';';
+            // Zero padded to a fixed width, divisor being its leading place.
+            const auto field = [&](char key, uint32_t value, uint32_t divisor)
+            {
+                output[pos++] = key;
+                output[pos++] = ':';
+                for (; divisor > 0; divisor /= 10)
+                {
+                    output[pos++] = static_cast<char>('0' + ((value / divisor) % 10));
+                }
+                output[pos++] = ';';
+            };
+            if (message.m_Sequence)
+            {
+                field('q', *message.m_Sequence, 100);
+            }
+            if (message.m_Level)
+            {
+                field('l', *message.m_Level, 100);
+            }
+            if (message.m_TransitionMilliseconds)
+            {
+                field('d', *message.m_TransitionMilliseconds, 10000);
+            }
+            if (message.m_ExecuteAt)
+            {
+                field('x', *message.m_ExecuteAt, 1000000000);
+            }
+            if (message.m_ControllerTime)
+            {
+                field('c', *message.m_ControllerTime, 1000000000);
+            }
+            output[pos++] = '\0';
+        }
+        return length;
+    }
+
+    // Single forward pass over the input. Each byte is inspected exactly
+    // once. Running out of input is reported as TRUNCATED, as opposed to
+    // a field mismatch, so that a stream reassembler can tell "wait for
+    // more bytes" apart from "discard this garbage".
+    constexpr ParseResult_t Parse(std::string_view input) noexcept
+    {
+        ParseResult_t result;
+        std::size_t   pos = 0;
+
+        const auto expect = [&](std::string_view literal, ParseError_t onMismatch)
+        {
+            for (const char c : literal)
+            {
+                if (pos >= input.size())
+                {
+                    return ParseError_t::TRUNCATED;
+                }
+                if (input[pos] != c)
+                {
+                    return onMismatch;
+                }
+                ++pos;
+            }
+            return ParseError_t::NONE;
+        };
+
+        if ((result.m_Error = expect("t:lights;g:", ParseError_t::TYPE_FIELD_INVALID)) != ParseError_t::NONE)
+        {
+            // A mismatch on the "g:" key is attributed to the group field.
+            if ((result.m_Error == ParseError_t::TYPE_FIELD_INVALID) && (pos >= 9))
+            {
+                result.m_Error = ParseError_t::GROUP_FIELD_INVALID;
+            }
+            return result;
+        }
+
+        // Exactly 3 decimal digits, as per "%03d"; 5 for transitions and
+        // 10 for timestamps.
+        uint64_t value = 0;
+        const auto digits = [&](ParseError_t onMismatch, int count = 3)
+        {
+            value = 0;
+            for (int digit = 0; digit < count; ++digit, ++pos)
+            {
+                if (pos >= input.size())
+                {
+                    return ParseError_t::TRUNCATED;
+                }
+                if ((input[pos] < '0') || (input[pos] > '9'))
+                {
+                    return onMismatch;
+                }
+                value = (value * 10) + static_cast<uint64_t>(input[pos] - '0');
+            }
+            return ParseError_t::NONE;
+        };
+
+        if ((result.m_Error = digits(ParseError_t::GROUP_FIELD_INVALID)) != ParseError_t::NONE)
+        {
+            return result;
+        }
+        const auto group = static_cast<uint16_t>(value);
+
+        if ((result.m_Error = expect(";", ParseError_t::GROUP_FIELD_INVALID)) != ParseError_t::NONE)
+        {
+            return result;
+        }
+        if ((result.m_Error = expect("s:", ParseError_t::STATE_FIELD_INVALID)) != ParseError_t::NONE)
+        {
+            return result;
+        }
+
+        if (pos >= input.size())
+        {
+            result.m_Error = ParseError_t::TRUNCATED;
+            return result;
+        }
+        if ((input[pos] != '0') && (input[pos] != '1'))
+        {
+            result.m_Error = ParseError_t::STATE_FIELD_INVALID;
+            return result;
+        }
+        const bool state = (input[pos++] == '1');
+
+        if ((result.m_Error = expect(";", ParseError_t::STATE_FIELD_INVALID)) != ParseError_t::NONE)
+        {
+            return result;
+        }
+
+        // Optional sequence number field. Stream transports must hand over
+        // the whole NUL terminated message, else its absence is ambiguous.
+        if ((pos < input.size()) && (input[pos] == 'q'))
+        {
+            if (((result.m_Error = expect("q:", ParseError_t::SEQUENCE_FIELD_INVALID)) != ParseError_t::NONE)
+             || ((result.m_Error = digits(ParseError_t::SEQUENCE_FIELD_INVALID)) != ParseError_t::NONE)
+             || ((result.m_Error = expect(";", ParseError_t::SEQUENCE_FIELD_INVALID)) != ParseError_t::NONE))
+            {
+                return result;
+            }
+            if (value > UINT8_MAX)
+            {
+                result.m_Error = ParseError_t::SEQUENCE_FIELD_INVALID;
+                return result;
+            }
+            result.m_Message.m_Sequence = static_cast<uint8_t>(value);
+        }
+
+        // Optional dimming fields, likewise; "l:" always ahead of "d:".
+        if ((pos < input.size()) && (input[pos] == 'l'))
+        {
+            if (((result.m_Error = expect("l:", ParseError_t::LEVEL_FIELD_INVALID)) != ParseError_t::NONE)
+             || ((result.m_Error = digits(ParseError_t::LEVEL_FIELD_INVALID)) != ParseError_t::NONE)
+             || ((result.m_Error = expect(";", ParseError_t::LEVEL_FIELD_INVALID)) != ParseError_t::NONE))
+            {
+                return result;
+            }
+            if ((value > UINT8_MAX) || ((value > 0) != state))
+            {
+                result.m_Error = ParseError_t::LEVEL_FIELD_INVALID;
+                return result;
+            }
+            result.m_Message.m_Level = static_cast<uint8_t>(value);
+        }
+        if ((pos < input.size()) && (input[pos] == 'd'))
+        {
+            if (((result.m_Error = expect("d:", ParseError_t::TRANSITION_FIELD_INVALID)) != ParseError_t::NONE)
+             || ((result.m_Error = digits(ParseError_t::TRANSITION_FIELD_INVALID, 5)) != ParseError_t::NONE)
+             || ((result.m_Error = expect(";", ParseError_t::TRANSITION_FIELD_INVALID)) != ParseError_t::NONE))
+            {
+                return result;
+            }
+            if (value > UINT16_MAX)
+            {
+                result.m_Error = ParseError_t::TRANSITION_FIELD_INVALID;
+                return result;
+            }
+            result.m_Message.m_TransitionMilliseconds = static_cast<uint16_t>(value);
+        }
+
+        // Optional timestamp fields, likewise; "x:" always ahead of "c:".
+        const auto timestamp = [&](char key, std::optional<uint32_t> & field)
+        {
+            if ((pos >= input.size()) || (input[pos] != key))
+            {
+                return ParseError_t::NONE;
+            }
+            const char prefix[] = {key, ':'};
+            ParseError_t error;
+            if (((error = expect(std::string_view(prefix, 2), ParseError_t::TIMESTAMP_FIELD_INVALID)) != ParseError_t::NONE)
+             || ((error = digits(ParseError_t::TIMESTAMP_FIELD_INVALID, 10)) != ParseError_t::NONE)
+             || ((error = expect(";", ParseError_t::TIMESTAMP_FIELD_INVALID)) != ParseError_t::NONE))
+            {
+                return error;
+            }
+            if (value > UINT32_MAX)
+            {
+                return ParseError_t::TIMESTAMP_FIELD_INVALID;
+            }
+            field = static_cast<uint32_t>(value);
+            return ParseError_t::NONE;
+        };
+
+        if (((result.m_Error = timestamp('x', result.m_Message.m_ExecuteAt)) != ParseError_t::NONE)
+         || ((result.m_Error = timestamp('c', result.m_Message.m_ControllerTime)) != ParseError_t::NONE))
+        {
+            return result;
+        }
+
+        result.m_Message.m_Group = group;
+        result.m_Message.m_State = state;
+        result.m_Consumed        = pos;
+        return result;
+    }
+
+    constexpr ParseResult_t ParseBinary(std::string_view input) noexcept
+    {
+        ParseResult_t result;
+
+        if (input.size() < BINARY_HEADER_SIZE)
+        {
+            result.m_Error = ParseError_t::TRUNCATED;
+            return result;
+        }
+        
+        const auto type  = static_cast<uint8_t>(input[0]);
+        const auto flags = static_cast<uint8_t>(input[1]);
+        
+        if ((type & BINARY_MARKER_MASK) != BINARY_MARKER
+            || ((type & ~BINARY_MARKER_MASK) != static_cast<uint8_t>(MessageType_t::LIGHTS)))
+        {
+            result.m_Error = ParseError_t::TYPE_FIELD_INVALID;
+            return result;
+        }
+
+        const auto group = static_cast<uint16_t>(((flags & BINARY_GROUP_HIGH_MASK) << 8)
+                                                | static_cast<uint8_t>(input[2]));
+        if (group > MAXIMUM_GROUP_ID)
+        {
+            result.m_Error = ParseError_t::GROUP_FIELD_INVALID;
+            return result;
+        }
+
+        result.m_Consumed = BINARY_HEADER_SIZE;
+        if (flags & BINARY_SEQUENCE_FLAG)
+        {
+            if (input.size() <= BINARY_HEADER_SIZE)
+            {
+                result.m_Error = ParseError_t::TRUNCATED;
+                return result;
+            }
+            result.m_Message.m_Sequence = static_cast<uint8_t>(input[BINARY_HEADER_SIZE]);
+            ++result.m_Consumed;
+        }
+        if (flags & BINARY_LEVEL_FLAG)
+        {
+            if (input.size() <= result.m_Consumed)
+            {
+                result.m_Error = ParseError_t::TRUNCATED;
+                return result;
+            }
+            const auto level = static_cast<uint8_t>(input[result.m_Consumed++]);
+            if ((level > 0) != ((flags & BINARY_STATE_FLAG) != 0))
+            {
+                result.m_Error = ParseError_t::LEVEL_FIELD_INVALID;
+                return result;
+            }
+            result.m_Message.m_Level = level;
+        }
+        if (flags & BINARY_TRANSITION_FLAG)
+        {
+            if (input.size() < (result.m_Consumed + BINARY_TRANSITION_SIZE))
+            {
+                result.m_Error = ParseError_t::TRUNCATED;
+                return result;
+            }
+            result.m_Message.m_TransitionMilliseconds = static_cast<uint16_t>(
+                (static_cast<uint8_t>(input[result.m_Consumed]) << 8)
+                | static_cast<uint8_t>(input[result.m_Consumed + 1]));
+            result.m_Consumed += BINARY_TRANSITION_SIZE;
+        }
+
+        const auto timestamp = [&](uint8_t flag, std::optional<uint32_t> & field)
+        {
+            if (!(flags & flag))
+            {
+                return true;
+            }
+            if (input.size() < (result.m_Consumed + BINARY_TIMESTAMP_SIZE))
+            {
+                return false;
+            }
+            uint32_t value = 0;
+            for (std::size_t i = 0; i < BINARY_TIMESTAMP_SIZE; ++i)
+            {
+                value = (value << 8) | static_cast<uint8_t>(input[result.m_Consumed++]);
+            }
+            field = value;
+            return true;
+        };
+
+        if (!timestamp(BINARY_EXECUTE_AT_FLAG, result.m_Message.m_ExecuteAt)
+            || !timestamp(BINARY_CONTROLLER_TIME_FLAG, result.m_Message.m_ControllerTime))
+        {
+            result.m_Error = ParseError_t::TRUNCATED;
+            return result;
+        }
+
+        result.m_Message.m_Group = group;
+        result.m_Message.m_State = ((flags & BINARY_STATE_FLAG) != 0);
+        result.m_Error = ParseError_t::NONE;
+        return result;
+    }
+
+    // Decodes either encoding; the decision is made from byte 0 alone.
+    constexpr ParseResult_t Decode(std::string_view input) noexcept
+    {
+        return IsBinaryEncoded(input) ? ParseBinary(input) : Parse(input);
+    }
+
+    // Length of the first complete message at the head of a byte stream,
+    // terminator included, or 0 should more bytes be needed to tell. Text
+    // messages are delimited by their NUL terminator; binary messages by
+    // the length implied by their header.
+    constexpr std::size_t FrameLength(std::string_view stream) noexcept
+    {
+        if (IsBinaryEncoded(stream))
+        {
+            if (stream.size() < 2)
+            {
+                return 0;
+            }
+            const auto flags = static_cast<uint8_t>(stream[1]);
+            const auto length = BINARY_HEADER_SIZE + ((flags & BINARY_SEQUENCE_FLAG) ? 1 : 0)
+                + ((flags & BINARY_LEVEL_FLAG) ? 1 : 0)
+                + ((flags & BINARY_TRANSITION_FLAG) ? BINARY_TRANSITION_SIZE : 0)
+                + ((flags & BINARY_EXECUTE_AT_FLAG) ? BINARY_TIMESTAMP_SIZE : 0)
+                + ((flags & BINARY_CONTROLLER_TIME_FLAG) ? BINARY_TIMESTAMP_SIZE : 0);
+            return (stream.size() >= length) ? length : 0;
+        }
+        const auto terminator = stream.find('\0');
+        return (terminator == std::string_view::npos) ? 0 : (terminator + 1);
+    }
+
+    // Wire format negotiation, "t:wire;f:<t|b>;". Always sent as text.
+    static constexpr std::size_t NEGOTIATION_MESSAGE_SIZE{15};
+
+    constexpr std::size_t EncodeNegotiation(WireFormat_t format, std::span<char> output) noexcept
+    {
+        constexpr std::string_view prefix{"t:wire;f:"};
+        if (output.size() < NEGOTIATION_MESSAGE_SIZE)
+        {
+            return 0;
+        }
+        std::size_t pos = 0;
+        for (const char c : prefix)
+        {
+            output[pos++] = c;
+        }
+        output[pos++] = ((format == WireFormat_t::BINARY) ? 'b' : 't');
+        output[pos++] = ';';
+        output[pos++] = '\0';
+        return pos;
+    }
+
+    constexpr std::optional<WireFormat_t> ParseNegotiation(std::string_view input) noexcept
+    {
+        constexpr std::string_view prefix{"t:wire;f:"};
+        if ((input.size() < (prefix.size() + 2)) 
+            || (input.substr(0, prefix.size()) != prefix)
+            || (input[prefix.size() + 1] != ';'))
+        {
+            return std::nullopt;
+        }
+        switch (input[prefix.size()])
+        {
+            case 'b': return WireFormat_t::BINARY;
+            case 't': return WireFormat_t::TEXT;
+            default:  return std::nullopt;
+        }
+    }
+
+    // Compile-time sanity checks of the parser against the canonical messages.
+    static_assert(Parse("t:lights;g:001;s:1;").m_Message.m_State);
+    static_assert(Parse("t:lights;g:042;s:0;").m_Message.m_Group == 42);
+    static_assert(Parse("t:lights;g:001;s:0;").m_Consumed == 19);
+    static_assert(Parse("t:lights;g:00").m_Error == ParseError_t::TRUNCATED);
+    static_assert(Parse("t:lamps;g:001;s:1;").m_Error == ParseError_t::TYPE_FIELD_INVALID);
+    static_assert(Parse("t:lights;x:001;s:1;").m_Error == ParseError_t::GROUP_FIELD_INVALID);
+    static_assert(Parse("t:lights;g:0a1;s:1;").m_Error == ParseError_t::GROUP_FIELD_INVALID);
+    static_assert(Parse("t:lights;g:001;s:2;").m_Error == ParseError_t::STATE_FIELD_INVALID);
+    static_assert(Parse("t:lights;g:001;s:1;q:256;").m_Error == ParseError_t::SEQUENCE_FIELD_INVALID);
+    static_assert(Parse("t:lights;g:001;s:1;q:04").m_Error == ParseError_t::TRUNCATED);
+
+    // ... and of the encoders against the decoders, in both encodings.
+    constexpr bool RoundTrips(WireFormat_t format, Message_t message)
+    {
+        char buffer[MAXIMUM_ENCODED_SIZE]{};
+        const auto length = Encode(format, message, buffer);
+        const auto result = Decode(std::string_view(buffer, length));
+        return (length == EncodedSize(format, message)) && result
+            && (result.m_Message.m_Group == message.m_Group)
+            && (result.m_Message.m_State == message.m_State)
+            && (result.m_Message.m_Sequence == message.m_Sequence)
+            && (result.m_Message.m_ExecuteAt == message.m_ExecuteAt)
+            && (result.m_Message.m_ControllerTime == message.m_ControllerTime)
+            && (result.m_Message.m_Level == message.m_Level)
+            && (result.m_Message.m_TransitionMilliseconds == message.m_TransitionMilliseconds)
+            && (result.m_Consumed == (length - ((format == WireFormat_t::TEXT) ? 1 : 0)));
+    }
+    static_assert(RoundTrips(WireFormat_t::TEXT,   Message_t{1, true}));
+    static_assert(RoundTrips(WireFormat_t::TEXT,   Message_t{999, false}));
+    static_assert(RoundTrips(WireFormat_t::TEXT,   Message_t{7, true, 200}));
+    static_assert(RoundTrips(WireFormat_t::BINARY, Message_t{1, true}));
+    static_assert(RoundTrips(WireFormat_t::BINARY, Message_t{999, false, 255}));
+    static_assert(RoundTrips(WireFormat_t::TEXT,   Message_t{7, true, 200, 4294967295u, 0}));
+    static_assert(RoundTrips(WireFormat_t::TEXT,   Message_t{7, true, std::nullopt, std::nullopt, 123456789}));
+    static_assert(RoundTrips(WireFormat_t::BINARY, Message_t{999, false, 255, 4294967295u, 0x01020304}));
+    static_assert(RoundTrips(WireFormat_t::BINARY, Message_t{1, true, std::nullopt, 60000}));
+    static_assert(RoundTrips(WireFormat_t::TEXT,   Message_t{7, true, 200, 1000, std::nullopt, 128, 65535}));
+    static_assert(RoundTrips(WireFormat_t::TEXT,   Message_t{7, false, std::nullopt, std::nullopt, std::nullopt, 0, 2000}));
+    static_assert(RoundTrips(WireFormat_t::BINARY, Message_t{999, true, 255, 4294967295u, 0, 1, 0x0102}));
+    static_assert(RoundTrips(WireFormat_t::BINARY, Message_t{1, false, std::nullopt, std::nullopt, std::nullopt, std::nullopt, 2000}));
+    static_assert(EncodedSize(WireFormat_t::TEXT, Message_t{1, true, 1, 1, 1, 1, 1}) == MAXIMUM_ENCODED_SIZE);
+    static_assert(Parse("t:lights;g:001;s:0;l:010;").m_Error == ParseError_t::LEVEL_FIELD_INVALID);
+    static_assert(Parse("t:lights;g:001;s:1;l:256;").m_Error == ParseError_t::LEVEL_FIELD_INVALID);
+    static_assert(Parse("t:lights;g:001;s:1;d:65536;").m_Error == ParseError_t::TRANSITION_FIELD_INVALID);
+    static_assert(ParseBinary("\xB0\x08\x01\x10").m_Error == ParseError_t::LEVEL_FIELD_INVALID);
+    static_assert(Parse("t:lights;g:001;s:1;x:4294967296;").m_Error == ParseError_t::TIMESTAMP_FIELD_INVALID);
+    static_assert(Parse("t:lights;g:001;s:1;c:12345;").m_Error == ParseError_t::TIMESTAMP_FIELD_INVALID);
+    static_assert(EncodedSize(WireFormat_t::BINARY, Message_t{1, true}) == 3);
+    static_assert(EncodedSize(WireFormat_t::BINARY, Message_t{1, true, 7}) == 4);
+    static_assert(ParseNegotiation("t:wire;f:b;") == WireFormat_t::BINARY);
+    static_assert(FrameLength(std::string_view("t:lights;g:001;s:1;\0t:li", 24)) == 20);
+    static_assert(FrameLength("t:lights;g:001;s:1;") == 0);
+    static_assert(FrameLength("\xB0\x41\x01") == 0);
+    static_assert(FrameLength(std::string_view("\xB0\x30\x01\0\0\0\0\0\0\0", 11)) == 11);
+    static_assert(FrameLength(std::string_view("\xB0\x8C\x01\x80\0\x10", 6)) == 6);
+} // end of namespace
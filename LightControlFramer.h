@@ -0,0 +1,209 @@
+/***********************************************************************
+* @file      LightControlFramer.h
+*
+*    Reassembly of LightControl messages from a TCP byte stream.
+*
+*    TCP preserves no message boundaries: under load one recv() may hand
+*    over several coalesced messages, and a message may just as well be
+*    split across two or more recv() calls. StreamFramer is a fixed-size
+*    ring buffer that recv() writes into directly, and out of which every
+*    complete message is then pulled, in place, by the same framing rules
+*    as LightControl::FrameLength(). Only a message that happens to wrap
+*    around the end of the ring is copied, once, into a small scratch
+*    area so that it can be handed to the parser contiguously.
+*
+* @brief
+*
+* @note    Deliberately free of any Mbed OS dependency so that it can be
+*          compiled and exercised on a Linux host just as well.
+*
+* @warning Not thread-safe; owned by whichever context calls recv().
+*
+* @author  Nuertey Odzeyem
+*
+* @date    May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <algorithm>
+
+#include "LightControlCodec.h"
+
+namespace LightControl
+{
+    enum class FrameStatus_t : uint8_t
+    {
+        FRAME,     // A complete message is available.
+        NEED_MORE, // Only (part of) a message is buffered; recv() again.
+        OVERSIZED  // More bytes than any valid message, yet no message.
+    };
+
+    template <std::size_t CAPACITY>
+    class StreamFramer
+    {
+        static_assert((CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of 2.");
+        static_assert(CAPACITY >= (2 * MAXIMUM_ENCODED_SIZE), "CAPACITY must hold at least 2 messages.");
+
+        static constexpr std::size_t MASK{CAPACITY - 1};
+
+    public:
+        constexpr std::size_t Size() const noexcept { return (m_Tail - m_Head); }
+        constexpr std::size_t Free() const noexcept { return (CAPACITY - Size()); }
+
+        constexpr void Clear() noexcept
+        {
+            m_Head = 0;
+            m_Tail = 0;
+        }
+
+        // Largest contiguous free region, for recv() to write into directly.
+        constexpr std::span<char> WritableSpan() noexcept
+        {
+            const auto start = (m_Tail & MASK);
+            return std::span<char>(m_Buffer + start, std::min(Free(), CAPACITY - start));
+        }
+
+        // Accounts for the bytes recv() has just written into WritableSpan().
+        constexpr void Commit(std::size_t count) noexcept
+        {
+            m_Tail += count;
+        }
+
+        // Copies bytes in, for when they have already been received elsewhere.
+        constexpr std::size_t Write(std::string_view bytes) noexcept
+        {
+            std::size_t written = 0;
+            while (written < bytes.size())
+            {
+                auto span = WritableSpan();
+                if (span.empty())
+                {
+                    break;
+                }
+                const auto count = std::min(span.size(), bytes.size() - written);
+                std::copy_n(bytes.data() + written, count, span.data());
+                Commit(count);
+                written += count;
+            }
+            return written;
+        }
+
+        // Largest contiguous buffered region, i.e. up to the end of the ring.
+        constexpr std::string_view ReadableView() const noexcept
+        {
+            const auto start = (m_Head & MASK);
+            return std::string_view(m_Buffer + start, std::min(Size(), CAPACITY - start));
+        }
+
+        // Looks at, without consuming, the next complete message. The view
+        // stays valid until the next call to Peek(), Consume() or Commit().
+        constexpr FrameStatus_t Peek(std::string_view & frame) noexcept
+        {
+            // Text message NUL terminators carry no information of their own.
+            while ((Size() > 0) && (m_Buffer[m_Head & MASK] == '\0'))
+            {
+                Consume(1);
+            }
+
+            auto head = ReadableView();
+            auto length = FrameLength(head);
+
+            if ((length == 0) && (head.size() < Size()))
+            {
+                // The message may wrap around the end of the ring.
+                const auto count = std::min(Size(), sizeof(m_Scratch));
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    m_Scratch[i] = m_Buffer[(m_Head + i) & MASK];
+                }
+                head = std::string_view(m_Scratch, count);
+                length = FrameLength(head);
+            }
+
+            if (length > 0)
+            {
+                frame = head.substr(0, length);
+                return FrameStatus_t::FRAME;
+            }
+
+            return (Size() >= MAXIMUM_ENCODED_SIZE) ? FrameStatus_t::OVERSIZED
+                                                    : FrameStatus_t::NEED_MORE;
+        }
+
+        constexpr void Consume(std::size_t count) noexcept
+        {
+            m_Head += std::min(count, Size());
+
+            // Once empty, rewind, so that the next recv() gets the whole
+            // ring as one contiguous region and can drain many messages.
+            if (m_Head == m_Tail)
+            {
+                Clear();
+            }
+        }
+
+    private:
+        char        m_Buffer[CAPACITY]{};
+        char        m_Scratch[MAXIMUM_ENCODED_SIZE]{};
+        std::size_t m_Head{0};
+        std::size_t m_Tail{0};
+    };
+
+    // Compile-time check that a stream of mixed text and binary messages,
+    // cut into pseudo-randomly sized chunks (splitting some messages and
+    // coalescing others, and wrapping around a deliberately small ring),
+    // is reassembled without the loss, duplication or reordering of any.
+    constexpr bool ReassemblesArbitrarilySplitStream(uint32_t seed)
+    {
+        constexpr std::size_t MESSAGE_COUNT{64};
+
+        char stream[MESSAGE_COUNT * MAXIMUM_ENCODED_SIZE]{};
+        std::size_t streamLength = 0;
+        for (std::size_t i = 0; i < MESSAGE_COUNT; ++i)
+        {
+            const auto format = ((i % 3) == 0) ? WireFormat_t::BINARY : WireFormat_t::TEXT;
+            Message_t message{static_cast<uint16_t>(i * 7), (i % 2) == 0, static_cast<uint8_t>(i)};
+            if ((i % 5) == 0)
+            {
+                message.m_ExecuteAt = static_cast<uint32_t>(i * 1000003u);
+            }
+            streamLength += Encode(format, message, std::span<char>(stream + streamLength, MAXIMUM_ENCODED_SIZE));
+        }
+
+        StreamFramer<2 * 128> framer;
+        std::size_t fed = 0;
+        std::size_t expected = 0;
+        uint32_t random = seed;
+
+        while (fed < streamLength)
+        {
+            random = (random * 1664525u) + 1013904223u;
+            const auto chunk = std::min<std::size_t>(1 + (random >> 27), streamLength - fed);
+            fed += framer.Write(std::string_view(stream + fed, chunk));
+
+            std::string_view frame;
+            FrameStatus_t status;
+            while ((status = framer.Peek(frame)) == FrameStatus_t::FRAME)
+            {
+                const auto result = Decode(frame);
+                if (!result || (result.m_Message.m_Sequence != static_cast<uint8_t>(expected))
+                            || (result.m_Message.m_Group != (expected * 7)))
+                {
+                    return false;
+                }
+                ++expected;
+                framer.Consume(frame.size());
+            }
+            if (status == FrameStatus_t::OVERSIZED)
+            {
+                return false;
+            }
+        }
+        return (expected == MESSAGE_COUNT) && (framer.Size() == 0);
+    }
+
+    static_assert(ReassemblesArbitrarilySplitStream(1));
+    static_assert(ReassemblesArbitrarilySplitStream(0xC0FFEE));
+} // end of namespace
@@ -0,0 +1,108 @@
+/***********************************************************************
+* @file      LightControlGroups.h
+*
+*    Runtime LightControl group membership.
+*
+*    A controller installed across several zones belongs to several
+*    LightControl groups at once. Membership is kept as one bit per group
+*    over the whole 000-999 range of the protocol, so that deciding
+*    whether a received message is addressed to us is a single bit test,
+*    no matter whether we belong to 1 group or to 500 of them.
+*
+*    Group 000, the master group, is a broadcast: every controller obeys
+*    it, on behalf of every group it is subscribed to, without having to
+*    subscribe to it explicitly.
+*
+* @brief
+*
+* @note    Deliberately free of any Mbed OS dependency so that it can be
+*          compiled and exercised on a Linux host just as well.
+*
+* @warning Not thread-safe; owned by whichever context consumes messages.
+*
+* @author  Nuertey Odzeyem
+*
+* @date    May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <bitset>
+
+#include "LightControlCodec.h"
+
+namespace LightControl
+{
+    static constexpr uint16_t MASTER_GROUP_ID{0};
+
+    class GroupSet
+    {
+    public:
+        // False, and no change, should the group be outside 000-999.
+        bool Subscribe(uint16_t group) noexcept
+        {
+            if (group > MAXIMUM_GROUP_ID)
+            {
+                return false;
+            }
+            m_Groups.set(group);
+            return true;
+        }
+
+        void Unsubscribe(uint16_t group) noexcept
+        {
+            if (group <= MAXIMUM_GROUP_ID)
+            {
+                m_Groups.reset(group);
+            }
+        }
+
+        void Clear() noexcept { m_Groups.reset(); }
+
+        bool IsSubscribed(uint16_t group) const noexcept
+        {
+            return (group <= MAXIMUM_GROUP_ID) && m_Groups.test(group);
+        }
+
+        bool IsBroadcast(uint16_t group) const noexcept
+        {
+            return (group == MASTER_GROUP_ID);
+        }
+
+        // Whether a message addressed to this group is ours to act upon.
+        bool Accepts(uint16_t group) const noexcept
+        {
+            return IsBroadcast(group) || IsSubscribed(group);
+        }
+
+        std::size_t Count() const noexcept { return m_Groups.count(); }
+
+        // Calls visitor(group) for every group that a message addressed to
+        // this group applies to: all subscribed groups for a broadcast,
+        // otherwise the group itself, if subscribed.
+        template <typename Visitor>
+        void ForEachTarget(uint16_t group, Visitor && visitor) const
+        {
+            if (!IsBroadcast(group))
+            {
+                if (IsSubscribed(group))
+                {
+                    visitor(group);
+                }
+                return;
+            }
+
+            for (uint16_t subscribed = 0; subscribed <= MAXIMUM_GROUP_ID; ++subscribed)
+            {
+                if (m_Groups.test(subscribed))
+                {
+                    visitor(subscribed);
+                }
+            }
+        }
+
+    private:
+        std::bitset<MAXIMUM_GROUP_ID + 1> m_Groups;
+    };
+} // end of namespace
@@ -0,0 +1,344 @@
+/***********************************************************************
+* @file      LightControlPubSub.h
+*
+*    Allocation-free encoding and decoding of the publish/subscribe
+*    transport mode, by which one controller commands thousands of
+*    devices by group through a broker, as opposed to each device talking
+*    to an echo server on its own.
+*
+*    The packets are those of MQTT-SN v1.2 (CONNECT, SUBSCRIBE, PUBLISH,
+*    PINGREQ, ... each prefixed with its 1-byte length and type), over
+*    UDP or NIDD. Only the subset that LightControl needs is supported:
+*
+*    - Topics are predefined topic IDs (TopicIdType 0b01), and the topic
+*      ID of a LightControl group is the group ID itself; so there is no
+*      REGISTER round trip, and a topic costs 2 bytes on air. Group 000,
+*      the master group, is its own topic that every device subscribes to.
+*
+*    - The payload of a PUBLISH is a LightControl message in either of the
+*      encodings of LightControlCodec.h, i.e. the very t:/g:/s: semantics
+*      that the echo exchange uses. Its group must match the topic.
+*
+*    - QoS 0 and QoS 1 only; no wills, no sleeping clients, no gateway
+*      discovery, and 1-byte lengths, i.e. packets of under 256 bytes.
+*
+*    Thus a stock MQTT-SN gateway, configured with predefined topics
+*    000-999, can stand in for the broker just as well.
+*
+* @brief
+*
+* @note    Deliberately free of any Mbed OS dependency so that the host
+*          broker (host/PubSubBroker.cpp) and fan-out benchmark
+*          (host/PubSubFanout.cpp) speak the protocol with the same code.
+*
+* @warning
+*
+* @author  Nuertey Odzeyem
+*
+* @date    May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+#include "LightControlCodec.h"
+
+namespace LightControl
+{
+    enum class PubSubType_t : uint8_t
+    {
+        CONNECT     = 0x04,
+        CONNACK     = 0x05,
+        PUBLISH     = 0x0C,
+        PUBACK      = 0x0D,
+        SUBSCRIBE   = 0x12,
+        SUBACK      = 0x13,
+        UNSUBSCRIBE = 0x14,
+        UNSUBACK    = 0x15,
+        PINGREQ     = 0x16,
+        PINGRESP    = 0x17,
+        DISCONNECT  = 0x18
+    };
+
+    enum class PubSubReturnCode_t : uint8_t
+    {
+        ACCEPTED            = 0x00,
+        REJECTED_CONGESTION = 0x01,
+        REJECTED_TOPIC_ID   = 0x02,
+        REJECTED_UNSUPPORTED = 0x03
+    };
+
+    static constexpr uint8_t  PUBSUB_PROTOCOL_ID{0x01};
+    static constexpr uint8_t  PUBSUB_FLAG_DUP{0x80};
+    static constexpr uint8_t  PUBSUB_FLAG_QOS_MASK{0x60};
+    static constexpr uint8_t  PUBSUB_FLAG_QOS_1{0x20};
+    static constexpr uint8_t  PUBSUB_FLAG_CLEAN_SESSION{0x04};
+    static constexpr uint8_t  PUBSUB_TOPIC_ID_TYPE_MASK{0x03};
+    static constexpr uint8_t  PUBSUB_TOPIC_ID_PREDEFINED{0x01};
+    static constexpr std::size_t PUBSUB_MAXIMUM_CLIENT_ID_SIZE{23};
+    static constexpr std::size_t PUBSUB_MAXIMUM_PACKET_SIZE{7 + MAXIMUM_ENCODED_SIZE};
+
+    // The fields of whichever packet type; each type only uses those that
+    // its MQTT-SN layout has. m_Payload refers into the decoded input, and
+    // carries the ClientId of a CONNECT, or the LightControl message of a
+    // PUBLISH.
+    struct PubSubPacket_t
+    {
+        PubSubType_t       m_Type{PubSubType_t::PINGREQ};
+        uint8_t            m_Flags{0};
+        uint16_t           m_TopicId{0};
+        uint16_t           m_MessageId{0};
+        uint16_t           m_Duration{0};  // CONNECT keep alive, in seconds.
+        PubSubReturnCode_t m_ReturnCode{PubSubReturnCode_t::ACCEPTED};
+        std::string_view   m_Payload{};
+
+        constexpr bool IsQoS1() const noexcept { return ((m_Flags & PUBSUB_FLAG_QOS_MASK) == PUBSUB_FLAG_QOS_1); }
+    };
+
+    constexpr uint8_t PubSubQoSFlags(uint8_t qos) noexcept
+    {
+        return (qos > 0) ? PUBSUB_FLAG_QOS_1 : 0;
+    }
+
+    // Number of bytes that the packet occupies on the wire.
+    constexpr std::size_t PubSubEncodedSize(const PubSubPacket_t & packet) noexcept
+    {
+        switch (packet.m_Type)
+        {
+            case PubSubType_t::CONNECT:     return 6 + packet.m_Payload.size();
+            case PubSubType_t::CONNACK:     return 3;
+            case PubSubType_t::PUBLISH:     return 7 + packet.m_Payload.size();
+            case PubSubType_t::PUBACK:      return 7;
+            case PubSubType_t::SUBSCRIBE:   return 7;
+            case PubSubType_t::SUBACK:      return 8;
+            case PubSubType_t::UNSUBSCRIBE: return 7;
+            case PubSubType_t::UNSUBACK:    return 4;
+            case PubSubType_t::PINGREQ:     return 2;
+            case PubSubType_t::PINGRESP:    return 2;
+            case PubSubType_t::DISCONNECT:  return 2;
+        }
+        return 0;
+    }
+
+    // Encodes the packet into the caller's buffer and returns the number
+    // of bytes to put on the wire, or 0 should the buffer be too small.
+    constexpr std::size_t EncodePubSub(const PubSubPacket_t & packet, std::span<char> output) noexcept
+    {
+        const auto length = PubSubEncodedSize(packet);
+        if ((length == 0) || (length > UINT8_MAX) || (output.size() < length)
+            || ((packet.m_Type == PubSubType_t::CONNECT) && (packet.m_Payload.size() > PUBSUB_MAXIMUM_CLIENT_ID_SIZE)))
+        {
+            return 0;
+        }
+
+        std::size_t pos = 0;
+        const auto byte = [&](uint8_t value) { output[pos++] = static_cast<char>(value); };
+        const auto word = [&](uint16_t value)
+        {
+            byte(static_cast<uint8_t>(value >> 8));
+            byte(static_cast<uint8_t>(value & 0xFF));
+        };
+        const auto bytes = [&](std::string_view value)
+        {
+            for (const char c : value)
+            {
+                output[pos++] = c;
+            }
+        };
+
+        byte(static_cast<uint8_t>(length));
+        byte(static_cast<uint8_t>(packet.m_Type));
+
+        switch (packet.m_Type)
+        {
+            case PubSubType_t::CONNECT:
+                byte(packet.m_Flags);
+                byte(PUBSUB_PROTOCOL_ID);
+                word(packet.m_Duration);
+                bytes(packet.m_Payload);
+                break;
+            case PubSubType_t::CONNACK:
+                byte(static_cast<uint8_t>(packet.m_ReturnCode));
+                break;
+            case PubSubType_t::PUBLISH:
+                byte(packet.m_Flags);
+                word(packet.m_TopicId);
+                word(packet.m_MessageId);
+                bytes(packet.m_Payload);
+                break;
+            case PubSubType_t::PUBACK:
+                word(packet.m_TopicId);
+                word(packet.m_MessageId);
+                byte(static_cast<uint8_t>(packet.m_ReturnCode));
+                break;
+            case PubSubType_t::SUBSCRIBE:
+            case PubSubType_t::UNSUBSCRIBE:
+                byte(packet.m_Flags);
+                word(packet.m_MessageId);
+                word(packet.m_TopicId);
+                break;
+            case PubSubType_t::SUBACK:
+                byte(packet.m_Flags);
+                word(packet.m_TopicId);
+                word(packet.m_MessageId);
+                byte(static_cast<uint8_t>(packet.m_ReturnCode));
+                break;
+            case PubSubType_t::UNSUBACK:
+                word(packet.m_MessageId);
+                break;
+            case PubSubType_t::PINGREQ:
+            case PubSubType_t::PINGRESP:
+            case PubSubType_t::DISCONNECT:
+                break;
+        }
+        return pos;
+    }
+
+    // One datagram holds exactly one packet; anything malformed, truncated,
+    // or of a type outside the subset above, is nothing.
+    constexpr std::optional<PubSubPacket_t> DecodePubSub(std::string_view input) noexcept
+    {
+        if ((input.size() < 2) || (static_cast<uint8_t>(input[0]) < 2)
+            || (static_cast<uint8_t>(input[0]) > input.size()))
+        {
+            return std::nullopt;
+        }
+        input = input.substr(0, static_cast<uint8_t>(input[0]));
+
+        PubSubPacket_t packet;
+        packet.m_Type = static_cast<PubSubType_t>(input[1]);
+
+        std::size_t pos = 2;
+        const auto byte = [&]() { return static_cast<uint8_t>(input[pos++]); };
+        const auto word = [&]()
+        {
+            const auto high = byte();
+            return static_cast<uint16_t>((high << 8) | byte());
+        };
+
+        // The fixed part of every supported type; anything beyond it is the payload.
+        std::size_t fixed = 0;
+        switch (packet.m_Type)
+        {
+            case PubSubType_t::CONNECT:     fixed = 6; break;
+            case PubSubType_t::CONNACK:     fixed = 3; break;
+            case PubSubType_t::PUBLISH:     fixed = 7; break;
+            case PubSubType_t::PUBACK:      fixed = 7; break;
+            case PubSubType_t::SUBSCRIBE:   fixed = 7; break;
+            case PubSubType_t::SUBACK:      fixed = 8; break;
+            case PubSubType_t::UNSUBSCRIBE: fixed = 7; break;
+            case PubSubType_t::UNSUBACK:    fixed = 4; break;
+            case PubSubType_t::PINGREQ:     fixed = 2; break;
+            case PubSubType_t::PINGRESP:    fixed = 2; break;
+            case PubSubType_t::DISCONNECT:  fixed = 2; break;
+            default:                        return std::nullopt;
+        }
+        if (input.size() < fixed)
+        {
+            return std::nullopt;
+        }
+
+        switch (packet.m_Type)
+        {
+            case PubSubType_t::CONNECT:
+                packet.m_Flags = byte();
+                if (byte() != PUBSUB_PROTOCOL_ID)
+                {
+                    return std::nullopt;
+                }
+                packet.m_Duration = word();
+                break;
+            case PubSubType_t::CONNACK:
+                packet.m_ReturnCode = static_cast<PubSubReturnCode_t>(byte());
+                break;
+            case PubSubType_t::PUBLISH:
+                packet.m_Flags = byte();
+                packet.m_TopicId = word();
+                packet.m_MessageId = word();
+                break;
+            case PubSubType_t::PUBACK:
+                packet.m_TopicId = word();
+                packet.m_MessageId = word();
+                packet.m_ReturnCode = static_cast<PubSubReturnCode_t>(byte());
+                break;
+            case PubSubType_t::SUBSCRIBE:
+            case PubSubType_t::UNSUBSCRIBE:
+                packet.m_Flags = byte();
+                packet.m_MessageId = word();
+                packet.m_TopicId = word();
+                break;
+            case PubSubType_t::SUBACK:
+                packet.m_Flags = byte();
+                packet.m_TopicId = word();
+                packet.m_MessageId = word();
+                packet.m_ReturnCode = static_cast<PubSubReturnCode_t>(byte());
+                break;
+            case PubSubType_t::UNSUBACK:
+                packet.m_MessageId = word();
+                break;
+            default:
+                break;
+        }
+        packet.m_Payload = input.substr(pos);
+        return packet;
+    }
+
+    // Wraps a LightControl message into a PUBLISH on its group's topic.
+    constexpr std::size_t EncodePublish(WireFormat_t format, const Message_t & message, uint8_t flags,
+                                        uint16_t messageId, std::span<char> output) noexcept
+    {
+        char payload[MAXIMUM_ENCODED_SIZE]{};
+        const auto length = Encode(format, message, payload);
+        if (length == 0)
+        {
+            return 0;
+        }
+        return EncodePubSub({PubSubType_t::PUBLISH, static_cast<uint8_t>(flags | PUBSUB_TOPIC_ID_PREDEFINED),
+                             message.m_Group, messageId, 0, PubSubReturnCode_t::ACCEPTED,
+                             std::string_view(payload, length)}, output);
+    }
+
+    constexpr PubSubPacket_t MakeSubscribe(uint16_t group, uint8_t qos, uint16_t messageId) noexcept
+    {
+        return {PubSubType_t::SUBSCRIBE, static_cast<uint8_t>(PubSubQoSFlags(qos) | PUBSUB_TOPIC_ID_PREDEFINED),
+                group, messageId};
+    }
+
+    constexpr PubSubPacket_t MakePubAck(const PubSubPacket_t & publish) noexcept
+    {
+        return {PubSubType_t::PUBACK, 0, publish.m_TopicId, publish.m_MessageId};
+    }
+
+    // Compile-time sanity checks of the encoder against the decoder.
+    constexpr bool PubSubRoundTrips(const PubSubPacket_t & packet)
+    {
+        char buffer[PUBSUB_MAXIMUM_PACKET_SIZE]{};
+        const auto length = EncodePubSub(packet, buffer);
+        const auto decoded = DecodePubSub(std::string_view(buffer, length));
+        return decoded && (length == PubSubEncodedSize(packet)) && (decoded->m_Type == packet.m_Type)
+            && (decoded->m_TopicId == packet.m_TopicId) && (decoded->m_MessageId == packet.m_MessageId)
+            && (decoded->m_Flags == packet.m_Flags) && (decoded->m_Payload == packet.m_Payload);
+    }
+    static_assert(PubSubRoundTrips(MakeSubscribe(42, 1, 7)));
+    static_assert(PubSubRoundTrips({PubSubType_t::PUBLISH, PUBSUB_TOPIC_ID_PREDEFINED, 999, 65535, 0,
+                                    PubSubReturnCode_t::ACCEPTED, "t:lights;g:999;s:1;"}));
+    static_assert(PubSubRoundTrips({PubSubType_t::CONNECT, PUBSUB_FLAG_CLEAN_SESSION, 0, 0, 60,
+                                    PubSubReturnCode_t::ACCEPTED, "lc-0123abcd"}));
+    static_assert(PubSubRoundTrips({PubSubType_t::PINGREQ}));
+    static_assert(PubSubEncodedSize(MakeSubscribe(1, 0, 1)) == 7);
+    static_assert([]()
+    {
+        char buffer[PUBSUB_MAXIMUM_PACKET_SIZE]{};
+        const auto length = EncodePublish(WireFormat_t::BINARY, Message_t{5, true}, 0, 1, buffer);
+        const auto decoded = DecodePubSub(std::string_view(buffer, length));
+        return (length == 10) && decoded && (Decode(decoded->m_Payload).m_Message.m_Group == 5);
+    }());
+    static_assert(!DecodePubSub(std::string_view("\x07\x0C\x01\x00", 4)));
+    static_assert(!DecodePubSub(std::string_view("\x02\x7F", 2)));
+} // end of namespace
@@ -0,0 +1,232 @@
+/***********************************************************************
+* @file      LightDimmer.h
+*
+*    Dimming and fades of PWM driven light channels.
+*
+*    Levels ("l:" in LightControlCodec.h) are on a perceptual scale, 0 to
+*    255, mapped to 16-bit PWM duty cycles by the CIE 1931 lightness
+*    curve, so that equal steps of level look like equal steps of
+*    brightness. The curve is computed once, at compile time, into a 257
+*    entry table; in between entries it is interpolated linearly.
+*
+*    A fade ("d:") moves a channel's level linearly, in 8.16 fixed point,
+*    from wherever it is to the target level over a number of steps; and
+*    so, through the table, along the curve. Each step of every channel
+*    fading is then one add, one table lookup and one interpolation, and a
+*    duty cycle written only should it have changed: no floating point,
+*    and no pow(), on the step path. Channels not fading cost nothing at
+*    all; nor does the engine, once idle.
+*
+* @brief
+*
+* @note    Deliberately free of any Mbed OS dependency; the device steps
+*          it from a hardware timer interrupt, writing PwmOut channels, and
+*          the host model (host/DimmingModel.cpp) checks the accuracy, and
+*          times the steps, of the very same code.
+*
+* @warning Not thread-safe. The device Start()s fades from the consuming
+*          thread, under a critical section, and Step()s them in the ISR.
+*
+* @author  Nuertey Odzeyem
+*
+* @date    May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace LightControl
+{
+    static constexpr uint8_t  MAXIMUM_LEVEL{255};
+    static constexpr uint16_t MAXIMUM_DUTY{UINT16_MAX};
+
+    // CIE 1931 relative luminance, 0 to 1, of a lightness of L* = 0 to 100.
+    constexpr double CieLuminance(double lightness) noexcept
+    {
+        if (lightness <= 8.0)
+        {
+            return lightness / 903.3;
+        }
+        const auto cubeRoot = (lightness + 16.0) / 116.0;
+        return cubeRoot * cubeRoot * cubeRoot;
+    }
+
+    // Duty cycles of levels 0 to 255, plus a repeat of the last one so that
+    // interpolation never needs to check for the top end.
+    static constexpr auto GAMMA_TABLE = []
+    {
+        std::array<uint16_t, MAXIMUM_LEVEL + 2> table{};
+        for (std::size_t level = 0; level <= MAXIMUM_LEVEL; ++level)
+        {
+            const auto luminance = CieLuminance((static_cast<double>(level) * 100.0) / MAXIMUM_LEVEL);
+            table[level] = static_cast<uint16_t>((luminance * MAXIMUM_DUTY) + 0.5);
+        }
+        table[MAXIMUM_LEVEL + 1] = table[MAXIMUM_LEVEL];
+        return table;
+    }();
+
+    constexpr uint16_t LevelToDuty(uint8_t level) noexcept
+    {
+        return GAMMA_TABLE[level];
+    }
+
+    // Duty cycle of a level in 8.16 fixed point.
+    constexpr uint16_t PositionToDuty(uint32_t position) noexcept
+    {
+        const auto index = (position >> 16) & 0xFF;
+        const auto fraction = position & 0xFFFF;
+        const auto low = GAMMA_TABLE[index];
+        const auto high = GAMMA_TABLE[index + 1];
+        return static_cast<uint16_t>(low + (((high - low) * fraction) >> 16));
+    }
+
+    template <std::size_t CHANNELS>
+    class FadeEngine
+    {
+        static_assert((CHANNELS > 0) && (CHANNELS <= 32), "Channels are bits of a uint32_t.");
+
+        struct Channel_t
+        {
+            uint32_t m_Position{0}; // Level, 8.16 fixed point.
+            uint32_t m_Target{0};
+            int32_t  m_Delta{0};    // Per step.
+            uint16_t m_Remaining{0};
+            uint16_t m_Duty{0};     // As last written.
+        };
+
+    public:
+        static constexpr uint32_t ALL_CHANNELS{(CHANNELS == 32) ? UINT32_MAX : ((1u << CHANNELS) - 1)};
+
+        // Fades the channels in the mask to the level over the given number
+        // of Step()s, from wherever each one is, superseding any fade of
+        // theirs under way. Over 0 steps the level is written at once, to
+        // output(channel, duty). Returns the number of writes.
+        template <typename Output>
+        constexpr std::size_t Start(uint32_t channels, uint8_t level, uint16_t steps, Output && output)
+        {
+            std::size_t writes = 0;
+            const auto target = static_cast<uint32_t>(level) << 16;
+            for (channels &= ALL_CHANNELS; channels != 0; channels &= (channels - 1))
+            {
+                const auto index = static_cast<std::size_t>(std::countr_zero(channels));
+                auto & channel = m_Channels[index];
+                channel.m_Target = target;
+                if (steps == 0)
+                {
+                    channel.m_Position = target;
+                    channel.m_Remaining = 0;
+                    m_Active &= ~(1u << index);
+                    writes += Write(index, output);
+                    continue;
+                }
+                channel.m_Delta = static_cast<int32_t>((static_cast<int64_t>(target)
+                                                      - static_cast<int64_t>(channel.m_Position)) / steps);
+                channel.m_Remaining = steps;
+                m_Active |= (1u << index);
+            }
+            return writes;
+        }
+
+        // One step of every fade under way. The last step of each lands on
+        // its target exactly. Returns the number of writes.
+        template <typename Output>
+        constexpr std::size_t Step(Output && output)
+        {
+            std::size_t writes = 0;
+            for (auto active = m_Active; active != 0; active &= (active - 1))
+            {
+                const auto index = static_cast<std::size_t>(std::countr_zero(active));
+                auto & channel = m_Channels[index];
+                if (--channel.m_Remaining == 0)
+                {
+                    channel.m_Position = channel.m_Target;
+                    m_Active &= ~(1u << index);
+                }
+                else
+                {
+                    channel.m_Position = static_cast<uint32_t>(static_cast<int32_t>(channel.m_Position)
+                                                             + channel.m_Delta);
+                }
+                writes += Write(index, output);
+            }
+            return writes;
+        }
+
+        constexpr bool IsActive() const noexcept { return (m_Active != 0); }
+        constexpr uint32_t ActiveChannels() const noexcept { return m_Active; }
+        constexpr uint16_t Duty(std::size_t channel) const noexcept { return m_Channels[channel].m_Duty; }
+        constexpr uint8_t Level(std::size_t channel) const noexcept
+        {
+            return static_cast<uint8_t>(m_Channels[channel].m_Position >> 16);
+        }
+
+    private:
+        template <typename Output>
+        constexpr std::size_t Write(std::size_t index, Output && output)
+        {
+            auto & channel = m_Channels[index];
+            const auto duty = PositionToDuty(channel.m_Position);
+            if (duty == channel.m_Duty)
+            {
+                return 0;
+            }
+            channel.m_Duty = duty;
+            output(index, duty);
+            return 1;
+        }
+
+        std::array<Channel_t, CHANNELS> m_Channels{};
+        uint32_t                        m_Active{0};
+    };
+
+    constexpr bool GammaTableIsMonotonic()
+    {
+        for (std::size_t level = 0; level <= MAXIMUM_LEVEL; ++level)
+        {
+            if (GAMMA_TABLE[level + 1] < GAMMA_TABLE[level])
+            {
+                return false;
+            }
+        }
+        return (GAMMA_TABLE[0] == 0) && (GAMMA_TABLE[MAXIMUM_LEVEL] == MAXIMUM_DUTY)
+            && (LevelToDuty(128) > 11800) && (LevelToDuty(128) < 12300); // ~18% at half lightness.
+    }
+
+    // One channel fades up and another down, over 200 steps, concurrently;
+    // both get there on the very last step, monotonically, and a third is
+    // switched at once meanwhile.
+    constexpr bool FadesOnTime()
+    {
+        FadeEngine<4> engine;
+        std::array<uint16_t, 4> duties{};
+        const auto output = [&](std::size_t channel, uint16_t duty) { duties[channel] = duty; };
+
+        engine.Start(0b0010, MAXIMUM_LEVEL, 0, output);
+        engine.Start(0b0001, MAXIMUM_LEVEL, 200, output);
+        engine.Start(0b0010, 10, 200, output);
+
+        std::size_t steps = 0;
+        bool isMonotonic = (duties[1] == MAXIMUM_DUTY);
+        while (engine.IsActive() && (steps < 1000))
+        {
+            const auto previous = duties;
+            engine.Step(output);
+            ++steps;
+            isMonotonic = isMonotonic && (duties[0] >= previous[0]) && (duties[1] <= previous[1]);
+            if (steps == 50)
+            {
+                engine.Start(0b0100, 1, 0, output);
+            }
+        }
+        return isMonotonic && (steps == 200) && (duties[0] == MAXIMUM_DUTY) && (duties[1] == LevelToDuty(10))
+            && (duties[2] == LevelToDuty(1)) && (engine.Level(0) == MAXIMUM_LEVEL) && (duties[3] == 0);
+    }
+
+    static_assert(GammaTableIsMonotonic());
+    static_assert(FadesOnTime());
+} // end of namespace
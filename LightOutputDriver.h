@@ -0,0 +1,165 @@
+/***********************************************************************
+* @file      LightOutputDriver.h
+*
+*    Multi-channel light output driver.
+*
+*    A node drives anything from the one user LED up to dozens of relays
+*    and LEDs. Channels are bits of up to MAXIMUM_OUTPUT_PORTS GPIO ports,
+*    and each LightControl group is mapped onto a set of such channels.
+*    A command is applied as one masked, port-wide PortOut write per port
+*    touched, rather than as one DigitalOut write per channel, so that all
+*    the channels of a group (or of every group, for a master group
+*    broadcast) switch together, in a single operation.
+*
+*    Group to channel set lookup is O(1): a byte per group, over the whole
+*    000-999 range, indexes a small table of the groups actually mapped.
+*
+* @brief
+*
+* @note    Channels are only ever driven through this class; it keeps a
+*          shadow of every port so that channels outside a command's
+*          channel set are written back unchanged.
+*
+* @warning Not thread-safe; owned by whichever context consumes messages.
+*
+* @author  Nuertey Odzeyem
+*
+* @date    May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <array>
+
+#include "mbed.h"
+
+#include "LightControlGroups.h"
+
+namespace LightControl
+{
+    static constexpr std::size_t MAXIMUM_OUTPUT_PORTS{4};
+
+    // Distinct groups that can be mapped onto channels. A controller only
+    // ever needs to map the groups it is actually installed in.
+    static constexpr std::size_t MAXIMUM_MAPPED_GROUPS{64};
+
+    // One channel mask per port.
+    using ChannelSet_t = std::array<uint32_t, MAXIMUM_OUTPUT_PORTS>;
+
+    class LightOutputDriver
+    {
+        static constexpr uint8_t UNMAPPED{0xFF};
+        static_assert(MAXIMUM_MAPPED_GROUPS < UNMAPPED);
+
+    public:
+        LightOutputDriver()
+        {
+            m_GroupSlots.fill(UNMAPPED);
+        }
+
+        LightOutputDriver(const LightOutputDriver&) = delete;
+        LightOutputDriver& operator=(const LightOutputDriver&) = delete;
+
+        // Claims the channels in mask on the given GPIO port. Returns the
+        // port index to map groups with, or nothing when out of ports.
+        std::optional<std::size_t> AddPort(PortName port, uint32_t mask)
+        {
+            if (m_PortCount == MAXIMUM_OUTPUT_PORTS)
+            {
+                return std::nullopt;
+            }
+            m_Ports[m_PortCount].emplace(port, static_cast<int>(mask));
+            m_Shadows[m_PortCount] = 0;
+            m_Ports[m_PortCount]->write(0); // All channels off to begin with.
+            return m_PortCount++;
+        }
+
+        // Adds channels (bits of the port's mask) to the group's channel set.
+        bool MapGroup(uint16_t group, std::size_t portIndex, uint32_t channels)
+        {
+            if ((group > MAXIMUM_GROUP_ID) || (portIndex >= m_PortCount))
+            {
+                return false;
+            }
+
+            if (m_GroupSlots[group] == UNMAPPED)
+            {
+                if (m_MappedCount == MAXIMUM_MAPPED_GROUPS)
+                {
+                    return false;
+                }
+                m_MappedGroups[m_MappedCount] = group;
+                m_ChannelSets[m_MappedCount] = ChannelSet_t{};
+                m_GroupSlots[group] = static_cast<uint8_t>(m_MappedCount++);
+            }
+
+            m_ChannelSets[m_GroupSlots[group]][portIndex] |= channels;
+            return true;
+        }
+
+        // Channels that a command to this group switches. A master group
+        // broadcast fans out to the channels of every subscribed group.
+        ChannelSet_t Channels(uint16_t group, const GroupSet & subscribed) const
+        {
+            if (subscribed.IsBroadcast(group))
+            {
+                ChannelSet_t channels{};
+                for (std::size_t slot = 0; slot < m_MappedCount; ++slot)
+                {
+                    if (subscribed.IsSubscribed(m_MappedGroups[slot]))
+                    {
+                        for (std::size_t port = 0; port < m_PortCount; ++port)
+                        {
+                            channels[port] |= m_ChannelSets[slot][port];
+                        }
+                    }
+                }
+                return channels;
+            }
+
+            if ((group > MAXIMUM_GROUP_ID) || (m_GroupSlots[group] == UNMAPPED))
+            {
+                return ChannelSet_t{};
+            }
+            return m_ChannelSets[m_GroupSlots[group]];
+        }
+
+        // Switches the channels of the addressed group(s) on or off, with
+        // one masked write per port touched. Returns the number of writes.
+        std::size_t Apply(uint16_t group, bool state, const GroupSet & subscribed)
+        {
+            return Apply(Channels(group, subscribed), state);
+        }
+
+        std::size_t Apply(const ChannelSet_t & channels, bool state)
+        {
+            std::size_t writes = 0;
+            for (std::size_t port = 0; port < m_PortCount; ++port)
+            {
+                if (channels[port] == 0)
+                {
+                    continue;
+                }
+                m_Shadows[port] = state ? (m_Shadows[port] | channels[port])
+                                        : (m_Shadows[port] & ~channels[port]);
+                m_Ports[port]->write(static_cast<int>(m_Shadows[port]));
+                ++writes;
+            }
+            return writes;
+        }
+
+        std::size_t PortCount() const noexcept { return m_PortCount; }
+        std::size_t MappedGroupCount() const noexcept { return m_MappedCount; }
+
+    private:
+        std::array<std::optional<mbed::PortOut>, MAXIMUM_OUTPUT_PORTS> m_Ports;
+        std::array<uint32_t, MAXIMUM_OUTPUT_PORTS>                     m_Shadows{};
+        std::size_t                                                    m_PortCount{0};
+
+        std::array<uint8_t, MAXIMUM_GROUP_ID + 1>         m_GroupSlots;
+        std::array<uint16_t, MAXIMUM_MAPPED_GROUPS>       m_MappedGroups{};
+        std::array<ChannelSet_t, MAXIMUM_MAPPED_GROUPS>   m_ChannelSets{};
+        std::size_t                                       m_MappedCount{0};
+    };
+} // end of namespace
@@ -0,0 +1,238 @@
+/***********************************************************************
+* @file      LinkStatistics.h
+*
+*    Built-in instrumentation of the LightControl link: a per-message
+*    round-trip time histogram, and counters of messages, bytes on air,
+*    failures (parse failures by field), timeouts and reconnects, the
+*    time it takes for the first reply to arrive, how long the link takes
+*    to recover from a loss, and how outgoing traffic was batched.
+*
+*    Everything is fixed size. The histogram has log-scale buckets, one
+*    per power of 2 of microseconds, so that it spans the microseconds of
+*    a loopback link up to the tens of seconds of a congested cellular
+*    one in 32 counters, with a worst-case quantization error of 2x.
+*
+* @brief
+*
+* @note    Deliberately free of any Mbed OS dependency so that it can be
+*          compiled and exercised on a Linux host just as well.
+*
+* @warning Not thread-safe; updated, and to be read, from the context
+*          that runs the exchange. LEDLightControl::GetStats() snapshots.
+*
+* @author  Nuertey Odzeyem
+*
+* @date    May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdio>
+
+#include "LightControlCodec.h"
+
+namespace LightControl
+{
+    static constexpr std::size_t PARSE_ERROR_COUNT{static_cast<std::size_t>(ParseError_t::TRANSITION_FIELD_INVALID) + 1};
+
+    class RoundTripHistogram
+    {
+    public:
+        // Bucket 0 holds 0 us, and bucket b > 0 holds [2^(b-1), 2^b) us.
+        static constexpr std::size_t BUCKET_COUNT{32};
+
+        static constexpr std::size_t Bucket(uint32_t microseconds) noexcept
+        {
+            return std::min<std::size_t>(std::bit_width(microseconds), BUCKET_COUNT - 1);
+        }
+
+        // Exclusive upper bound of the bucket, in microseconds.
+        static constexpr uint64_t UpperBound(std::size_t bucket) noexcept
+        {
+            return (static_cast<uint64_t>(1) << bucket);
+        }
+
+        constexpr void Record(uint32_t microseconds) noexcept
+        {
+            ++m_Buckets[Bucket(microseconds)];
+            ++m_Count;
+            m_Sum += microseconds;
+            m_Minimum = std::min(m_Minimum, microseconds);
+            m_Maximum = std::max(m_Maximum, microseconds);
+        }
+
+        constexpr uint32_t Count() const noexcept { return m_Count; }
+        constexpr uint32_t Minimum() const noexcept { return (m_Count > 0) ? m_Minimum : 0; }
+        constexpr uint32_t Maximum() const noexcept { return m_Maximum; }
+        constexpr uint32_t Mean() const noexcept { return (m_Count > 0) ? static_cast<uint32_t>(m_Sum / m_Count) : 0; }
+        constexpr const std::array<uint32_t, BUCKET_COUNT> & Buckets() const noexcept { return m_Buckets; }
+
+        // Upper bound of the bucket that the given fraction (0-1) of round
+        // trips fall within, capped by the maximum actually seen.
+        constexpr uint32_t Percentile(double fraction) const noexcept
+        {
+            const auto rank = static_cast<uint64_t>(fraction * m_Count);
+            uint64_t seen = 0;
+            for (std::size_t bucket = 0; bucket < BUCKET_COUNT; ++bucket)
+            {
+                seen += m_Buckets[bucket];
+                if ((seen > rank) || (seen == m_Count))
+                {
+                    return static_cast<uint32_t>(std::min<uint64_t>(UpperBound(bucket), m_Maximum));
+                }
+            }
+            return m_Maximum;
+        }
+
+    private:
+        std::array<uint32_t, BUCKET_COUNT> m_Buckets{};
+        uint32_t                           m_Count{0};
+        uint64_t                           m_Sum{0};
+        uint32_t                           m_Minimum{UINT32_MAX};
+        uint32_t                           m_Maximum{0};
+    };
+
+    struct LinkStatistics_t
+    {
+        uint32_t           m_MessagesSent{0};
+        uint32_t           m_MessagesReceived{0};  // Parsed and acted upon.
+        uint64_t           m_BytesSent{0};         // Everything on air, negotiation included.
+        uint64_t           m_BytesReceived{0};
+        uint32_t           m_SendFailures{0};
+        uint32_t           m_ReceiveFailures{0};
+        uint32_t           m_Timeouts{0};
+        uint32_t           m_Connections{0};
+        uint32_t           m_Reconnects{0};
+        uint32_t           m_UnmatchedReplies{0};
+        uint32_t           m_LateNegotiationReplies{0}; // After falling back to text; dropped.
+
+        // Time to the first reply: from boot, over the first connection,
+        // and from the start of the latest (re)connect attempt.
+        uint32_t           m_BootToFirstMessageMilliseconds{0};
+        uint32_t           m_ConnectToFirstMessageMilliseconds{0};
+
+        // Recovery: from the link (or socket) being lost, through however
+        // many reconnect attempts it takes, to the next reply parsed.
+        uint32_t           m_ReconnectAttempts{0};
+        uint32_t           m_Recoveries{0};
+        uint64_t           m_RecoveryMillisecondsTotal{0};
+        uint32_t           m_RecoveryMillisecondsMaximum{0};
+
+        constexpr uint32_t MeanRecoveryMilliseconds() const noexcept
+        {
+            return (m_Recoveries > 0) ? static_cast<uint32_t>(m_RecoveryMillisecondsTotal / m_Recoveries) : 0;
+        }
+
+        // Wake windows: bursts flushed, and queued messages that were
+        // superseded by a newer one for the same group, or found no room.
+        uint32_t           m_WakeBursts{0};
+        uint32_t           m_CoalescedMessages{0};
+        uint32_t           m_DroppedMessages{0};
+
+        // Datagram reliability (UDP and NIDD only), with the RTO and the
+        // smoothed RTT that it is based upon as of the snapshot.
+        uint32_t           m_Retransmissions{0};
+        uint32_t           m_DuplicateReplies{0};
+        uint32_t           m_RetransmissionTimeoutMilliseconds{0};
+        uint32_t           m_SmoothedRoundTripMilliseconds{0};
+
+        // Synchronized commands (see ClockSync.h): exchanges stamped by the
+        // controller, and the error bound of the estimate as of the snapshot;
+        // commands executed from the timer, and how late at worst, and those
+        // applied on receipt instead, being overdue, or unsynchronized (or
+        // too far ahead, or finding the schedule full).
+        uint32_t           m_ClockExchanges{0};
+        uint32_t           m_ClockDispersionMicroseconds{0};
+        uint32_t           m_ScheduledCommands{0};
+        uint32_t           m_ExecutionLatenessMaximumMicroseconds{0};
+        uint32_t           m_LateCommands{0};
+        uint32_t           m_UnscheduledCommands{0};
+
+        // Light actions scheduled by the application on the timer wheel:
+        // expired and applied, and turned away (wheel full, or too far ahead).
+        uint32_t           m_TimedActionsExecuted{0};
+        uint32_t           m_TimedActionsRejected{0};
+
+        // Dimmed commands (see LightDimmer.h): fades started on the PWM
+        // channels, and steps of them taken by the fade timer.
+        uint32_t           m_FadesStarted{0};
+        uint32_t           m_FadeSteps{0};
+
+        // Indexed by ParseError_t; GROUP_NOT_SUBSCRIBED included.
+        std::array<uint32_t, PARSE_ERROR_COUNT> m_ParseFailures{};
+
+        RoundTripHistogram m_RoundTripTime;
+
+        void Print(FILE * stream) const
+        {
+            fprintf(stream, "LightControl link statistics:\r\n");
+            fprintf(stream, "\tmessages sent/received: %lu/%lu\r\n",
+                static_cast<unsigned long>(m_MessagesSent), static_cast<unsigned long>(m_MessagesReceived));
+            fprintf(stream, "\tbytes sent/received: %llu/%llu\r\n",
+                static_cast<unsigned long long>(m_BytesSent), static_cast<unsigned long long>(m_BytesReceived));
+            fprintf(stream, "\tsend/receive failures: %lu/%lu, timeouts: %lu, unmatched replies: %lu, late negotiation replies: %lu\r\n",
+                static_cast<unsigned long>(m_SendFailures), static_cast<unsigned long>(m_ReceiveFailures),
+                static_cast<unsigned long>(m_Timeouts), static_cast<unsigned long>(m_UnmatchedReplies),
+                static_cast<unsigned long>(m_LateNegotiationReplies));
+            fprintf(stream, "\tconnections: %lu, reconnects: %lu\r\n",
+                static_cast<unsigned long>(m_Connections), static_cast<unsigned long>(m_Reconnects));
+            fprintf(stream, "\ttime to first message (ms): from boot %lu, from latest connect %lu\r\n",
+                static_cast<unsigned long>(m_BootToFirstMessageMilliseconds),
+                static_cast<unsigned long>(m_ConnectToFirstMessageMilliseconds));
+            fprintf(stream, "\trecoveries: %lu after %lu reconnect attempts, link loss to next message (ms): mean %lu, max %lu\r\n",
+                static_cast<unsigned long>(m_Recoveries), static_cast<unsigned long>(m_ReconnectAttempts),
+                static_cast<unsigned long>(MeanRecoveryMilliseconds()),
+                static_cast<unsigned long>(m_RecoveryMillisecondsMaximum));
+            fprintf(stream, "\twake window bursts: %lu, queued messages coalesced: %lu, dropped: %lu\r\n",
+                static_cast<unsigned long>(m_WakeBursts), static_cast<unsigned long>(m_CoalescedMessages),
+                static_cast<unsigned long>(m_DroppedMessages));
+            fprintf(stream, "\tretransmissions: %lu, duplicate replies suppressed: %lu, RTO %lu ms (smoothed RTT %lu ms)\r\n",
+                static_cast<unsigned long>(m_Retransmissions), static_cast<unsigned long>(m_DuplicateReplies),
+                static_cast<unsigned long>(m_RetransmissionTimeoutMilliseconds),
+                static_cast<unsigned long>(m_SmoothedRoundTripMilliseconds));
+            fprintf(stream, "\tclock exchanges: %lu (+/-%lu us), commands scheduled: %lu (max %lu us late), overdue: %lu, unscheduled: %lu\r\n",
+                static_cast<unsigned long>(m_ClockExchanges), static_cast<unsigned long>(m_ClockDispersionMicroseconds),
+                static_cast<unsigned long>(m_ScheduledCommands),
+                static_cast<unsigned long>(m_ExecutionLatenessMaximumMicroseconds),
+                static_cast<unsigned long>(m_LateCommands), static_cast<unsigned long>(m_UnscheduledCommands));
+            fprintf(stream, "\ttimed actions executed: %lu, rejected: %lu\r\n",
+                static_cast<unsigned long>(m_TimedActionsExecuted), static_cast<unsigned long>(m_TimedActionsRejected));
+            fprintf(stream, "\tfades started: %lu, fade steps: %lu\r\n",
+                static_cast<unsigned long>(m_FadesStarted), static_cast<unsigned long>(m_FadeSteps));
+
+            for (std::size_t error = 1; error < PARSE_ERROR_COUNT; ++error)
+            {
+                if (m_ParseFailures[error] > 0)
+                {
+                    fprintf(stream, "\tparse failures, %s: %lu\r\n", ToString(static_cast<ParseError_t>(error)),
+                        static_cast<unsigned long>(m_ParseFailures[error]));
+                }
+            }
+
+            const auto & rtt = m_RoundTripTime;
+            fprintf(stream, "\tround trip (us): min %lu, mean %lu, p50 <=%lu, p90 <=%lu, p99 <=%lu, max %lu\r\n",
+                static_cast<unsigned long>(rtt.Minimum()), static_cast<unsigned long>(rtt.Mean()),
+                static_cast<unsigned long>(rtt.Percentile(0.50)), static_cast<unsigned long>(rtt.Percentile(0.90)),
+                static_cast<unsigned long>(rtt.Percentile(0.99)), static_cast<unsigned long>(rtt.Maximum()));
+
+            for (std::size_t bucket = 0; bucket < RoundTripHistogram::BUCKET_COUNT; ++bucket)
+            {
+                if (rtt.Buckets()[bucket] > 0)
+                {
+                    fprintf(stream, "\t\t< %10llu us: %lu\r\n",
+                        static_cast<unsigned long long>(RoundTripHistogram::UpperBound(bucket)),
+                        static_cast<unsigned long>(rtt.Buckets()[bucket]));
+                }
+            }
+        }
+    };
+
+    static_assert(RoundTripHistogram::Bucket(0) == 0);
+    static_assert(RoundTripHistogram::Bucket(1) == 1);
+    static_assert(RoundTripHistogram::Bucket(1000) == 10); // [512, 1024)
+    static_assert(RoundTripHistogram::Bucket(UINT32_MAX) == (RoundTripHistogram::BUCKET_COUNT - 1));
+} // end of namespace
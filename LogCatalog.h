@@ -0,0 +1,141 @@
+/***********************************************************************
+* @file      LogCatalog.h
+*
+*    Log points of the deferred LightControl logger, and the fixed-size
+*    binary record that each one is captured as.
+*
+*    On the message hot path a log point is never formatted where it
+*    happens. Only its ID, a timestamp and up to MAXIMUM_LOG_ARGUMENTS
+*    integer arguments are recorded (see DeferredLog.h); the printf-style
+*    format string lives here, and is only applied later, by the low
+*    priority drain thread on the target or by host/LogDecoder.cpp.
+*
+*    Only the per-message log points are deferred; anything that ends, or
+*    sets up, the exchange is still printf'ed in full where it happens.
+*
+* @brief
+*
+* @note    Deliberately free of any Mbed OS dependency so that the host
+*          decoder can share this very catalog with the target.
+*
+* @warning Append new log points at the end only; IDs already in the
+*          field must keep their meaning for the decoder.
+*
+* @author  Nuertey Odzeyem
+*
+* @date    May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+namespace LightControl
+{
+    enum class LogPoint_t : uint16_t
+    {
+        RECEIVED,
+        UNMATCHED_REPLY,
+        PARSE_FAILED,
+        GROUP_NOT_SUBSCRIBED,
+        LIGHTS_SWITCHED,
+        RECORDS_DROPPED,
+        DUPLICATE_REPLY,
+        RETRANSMITTED,
+        COMMAND_SCHEDULED,
+        BOOTED,
+        FAULTED,
+        NETWORK_STATUS,
+        CELLULAR_EVENT,
+        SOCKET_ERROR,
+        RECONNECT_SCHEDULED,
+        REPLY_TIMEOUT,
+        COUNT // Must remain last.
+    };
+
+    static constexpr std::size_t MAXIMUM_LOG_ARGUMENTS{3};
+
+    // First argument of LogPoint_t::SOCKET_ERROR.
+    enum class SocketOperation_t : int32_t
+    {
+        OPEN,
+        CONNECT,
+        SEND,
+        RECEIVE
+    };
+
+    // Marks the start of every record in a binary log stream, so that a
+    // decoder joining mid-stream can find the next record boundary.
+    static constexpr uint8_t LOG_RECORD_MAGIC{0xA5};
+
+    struct LogRecord_t
+    {
+        uint8_t  m_Magic{LOG_RECORD_MAGIC};
+        uint8_t  m_ArgumentCount{0};
+        uint16_t m_LogPoint{0};
+        uint32_t m_TimestampMilliseconds{0};
+        int32_t  m_Arguments[MAXIMUM_LOG_ARGUMENTS]{};
+    };
+
+    static_assert(sizeof(LogRecord_t) == 20, "LogRecord_t is a wire format; keep it packed.");
+
+    // Indexed by LogPoint_t. Every argument is an int32_t.
+    static constexpr const char * LOG_FORMATS[] =
+    {
+        "Success! Socket receive returned: [%d] bytes\n",
+        "Warning! Reply matches no LightControl message in flight.\r\n",
+        "Error! LightControl message parsing failed: [%d] (see LightControl::ParseError_t)\r\n",
+        "Error! \"g:%03d\" is not one of our %d subscribed groups.\r\n",
+        "Successfully parsed LightControl message. Switched \"g:%03d\" to \"s:%d\" in %d port write(s).\r\n",
+        "Warning! %d deferred log records dropped.\r\n",
+        "Warning! Duplicate reply to LightControl message %d suppressed.\r\n",
+        "Warning! LightControl message %d retransmitted; RTO now %d ms.\r\n",
+        "Scheduled \"g:%03d\" to \"s:%d\" in %d ms.\r\n",
+        "Booted; boot %d since the flight recorder was cleared, reset reason %d (see reset_reason_t).\r\n",
+        "Error! Fatal error before the reset: status 0x%08x at address 0x%08x.\r\n",
+        "Network connection status changed to %d (see nsapi_connection_status_t).\r\n",
+        "Cellular event %d, error [%d] (see cellular_connection_status_t, nsapi_error_t).\r\n",
+        "Error! Socket operation %d (see LightControl::SocketOperation_t) returned: [%d]\r\n",
+        "Reconnecting in %d ms (attempt %d) ...\r\n",
+        "Error! No LightControl reply within %d ms.\r\n"
+    };
+
+    static_assert((sizeof(LOG_FORMATS) / sizeof(LOG_FORMATS[0])) == static_cast<std::size_t>(LogPoint_t::COUNT),
+        "Every LogPoint_t needs exactly one format.");
+
+    inline bool IsValid(const LogRecord_t & record)
+    {
+        return (record.m_Magic == LOG_RECORD_MAGIC)
+            && (record.m_LogPoint < static_cast<uint16_t>(LogPoint_t::COUNT))
+            && (record.m_ArgumentCount <= MAXIMUM_LOG_ARGUMENTS);
+    }
+
+    // Longest formatted line, timestamp aside; longer ones are truncated.
+    static constexpr std::size_t MAXIMUM_LOG_LINE{160};
+
+    // Formats the record as its log point's line, prefixed with its timestamp,
+    // and writes it out with a single fprintf(), so that no other writer's
+    // output can land in between the two.
+    inline int Print(FILE * stream, const LogRecord_t & record)
+    {
+        const auto & arguments = record.m_Arguments;
+        char line[MAXIMUM_LOG_LINE];
+
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#pragma GCC diagnostic ignored "-Wformat-extra-args"
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+#endif
+        // Arguments beyond those consumed by the format are ignored.
+        snprintf(line, sizeof(line), LOG_FORMATS[record.m_LogPoint],
+            static_cast<int>(arguments[0]), static_cast<int>(arguments[1]), static_cast<int>(arguments[2]));
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+        return fprintf(stream, "[%10u ms] %s", static_cast<unsigned>(record.m_TimestampMilliseconds), line);
+    }
+} // end of namespace
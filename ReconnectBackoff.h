@@ -0,0 +1,86 @@
+/***********************************************************************
+* @file      ReconnectBackoff.h
+*
+*    Jittered exponential backoff between LightControl reconnect attempts.
+*
+*    The ceiling of the delay doubles with every consecutive failed attempt,
+*    from the initial delay up to the maximum. The delay actually waited is
+*    drawn uniformly from the upper half of that ceiling ("equal jitter"),
+*    so that it still grows from attempt to attempt, while a fleet of nodes
+*    that lost the same cell at the same moment does not hammer it again
+*    in lock-step once it comes back.
+*
+* @brief
+*
+* @note    Deliberately free of any Mbed OS dependency; the caller hands
+*          in the random bits (randLIB on the target).
+*
+* @warning Reset() once a connection has proven itself, i.e. only after
+*          the first LightControl reply, not merely after connect().
+*
+* @author  Nuertey Odzeyem
+*
+* @date    May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+namespace LightControl
+{
+    class ReconnectBackoff
+    {
+    public:
+        constexpr ReconnectBackoff(std::chrono::milliseconds initial, std::chrono::milliseconds maximum) noexcept
+            : m_Initial(std::max(initial, std::chrono::milliseconds(1)))
+            , m_Maximum(std::max(maximum, m_Initial))
+            , m_Attempt(0)
+        {
+        }
+
+        // Upper bound of the delay before the given (0-based) attempt.
+        constexpr std::chrono::milliseconds Ceiling(uint32_t attempt) const noexcept
+        {
+            auto ceiling = m_Initial;
+            while ((attempt-- > 0) && (ceiling < m_Maximum))
+            {
+                ceiling *= 2;
+            }
+            return std::min(ceiling, m_Maximum);
+        }
+
+        // Delay before the next attempt, given 32 random bits.
+        constexpr std::chrono::milliseconds Next(uint32_t random) noexcept
+        {
+            const auto ceiling = Ceiling(m_Attempt++);
+            const auto half = ceiling / 2;
+            const auto span = static_cast<uint64_t>((ceiling - half).count()) + 1;
+            return half + std::chrono::milliseconds(static_cast<int64_t>(random % span));
+        }
+
+        constexpr void Reset() noexcept { m_Attempt = 0; }
+
+        // Consecutive attempts since the last Reset().
+        constexpr uint32_t Attempts() const noexcept { return m_Attempt; }
+
+    private:
+        std::chrono::milliseconds m_Initial;
+        std::chrono::milliseconds m_Maximum;
+        uint32_t                  m_Attempt;
+    };
+
+    static_assert(ReconnectBackoff(std::chrono::milliseconds(1000), std::chrono::milliseconds(60000)).Ceiling(0)
+                  == std::chrono::milliseconds(1000));
+    static_assert(ReconnectBackoff(std::chrono::milliseconds(1000), std::chrono::milliseconds(60000)).Ceiling(3)
+                  == std::chrono::milliseconds(8000));
+    static_assert(ReconnectBackoff(std::chrono::milliseconds(1000), std::chrono::milliseconds(60000)).Ceiling(100)
+                  == std::chrono::milliseconds(60000));
+    static_assert(ReconnectBackoff(std::chrono::milliseconds(1000), std::chrono::milliseconds(60000)).Next(0)
+                  == std::chrono::milliseconds(500));
+    static_assert(ReconnectBackoff(std::chrono::milliseconds(1000), std::chrono::milliseconds(60000)).Next(UINT32_MAX)
+                  <= std::chrono::milliseconds(1000));
+} // end of namespace
@@ -0,0 +1,319 @@
+/***********************************************************************
+* @file      TimerWheel.h
+*
+*    Hierarchical timer wheel, for thousands of pending light actions
+*    (scheduled switching, delayed offs, steps of fades, per group) at a
+*    constant cost each, in fixed memory.
+*
+*    Each pending action as an EventQueue::call_in() of its own would
+*    cost event-queue memory, and an insert into the queue's time-sorted
+*    list, that grow with the number pending. Instead the wheel is one
+*    pool of fixed-size entries, hashed by expiry into LEVELS wheels of
+*    SLOTS slots each: level 0 holds what expires within SLOTS ticks, one
+*    tick per slot; level 1 what expires within SLOTS^2 ticks, SLOTS
+*    ticks per slot; and so on. Schedule() and Cancel() are an O(1) link
+*    and unlink. Every time a level wraps around, the next slot of the
+*    level above is cascaded down, so an entry moves at most LEVELS - 1
+*    times before it expires; Advance() costs O(1) per tick plus that,
+*    no matter how many entries are pending.
+*
+*    With 4 levels of 64 slots, delays up to 2^24 ticks (46 hours at a
+*    10 ms tick) can be scheduled.
+*
+* @brief
+*
+* @note    Deliberately free of any Mbed OS dependency; the device drives
+*          it from one event on the shared event queue, re-armed for the
+*          next slot due, and the host benchmark (host/Benchmark.cpp) runs
+*          the very same code.
+*
+* @warning Not thread-safe; owned by whichever context advances it. The
+*          callback of Advance() may Schedule() and Cancel() at will.
+*
+* @author  Nuertey Odzeyem
+*
+* @date    May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace LightControl
+{
+    // Identifies one scheduled entry. Stale once it has expired or been
+    // cancelled; the generation tells it apart from the slot's next use.
+    struct TimerHandle_t
+    {
+        uint16_t m_Index{0};
+        uint8_t  m_Generation{0};
+
+        constexpr bool operator==(const TimerHandle_t &) const = default;
+    };
+
+    template <typename Payload_t, std::size_t CAPACITY>
+    class TimerWheel
+    {
+        static constexpr std::size_t SLOT_BITS{6};
+        static constexpr std::size_t SLOTS{1u << SLOT_BITS};
+        static constexpr std::size_t LEVELS{4};
+        static constexpr uint16_t    NIL{UINT16_MAX};
+
+        static_assert((CAPACITY > 0) && (CAPACITY < NIL), "Entries are indexed by uint16_t.");
+        static_assert((LEVELS * SLOTS) <= (UINT8_MAX + 1), "Slots are indexed by uint8_t.");
+
+        struct Entry_t
+        {
+            uint32_t  m_Expiry{0};      // Absolute tick.
+            Payload_t m_Payload{};
+            uint16_t  m_Next{NIL};
+            uint16_t  m_Previous{NIL};
+            uint8_t   m_Generation{0}; // Odd while pending.
+            uint8_t   m_Slot{0};
+        };
+
+    public:
+        // Longest delay that can be scheduled, in ticks.
+        static constexpr uint32_t MAXIMUM_DELAY{(1u << (SLOT_BITS * LEVELS)) - 1};
+
+        constexpr TimerWheel() noexcept
+        {
+            m_Heads.fill(NIL);
+            for (std::size_t i = 0; i < CAPACITY; ++i)
+            {
+                m_Entries[i].m_Next = static_cast<uint16_t>(((i + 1) < CAPACITY) ? (i + 1) : NIL);
+            }
+        }
+
+        TimerWheel(const TimerWheel&) = delete;
+        TimerWheel& operator=(const TimerWheel&) = delete;
+
+        // Expires on the delay'th Advance()d tick from now; a delay of 0 is
+        // taken as 1. Nothing when full, or when the delay is out of range.
+        constexpr std::optional<TimerHandle_t> Schedule(uint32_t delay, const Payload_t & payload) noexcept
+        {
+            if ((m_Free == NIL) || (delay > MAXIMUM_DELAY))
+            {
+                return std::nullopt;
+            }
+
+            const auto index = m_Free;
+            auto & entry = m_Entries[index];
+            m_Free = entry.m_Next;
+
+            entry.m_Expiry = m_Now + ((delay > 0) ? delay : 1);
+            entry.m_Payload = payload;
+            ++entry.m_Generation;
+            Link(index);
+            ++m_Size;
+            return TimerHandle_t{index, entry.m_Generation};
+        }
+
+        // False, and no change, should the entry have expired already.
+        constexpr bool Cancel(const TimerHandle_t & handle) noexcept
+        {
+            if (!IsPending(handle))
+            {
+                return false;
+            }
+            Unlink(handle.m_Index);
+            Release(handle.m_Index);
+            return true;
+        }
+
+        constexpr bool IsPending(const TimerHandle_t & handle) const noexcept
+        {
+            return (handle.m_Index < CAPACITY) && ((handle.m_Generation & 1) != 0)
+                && (m_Entries[handle.m_Index].m_Generation == handle.m_Generation);
+        }
+
+        // Moves time on by the given number of ticks, handing the payload
+        // of every entry that expires to onExpired, in order of expiry.
+        // Returns the number of entries expired.
+        template <typename OnExpired>
+        constexpr std::size_t Advance(uint32_t ticks, OnExpired && onExpired)
+        {
+            std::size_t expired = 0;
+            for (uint32_t tick = 0; tick < ticks; ++tick)
+            {
+                ++m_Now;
+
+                // Cascade each level that has just wrapped around, from the
+                // highest, so that what comes down lands in the right slot.
+                std::size_t wrapped = 0;
+                while ((wrapped < (LEVELS - 1)) && (((m_Now >> (SLOT_BITS * (wrapped + 1))) << (SLOT_BITS * (wrapped + 1)))
+                                                     == m_Now))
+                {
+                    ++wrapped;
+                }
+                for (auto level = wrapped; level > 0; --level)
+                {
+                    const auto slot = SlotOf(level, m_Now);
+                    while (m_Heads[slot] != NIL)
+                    {
+                        const auto index = m_Heads[slot];
+                        Unlink(index);
+                        Link(index);
+                    }
+                }
+
+                // Popped one at a time, as the callback may Cancel() others.
+                const auto slot = SlotOf(0, m_Now);
+                while (m_Heads[slot] != NIL)
+                {
+                    const auto index = m_Heads[slot];
+                    const auto payload = m_Entries[index].m_Payload;
+                    Unlink(index);
+                    Release(index);
+                    ++expired;
+                    onExpired(payload);
+                }
+            }
+            return expired;
+        }
+
+        // Ticks until the next level 0 slot with anything in it, or the next
+        // cascade, whichever is sooner; so that whatever drives the wheel
+        // need not wake up for idle ticks. Nothing when empty.
+        constexpr std::optional<uint32_t> TicksToNextSlot() const noexcept
+        {
+            if (m_Size == 0)
+            {
+                return std::nullopt;
+            }
+            for (uint32_t ahead = 1; ahead <= SLOTS; ++ahead)
+            {
+                if ((m_Heads[SlotOf(0, m_Now + ahead)] != NIL) || (((m_Now + ahead) % SLOTS) == 0))
+                {
+                    return ahead;
+                }
+            }
+            return static_cast<uint32_t>(SLOTS);
+        }
+
+        constexpr uint32_t Now() const noexcept { return m_Now; }
+        constexpr std::size_t Size() const noexcept { return m_Size; }
+        constexpr bool IsEmpty() const noexcept { return (m_Size == 0); }
+        static constexpr std::size_t Capacity() noexcept { return CAPACITY; }
+        static constexpr std::size_t EntrySize() noexcept { return sizeof(Entry_t); }
+
+    private:
+        static constexpr uint8_t SlotOf(std::size_t level, uint32_t tick) noexcept
+        {
+            return static_cast<uint8_t>((level * SLOTS) + ((tick >> (SLOT_BITS * level)) & (SLOTS - 1)));
+        }
+
+        // Into the lowest level whose span covers the time left.
+        constexpr void Link(uint16_t index) noexcept
+        {
+            auto & entry = m_Entries[index];
+            const auto remaining = entry.m_Expiry - m_Now;
+
+            std::size_t level = 0;
+            while ((level < (LEVELS - 1)) && (remaining >= (1u << (SLOT_BITS * (level + 1)))))
+            {
+                ++level;
+            }
+
+            entry.m_Slot = SlotOf(level, entry.m_Expiry);
+            entry.m_Previous = NIL;
+            entry.m_Next = m_Heads[entry.m_Slot];
+            if (entry.m_Next != NIL)
+            {
+                m_Entries[entry.m_Next].m_Previous = index;
+            }
+            m_Heads[entry.m_Slot] = index;
+        }
+
+        constexpr void Unlink(uint16_t index) noexcept
+        {
+            auto & entry = m_Entries[index];
+            if (entry.m_Previous != NIL)
+            {
+                m_Entries[entry.m_Previous].m_Next = entry.m_Next;
+            }
+            else
+            {
+                m_Heads[entry.m_Slot] = entry.m_Next;
+            }
+            if (entry.m_Next != NIL)
+            {
+                m_Entries[entry.m_Next].m_Previous = entry.m_Previous;
+            }
+        }
+
+        constexpr void Release(uint16_t index) noexcept
+        {
+            auto & entry = m_Entries[index];
+            ++entry.m_Generation;
+            entry.m_Next = m_Free;
+            m_Free = index;
+            --m_Size;
+        }
+
+        std::array<Entry_t, CAPACITY>        m_Entries{};
+        std::array<uint16_t, LEVELS * SLOTS> m_Heads{};
+        uint16_t                             m_Free{0};
+        std::size_t                          m_Size{0};
+        uint32_t                             m_Now{0};
+    };
+
+    // Entries expire on the very tick they are due, across cascades from
+    // levels 1 and 2; level 3 takes 2^18 ticks, too many to step through
+    // at compile time.
+    constexpr bool ExpiresOnTime()
+    {
+        TimerWheel<uint32_t, 8> wheel;
+        constexpr uint32_t DELAYS[] = {1, 63, 64, 65, 4095, 4096, 4097, 20000};
+        for (const auto delay : DELAYS)
+        {
+            if (!wheel.Schedule(delay, delay))
+            {
+                return false;
+            }
+        }
+        const auto cancelled = wheel.Schedule(10, 10);
+        if (cancelled)
+        {
+            return false; // Full.
+        }
+
+        uint32_t expired = 0;
+        bool isOnTime = true;
+        while ((wheel.Size() > 0) && (wheel.Now() < 30000))
+        {
+            wheel.Advance(1, [&](uint32_t delay)
+            {
+                isOnTime = isOnTime && (wheel.Now() == delay);
+                ++expired;
+            });
+        }
+        return isOnTime && (expired == 8) && wheel.IsEmpty();
+    }
+
+    constexpr bool CancelsInConstantTime()
+    {
+        TimerWheel<uint32_t, 4> wheel;
+        const auto first = wheel.Schedule(5, 1);
+        const auto second = wheel.Schedule(5, 2);
+        const auto third = wheel.Schedule(5, 3);
+        if (!first || !second || !third || !wheel.Cancel(*second) || wheel.Cancel(*second))
+        {
+            return false;
+        }
+
+        // The freed entry's reuse does not revive the stale handle.
+        const auto reused = wheel.Schedule(2, 4);
+        uint32_t sum = 0;
+        const auto expired = wheel.Advance(5, [&](uint32_t payload) { sum += payload; });
+        return reused && (reused->m_Index == second->m_Index) && !wheel.IsPending(*second)
+            && (expired == 3) && (sum == (1 + 3 + 4)) && !wheel.Cancel(*first);
+    }
+
+    static_assert(ExpiresOnTime());
+    static_assert(CancelsInConstantTime());
+} // end of namespace
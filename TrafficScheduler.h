@@ -0,0 +1,147 @@
+/***********************************************************************
+* @file      TrafficScheduler.h
+*
+*    Batches outgoing LightControl messages into radio wake windows.
+*
+*    In PSM (3GPP Release 12) and eDRX (Release 13) the modem only costs
+*    microamps while asleep; what drains the battery is the time spent in
+*    RRC connected mode. Every uplink packet sent on its own wakes the
+*    radio, pays for the connection setup, and then keeps it on for the
+*    network's inactivity timer (typically 5-20 s) after the last packet.
+*
+*    Outgoing messages are therefore queued, and only flushed, as one
+*    burst, once a wake window opens. Windows recur every m_Period and
+*    stay open for m_Length, from the epoch of whichever clock the caller
+*    hands in, so that a node's bursts and the modem's own periodic TAU
+*    wake-ups can be lined up with one another.
+*
+*    Light state messages carry an absolute state, not a toggle; so a
+*    message queued for a group that already has one queued supersedes it
+*    in place. The light ends up the same, with one message less on air.
+*
+* @brief
+*
+* @note    Deliberately free of any Mbed OS dependency so that the host
+*          simulator (host/RadioScheduleSimulator.cpp) can drive it from a
+*          simulated clock, and report radio-on time per hour.
+*
+* @warning Not thread-safe; owned by the context that runs the exchange.
+*
+* @author  Nuertey Odzeyem
+*
+* @date    May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+#include "LightControlCodec.h"
+
+namespace LightControl
+{
+    struct WakeSchedule_t
+    {
+        std::chrono::milliseconds m_Period{0}; // 0 disables scheduling; send at once.
+        std::chrono::milliseconds m_Length{0};
+
+        constexpr bool IsEnabled() const noexcept { return (m_Period.count() > 0); }
+
+        // Now, if a window is open now; else the start of the next one.
+        constexpr std::chrono::milliseconds WindowStart(std::chrono::milliseconds now) const noexcept
+        {
+            if (!IsEnabled())
+            {
+                return now;
+            }
+            const auto intoPeriod = now % m_Period;
+            return (intoPeriod < m_Length) ? now : (now - intoPeriod + m_Period);
+        }
+    };
+
+    enum class Enqueued_t : uint8_t
+    {
+        QUEUED,
+        COALESCED, // Superseded the message already queued for its group.
+        FULL
+    };
+
+    template <std::size_t CAPACITY>
+    class TrafficScheduler
+    {
+    public:
+        constexpr explicit TrafficScheduler(WakeSchedule_t schedule) noexcept
+            : m_Schedule(schedule)
+        {
+        }
+
+        constexpr const WakeSchedule_t & Schedule() const noexcept { return m_Schedule; }
+
+        constexpr Enqueued_t Enqueue(const Message_t & message) noexcept
+        {
+            for (std::size_t i = 0; i < m_Size; ++i)
+            {
+                auto & queued = m_Messages[(m_Head + i) % CAPACITY];
+                if (queued.m_Group == message.m_Group)
+                {
+                    queued.m_State = message.m_State;
+                    ++m_CoalescedCount;
+                    return Enqueued_t::COALESCED;
+                }
+            }
+
+            if (m_Size == CAPACITY)
+            {
+                ++m_DroppedCount;
+                return Enqueued_t::FULL;
+            }
+
+            m_Messages[(m_Head + m_Size++) % CAPACITY] = message;
+            return Enqueued_t::QUEUED;
+        }
+
+        // When the queue ought to be flushed next, if there is anything in it.
+        constexpr std::optional<std::chrono::milliseconds> NextFlush(std::chrono::milliseconds now) const noexcept
+        {
+            if (m_Size == 0)
+            {
+                return std::nullopt;
+            }
+            return m_Schedule.WindowStart(now);
+        }
+
+        constexpr const Message_t & Front() const noexcept { return m_Messages[m_Head]; }
+
+        constexpr void Pop() noexcept
+        {
+            if (m_Size > 0)
+            {
+                m_Head = (m_Head + 1) % CAPACITY;
+                --m_Size;
+            }
+        }
+
+        constexpr std::size_t Size() const noexcept { return m_Size; }
+        constexpr bool IsEmpty() const noexcept { return (m_Size == 0); }
+        constexpr uint32_t CoalescedCount() const noexcept { return m_CoalescedCount; }
+        constexpr uint32_t DroppedCount() const noexcept { return m_DroppedCount; }
+
+    private:
+        WakeSchedule_t                    m_Schedule;
+        std::array<Message_t, CAPACITY>   m_Messages{};
+        std::size_t                       m_Head{0};
+        std::size_t                       m_Size{0};
+        uint32_t                          m_CoalescedCount{0};
+        uint32_t                          m_DroppedCount{0};
+    };
+
+    static_assert(WakeSchedule_t{std::chrono::milliseconds(60000), std::chrono::milliseconds(5000)}
+                  .WindowStart(std::chrono::milliseconds(62000)) == std::chrono::milliseconds(62000));
+    static_assert(WakeSchedule_t{std::chrono::milliseconds(60000), std::chrono::milliseconds(5000)}
+                  .WindowStart(std::chrono::milliseconds(65000)) == std::chrono::milliseconds(120000));
+    static_assert(WakeSchedule_t{}.WindowStart(std::chrono::milliseconds(65000)) == std::chrono::milliseconds(65000));
+} // end of namespace
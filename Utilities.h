@@ -29,64 +29,148 @@
 #include <utility> 
 #include <type_traits>
 #include <algorithm>
+#include <atomic>
+#include <bitset>
 #include <functional>
+#include <iterator>
 #include <optional>
-#include <map>
 #include <string>
 
 #include "nsapi_types.h"
 
-using ErrorCodesMap_t = std::map<nsapi_error_t, std::string>;
-using IndexElement_t  = ErrorCodesMap_t::value_type;
+// Compile-time catalog of error and status codes; one shared copy in flash,
+// built by the compiler rather than at static initialization, and looked
+// up without a single allocation. Entries are kept sorted by code.
+struct ErrorCode_t
+{
+    int          m_Code;
+    const char * m_pText;
+};
+
+inline constexpr ErrorCode_t NSAPI_ERROR_CODES[] =
+{
+    {NSAPI_ERROR_BUSY,               "\"device is busy and cannot accept new operation\""},
+    {NSAPI_ERROR_TIMEOUT,            "\"operation timed out\""},
+    {NSAPI_ERROR_ADDRESS_IN_USE,     "\"Address already in use\""},
+    {NSAPI_ERROR_CONNECTION_TIMEOUT, "\"connection timed out\""},
+    {NSAPI_ERROR_CONNECTION_LOST,    "\"connection lost\""},
+    {NSAPI_ERROR_IS_CONNECTED,       "\"socket is already connected\""},
+    {NSAPI_ERROR_ALREADY,            "\"operation (eg connect) already in progress\""},
+    {NSAPI_ERROR_IN_PROGRESS,        "\"operation (eg connect) in progress\""},
+    {NSAPI_ERROR_DEVICE_ERROR,       "\"failure interfacing with the network processor\""},
+    {NSAPI_ERROR_AUTH_FAILURE,       "\"connection to access point failed\""},
+    {NSAPI_ERROR_DHCP_FAILURE,       "\"DHCP failed to complete successfully\""},
+    {NSAPI_ERROR_DNS_FAILURE,        "\"DNS failed to complete successfully\""},
+    {NSAPI_ERROR_NO_SSID,            "\"ssid not found\""},
+    {NSAPI_ERROR_NO_MEMORY,          "\"memory resource not available\""},
+    {NSAPI_ERROR_NO_ADDRESS,         "\"IP address is not known\""},
+    {NSAPI_ERROR_NO_SOCKET,          "\"socket not available for use\""},
+    {NSAPI_ERROR_NO_CONNECTION,      "\"not connected to a network\""},
+    {NSAPI_ERROR_PARAMETER,          "\"invalid configuration\""},
+    {NSAPI_ERROR_UNSUPPORTED,        "\"unsupported functionality\""},
+    {NSAPI_ERROR_WOULD_BLOCK,        "\"no data is not available but call is non-blocking\""},
+    {NSAPI_ERROR_OK,                 "\"no error\""}
+};
+
+// The cellular framework's events, i.e. cellular_connection_status_t, as
+// handed to the network status callback; values as of Mbed OS 6.15.
+inline constexpr int CELLULAR_SIM_STATUS_CHANGED_EVENT{NSAPI_EVENT_CELLULAR_STATUS_BASE + 1};
+inline constexpr int CELLULAR_REGISTRATION_STATUS_CHANGED_EVENT{NSAPI_EVENT_CELLULAR_STATUS_BASE + 2};
+
+inline constexpr ErrorCode_t CELLULAR_EVENT_CODES[] =
+{
+    {NSAPI_EVENT_CELLULAR_STATUS_BASE + 0,  "\"CellularDeviceReady\""},
+    {NSAPI_EVENT_CELLULAR_STATUS_BASE + 1,  "\"CellularSIMStatusChanged\""},
+    {NSAPI_EVENT_CELLULAR_STATUS_BASE + 2,  "\"CellularRegistrationStatusChanged\""},
+    {NSAPI_EVENT_CELLULAR_STATUS_BASE + 3,  "\"CellularRegistrationTypeChanged\""},
+    {NSAPI_EVENT_CELLULAR_STATUS_BASE + 4,  "\"CellularCellIDChanged\""},
+    {NSAPI_EVENT_CELLULAR_STATUS_BASE + 5,  "\"CellularRadioAccessTechnologyChanged\""},
+    {NSAPI_EVENT_CELLULAR_STATUS_BASE + 6,  "\"CellularAttachNetwork\""},
+    {NSAPI_EVENT_CELLULAR_STATUS_BASE + 7,  "\"CellularActivatePDPContext\""},
+    {NSAPI_EVENT_CELLULAR_STATUS_BASE + 8,  "\"CellularSignalQuality\""},
+    {NSAPI_EVENT_CELLULAR_STATUS_BASE + 9,  "\"CellularStateRetryEvent\""},
+    {NSAPI_EVENT_CELLULAR_STATUS_BASE + 10, "\"CellularDeviceTimeout\""}
+};
+
+// cell_callback_data_t::status_data of a CellularRegistrationStatusChanged,
+// i.e. CellularNetwork::RegistrationStatus.
+inline constexpr ErrorCode_t CELLULAR_REGISTRATION_CODES[] =
+{
+    {-1, "\"registration status not available\""},
+    {0,  "\"not registered\""},
+    {1,  "\"registered, home network\""},
+    {2,  "\"searching network\""},
+    {3,  "\"registration denied\""},
+    {4,  "\"registration status unknown\""},
+    {5,  "\"registered, roaming\""},
+    {6,  "\"registered for SMS only, home network\""},
+    {7,  "\"registered for SMS only, roaming\""},
+    {8,  "\"attached for emergency bearer services only\""},
+    {9,  "\"registered for CSFB not preferred, home network\""},
+    {10, "\"registered for CSFB not preferred, roaming\""},
+    {11, "\"already registered\""}
+};
+
+// ...and that of a CellularSIMStatusChanged, i.e. CellularDevice::SimState.
+inline constexpr ErrorCode_t CELLULAR_SIM_CODES[] =
+{
+    {0, "\"SIM ready\""},
+    {1, "\"SIM PIN needed\""},
+    {2, "\"SIM PUK needed\""},
+    {3, "\"SIM state unknown\""}
+};
+
+template <std::size_t N>
+constexpr bool IsSortedByCode(const ErrorCode_t (& catalog)[N])
+{
+    return std::is_sorted(std::begin(catalog), std::end(catalog), 
+        [](const ErrorCode_t & lhs, const ErrorCode_t & rhs) { return lhs.m_Code < rhs.m_Code; });
+}
+
+static_assert(IsSortedByCode(NSAPI_ERROR_CODES), "NSAPI_ERROR_CODES must be sorted by code.");
+static_assert(IsSortedByCode(CELLULAR_EVENT_CODES), "CELLULAR_EVENT_CODES must be sorted by code.");
+static_assert(IsSortedByCode(CELLULAR_REGISTRATION_CODES), "CELLULAR_REGISTRATION_CODES must be sorted by code.");
+static_assert(IsSortedByCode(CELLULAR_SIM_CODES), "CELLULAR_SIM_CODES must be sorted by code.");
 
-inline static auto make_error_codes_map()
+template <std::size_t N>
+constexpr const char * LookUp(const ErrorCode_t (& catalog)[N], int code, const char * pUnknown)
 {
-    ErrorCodesMap_t eMap;
+    const auto iter = std::lower_bound(std::begin(catalog), std::end(catalog), code, 
+        [](const ErrorCode_t & entry, int key) { return entry.m_Code < key; });
     
-    eMap.insert(IndexElement_t(NSAPI_ERROR_OK, std::string("\"no error\"")));
-    eMap.insert(IndexElement_t(NSAPI_ERROR_WOULD_BLOCK, std::string("\"no data is not available but call is non-blocking\"")));
-    eMap.insert(IndexElement_t(NSAPI_ERROR_UNSUPPORTED, std::string("\"unsupported functionality\"")));
-    eMap.insert(IndexElement_t(NSAPI_ERROR_PARAMETER, std::string("\"invalid configuration\"")));
-    eMap.insert(IndexElement_t(NSAPI_ERROR_NO_CONNECTION, std::string("\"not connected to a network\"")));
-    eMap.insert(IndexElement_t(NSAPI_ERROR_NO_SOCKET, std::string("\"socket not available for use\"")));
-    eMap.insert(IndexElement_t(NSAPI_ERROR_NO_ADDRESS, std::string("\"IP address is not known\"")));
-    eMap.insert(IndexElement_t(NSAPI_ERROR_NO_MEMORY, std::string("\"memory resource not available\"")));
-    eMap.insert(IndexElement_t(NSAPI_ERROR_NO_SSID, std::string("\"ssid not found\"")));
-    eMap.insert(IndexElement_t(NSAPI_ERROR_DNS_FAILURE, std::string("\"DNS failed to complete successfully\"")));
-    eMap.insert(IndexElement_t(NSAPI_ERROR_DHCP_FAILURE, std::string("\"DHCP failed to complete successfully\"")));
-    eMap.insert(IndexElement_t(NSAPI_ERROR_AUTH_FAILURE, std::string("\"connection to access point failed\"")));
-    eMap.insert(IndexElement_t(NSAPI_ERROR_DEVICE_ERROR, std::string("\"failure interfacing with the network processor\"")));
-    eMap.insert(IndexElement_t(NSAPI_ERROR_IN_PROGRESS, std::string("\"operation (eg connect) in progress\"")));
-    eMap.insert(IndexElement_t(NSAPI_ERROR_ALREADY, std::string("\"operation (eg connect) already in progress\"")));
-    eMap.insert(IndexElement_t(NSAPI_ERROR_IS_CONNECTED, std::string("\"socket is already connected\"")));
-    eMap.insert(IndexElement_t(NSAPI_ERROR_CONNECTION_LOST, std::string("\"connection lost\"")));
-    eMap.insert(IndexElement_t(NSAPI_ERROR_CONNECTION_TIMEOUT, std::string("\"connection timed out\"")));
-    eMap.insert(IndexElement_t(NSAPI_ERROR_ADDRESS_IN_USE, std::string("\"Address already in use\"")));
-    eMap.insert(IndexElement_t(NSAPI_ERROR_TIMEOUT, std::string("\"operation timed out\"")));    
-    return eMap;
+    return ((iter != std::end(catalog)) && (iter->m_Code == code)) ? iter->m_pText : pUnknown;
 }
 
-static ErrorCodesMap_t gs_ErrorCodesMap = make_error_codes_map();
+constexpr const char * ToString(const nsapi_error_t & key)
+{
+    return LookUp(NSAPI_ERROR_CODES, key, 
+        "\"Warning! Code does not indicate an error and consequently does not exist in NSAPI_ERROR_CODES!\"");
+}
 
-inline std::string ToString(const nsapi_error_t & key)
+// Of a network status callback's event, for NSAPI_EVENT_CELLULAR_STATUS_BASE
+// and on; should the event be a status change, statusData is also named.
+constexpr const char * CellularEventToString(int event)
 {
-    std::string result;
+    return LookUp(CELLULAR_EVENT_CODES, event, "\"unknown cellular event\"");
+}
 
-    // Prevent the possibility of std::out_of_range exception if the container
-    // does not have an error element with the specified key.
-    auto iter = gs_ErrorCodesMap.find(key);     
-    if (iter != gs_ErrorCodesMap.end())
+constexpr const char * CellularStatusToString(int event, int statusData)
+{
+    if (event == CELLULAR_SIM_STATUS_CHANGED_EVENT)
     {
-        result = iter->second;
+        return LookUp(CELLULAR_SIM_CODES, statusData, "\"unknown SIM state\"");
     }
-    else
+    else if (event == CELLULAR_REGISTRATION_STATUS_CHANGED_EVENT)
     {
-        result = std::string("\"Warning! Code does not indicate an error and consequently does not exist in gs_ErrorCodesMap!\"");
+        return LookUp(CELLULAR_REGISTRATION_CODES, statusData, "\"unknown registration status\"");
     }
-    
-    return result;
+    return "\"\"";
 }
-    
+
+// Every nsapi_error_t there is, NSAPI_ERROR_WOULD_BLOCK down to NSAPI_ERROR_BUSY, is named.
+static_assert(std::size(NSAPI_ERROR_CODES) == (2 + NSAPI_ERROR_WOULD_BLOCK - NSAPI_ERROR_BUSY)
+           && (NSAPI_ERROR_CODES[0].m_Code == NSAPI_ERROR_BUSY), "NSAPI_ERROR_CODES is missing a code.");
+
 namespace Utilities
 {
     const auto GetNetworkInterfaceProfile = [](NetworkInterface * pInterface)
@@ -155,7 +239,7 @@ namespace Utilities
                 nsapi_error_t retVal = pInterface->gethostbyname(address.c_str(), pTheSocketAddress);
                 if (retVal < 0)
                 {
-                    printf("Error! On DNS lookup, Network returned: [%d] -> %s\n", retVal, ToString(retVal).c_str());
+                    printf("Error! On DNS lookup, Network returned: [%d] -> %s\n", retVal, ToString(retVal));
                 }
                 else
                 {
@@ -0,0 +1,405 @@
+/***********************************************************************
+* @file      Benchmark.cpp
+*
+*    Host benchmark suite for the LightControl hot path:
+*
+*    1. Message formatting, as in Send(): LightControl::Encode() in both
+*       wire formats, against the original snprintf() formatting.
+*    2. ParseAndConsumeLightControlMessage() throughput on valid and on
+*       malformed input, against the original std::string based parser.
+*    3. ToString(nsapi_error_t) lookup cost.
+*    4. Event dispatch: posting and dispatching one event on the shared
+*       event queue (the host shim thereof; indicative only).
+*    5. End-to-end round trips through the unmodified blocking Run()
+*       loop, against an in-process loopback echo server.
+*    6. Scheduled light actions: scheduling and cancelling one, and
+*       expiring them, on the timer wheel with 100, 1000 and 10000
+*       pending; against call_in()/cancel() on the event queue.
+*
+*    Results go to stdout as JSON Lines, one object per benchmark, so that
+*    they can be diffed and checked for hot-path regressions in CI:
+*
+*    {"benchmark":"parse/consume/text","iterations":N,"ns_per_op":X,"ops_per_second":Y}
+*
+*    Everything else that the application prints is discarded.
+*
+* @brief   Usage: Benchmark [end-to-end seconds=2]
+*
+* @note    The original snprintf()/std::string code is reproduced here,
+*          minus its printf()s, purely as a baseline to compare against.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <memory>
+#include <random>
+#include <thread>
+
+#include "LEDLightControl.h"
+
+MCUTarget_t g_MCUTarget{MCUTarget_t::NUCLEO_F767ZI};
+
+namespace
+{
+    // Exposes the protected parser, exactly as the exchange calls it.
+    class BenchmarkLightControl : public LEDLightControl
+    {
+    public:
+        using LEDLightControl::ParseAndConsumeLightControlMessage;
+    };
+
+    // One instance only: ~LEDLightControl() breaks the shared event queue's
+    // dispatch, which would cut the end-to-end benchmark short.
+    BenchmarkLightControl * g_pBenchmarkLightControl = new BenchmarkLightControl();
+} // end of anonymous namespace
+
+LEDLightControl * g_pLEDLightControlManager = g_pBenchmarkLightControl;
+
+namespace
+{
+    constexpr auto MINIMUM_DURATION = std::chrono::milliseconds(200);
+
+    FILE * g_pResults = nullptr;
+
+    // Keeps the compiler from optimizing away a result that is never used.
+    template <typename T>
+    inline void DoNotOptimize(const T & value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    void Emit(const char * pName, uint64_t iterations, double nanosecondsPerOperation)
+    {
+        fprintf(g_pResults, "{\"benchmark\":\"%s\",\"iterations\":%llu,\"ns_per_op\":%.2f,\"ops_per_second\":%.0f}\n",
+            pName, static_cast<unsigned long long>(iterations), nanosecondsPerOperation,
+            (nanosecondsPerOperation > 0.0) ? (1e9 / nanosecondsPerOperation) : 0.0);
+        fflush(g_pResults);
+    }
+
+    // Runs operation(i) in ever larger batches until MINIMUM_DURATION has
+    // been spent on it, and emits the mean cost of one operation.
+    template <typename Operation>
+    void Measure(const char * pName, Operation && operation)
+    {
+        uint64_t iterations = 0;
+        uint64_t batch = 64;
+        std::chrono::steady_clock::duration elapsed{};
+
+        while (elapsed < MINIMUM_DURATION)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            for (uint64_t i = 0; i < batch; ++i)
+            {
+                operation(iterations + i);
+            }
+            elapsed += std::chrono::steady_clock::now() - start;
+            iterations += batch;
+            batch *= 2;
+        }
+
+        Emit(pName, iterations, std::chrono::duration<double, std::nano>(elapsed).count() / iterations);
+    }
+
+    // The original Send() formatting.
+    int LegacyFormat(char * pBuffer, std::size_t size, bool state)
+    {
+        memset(pBuffer, 0, size);
+        return std::snprintf(pBuffer, size, "t:lights;g:%03d;s:%s;", 1, (state ? "1" : "0")) + 1;
+    }
+
+    // The original std::string based ParseAndConsumeLightControlMessage().
+    bool LegacyParse(std::string & s, const std::string & delimiter)
+    {
+        auto result = false;
+        size_t pos = 0;
+        std::string token;
+        if ((pos = s.find(delimiter)) != std::string::npos)
+        {
+            token = s.substr(0, pos);
+            if (!token.compare("t:lights"))
+            {
+                s.erase(0, pos + delimiter.length());
+                if ((pos = s.find(delimiter)) != std::string::npos)
+                {
+                    token = s.substr(0, pos);
+                    if (!token.compare("g:001"))
+                    {
+                        s.erase(0, pos + delimiter.length());
+                        if ((pos = s.find(delimiter)) != std::string::npos)
+                        {
+                            token = s.substr(0, pos);
+                            result = (!token.compare("s:0") || !token.compare("s:1"));
+                        }
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+    void BenchmarkFormatting()
+    {
+        char buffer[40];
+
+        Measure("format/snprintf/legacy", [&buffer](uint64_t i)
+        {
+            DoNotOptimize(LegacyFormat(buffer, sizeof(buffer), (i & 1)));
+            DoNotOptimize(buffer);
+        });
+
+        const auto encode = [&buffer](LightControl::WireFormat_t format, bool withSequence)
+        {
+            return [&buffer, format, withSequence](uint64_t i)
+            {
+                LightControl::Message_t message{1, static_cast<bool>(i & 1)};
+                if (withSequence)
+                {
+                    message.m_Sequence = static_cast<uint8_t>(i);
+                }
+                DoNotOptimize(LightControl::Encode(format, message, buffer));
+                DoNotOptimize(buffer);
+            };
+        };
+        Measure("format/encode/text", encode(LightControl::WireFormat_t::TEXT, false));
+        Measure("format/encode/text_sequence", encode(LightControl::WireFormat_t::TEXT, true));
+        Measure("format/encode/binary", encode(LightControl::WireFormat_t::BINARY, false));
+        Measure("format/encode/binary_sequence", encode(LightControl::WireFormat_t::BINARY, true));
+    }
+
+    void BenchmarkParsing()
+    {
+        // Received as on the wire: NUL terminated text, or binary.
+        struct Input_t
+        {
+            const char *     m_pName;
+            const char *     m_pLegacyName;
+            std::string_view m_Message;
+        };
+
+        static constexpr char BINARY_MESSAGE[] = {static_cast<char>(0xB0 | 0x80), 0x00, 0x01};
+
+        const Input_t inputs[] =
+        {
+            {"parse/consume/text",                  "parse/legacy/text",                  {"t:lights;g:001;s:1;", 20}},
+            {"parse/consume/text_sequence",         nullptr,                              {"t:lights;g:001;s:0;q:042;", 26}},
+            {"parse/consume/binary",                nullptr,                              {BINARY_MESSAGE, sizeof(BINARY_MESSAGE)}},
+            {"parse/consume/malformed_type",        "parse/legacy/malformed_type",        {"t:light5;g:001;s:1;", 20}},
+            {"parse/consume/malformed_group",       "parse/legacy/malformed_group",       {"t:lights;g:0x1;s:1;", 20}},
+            {"parse/consume/malformed_state",       "parse/legacy/malformed_state",       {"t:lights;g:001;s:2;", 20}},
+            {"parse/consume/truncated",             "parse/legacy/truncated",             {"t:lights;g:0", 12}},
+            {"parse/consume/group_not_subscribed",  "parse/legacy/group_not_subscribed",  {"t:lights;g:002;s:1;", 20}},
+        };
+
+        for (const auto & input : inputs)
+        {
+            Measure(input.m_pName, [&input](uint64_t)
+            {
+                DoNotOptimize(g_pBenchmarkLightControl->ParseAndConsumeLightControlMessage(input.m_Message));
+            });
+
+            if (input.m_pLegacyName)
+            {
+                const std::string delimiter = ";";
+                Measure(input.m_pLegacyName, [&input, &delimiter](uint64_t)
+                {
+                    // The original built this std::string out of every recv().
+                    std::string s(input.m_Message);
+                    DoNotOptimize(LegacyParse(s, delimiter));
+                });
+            }
+        }
+    }
+
+    void BenchmarkErrorStrings()
+    {
+        static constexpr nsapi_error_t CODES[] =
+        {
+            NSAPI_ERROR_WOULD_BLOCK, NSAPI_ERROR_NO_SOCKET, NSAPI_ERROR_NO_CONNECTION,
+            NSAPI_ERROR_CONNECTION_TIMEOUT, NSAPI_ERROR_ADDRESS_IN_USE, NSAPI_ERROR_BUSY
+        };
+
+        Measure("tostring/nsapi_error", [](uint64_t i)
+        {
+            DoNotOptimize(ToString(CODES[i % std::size(CODES)]));
+        });
+        Measure("tostring/nsapi_error_unknown", [](uint64_t i)
+        {
+            DoNotOptimize(ToString(static_cast<nsapi_error_t>(1 + (i & 7))));
+        });
+    }
+
+    void BenchmarkEventDispatch()
+    {
+        EventQueue queue;
+        uint64_t dispatched = 0;
+
+        Measure("dispatch/event_queue/call", [&queue, &dispatched](uint64_t)
+        {
+            queue.call([&dispatched]() { ++dispatched; });
+            queue.dispatch_once();
+        });
+        DoNotOptimize(dispatched);
+    }
+
+    void BenchmarkTimerWheel()
+    {
+        using Wheel_t = LightControl::TimerWheel<uint16_t, 16384>;
+        constexpr std::size_t PENDING[] = {100, 1000, 10000};
+        char name[64];
+
+        for (const auto pending : PENDING)
+        {
+            // Spread over every level of the wheel, up to 2^20 ticks ahead.
+            std::mt19937 random(pending);
+            const auto delay = [&random](uint32_t span) { return 1 + (random() % span); };
+
+            auto pWheel = std::make_unique<Wheel_t>();
+            for (std::size_t i = 0; i < pending; ++i)
+            {
+                pWheel->Schedule(delay(1u << 20), static_cast<uint16_t>(i));
+            }
+
+            snprintf(name, sizeof(name), "timer_wheel/schedule_cancel/%zu", pending);
+            Measure(name, [&](uint64_t i)
+            {
+                const auto handle = pWheel->Schedule(delay(1u << 20), static_cast<uint16_t>(i));
+                DoNotOptimize(pWheel->Cancel(*handle));
+            });
+
+            // Steady state: every expiry schedules its successor, within
+            // 4096 ticks, so that each tick has about pending/2048 due.
+            pWheel = std::make_unique<Wheel_t>();
+            for (std::size_t i = 0; i < pending; ++i)
+            {
+                pWheel->Schedule(delay(4096), static_cast<uint16_t>(i));
+            }
+            uint64_t expired = 0;
+            const auto start = std::chrono::steady_clock::now();
+            while ((std::chrono::steady_clock::now() - start) < MINIMUM_DURATION)
+            {
+                expired += pWheel->Advance(4096, [&](uint16_t payload)
+                {
+                    pWheel->Schedule(delay(4096), payload);
+                });
+            }
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            snprintf(name, sizeof(name), "timer_wheel/expire/%zu", pending);
+            Emit(name, expired, std::chrono::duration<double, std::nano>(elapsed).count() / std::max<uint64_t>(expired, 1));
+
+            EventQueue queue;
+            for (std::size_t i = 0; i < pending; ++i)
+            {
+                queue.call_in(std::chrono::milliseconds(3600000 + delay(1u << 20)), []() {});
+            }
+            snprintf(name, sizeof(name), "event_queue/call_in_cancel/%zu", pending);
+            Measure(name, [&](uint64_t)
+            {
+                const auto id = queue.call_in(std::chrono::milliseconds(3600000 + delay(1u << 20)), []() {});
+                DoNotOptimize(queue.cancel(id));
+            });
+        }
+    }
+
+    // A minimal TCP echo server on ECHO_PORT, for the end-to-end benchmark.
+    void EchoForever(int listener)
+    {
+        for (;;)
+        {
+            const int connection = accept(listener, nullptr, nullptr);
+            if (connection < 0)
+            {
+                return;
+            }
+            std::thread([connection]()
+            {
+                char buffer[4096];
+                ssize_t count;
+                while ((count = recv(connection, buffer, sizeof(buffer), 0)) > 0)
+                {
+                    if (send(connection, buffer, count, MSG_NOSIGNAL) != count)
+                    {
+                        break;
+                    }
+                }
+                close(connection);
+            }).detach();
+        }
+    }
+
+    void BenchmarkRoundTrips(std::chrono::seconds duration)
+    {
+        const int listener = socket(AF_INET, SOCK_STREAM, 0);
+        const int reuse = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(ECHO_PORT);
+        if ((bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+            || (listen(listener, 4) != 0))
+        {
+            fprintf(stderr, "Error! Cannot listen on port %d; is an EchoServer already running?\n", ECHO_PORT);
+            close(listener);
+            return;
+        }
+        std::thread(EchoForever, listener).detach();
+
+        // Plays the part of the link going down, which ends Run().
+        std::thread stopper([duration]()
+        {
+            std::this_thread::sleep_for(duration);
+            g_IsConnected = false;
+            g_pSharedEventQueue->break_dispatch();
+        });
+
+        g_pLEDLightControlManager->SetPipelineWindow(1);
+        g_pLEDLightControlManager->SetNonBlocking(false);
+        g_pLEDLightControlManager->Setup<TransportScheme_t::ETHERNET, TransportSocket_t::TCP>();
+        stopper.join();
+
+        const auto statistics = g_pLEDLightControlManager->GetStats();
+        const auto roundTrips = statistics.m_RoundTripTime.Count();
+        Emit("e2e/run/tcp_round_trip", roundTrips,
+            (roundTrips > 0) ? (std::chrono::duration<double, std::nano>(duration).count() / roundTrips) : 0.0);
+
+        fprintf(g_pResults, "{\"benchmark\":\"e2e/run/tcp_round_trip_latency\",\"iterations\":%lu,"
+            "\"mean_us\":%lu,\"p50_us_at_most\":%lu,\"p99_us_at_most\":%lu,\"max_us\":%lu}\n",
+            static_cast<unsigned long>(roundTrips), static_cast<unsigned long>(statistics.m_RoundTripTime.Mean()),
+            static_cast<unsigned long>(statistics.m_RoundTripTime.Percentile(0.50)),
+            static_cast<unsigned long>(statistics.m_RoundTripTime.Percentile(0.99)),
+            static_cast<unsigned long>(statistics.m_RoundTripTime.Maximum()));
+        fflush(g_pResults);
+    }
+} // end of anonymous namespace
+
+int main(int argc, char * argv[])
+{
+    const auto duration = std::chrono::seconds((argc > 1) ? std::atoi(argv[1]) : 2);
+
+    // Results keep the real stdout; the application's own output is dropped.
+    g_pResults = fdopen(dup(STDOUT_FILENO), "w");
+    if (!g_pResults || !freopen("/dev/null", "w", stdout))
+    {
+        fprintf(stderr, "Error! Cannot redirect stdout.\n");
+        return 1;
+    }
+
+    BenchmarkFormatting();
+    BenchmarkParsing();
+    BenchmarkErrorStrings();
+    BenchmarkEventDispatch();
+    BenchmarkTimerWheel();
+    BenchmarkRoundTrips(duration);
+
+    delete g_pLEDLightControlManager;
+    fclose(g_pResults);
+    return 0;
+}
@@ -0,0 +1,116 @@
+/***********************************************************************
+* @file      CodecSizes.cpp
+*
+*    Host check of the bytes on air per LightControl command, in either
+*    wire format. Every combination of the optional fields, i.e. with and
+*    without q: (sequence), l: (level), d: (transition) and x: (execute
+*    at), is encoded through the very Encode() that Send() uses, decoded
+*    back through Decode(), and reported as one row of:
+*
+*    fields          text  binary  saved  text+UDP/IPv4  binary+UDP/IPv4
+*
+*    where the last two columns add the 28 bytes of UDP and IPv4 headers
+*    that every datagram pays for on top (uncompressed, i.e. without ROHC).
+*
+* @brief   Usage: CodecSizes
+*
+* @note    Exits with 1 should any message not encode to EncodedSize()
+*          bytes, or not decode back to the very message encoded.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#include <cstdio>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+#include "LightControlCodec.h"
+
+namespace
+{
+    using namespace LightControl;
+
+    constexpr std::size_t UDP_IPV4_HEADER_SIZE{28};
+
+    struct Field_t
+    {
+        const char * m_pName;
+        void (*m_Set)(Message_t & message);
+    };
+
+    constexpr Field_t OPTIONAL_FIELDS[] =
+    {
+        {"q:", [](Message_t & message) { message.m_Sequence = 42; }},
+        {"l:", [](Message_t & message) { message.m_Level = 128; }},
+        {"d:", [](Message_t & message) { message.m_TransitionMilliseconds = 1500; }},
+        {"x:", [](Message_t & message) { message.m_ExecuteAt = 123456789; }},
+    };
+
+    constexpr std::size_t FIELD_COMBINATIONS{1u << std::size(OPTIONAL_FIELDS)};
+
+    bool IsSame(const Message_t & received, const Message_t & sent)
+    {
+        return (received.m_Group == sent.m_Group) && (received.m_State == sent.m_State)
+            && (received.m_Sequence == sent.m_Sequence) && (received.m_ExecuteAt == sent.m_ExecuteAt)
+            && (received.m_ControllerTime == sent.m_ControllerTime) && (received.m_Level == sent.m_Level)
+            && (received.m_TransitionMilliseconds == sent.m_TransitionMilliseconds);
+    }
+
+    // Bytes on the wire for the message, or 0 should it not round trip.
+    std::size_t EncodedBytes(WireFormat_t format, const Message_t & message)
+    {
+        char encoded[MAXIMUM_ENCODED_SIZE];
+        const auto length = Encode(format, message, encoded);
+        const auto decoded = Decode(std::string_view(encoded, length));
+
+        if ((length == 0) || (length != EncodedSize(format, message)) || !decoded
+            || !IsSame(decoded.m_Message, message))
+        {
+            fprintf(stderr, "Error! %s message of group %u failed to round trip.\n",
+                ToString(format), static_cast<unsigned>(message.m_Group));
+            return 0;
+        }
+        return length;
+    }
+} // end of anonymous namespace
+
+int main()
+{
+    bool isPassed = true;
+
+    printf("%-20s %5s %7s %6s %14s %16s\n", "fields", "text", "binary", "saved", "text+UDP/IPv4", "binary+UDP/IPv4");
+
+    for (std::size_t combination = 0; combination < FIELD_COMBINATIONS; ++combination)
+    {
+        Message_t message{1, true};
+        std::string fields("t: g: s:");
+        for (std::size_t field = 0; field < std::size(OPTIONAL_FIELDS); ++field)
+        {
+            if (combination & (1u << field))
+            {
+                OPTIONAL_FIELDS[field].m_Set(message);
+                fields += ' ';
+                fields += OPTIONAL_FIELDS[field].m_pName;
+            }
+        }
+
+        const auto text = EncodedBytes(WireFormat_t::TEXT, message);
+        const auto binary = EncodedBytes(WireFormat_t::BINARY, message);
+        isPassed = isPassed && (text > 0) && (binary > 0);
+
+        printf("%-20s %5zu %7zu %5.0f%% %14zu %16zu\n", fields.c_str(), text, binary,
+            (text > 0) ? (100.0 * static_cast<double>(text - binary) / static_cast<double>(text)) : 0.0,
+            text + UDP_IPV4_HEADER_SIZE, binary + UDP_IPV4_HEADER_SIZE);
+    }
+
+    if (!isPassed)
+    {
+        fprintf(stderr, "Error! Messages failed to round trip.\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,755 @@
+/***********************************************************************
+* @file      ControlServer.cpp
+*
+*    The control-plane counterpart of LEDLightControl: a LightControl
+*    server that devices connect to instead of a generic echo server, and
+*    through which an operator switches whole groups of lights at once.
+*
+*    Towards the devices it is a drop-in for the echo server, over TCP and
+*    UDP alike: wire format negotiations and LightControl messages are
+*    answered with themselves, so that a device's lock-step or pipelined
+*    exchange, and its datagram reliability, work unchanged. Each message
+*    also tells the server which group the device is in; the server keeps
+*    a group -> connection index from those, per worker thread, in one
+*    flat array over the whole 000-999 group range.
+*
+*    A device that asks for its reply to be stamped ("c:0000000000", see
+*    ClockSync.h) gets it back with the server's clock instead: the host's
+*    system clock, in milliseconds since the epoch modulo 2^32. So an
+*    operator on any NTP-synchronized host can stamp commands with the
+*    time at which they are to take effect ("x:"), for every device of
+*    the group to switch at that same instant.
+*
+*    Towards the operator it listens on a control port (UDP) for ordinary
+*    LightControl messages, each a command to push to every device of that
+*    group, or of every group for the master group 000. A command is acked
+*    with itself once it has been handed to every worker.
+*
+*    Every worker runs its own epoll loop over its own SO_REUSEPORT
+*    listening and datagram sockets, so that neither connections nor the
+*    group index are shared between threads. Writes are batched: replies
+*    and pushes are only queued as they arise, and at the end of each pass
+*    of the loop every connection gets one send() for all that it is owed,
+*    and the datagrams go out, up to 64 at a time, in one sendmmsg(). A
+*    push is encoded once per wire format, never once per device.
+*
+*    Messages are framed and parsed by the very codec and stream framer
+*    that the device uses (LightControlCodec.h, LightControlFramer.h).
+*
+* @brief   Usage: ControlServer [port=7007] [control port=7070] [threads=all cores]
+*
+* @note    A device that reads a pushed command while one of its own
+*          messages is in flight takes it for that message's reply (both
+*          are applied); that costs it at worst an unmatched reply.
+*
+* @warning UDP devices are forgotten after PEER_IDLE_TIMEOUT without a
+*          message; their regular exchange keeps them registered.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "LightControlFramer.h"
+#include "LightControlGroups.h"
+
+namespace
+{
+    using namespace LightControl;
+    using Clock_t = std::chrono::steady_clock;
+
+    constexpr auto PEER_IDLE_TIMEOUT = std::chrono::minutes(5);
+
+    // A device that does not drain this much of what it is owed is cut off.
+    constexpr std::size_t MAXIMUM_PENDING_OUTPUT{64 * 1024};
+
+    constexpr std::size_t DATAGRAM_BATCH_SIZE{64};
+
+    // Tags of the epoll registrations other than those of connections.
+    constexpr uint64_t LISTENER_TAG{~0ull};
+    constexpr uint64_t DATAGRAM_TAG{~0ull - 1};
+    constexpr uint64_t MAILBOX_TAG{~0ull - 2};
+
+    // Never CONTROLLER_TIME_REQUEST, which is what asks for a stamp.
+    uint32_t ControllerMilliseconds()
+    {
+        const auto now = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                             std::chrono::system_clock::now().time_since_epoch()).count());
+        return (now == CONTROLLER_TIME_REQUEST) ? (now + 1) : now;
+    }
+
+    struct Counters_t
+    {
+        std::atomic<uint64_t> m_Connections{0};
+        std::atomic<uint64_t> m_DatagramPeers{0};
+        std::atomic<uint64_t> m_MessagesIn{0};
+        std::atomic<uint64_t> m_Malformed{0};
+        std::atomic<uint64_t> m_Stamped{0};
+        std::atomic<uint64_t> m_Pushes{0};
+        std::atomic<uint64_t> m_MessagesOut{0};
+        std::atomic<uint64_t> m_Writes{0};
+        std::atomic<uint64_t> m_SlowDevicesDropped{0};
+    };
+
+    // A TCP connection, or a UDP device known by its address.
+    struct Device_t
+    {
+        int                   m_Socket{-1};    // -1 for a UDP device.
+        sockaddr_in           m_Address{};
+        WireFormat_t          m_Format{WireFormat_t::TEXT};
+        bool                  m_IsQueued{false};
+        bool                  m_IsWriteBlocked{false};
+        Clock_t::time_point   m_LastHeard{};
+        std::vector<uint16_t> m_Groups;
+        std::string           m_Output;
+        std::unique_ptr<StreamFramer<256>> m_pFramer; // TCP only.
+    };
+
+    uint64_t KeyOf(const sockaddr_in & address)
+    {
+        return (static_cast<uint64_t>(address.sin_addr.s_addr) << 16) | address.sin_port;
+    }
+
+    int OpenBoundSocket(int type, uint16_t port)
+    {
+        int fd = ::socket(AF_INET, type | SOCK_NONBLOCK, 0);
+        int one = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+
+        sockaddr_in address{};
+        address.sin_family      = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port        = htons(port);
+        if (::bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+        {
+            perror("bind");
+            std::exit(EXIT_FAILURE);
+        }
+        return fd;
+    }
+
+    class Worker
+    {
+    public:
+        Worker(uint16_t port, Counters_t & counters)
+            : m_Epoll(::epoll_create1(0))
+            , m_Listener(OpenBoundSocket(SOCK_STREAM, port))
+            , m_Datagrams(OpenBoundSocket(SOCK_DGRAM, port))
+            , m_Mailbox(::eventfd(0, EFD_NONBLOCK))
+            , m_Counters(counters)
+        {
+            ::listen(m_Listener, SOMAXCONN);
+
+            int bufferSize = 4 * 1024 * 1024;
+            ::setsockopt(m_Datagrams, SOL_SOCKET, SO_SNDBUF, &bufferSize, sizeof(bufferSize));
+            ::setsockopt(m_Datagrams, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+
+            Watch(m_Listener, EPOLLIN, LISTENER_TAG);
+            Watch(m_Datagrams, EPOLLIN | EPOLLET, DATAGRAM_TAG);
+            Watch(m_Mailbox, EPOLLIN, MAILBOX_TAG);
+        }
+
+        // From the control thread.
+        void Post(const Message_t & command)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_MailboxMutex);
+                m_Commands.push_back(command);
+            }
+            const uint64_t one = 1;
+            [[maybe_unused]] auto rc = ::write(m_Mailbox, &one, sizeof(one));
+        }
+
+        [[noreturn]] void Run()
+        {
+            epoll_event events[256];
+            auto nextSweep = Clock_t::now() + std::chrono::seconds(1);
+
+            for (;;)
+            {
+                const int count = ::epoll_wait(m_Epoll, events, 256, 1000);
+                for (int i = 0; i < count; ++i)
+                {
+                    const auto tag = events[i].data.u64;
+                    if (tag == LISTENER_TAG)
+                    {
+                        Accept();
+                    }
+                    else if (tag == DATAGRAM_TAG)
+                    {
+                        ReceiveDatagrams();
+                    }
+                    else if (tag == MAILBOX_TAG)
+                    {
+                        PushCommands();
+                    }
+                    else
+                    {
+                        OnStream(static_cast<uint32_t>(tag), events[i].events);
+                    }
+                }
+
+                // Everything queued in this pass leaves in as few writes as it can.
+                FlushStreams();
+                FlushDatagrams();
+
+                if (Clock_t::now() >= nextSweep)
+                {
+                    ForgetIdlePeers();
+                    nextSweep += std::chrono::seconds(1);
+                }
+            }
+        }
+
+    private:
+        void Watch(int fd, uint32_t events, uint64_t tag, int operation = EPOLL_CTL_ADD)
+        {
+            epoll_event event{};
+            event.events = events;
+            event.data.u64 = tag;
+            ::epoll_ctl(m_Epoll, operation, fd, &event);
+        }
+
+        uint32_t Allocate()
+        {
+            if (!m_FreeSlots.empty())
+            {
+                const auto slot = m_FreeSlots.back();
+                m_FreeSlots.pop_back();
+                return slot;
+            }
+            m_Devices.emplace_back();
+            return static_cast<uint32_t>(m_Devices.size() - 1);
+        }
+
+        void Release(uint32_t slot)
+        {
+            auto & device = m_Devices[slot];
+            for (const auto group : device.m_Groups)
+            {
+                auto & members = m_Members[group];
+                auto found = std::find(members.begin(), members.end(), slot);
+                if (found != members.end())
+                {
+                    *found = members.back();
+                    members.pop_back();
+                }
+            }
+            if (device.m_Socket >= 0)
+            {
+                ::close(device.m_Socket);
+                --m_Counters.m_Connections;
+            }
+            else
+            {
+                m_Peers.erase(KeyOf(device.m_Address));
+                --m_Counters.m_DatagramPeers;
+            }
+            device = Device_t{};
+            m_FreeSlots.push_back(slot);
+        }
+
+        void Accept()
+        {
+            for (;;)
+            {
+                const int fd = ::accept4(m_Listener, nullptr, nullptr, SOCK_NONBLOCK);
+                if (fd < 0)
+                {
+                    if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != ECONNABORTED))
+                    {
+                        perror("accept4");
+                    }
+                    if (errno != ECONNABORTED)
+                    {
+                        return;
+                    }
+                    continue;
+                }
+                int one = 1;
+                ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+                const auto slot = Allocate();
+                auto & device = m_Devices[slot];
+                device.m_Socket = fd;
+                device.m_pFramer = std::make_unique<StreamFramer<256>>();
+                Watch(fd, EPOLLIN | EPOLLRDHUP | EPOLLET, slot);
+                ++m_Counters.m_Connections;
+            }
+        }
+
+        void OnStream(uint32_t slot, uint32_t events)
+        {
+            auto & device = m_Devices[slot];
+
+            if ((events & EPOLLOUT) && device.m_IsWriteBlocked)
+            {
+                device.m_IsWriteBlocked = false;
+                Watch(device.m_Socket, EPOLLIN | EPOLLRDHUP | EPOLLET, slot, EPOLL_CTL_MOD);
+                Enqueue(slot);
+            }
+            if (!(events & (EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP)))
+            {
+                return;
+            }
+
+            // Edge triggered; drain it.
+            for (;;)
+            {
+                auto span = device.m_pFramer->WritableSpan();
+                const auto received = ::recv(device.m_Socket, span.data(), span.size(), 0);
+                if (received < 0)
+                {
+                    if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+                    {
+                        return;
+                    }
+                    Release(slot);
+                    return;
+                }
+                if (received == 0)
+                {
+                    Release(slot);
+                    return;
+                }
+                device.m_pFramer->Commit(received);
+
+                std::string_view frame;
+                FrameStatus_t status;
+                while ((status = device.m_pFramer->Peek(frame)) == FrameStatus_t::FRAME)
+                {
+                    OnFrame(slot, frame);
+                    device.m_pFramer->Consume(frame.size());
+                }
+                if (status == FrameStatus_t::OVERSIZED)
+                {
+                    // Not a LightControl device; nothing more it says can be framed.
+                    ++m_Counters.m_Malformed;
+                    Release(slot);
+                    return;
+                }
+            }
+        }
+
+        void ReceiveDatagrams()
+        {
+            char buffers[DATAGRAM_BATCH_SIZE][256];
+            iovec vectors[DATAGRAM_BATCH_SIZE];
+            sockaddr_in addresses[DATAGRAM_BATCH_SIZE];
+            mmsghdr messages[DATAGRAM_BATCH_SIZE];
+
+            for (;;)
+            {
+                for (std::size_t i = 0; i < DATAGRAM_BATCH_SIZE; ++i)
+                {
+                    vectors[i] = {buffers[i], sizeof(buffers[i])};
+                    messages[i] = {};
+                    messages[i].msg_hdr.msg_name = &addresses[i];
+                    messages[i].msg_hdr.msg_namelen = sizeof(addresses[i]);
+                    messages[i].msg_hdr.msg_iov = &vectors[i];
+                    messages[i].msg_hdr.msg_iovlen = 1;
+                }
+
+                const int count = ::recvmmsg(m_Datagrams, messages, DATAGRAM_BATCH_SIZE, MSG_DONTWAIT, nullptr);
+                if (count <= 0)
+                {
+                    return;
+                }
+                const auto now = Clock_t::now();
+                for (int i = 0; i < count; ++i)
+                {
+                    const auto slot = PeerSlot(addresses[i]);
+                    m_Devices[slot].m_LastHeard = now;
+
+                    // A datagram is delivered whole, so it is parsed as is.
+                    std::string_view pending(buffers[i], messages[i].msg_len);
+                    while (!pending.empty())
+                    {
+                        if (pending.front() == '\0')
+                        {
+                            pending.remove_prefix(1);
+                            continue;
+                        }
+                        const auto length = FrameLength(pending);
+                        const auto frame = pending.substr(0, (length > 0) ? length : MAXIMUM_ENCODED_SIZE);
+                        OnFrame(slot, frame);
+                        pending.remove_prefix(frame.size());
+                    }
+                }
+            }
+        }
+
+        uint32_t PeerSlot(const sockaddr_in & address)
+        {
+            const auto [known, isNew] = m_Peers.try_emplace(KeyOf(address), 0);
+            if (isNew)
+            {
+                const auto slot = Allocate();
+                m_Devices[slot].m_Address = address;
+                known->second = slot;
+                ++m_Counters.m_DatagramPeers;
+            }
+            return known->second;
+        }
+
+        void OnFrame(uint32_t slot, std::string_view frame)
+        {
+            auto & device = m_Devices[slot];
+
+            if (const auto format = ParseNegotiation(frame))
+            {
+                // Accepted by being echoed; the device's own rule.
+                device.m_Format = *format;
+                Queue(slot, frame);
+                return;
+            }
+
+            const auto result = Decode(frame);
+            if (!result)
+            {
+                ++m_Counters.m_Malformed;
+                return;
+            }
+            ++m_Counters.m_MessagesIn;
+
+            const auto group = result.m_Message.m_Group;
+            if ((group != MASTER_GROUP_ID)
+                && (std::find(device.m_Groups.begin(), device.m_Groups.end(), group) == device.m_Groups.end()))
+            {
+                device.m_Groups.push_back(group);
+                m_Members[group].push_back(slot);
+            }
+
+            // Asked to be stamped, the reply carries our clock instead; see
+            // ClockSync.h. Otherwise the message is its own reply.
+            if (result.m_Message.m_ControllerTime == CONTROLLER_TIME_REQUEST)
+            {
+                auto reply = result.m_Message;
+                reply.m_ControllerTime = ControllerMilliseconds();
+                char encoded[MAXIMUM_ENCODED_SIZE];
+                Queue(slot, std::string_view(encoded, Encode(IsBinaryEncoded(frame) ? WireFormat_t::BINARY 
+                                                                                    : WireFormat_t::TEXT, reply, encoded)));
+                ++m_Counters.m_Stamped;
+                return;
+            }
+            Queue(slot, frame);
+        }
+
+        void PushCommands()
+        {
+            uint64_t posted;
+            [[maybe_unused]] auto rc = ::read(m_Mailbox, &posted, sizeof(posted));
+
+            std::vector<Message_t> commands;
+            {
+                std::lock_guard<std::mutex> lock(m_MailboxMutex);
+                commands.swap(m_Commands);
+            }
+
+            for (const auto & command : commands)
+            {
+                // Once per wire format, not once per device.
+                char encoded[2][MAXIMUM_ENCODED_SIZE];
+                const std::string_view text(encoded[0], Encode(WireFormat_t::TEXT, command, encoded[0]));
+                const std::string_view binary(encoded[1], Encode(WireFormat_t::BINARY, command, encoded[1]));
+
+                const auto push = [&](uint32_t slot)
+                {
+                    Queue(slot, (m_Devices[slot].m_Format == WireFormat_t::BINARY) ? binary : text);
+                    ++m_Counters.m_Pushes;
+                };
+
+                if (command.m_Group == MASTER_GROUP_ID)
+                {
+                    for (uint32_t slot = 0; slot < m_Devices.size(); ++slot)
+                    {
+                        if ((m_Devices[slot].m_Socket >= 0) || !m_Devices[slot].m_Groups.empty())
+                        {
+                            push(slot);
+                        }
+                    }
+                }
+                else
+                {
+                    for (const auto slot : m_Members[command.m_Group])
+                    {
+                        push(slot);
+                    }
+                }
+            }
+        }
+
+        void Queue(uint32_t slot, std::string_view bytes)
+        {
+            auto & device = m_Devices[slot];
+            ++m_Counters.m_MessagesOut;
+
+            if (device.m_Socket < 0)
+            {
+                if (m_DatagramCount == DATAGRAM_BATCH_SIZE)
+                {
+                    FlushDatagrams();
+                }
+                auto & outgoing = m_OutgoingDatagrams[m_DatagramCount++];
+                std::copy_n(bytes.data(), bytes.size(), outgoing.m_Data);
+                outgoing.m_Length = bytes.size();
+                outgoing.m_Address = device.m_Address;
+                return;
+            }
+
+            device.m_Output.append(bytes);
+            Enqueue(slot);
+        }
+
+        void Enqueue(uint32_t slot)
+        {
+            auto & device = m_Devices[slot];
+            if (!device.m_IsQueued && !device.m_IsWriteBlocked)
+            {
+                device.m_IsQueued = true;
+                m_Pending.push_back(slot);
+            }
+        }
+
+        void FlushStreams()
+        {
+            for (const auto slot : m_Pending)
+            {
+                auto & device = m_Devices[slot];
+                device.m_IsQueued = false;
+                if ((device.m_Socket < 0) || device.m_Output.empty())
+                {
+                    continue;
+                }
+
+                const auto sent = ::send(device.m_Socket, device.m_Output.data(), device.m_Output.size(), MSG_NOSIGNAL);
+                ++m_Counters.m_Writes;
+                if ((sent < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK))
+                {
+                    Release(slot);
+                    continue;
+                }
+                device.m_Output.erase(0, std::max<ssize_t>(sent, 0));
+                if (device.m_Output.empty())
+                {
+                    continue;
+                }
+                if (device.m_Output.size() > MAXIMUM_PENDING_OUTPUT)
+                {
+                    ++m_Counters.m_SlowDevicesDropped;
+                    Release(slot);
+                    continue;
+                }
+                // The rest once the socket drains.
+                device.m_IsWriteBlocked = true;
+                Watch(device.m_Socket, EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET, slot, EPOLL_CTL_MOD);
+            }
+            m_Pending.clear();
+        }
+
+        void FlushDatagrams()
+        {
+            iovec vectors[DATAGRAM_BATCH_SIZE];
+            mmsghdr messages[DATAGRAM_BATCH_SIZE];
+            for (std::size_t i = 0; i < m_DatagramCount; ++i)
+            {
+                auto & outgoing = m_OutgoingDatagrams[i];
+                vectors[i] = {outgoing.m_Data, outgoing.m_Length};
+                messages[i] = {};
+                messages[i].msg_hdr.msg_name = &outgoing.m_Address;
+                messages[i].msg_hdr.msg_namelen = sizeof(outgoing.m_Address);
+                messages[i].msg_hdr.msg_iov = &vectors[i];
+                messages[i].msg_hdr.msg_iovlen = 1;
+            }
+
+            std::size_t sent = 0;
+            while (sent < m_DatagramCount)
+            {
+                const int rc = ::sendmmsg(m_Datagrams, messages + sent, m_DatagramCount - sent, 0);
+                ++m_Counters.m_Writes;
+                if (rc <= 0)
+                {
+                    // A full send buffer; as on any lossy link, the device retransmits.
+                    break;
+                }
+                sent += rc;
+            }
+            m_DatagramCount = 0;
+        }
+
+        void ForgetIdlePeers()
+        {
+            const auto now = Clock_t::now();
+            std::vector<uint32_t> idle;
+            for (const auto & [key, slot] : m_Peers)
+            {
+                if ((now - m_Devices[slot].m_LastHeard) > PEER_IDLE_TIMEOUT)
+                {
+                    idle.push_back(slot);
+                }
+            }
+            for (const auto slot : idle)
+            {
+                Release(slot);
+            }
+        }
+
+        struct Datagram_t
+        {
+            char        m_Data[MAXIMUM_ENCODED_SIZE];
+            std::size_t m_Length;
+            sockaddr_in m_Address;
+        };
+
+        int                                                     m_Epoll;
+        int                                                     m_Listener;
+        int                                                     m_Datagrams;
+        int                                                     m_Mailbox;
+        Counters_t &                                            m_Counters;
+        std::vector<Device_t>                                   m_Devices;
+        std::vector<uint32_t>                                   m_FreeSlots;
+        std::array<std::vector<uint32_t>, MAXIMUM_GROUP_ID + 1> m_Members;
+        std::unordered_map<uint64_t, uint32_t>                  m_Peers;
+        std::vector<uint32_t>                                   m_Pending;
+        std::array<Datagram_t, DATAGRAM_BATCH_SIZE>             m_OutgoingDatagrams;
+        std::size_t                                             m_DatagramCount{0};
+        std::mutex                                              m_MailboxMutex;
+        std::vector<Message_t>                                  m_Commands;
+    };
+
+    void RaiseOpenFileLimit()
+    {
+        rlimit limit{};
+        if (::getrlimit(RLIMIT_NOFILE, &limit) == 0)
+        {
+            limit.rlim_cur = limit.rlim_max;
+            ::setrlimit(RLIMIT_NOFILE, &limit);
+        }
+    }
+
+    void Report(const Counters_t & counters, uint64_t commands)
+    {
+        const auto writes = counters.m_Writes.load();
+        fprintf(stderr, "ControlServer: %llu connections, %llu UDP devices, %llu messages in, %llu malformed, "
+            "%llu stamped, %llu commands, %llu pushes, %llu messages out in %llu writes (%.1f per write), %llu slow devices dropped\n",
+            static_cast<unsigned long long>(counters.m_Connections.load()),
+            static_cast<unsigned long long>(counters.m_DatagramPeers.load()),
+            static_cast<unsigned long long>(counters.m_MessagesIn.load()),
+            static_cast<unsigned long long>(counters.m_Malformed.load()),
+            static_cast<unsigned long long>(counters.m_Stamped.load()),
+            static_cast<unsigned long long>(commands),
+            static_cast<unsigned long long>(counters.m_Pushes.load()),
+            static_cast<unsigned long long>(counters.m_MessagesOut.load()),
+            static_cast<unsigned long long>(writes),
+            (writes > 0) ? (static_cast<double>(counters.m_MessagesOut.load()) / writes) : 0.0,
+            static_cast<unsigned long long>(counters.m_SlowDevicesDropped.load()));
+    }
+} // end of anonymous namespace
+
+int main(int argc, char * argv[])
+{
+    const auto port        = static_cast<uint16_t>((argc > 1) ? std::atoi(argv[1]) : 7007);
+    const auto controlPort = static_cast<uint16_t>((argc > 2) ? std::atoi(argv[2]) : 7070);
+    const auto threads     = static_cast<unsigned>((argc > 3) ? std::max(1, std::atoi(argv[3]))
+                                                              : std::max(1u, std::thread::hardware_concurrency()));
+
+    std::signal(SIGPIPE, SIG_IGN);
+    RaiseOpenFileLimit();
+
+    static Counters_t counters;
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (unsigned i = 0; i < threads; ++i)
+    {
+        workers.push_back(std::make_unique<Worker>(port, counters));
+    }
+    for (auto & worker : workers)
+    {
+        std::thread([pWorker = worker.get()]() { pWorker->Run(); }).detach();
+    }
+
+    // The control port is blocking; it reports once every 5 s from its
+    // receive timeout, so that a run can be ended at any point.
+    const int control = ::socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in address{};
+    address.sin_family      = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port        = htons(controlPort);
+    if (::bind(control, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+    {
+        perror("bind");
+        return EXIT_FAILURE;
+    }
+    timeval timeout{1, 0};
+    ::setsockopt(control, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    printf("ControlServer listening for devices on TCP and UDP port %u, for commands on UDP port %u, %u threads ...\n",
+        port, controlPort, threads);
+
+    uint64_t commands = 0;
+    auto nextReport = Clock_t::now() + std::chrono::seconds(5);
+    char buffer[2048];
+    for (;;)
+    {
+        sockaddr_in from{};
+        socklen_t length = sizeof(from);
+        const auto received = ::recvfrom(control, buffer, sizeof(buffer), 0, reinterpret_cast<sockaddr *>(&from), &length);
+
+        std::string_view pending(buffer, std::max<ssize_t>(received, 0));
+        while (!pending.empty())
+        {
+            if (pending.front() == '\0')
+            {
+                pending.remove_prefix(1);
+                continue;
+            }
+            const auto frameLength = FrameLength(pending);
+            const auto frame = pending.substr(0, (frameLength > 0) ? frameLength : pending.size());
+            pending.remove_prefix(frame.size());
+
+            const auto result = Decode(frame);
+            if (!result)
+            {
+                fprintf(stderr, "Error! Command rejected: %s\n", ToString(result.m_Error));
+                continue;
+            }
+            for (auto & worker : workers)
+            {
+                worker->Post(result.m_Message);
+            }
+            ++commands;
+            ::sendto(control, frame.data(), frame.size(), 0, reinterpret_cast<const sockaddr *>(&from), length);
+        }
+
+        if (Clock_t::now() >= nextReport)
+        {
+            Report(counters, commands);
+            nextReport += std::chrono::seconds(5);
+        }
+    }
+}
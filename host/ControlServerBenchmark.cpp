@@ -0,0 +1,324 @@
+/***********************************************************************
+* @file      ControlServerBenchmark.cpp
+*
+*    Benchmarks the push path of host/ControlServer.cpp: N simulated
+*    devices, each a TCP connection or UDP socket of its own, register
+*    with the server by sending it one LightControl message for their
+*    group, spread evenly over the given number of groups. An operator
+*    then issues commands on the control port, one at a time, to each
+*    group in turn, and the time until every device of the group has its
+*    command is measured.
+*
+*    Reported are the latency of each single delivery, that of the
+*    fan-out as a whole, i.e. until the last device of the group has it,
+*    and the rate of deliveries. With 0 groups every device is in group
+*    001, and every command goes to the master group 000 instead.
+*
+* @brief   Usage: ControlServerBenchmark [devices=10000] [commands=100] [groups=10] [tcp|udp]
+*                                        [port=7007] [control port=7070] [binary=0]
+*
+* @note    Request/reply throughput of the server, the devices' own
+*          exchange, is what host/FleetSimulator.cpp measures; point it
+*          at the ControlServer's port.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "LightControlFramer.h"
+#include "LightControlGroups.h"
+
+namespace
+{
+    using namespace LightControl;
+    using Clock_t = std::chrono::steady_clock;
+
+    // How long the devices are given to register, or to receive one command.
+    constexpr auto DELIVERY_TIMEOUT = std::chrono::seconds(2);
+
+    struct Device_t
+    {
+        int                               m_Socket{-1};
+        uint16_t                          m_Group{1};
+        bool                              m_IsWaiting{false};
+        uint8_t                           m_Awaited{0};   // Sequence of the command awaited.
+        std::unique_ptr<StreamFramer<256>> m_pFramer;      // TCP only.
+    };
+
+    sockaddr_in Loopback(uint16_t port)
+    {
+        sockaddr_in address{};
+        address.sin_family      = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port        = htons(port);
+        return address;
+    }
+
+    void RaiseOpenFileLimit()
+    {
+        rlimit limit{};
+        if (::getrlimit(RLIMIT_NOFILE, &limit) == 0)
+        {
+            limit.rlim_cur = limit.rlim_max;
+            ::setrlimit(RLIMIT_NOFILE, &limit);
+        }
+    }
+
+    double Percentile(std::vector<double> & samples, double fraction)
+    {
+        if (samples.empty())
+        {
+            return 0.0;
+        }
+        std::sort(samples.begin(), samples.end());
+        return samples[static_cast<std::size_t>(fraction * (samples.size() - 1))];
+    }
+
+    class Devices
+    {
+    public:
+        Devices(std::size_t count, uint16_t groups, bool isUdp, uint16_t port)
+            : m_Epoll(::epoll_create1(0))
+            , m_IsUdp(isUdp)
+            , m_Devices(count)
+        {
+            const auto server = Loopback(port);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                auto & device = m_Devices[i];
+                device.m_Group = static_cast<uint16_t>(1 + (i % std::max<uint16_t>(groups, 1)));
+                device.m_Socket = ::socket(AF_INET, isUdp ? SOCK_DGRAM : SOCK_STREAM, 0);
+                if ((device.m_Socket < 0)
+                    || (::connect(device.m_Socket, reinterpret_cast<const sockaddr *>(&server), sizeof(server)) < 0))
+                {
+                    perror("Error! Device socket");
+                    std::exit(EXIT_FAILURE);
+                }
+                if (!isUdp)
+                {
+                    device.m_pFramer = std::make_unique<StreamFramer<256>>();
+                }
+
+                epoll_event event{};
+                event.events = EPOLLIN;
+                event.data.u32 = static_cast<uint32_t>(i);
+                ::epoll_ctl(m_Epoll, EPOLL_CTL_ADD, device.m_Socket, &event);
+            }
+        }
+
+        // Negotiates the wire format, and joins each device's group by way
+        // of one message of its own; true once every device has its echo.
+        bool Register(WireFormat_t format)
+        {
+            for (auto & device : m_Devices)
+            {
+                device.m_IsWaiting = true;
+                device.m_Awaited = 0;
+            }
+            for (int attempt = 0; (attempt < 3) && (Waiting() > 0); ++attempt)
+            {
+                for (auto & device : m_Devices)
+                {
+                    if (!device.m_IsWaiting)
+                    {
+                        continue;
+                    }
+                    char encoded[NEGOTIATION_MESSAGE_SIZE + MAXIMUM_ENCODED_SIZE];
+                    std::size_t length = 0;
+                    if (format == WireFormat_t::BINARY)
+                    {
+                        length = EncodeNegotiation(format, encoded);
+                    }
+                    length += Encode(format, Message_t{device.m_Group, false, 0},
+                                     std::span<char>(encoded + length, MAXIMUM_ENCODED_SIZE));
+                    ::send(device.m_Socket, encoded, length, MSG_NOSIGNAL);
+                }
+                Await(Clock_t::now(), [](std::size_t, double) {});
+            }
+            return (Waiting() == 0);
+        }
+
+        // Marks every device of the group (or all, for the master group)
+        // as awaiting the command with this sequence number.
+        std::size_t Expect(uint16_t group, uint8_t sequence)
+        {
+            std::size_t expected = 0;
+            for (auto & device : m_Devices)
+            {
+                device.m_IsWaiting = (group == MASTER_GROUP_ID) || (device.m_Group == group);
+                device.m_Awaited = sequence;
+                expected += device.m_IsWaiting ? 1 : 0;
+            }
+            return expected;
+        }
+
+        // Receives until no device is waiting any more, or the timeout; the
+        // callback is given each delivery's latency in microseconds.
+        template <typename OnDelivery>
+        std::size_t Await(Clock_t::time_point sent, OnDelivery && onDelivery)
+        {
+            auto remaining = Waiting();
+            const auto deadline = Clock_t::now() + DELIVERY_TIMEOUT;
+            epoll_event events[256];
+
+            while ((remaining > 0) && (Clock_t::now() < deadline))
+            {
+                const int count = ::epoll_wait(m_Epoll, events, 256, 10);
+                const auto now = Clock_t::now();
+                const auto latency = std::chrono::duration<double, std::micro>(now - sent).count();
+                for (int i = 0; i < count; ++i)
+                {
+                    const auto index = events[i].data.u32;
+                    if (Receive(m_Devices[index]))
+                    {
+                        onDelivery(index, latency);
+                        --remaining;
+                    }
+                }
+            }
+            return remaining;
+        }
+
+        std::size_t Waiting() const
+        {
+            return static_cast<std::size_t>(std::count_if(m_Devices.begin(), m_Devices.end(),
+                [](const Device_t & device) { return device.m_IsWaiting; }));
+        }
+
+        std::size_t Size() const { return m_Devices.size(); }
+
+    private:
+        // True should the device have just received what it was waiting for.
+        bool Receive(Device_t & device)
+        {
+            bool isDelivered = false;
+            const auto onFrame = [&](std::string_view frame)
+            {
+                const auto result = Decode(frame);
+                if (result && device.m_IsWaiting && (result.m_Message.m_Sequence == device.m_Awaited))
+                {
+                    device.m_IsWaiting = false;
+                    isDelivered = true;
+                }
+            };
+
+            if (m_IsUdp)
+            {
+                char datagram[256];
+                const auto received = ::recv(device.m_Socket, datagram, sizeof(datagram), MSG_DONTWAIT);
+                std::string_view pending(datagram, std::max<ssize_t>(received, 0));
+                while (!pending.empty())
+                {
+                    if (pending.front() == '\0')
+                    {
+                        pending.remove_prefix(1);
+                        continue;
+                    }
+                    const auto length = FrameLength(pending);
+                    const auto frame = pending.substr(0, (length > 0) ? length : pending.size());
+                    onFrame(frame);
+                    pending.remove_prefix(frame.size());
+                }
+                return isDelivered;
+            }
+
+            auto span = device.m_pFramer->WritableSpan();
+            const auto received = ::recv(device.m_Socket, span.data(), span.size(), MSG_DONTWAIT);
+            if (received > 0)
+            {
+                device.m_pFramer->Commit(received);
+                std::string_view frame;
+                while (device.m_pFramer->Peek(frame) == FrameStatus_t::FRAME)
+                {
+                    onFrame(frame);
+                    device.m_pFramer->Consume(frame.size());
+                }
+            }
+            return isDelivered;
+        }
+
+        int                   m_Epoll;
+        bool                  m_IsUdp;
+        std::vector<Device_t> m_Devices;
+    };
+} // end of anonymous namespace
+
+int main(int argc, char * argv[])
+{
+    const auto count       = static_cast<std::size_t>((argc > 1) ? std::max(1, std::atoi(argv[1])) : 10000);
+    const auto commands    = (argc > 2) ? std::max(1, std::atoi(argv[2])) : 100;
+    const auto groups      = static_cast<uint16_t>((argc > 3) ? std::clamp(std::atoi(argv[3]), 0, 999) : 10);
+    const auto isUdp       = ((argc > 4) && (std::strcmp(argv[4], "udp") == 0));
+    const auto port        = static_cast<uint16_t>((argc > 5) ? std::atoi(argv[5]) : 7007);
+    const auto controlPort = static_cast<uint16_t>((argc > 6) ? std::atoi(argv[6]) : 7070);
+    const auto format      = ((argc > 7) && (std::atoi(argv[7]) != 0)) ? WireFormat_t::BINARY : WireFormat_t::TEXT;
+
+    RaiseOpenFileLimit();
+
+    Devices devices(count, groups, isUdp, port);
+    if (!devices.Register(format))
+    {
+        fprintf(stderr, "Error! %zu of %zu devices could not register; is the ControlServer listening on port %u?\n",
+            devices.Waiting(), count, port);
+        return EXIT_FAILURE;
+    }
+
+    const int operatorSocket = ::socket(AF_INET, SOCK_DGRAM, 0);
+    const auto control = Loopback(controlPort);
+    ::connect(operatorSocket, reinterpret_cast<const sockaddr *>(&control), sizeof(control));
+
+    std::vector<double> deliveries;
+    std::vector<double> fanouts;
+    std::size_t expectedTotal = 0;
+    std::size_t lost = 0;
+    const auto started = Clock_t::now();
+
+    for (int command = 0; command < commands; ++command)
+    {
+        const auto group = (groups == 0) ? MASTER_GROUP_ID : static_cast<uint16_t>(1 + (command % groups));
+        // Sequence 0 is the devices' registration echo.
+        const auto sequence = static_cast<uint8_t>(1 + (command % 255));
+        expectedTotal += devices.Expect(group, sequence);
+
+        char encoded[MAXIMUM_ENCODED_SIZE];
+        const auto length = Encode(WireFormat_t::TEXT, Message_t{group, static_cast<bool>(command & 1), sequence}, encoded);
+        const auto sent = Clock_t::now();
+        ::send(operatorSocket, encoded, length, 0);
+
+        double slowest = 0.0;
+        lost += devices.Await(sent, [&](std::size_t, double latency)
+        {
+            deliveries.push_back(latency);
+            slowest = std::max(slowest, latency);
+        });
+        fanouts.push_back(slowest);
+    }
+
+    const auto seconds = std::chrono::duration<double>(Clock_t::now() - started).count();
+
+    printf("%zu devices over %s in %u groups, %d commands%s, %s\n", devices.Size(), (isUdp ? "UDP" : "TCP"),
+        std::max<uint16_t>(groups, 1), commands, ((groups == 0) ? " to the master group" : ""), ToString(format));
+    printf("deliveries:        %zu of %zu (%zu lost)\n", deliveries.size(), expectedTotal, lost);
+    printf("delivery latency:  p50 %.1f us, p99 %.1f us, max %.1f us\n",
+        Percentile(deliveries, 0.50), Percentile(deliveries, 0.99), Percentile(deliveries, 1.00));
+    printf("fan-out complete:  p50 %.1f us, p99 %.1f us, max %.1f us\n",
+        Percentile(fanouts, 0.50), Percentile(fanouts, 0.99), Percentile(fanouts, 1.00));
+    printf("throughput:        %.0f deliveries/s\n", deliveries.size() / seconds);
+    return 0;
+}
@@ -0,0 +1,234 @@
+/***********************************************************************
+* @file      DimmingModel.cpp
+*
+*    Checks the fades of LightDimmer.h against the ideal CIE 1931 curve,
+*    and reports what stepping them costs.
+*
+*    Accuracy: a handful of fades, up and down, long and short, and one
+*    superseding another half way, are stepped through the very engine
+*    that the device runs. Every duty cycle written is compared with the
+*    ideal one, i.e. the curve computed in double precision at the level
+*    the fade should be at by then; and every fade must be monotonic, take
+*    exactly its number of steps and end on its target's table entry.
+*
+*    Cost: every channel fades the whole range, at once, for the given
+*    transition time, over and over, and each Step() is timed. Steps of
+*    the same fades computing pow() per channel instead of looking the
+*    table up are timed alongside, for comparison. The share of one CPU
+*    that the fades would take at the given step period follows.
+*
+* @brief   Usage: DimmingModel [channels=32] [transition ms=2000] [step us=10000] [repetitions=200]
+*
+* @note    Exits with 1 should any check fail.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "LightDimmer.h"
+
+namespace
+{
+    using namespace LightControl;
+
+    constexpr std::size_t CHANNELS{32};
+
+    template <typename T>
+    inline void DoNotOptimize(const T & value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    double IdealDuty(double level)
+    {
+        return CieLuminance((level * 100.0) / MAXIMUM_LEVEL) * MAXIMUM_DUTY;
+    }
+
+    struct Fade_t
+    {
+        uint8_t  m_From;
+        uint8_t  m_To;
+        uint16_t m_Steps;
+    };
+
+    struct Accuracy_t
+    {
+        double      m_MaximumError{0};          // Duty cycle counts, of 65535.
+        double      m_MaximumRelativeError{0};  // Of the ideal, above 1% duty.
+        std::size_t m_Writes{0};
+        bool        m_IsMonotonic{true};
+        bool        m_IsOnTime{true};
+        bool        m_IsOnTarget{true};
+    };
+
+    // Fades one channel from one level to another; the first fade sets
+    // the channel at its starting level at once.
+    void CheckFade(const Fade_t & fade, Accuracy_t & accuracy)
+    {
+        FadeEngine<1> engine;
+        uint16_t duty = 0;
+        const auto output = [&](std::size_t, uint16_t written) { duty = written; ++accuracy.m_Writes; };
+
+        engine.Start(1, fade.m_From, 0, output);
+        engine.Start(1, fade.m_To, fade.m_Steps, output);
+
+        const bool isUp = (fade.m_To >= fade.m_From);
+        std::size_t steps = 0;
+        while (engine.IsActive())
+        {
+            const auto previous = duty;
+            engine.Step(output);
+            ++steps;
+
+            const auto level = fade.m_From + ((static_cast<double>(fade.m_To) - fade.m_From) * steps / fade.m_Steps);
+            const auto ideal = IdealDuty(level);
+            const auto error = std::fabs(duty - ideal);
+            accuracy.m_MaximumError = std::max(accuracy.m_MaximumError, error);
+            if (ideal >= (MAXIMUM_DUTY / 100.0))
+            {
+                accuracy.m_MaximumRelativeError = std::max(accuracy.m_MaximumRelativeError, error / ideal);
+            }
+            accuracy.m_IsMonotonic = accuracy.m_IsMonotonic && (isUp ? (duty >= previous) : (duty <= previous));
+        }
+        accuracy.m_IsOnTime = accuracy.m_IsOnTime && (steps == fade.m_Steps);
+        accuracy.m_IsOnTarget = accuracy.m_IsOnTarget && (duty == LevelToDuty(fade.m_To));
+    }
+
+    // Half way through a fade up, it is sent back down instead.
+    bool CheckSupersededFade()
+    {
+        FadeEngine<1> engine;
+        uint16_t duty = 0;
+        const auto output = [&](std::size_t, uint16_t written) { duty = written; };
+
+        engine.Start(1, MAXIMUM_LEVEL, 100, output);
+        for (int step = 0; step < 50; ++step)
+        {
+            engine.Step(output);
+        }
+        const auto turnedAt = duty;
+        engine.Start(1, 20, 30, output);
+
+        bool isMonotonic = true;
+        std::size_t steps = 0;
+        while (engine.IsActive())
+        {
+            const auto previous = duty;
+            engine.Step(output);
+            ++steps;
+            isMonotonic = isMonotonic && (duty <= previous);
+        }
+        return isMonotonic && (steps == 30) && (turnedAt > LevelToDuty(120)) && (duty == LevelToDuty(20));
+    }
+
+    template <typename Step>
+    double NanosecondsPerStep(std::size_t repetitions, std::size_t & steps, Step && step)
+    {
+        std::chrono::steady_clock::duration elapsed{};
+        steps = 0;
+        for (std::size_t repetition = 0; repetition < repetitions; ++repetition)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            steps += step(repetition);
+            elapsed += std::chrono::steady_clock::now() - start;
+        }
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count())
+             / static_cast<double>(std::max<std::size_t>(1, steps));
+    }
+} // end of anonymous namespace
+
+int main(int argc, char * argv[])
+{
+    const auto channels    = static_cast<std::size_t>(std::clamp((argc > 1) ? std::atoi(argv[1]) : 32, 1, 32));
+    const auto transition  = static_cast<uint32_t>(std::max(1, (argc > 2) ? std::atoi(argv[2]) : 2000));
+    const auto stepPeriod  = static_cast<uint32_t>(std::max(1, (argc > 3) ? std::atoi(argv[3]) : 10000));
+    const auto repetitions = static_cast<std::size_t>(std::max(1, (argc > 4) ? std::atoi(argv[4]) : 200));
+    const auto fadeSteps   = static_cast<uint16_t>(std::min<uint64_t>(UINT16_MAX,
+                               ((static_cast<uint64_t>(transition) * 1000) + stepPeriod - 1) / stepPeriod));
+
+    printf("Fades of %zu channels over %u ms, a step every %u us (%u steps), %zu times\n",
+        channels, transition, stepPeriod, fadeSteps, repetitions);
+
+    // Accuracy.
+    const Fade_t fades[] = {
+        {0, MAXIMUM_LEVEL, fadeSteps}, {MAXIMUM_LEVEL, 0, fadeSteps}, {0, MAXIMUM_LEVEL, 1},
+        {10, 200, fadeSteps}, {200, 10, 7}, {128, 129, fadeSteps}, {1, 0, 3}, {0, 64, 6553}
+    };
+    Accuracy_t accuracy;
+    for (const auto & fade : fades)
+    {
+        CheckFade(fade, accuracy);
+    }
+    const bool isSuperseded = CheckSupersededFade();
+
+    printf("accuracy: max error %.1f of %u duty counts (%.4f%% of full scale), %.3f%% of the ideal above 1%% duty\n",
+        accuracy.m_MaximumError, MAXIMUM_DUTY, (100.0 * accuracy.m_MaximumError) / MAXIMUM_DUTY,
+        100.0 * accuracy.m_MaximumRelativeError);
+    printf("          monotonic %s, on time %s, on target %s, superseded %s, %zu writes\n",
+        (accuracy.m_IsMonotonic ? "yes" : "NO"), (accuracy.m_IsOnTime ? "yes" : "NO"),
+        (accuracy.m_IsOnTarget ? "yes" : "NO"), (isSuperseded ? "yes" : "NO"), accuracy.m_Writes);
+
+    // Cost, table driven, as on the device.
+    const uint32_t mask = (channels == 32) ? UINT32_MAX : ((1u << channels) - 1);
+    std::vector<uint16_t> duties(CHANNELS);
+    std::size_t writes = 0;
+    const auto output = [&](std::size_t channel, uint16_t duty) { duties[channel] = duty; ++writes; };
+
+    FadeEngine<CHANNELS> engine;
+    std::size_t steps = 0;
+    const auto tableNanoseconds = NanosecondsPerStep(repetitions, steps, [&](std::size_t repetition)
+    {
+        engine.Start(mask, ((repetition % 2) == 0) ? MAXIMUM_LEVEL : 0, fadeSteps, output);
+        std::size_t taken = 0;
+        while (engine.IsActive())
+        {
+            engine.Step(output);
+            ++taken;
+        }
+        DoNotOptimize(duties.data());
+        return taken;
+    });
+    const auto writesPerStep = static_cast<double>(writes) / static_cast<double>(std::max<std::size_t>(1, steps));
+
+    // The same fades with the curve computed per channel-step instead.
+    std::vector<double> levels(CHANNELS);
+    const auto powNanoseconds = NanosecondsPerStep(repetitions, steps, [&](std::size_t repetition)
+    {
+        const double from = ((repetition % 2) == 0) ? 0 : MAXIMUM_LEVEL;
+        const double delta = ((MAXIMUM_LEVEL - from) - from) / fadeSteps;
+        std::fill(levels.begin(), levels.end(), from);
+        for (uint16_t step = 0; step < fadeSteps; ++step)
+        {
+            for (std::size_t channel = 0; channel < channels; ++channel)
+            {
+                levels[channel] += delta;
+                const auto lightness = (levels[channel] * 100.0) / MAXIMUM_LEVEL;
+                duties[channel] = static_cast<uint16_t>(std::clamp((lightness <= 8.0) ? (lightness / 903.3)
+                                   : std::pow((lightness + 16.0) / 116.0, 3.0), 0.0, 1.0) * MAXIMUM_DUTY);
+            }
+            DoNotOptimize(duties.data());
+        }
+        return static_cast<std::size_t>(fadeSteps);
+    });
+
+    printf("cost:     %.1f ns per step of %zu channels (%.2f ns per channel-step, %.1f writes), "
+           "pow() per channel-step %.1f ns per step\n",
+        tableNanoseconds, channels, tableNanoseconds / channels, writesPerStep, powNanoseconds);
+    printf("          %.4f%% of this CPU at a step every %u us, for %.1f us of CPU per %u ms fade\n",
+        (100.0 * tableNanoseconds) / (stepPeriod * 1000.0), stepPeriod,
+        (tableNanoseconds * fadeSteps) / 1000.0, transition);
+
+    const bool isPassed = accuracy.m_IsMonotonic && accuracy.m_IsOnTime && accuracy.m_IsOnTarget && isSuperseded
+                       && (accuracy.m_MaximumError < (MAXIMUM_DUTY / 1000.0));
+    printf("%s\n", (isPassed ? "PASSED" : "FAILED"));
+    return isPassed ? 0 : 1;
+}
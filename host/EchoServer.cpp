@@ -0,0 +1,214 @@
+/***********************************************************************
+* @file      EchoServer.cpp
+*
+*    Local stand-in for echo.mbedcloudtesting.com. Echoes every TCP
+*    stream and every UDP datagram received on the given port straight
+*    back to its sender, so that the LightControl client loop can be run
+*    and measured on a Linux box without any external dependency.
+*
+*    An optional delay holds every echo back by that long, without
+*    serialising them, so as to emulate the round-trip time of a cellular
+*    link while leaving its bandwidth, and so pipelining, intact.
+*
+* @brief   Usage: EchoServer [port=7007] [delay milliseconds=0]
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    std::chrono::milliseconds g_EchoDelay{0};
+
+    // Runs each posted echo once it has been held back for g_EchoDelay,
+    // in posting order, on a thread of its own.
+    class DelayLine
+    {
+        using Clock_t = std::chrono::steady_clock;
+
+        struct Pending_t
+        {
+            Clock_t::time_point   m_Due;
+            std::function<void()> m_Echo;
+        };
+
+    public:
+        DelayLine()
+            : m_Thread([this]() { Drain(); })
+        {
+            m_Thread.detach();
+        }
+
+        void Post(std::function<void()> echo)
+        {
+            if (g_EchoDelay.count() == 0)
+            {
+                echo();
+                return;
+            }
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Pending.push_back(Pending_t{Clock_t::now() + g_EchoDelay, std::move(echo)});
+            m_Condition.notify_one();
+        }
+
+        void Stop()
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Stopped = true;
+            m_Condition.notify_one();
+        }
+
+    private:
+        void Drain()
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            while (!m_Stopped || !m_Pending.empty())
+            {
+                if (m_Pending.empty())
+                {
+                    m_Condition.wait(lock);
+                    continue;
+                }
+                if (Clock_t::now() < m_Pending.front().m_Due)
+                {
+                    m_Condition.wait_until(lock, m_Pending.front().m_Due);
+                    continue;
+                }
+                auto pending = std::move(m_Pending.front());
+                m_Pending.pop_front();
+                lock.unlock();
+                pending.m_Echo();
+                lock.lock();
+            }
+            lock.unlock();
+            delete this;
+        }
+
+        std::mutex              m_Mutex;
+        std::condition_variable m_Condition;
+        std::deque<Pending_t>   m_Pending;
+        bool                    m_Stopped{false};
+        std::thread             m_Thread;
+    };
+
+    int OpenBoundSocket(int type, uint16_t port)
+    {
+        int fd = ::socket(AF_INET, type, 0);
+        int one = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+        sockaddr_in address{};
+        address.sin_family      = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port        = htons(port);
+        if (::bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+        {
+            perror("bind");
+            std::exit(EXIT_FAILURE);
+        }
+        return fd;
+    }
+
+    void SendAll(int fd, const char * pData, ssize_t size)
+    {
+        ssize_t sent = 0;
+        while (sent < size)
+        {
+            ssize_t rc = ::send(fd, pData + sent, size - sent, MSG_NOSIGNAL);
+            if (rc <= 0)
+            {
+                return;
+            }
+            sent += rc;
+        }
+    }
+
+    void EchoStream(int fd)
+    {
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        // Owns itself; deletes itself once stopped and drained.
+        auto pDelayLine = new DelayLine();
+
+        char buffer[4096];
+        ssize_t received;
+        while ((received = ::recv(fd, buffer, sizeof(buffer), 0)) > 0)
+        {
+            pDelayLine->Post([fd, data = std::vector<char>(buffer, buffer + received)]()
+            {
+                SendAll(fd, data.data(), static_cast<ssize_t>(data.size()));
+            });
+        }
+
+        // The socket is closed by the last echo to leave the delay line.
+        pDelayLine->Post([fd]() { ::close(fd); });
+        pDelayLine->Stop();
+    }
+
+    void EchoDatagrams(int fd)
+    {
+        auto pDelayLine = new DelayLine();
+
+        char buffer[2048];
+        for (;;)
+        {
+            sockaddr_in peer{};
+            socklen_t length = sizeof(peer);
+            ssize_t received = ::recvfrom(fd, buffer, sizeof(buffer), 0, 
+                                          reinterpret_cast<sockaddr *>(&peer), &length);
+            if (received > 0)
+            {
+                pDelayLine->Post([fd, peer, length, data = std::vector<char>(buffer, buffer + received)]()
+                {
+                    ::sendto(fd, data.data(), data.size(), 0, 
+                             reinterpret_cast<const sockaddr *>(&peer), length);
+                });
+            }
+        }
+    }
+} // end of anonymous namespace
+
+int main(int argc, char * argv[])
+{
+    const auto port = static_cast<uint16_t>((argc > 1) ? std::atoi(argv[1]) : 7007);
+    g_EchoDelay     = std::chrono::milliseconds((argc > 2) ? std::atoi(argv[2]) : 0);
+
+    std::signal(SIGPIPE, SIG_IGN);
+
+    int udpSocket = OpenBoundSocket(SOCK_DGRAM, port);
+    std::thread(EchoDatagrams, udpSocket).detach();
+
+    int tcpSocket = OpenBoundSocket(SOCK_STREAM, port);
+    ::listen(tcpSocket, SOMAXCONN);
+
+    printf("EchoServer listening on TCP and UDP port %u, echo delay %lld ms ...\n", 
+        port, static_cast<long long>(g_EchoDelay.count()));
+
+    for (;;)
+    {
+        int client = ::accept(tcpSocket, nullptr, nullptr);
+        if (client >= 0)
+        {
+            std::thread(EchoStream, client).detach();
+        }
+    }
+}
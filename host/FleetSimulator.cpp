@@ -0,0 +1,612 @@
+/***********************************************************************
+* @file      FleetSimulator.cpp
+*
+*    Load generator for sizing a LightControl backend: thousands of
+*    virtual Dragonfly nodes in one process, each running the lock-step
+*    exchange of LEDLightControl (send a LightControl message, await its
+*    reply, send the next) on its own TCP connection or UDP socket, all
+*    multiplexed onto a single thread by epoll.
+*
+*    Messages are formatted and replies framed and parsed by the very
+*    codec that the device uses (LightControlCodec.h), in either encoding.
+*
+*    Each node sends at the given rate, or, at a rate of 0, back to back
+*    as the device's Run() does. A simulated link delay holds every message
+*    back by that long on its way out, and every reply on its way in, so
+*    that a cellular round-trip time can be emulated against a local
+*    server. Nodes start, and connect, staggered over the first period.
+*
+*    A node only costs a file descriptor, one small fixed-size state
+*    record, and at most two pending timers; 10k+ nodes fit comfortably
+*    on a laptop. The resident memory per node is reported at the end.
+*
+* @brief   Usage: FleetSimulator [nodes=1000] [seconds=10] [messages/s per node=1, 0=back to back]
+*                                [tcp|udp] [link delay ms=0] [port=7007] [binary=0]
+*
+* @note    Against host/EchoServer.cpp, or any server speaking the echo
+*          exchange. Raises the open file limit as far as it goes; each
+*          node needs a descriptor of its own, as would each real device.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include "LightControlCodec.h"
+
+namespace
+{
+    using namespace LightControl;
+    using Clock_t = std::chrono::steady_clock;
+
+    // A reply that has not arrived within this long is counted as a
+    // timeout, and the node moves on to its next message.
+    constexpr uint64_t REPLY_TIMEOUT_MICROSECONDS{5000000};
+
+    // Bounds the SYNs in flight, lest the server's accept backlog overflow.
+    constexpr std::size_t MAXIMUM_CONNECTS_IN_PROGRESS{256};
+
+    // Latencies kept for the percentiles; beyond that, a uniform sample.
+    constexpr std::size_t MAXIMUM_LATENCY_SAMPLES{1 << 20};
+
+    enum class NodeState_t : uint8_t
+    {
+        UNCONNECTED,
+        CONNECTING,
+        IDLE,            // Waiting for its next message to be due.
+        SENDING,         // Message held back by the uplink delay.
+        AWAITING_REPLY,
+        DELIVERING,      // Reply held back by the downlink delay.
+        FAILED
+    };
+
+    // Everything that a node costs in user space, besides its timers.
+    struct Node_t
+    {
+        int32_t     m_Socket{-1};
+        uint32_t    m_SentAt{0};        // Microseconds since the start of the run.
+        uint32_t    m_ConnectStartedAt{0};
+        uint16_t    m_Group{1};
+        uint8_t     m_Sequence{0};
+        NodeState_t m_State{NodeState_t::UNCONNECTED};
+        uint8_t     m_Received{0};      // Bytes of a partial reply, TCP only.
+        char        m_Buffer[MAXIMUM_ENCODED_SIZE];
+    };
+
+    enum class TimerKind_t : uint8_t
+    {
+        CONNECT,
+        SEND_DUE,
+        TRANSMIT,   // Uplink delay over; onto the socket with it.
+        DELIVER     // Downlink delay over; the reply counts as received.
+    };
+
+    struct Timer_t
+    {
+        uint64_t    m_Due;
+        uint32_t    m_Node;
+        TimerKind_t m_Kind;
+
+        bool operator>(const Timer_t & other) const { return m_Due > other.m_Due; }
+    };
+
+    struct Options_t
+    {
+        std::size_t m_Nodes;
+        double      m_Seconds;
+        double      m_Rate;
+        bool        m_IsUdp;
+        uint64_t    m_LinkDelayMicroseconds;
+        uint16_t    m_Port;
+        WireFormat_t m_Format;
+    };
+
+    class Fleet
+    {
+    public:
+        explicit Fleet(const Options_t & options)
+            : m_Options(options)
+            , m_Nodes(options.m_Nodes)
+            , m_Epoll(::epoll_create1(0))
+            , m_Start(Clock_t::now())
+            , m_Engine(7)
+        {
+            m_Server.sin_family      = AF_INET;
+            m_Server.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            m_Server.sin_port        = htons(options.m_Port);
+            m_Latencies.reserve(std::min<std::size_t>(MAXIMUM_LATENCY_SAMPLES, 65536));
+
+            // Staggered over the first period, or over the first second
+            // when back to back, just as a fleet would power up.
+            const double spread = (options.m_Rate > 0.0) ? (1000000.0 / options.m_Rate) : 1000000.0;
+            std::uniform_real_distribution<double> offset(0.0, spread);
+            for (uint32_t node = 0; node < m_Nodes.size(); ++node)
+            {
+                m_Nodes[node].m_Group = static_cast<uint16_t>(1 + (node % MAXIMUM_GROUP_ID));
+                Schedule(static_cast<uint64_t>(offset(m_Engine)), node, TimerKind_t::CONNECT);
+            }
+        }
+
+        void Run()
+        {
+            const auto end = static_cast<uint64_t>(m_Options.m_Seconds * 1000000.0);
+            uint64_t nextSweep = 100000;
+            uint64_t nextReport = 1000000;
+            epoll_event events[256];
+
+            for (uint64_t now = Now(); now < end; now = Now())
+            {
+                const auto nextTimer = m_Timers.empty() ? end : m_Timers.top().m_Due;
+                const auto wakeAt = std::min({nextTimer, nextSweep, end});
+                const int timeout = (wakeAt > now) ? static_cast<int>((wakeAt - now + 999) / 1000) : 0;
+
+                const int count = ::epoll_wait(m_Epoll, events, 256, timeout);
+                for (int i = 0; i < count; ++i)
+                {
+                    OnEvent(events[i].data.u32, events[i].events);
+                }
+
+                now = Now();
+                while (!m_Timers.empty() && (m_Timers.top().m_Due <= now))
+                {
+                    const auto timer = m_Timers.top();
+                    m_Timers.pop();
+                    OnTimer(timer, now);
+                }
+
+                if (now >= nextSweep)
+                {
+                    Sweep(now);
+                    nextSweep = now + 100000;
+                }
+                if (now >= nextReport)
+                {
+                    Progress(now);
+                    nextReport += 1000000;
+                }
+            }
+        }
+
+        void Report() const
+        {
+            auto latencies = m_Latencies;
+            std::sort(latencies.begin(), latencies.end());
+            auto connects = m_ConnectTimes;
+            std::sort(connects.begin(), connects.end());
+
+            const auto at = [](const std::vector<uint32_t> & sorted, double fraction)
+            {
+                return sorted.empty() ? 0.0 : (sorted[static_cast<std::size_t>(fraction * (sorted.size() - 1))] / 1000.0);
+            };
+
+            rusage usage{};
+            ::getrusage(RUSAGE_SELF, &usage);
+
+            const std::size_t connected = std::count_if(m_Nodes.begin(), m_Nodes.end(), [](const Node_t & node)
+            {
+                return (node.m_State != NodeState_t::UNCONNECTED) && (node.m_State != NodeState_t::CONNECTING)
+                    && (node.m_State != NodeState_t::FAILED);
+            });
+
+            printf("%zu nodes over %s, %.1f messages/s each%s, link delay %.1f ms each way, %s, %.0f s\n",
+                m_Nodes.size(), (m_Options.m_IsUdp ? "UDP" : "TCP"), m_Options.m_Rate,
+                ((m_Options.m_Rate > 0.0) ? "" : " (back to back)"), m_Options.m_LinkDelayMicroseconds / 1000.0,
+                ToString(m_Options.m_Format), m_Options.m_Seconds);
+            printf("nodes connected:   %zu (%llu connect failures)\n", connected,
+                static_cast<unsigned long long>(m_ConnectFailures));
+            printf("connect time:      p50 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+                at(connects, 0.50), at(connects, 0.99), at(connects, 1.0));
+            printf("messages:          %llu sent, %llu replies, %llu timeouts, %llu send failures, %llu parse failures\n",
+                static_cast<unsigned long long>(m_Sent), static_cast<unsigned long long>(m_Replies),
+                static_cast<unsigned long long>(m_Timeouts), static_cast<unsigned long long>(m_SendFailures),
+                static_cast<unsigned long long>(m_ParseFailures));
+            printf("throughput:        %.0f replies/s\n", m_Replies / m_Options.m_Seconds);
+            printf("round trip:        p50 %.2f ms, p90 %.2f ms, p99 %.2f ms, p99.9 %.2f ms, max %.2f ms\n",
+                at(latencies, 0.50), at(latencies, 0.90), at(latencies, 0.99), at(latencies, 0.999),
+                at(latencies, 1.0));
+            printf("memory:            %ld KiB resident, %zu bytes of node state each\n",
+                usage.ru_maxrss, sizeof(Node_t));
+        }
+
+    private:
+        uint64_t Now() const
+        {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                Clock_t::now() - m_Start).count());
+        }
+
+        void Schedule(uint64_t due, uint32_t node, TimerKind_t kind)
+        {
+            m_Timers.push({due, node, kind});
+        }
+
+        void OnTimer(const Timer_t & timer, uint64_t now)
+        {
+            auto & node = m_Nodes[timer.m_Node];
+            switch (timer.m_Kind)
+            {
+                case TimerKind_t::CONNECT:
+                    if (m_ConnectsInProgress >= MAXIMUM_CONNECTS_IN_PROGRESS)
+                    {
+                        Schedule(now + 1000, timer.m_Node, TimerKind_t::CONNECT);
+                    }
+                    else
+                    {
+                        Connect(timer.m_Node, now);
+                    }
+                    break;
+
+                case TimerKind_t::SEND_DUE:
+                    if (node.m_State == NodeState_t::IDLE)
+                    {
+                        node.m_SentAt = static_cast<uint32_t>(now);
+                        if (m_Options.m_LinkDelayMicroseconds > 0)
+                        {
+                            node.m_State = NodeState_t::SENDING;
+                            Schedule(now + m_Options.m_LinkDelayMicroseconds, timer.m_Node, TimerKind_t::TRANSMIT);
+                        }
+                        else
+                        {
+                            Transmit(timer.m_Node, now);
+                        }
+                    }
+                    break;
+
+                case TimerKind_t::TRANSMIT:
+                    if (node.m_State == NodeState_t::SENDING)
+                    {
+                        Transmit(timer.m_Node, now);
+                    }
+                    break;
+
+                case TimerKind_t::DELIVER:
+                    if (node.m_State == NodeState_t::DELIVERING)
+                    {
+                        Delivered(timer.m_Node, now);
+                    }
+                    break;
+            }
+        }
+
+        void Connect(uint32_t index, uint64_t now)
+        {
+            auto & node = m_Nodes[index];
+            node.m_Socket = ::socket(AF_INET, (m_Options.m_IsUdp ? SOCK_DGRAM : SOCK_STREAM) | SOCK_NONBLOCK, 0);
+            if (node.m_Socket < 0)
+            {
+                Fail(index, "socket");
+                return;
+            }
+            if (!m_Options.m_IsUdp)
+            {
+                int one = 1;
+                ::setsockopt(node.m_Socket, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            }
+
+            node.m_ConnectStartedAt = static_cast<uint32_t>(now);
+            const int rc = ::connect(node.m_Socket, reinterpret_cast<const sockaddr *>(&m_Server), sizeof(m_Server));
+
+            epoll_event event{};
+            event.data.u32 = index;
+            if ((rc < 0) && (errno == EINPROGRESS))
+            {
+                node.m_State = NodeState_t::CONNECTING;
+                ++m_ConnectsInProgress;
+                event.events = EPOLLIN | EPOLLOUT | EPOLLET;
+            }
+            else if (rc == 0)
+            {
+                event.events = EPOLLIN | EPOLLET;
+            }
+            else
+            {
+                Fail(index, "connect");
+                return;
+            }
+            ::epoll_ctl(m_Epoll, EPOLL_CTL_ADD, node.m_Socket, &event);
+
+            if (rc == 0)
+            {
+                Connected(index, now);
+            }
+        }
+
+        void Connected(uint32_t index, uint64_t now)
+        {
+            auto & node = m_Nodes[index];
+            node.m_State = NodeState_t::IDLE;
+            m_ConnectTimes.push_back(static_cast<uint32_t>(now - node.m_ConnectStartedAt));
+            Schedule(now, index, TimerKind_t::SEND_DUE);
+        }
+
+        void Fail(uint32_t index, const char * pWhat)
+        {
+            auto & node = m_Nodes[index];
+            if (node.m_State == NodeState_t::CONNECTING)
+            {
+                --m_ConnectsInProgress;
+            }
+            if (node.m_Socket >= 0)
+            {
+                ::close(node.m_Socket);
+                node.m_Socket = -1;
+            }
+            if ((node.m_State == NodeState_t::UNCONNECTED) || (node.m_State == NodeState_t::CONNECTING))
+            {
+                ++m_ConnectFailures;
+            }
+            if (m_ReportedErrors++ < 5)
+            {
+                fprintf(stderr, "Error! Node %u: %s: %s\n", index, pWhat, strerror(errno));
+            }
+            node.m_State = NodeState_t::FAILED;
+        }
+
+        void Transmit(uint32_t index, uint64_t now)
+        {
+            auto & node = m_Nodes[index];
+            const Message_t message{node.m_Group, static_cast<bool>(node.m_Sequence & 1), node.m_Sequence};
+
+            char encoded[MAXIMUM_ENCODED_SIZE];
+            const auto length = Encode(m_Options.m_Format, message, encoded);
+            const auto rc = ::send(node.m_Socket, encoded, length, MSG_NOSIGNAL);
+            if (rc != static_cast<ssize_t>(length))
+            {
+                // A short or failed send of a few dozen bytes: the node gives
+                // this message up, as the device would on a send failure.
+                ++m_SendFailures;
+                node.m_State = NodeState_t::IDLE;
+                ScheduleNext(index, now);
+                return;
+            }
+            ++m_Sent;
+            node.m_Received = 0;
+            node.m_State = NodeState_t::AWAITING_REPLY;
+        }
+
+        void OnEvent(uint32_t index, uint32_t events)
+        {
+            auto & node = m_Nodes[index];
+            const uint64_t now = Now();
+
+            if (node.m_State == NodeState_t::CONNECTING)
+            {
+                int error = 0;
+                socklen_t length = sizeof(error);
+                ::getsockopt(node.m_Socket, SOL_SOCKET, SO_ERROR, &error, &length);
+                if ((error != 0) || (events & (EPOLLERR | EPOLLHUP)))
+                {
+                    errno = error;
+                    Fail(index, "connect");
+                    return;
+                }
+                if (!(events & EPOLLOUT))
+                {
+                    return;
+                }
+                --m_ConnectsInProgress;
+
+                // From now on only readability matters.
+                epoll_event event{};
+                event.data.u32 = index;
+                event.events = EPOLLIN | EPOLLET;
+                ::epoll_ctl(m_Epoll, EPOLL_CTL_MOD, node.m_Socket, &event);
+                Connected(index, now);
+                return;
+            }
+
+            if (events & EPOLLIN)
+            {
+                Receive(index, now);
+            }
+        }
+
+        void Receive(uint32_t index, uint64_t now)
+        {
+            auto & node = m_Nodes[index];
+
+            // Edge triggered; drain it.
+            for (;;)
+            {
+                char datagram[256];
+                const bool isStream = !m_Options.m_IsUdp;
+                char * pInto = isStream ? (node.m_Buffer + node.m_Received) : datagram;
+                const std::size_t room = isStream ? (sizeof(node.m_Buffer) - node.m_Received) : sizeof(datagram);
+
+                const auto rc = ::recv(node.m_Socket, pInto, room, 0);
+                if (rc < 0)
+                {
+                    if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != ECONNREFUSED))
+                    {
+                        Fail(index, "recv");
+                    }
+                    return;
+                }
+                if (rc == 0)
+                {
+                    errno = ECONNRESET;
+                    Fail(index, "recv");
+                    return;
+                }
+
+                std::string_view frame;
+                if (isStream)
+                {
+                    node.m_Received = static_cast<uint8_t>(node.m_Received + rc);
+                    const auto length = FrameLength(std::string_view(node.m_Buffer, node.m_Received));
+                    if (length == 0)
+                    {
+                        if (node.m_Received == sizeof(node.m_Buffer))
+                        {
+                            ++m_ParseFailures;
+                            node.m_Received = 0;
+                        }
+                        continue;
+                    }
+                    frame = std::string_view(node.m_Buffer, length);
+                }
+                else
+                {
+                    frame = std::string_view(datagram, rc);
+                }
+
+                const auto result = Decode(frame);
+                const bool isReply = result && (result.m_Message.m_Sequence == node.m_Sequence)
+                                            && (node.m_State == NodeState_t::AWAITING_REPLY);
+                if (!result)
+                {
+                    ++m_ParseFailures;
+                }
+
+                if (isStream)
+                {
+                    // Lock-step; nothing but the reply is ever in flight.
+                    node.m_Received = 0;
+                }
+
+                if (isReply)
+                {
+                    if (m_Options.m_LinkDelayMicroseconds > 0)
+                    {
+                        node.m_State = NodeState_t::DELIVERING;
+                        Schedule(now + m_Options.m_LinkDelayMicroseconds, index, TimerKind_t::DELIVER);
+                    }
+                    else
+                    {
+                        Delivered(index, now);
+                    }
+                }
+            }
+        }
+
+        void Delivered(uint32_t index, uint64_t now)
+        {
+            auto & node = m_Nodes[index];
+            RecordLatency(static_cast<uint32_t>(now - node.m_SentAt));
+            ++m_Replies;
+            ++node.m_Sequence;
+            node.m_State = NodeState_t::IDLE;
+            ScheduleNext(index, now);
+        }
+
+        void ScheduleNext(uint32_t index, uint64_t now)
+        {
+            const auto & node = m_Nodes[index];
+            if (m_Options.m_Rate <= 0.0)
+            {
+                Schedule(now, index, TimerKind_t::SEND_DUE);
+                return;
+            }
+            // On the node's own period, unless it has fallen behind it.
+            const auto period = static_cast<uint64_t>(1000000.0 / m_Options.m_Rate);
+            Schedule(std::max<uint64_t>(node.m_SentAt + period, now), index, TimerKind_t::SEND_DUE);
+        }
+
+        void RecordLatency(uint32_t microseconds)
+        {
+            if (m_Latencies.size() < MAXIMUM_LATENCY_SAMPLES)
+            {
+                m_Latencies.push_back(microseconds);
+                return;
+            }
+            // Reservoir sampling keeps the percentiles unbiased in bounded memory.
+            std::uniform_int_distribution<uint64_t> slot(0, m_Replies);
+            const auto replaced = slot(m_Engine);
+            if (replaced < MAXIMUM_LATENCY_SAMPLES)
+            {
+                m_Latencies[replaced] = microseconds;
+            }
+        }
+
+        void Sweep(uint64_t now)
+        {
+            for (uint32_t index = 0; index < m_Nodes.size(); ++index)
+            {
+                auto & node = m_Nodes[index];
+                if ((node.m_State == NodeState_t::AWAITING_REPLY) && ((now - node.m_SentAt) >= REPLY_TIMEOUT_MICROSECONDS))
+                {
+                    ++m_Timeouts;
+                    ++node.m_Sequence;
+                    node.m_Received = 0;
+                    node.m_State = NodeState_t::IDLE;
+                    ScheduleNext(index, now);
+                }
+            }
+        }
+
+        void Progress(uint64_t now)
+        {
+            fprintf(stderr, "FleetSimulator: %3.0f s, %zu connected, %llu replies/s, %llu timeouts\n", now / 1000000.0,
+                m_ConnectTimes.size(),
+                static_cast<unsigned long long>(m_Replies - m_RepliesAtLastProgress),
+                static_cast<unsigned long long>(m_Timeouts));
+            m_RepliesAtLastProgress = m_Replies;
+        }
+
+        Options_t                 m_Options;
+        std::vector<Node_t>       m_Nodes;
+        int                       m_Epoll;
+        sockaddr_in               m_Server{};
+        Clock_t::time_point       m_Start;
+        std::mt19937_64           m_Engine;
+        std::priority_queue<Timer_t, std::vector<Timer_t>, std::greater<Timer_t>> m_Timers;
+        std::vector<uint32_t>     m_Latencies;
+        std::vector<uint32_t>     m_ConnectTimes;
+        std::size_t               m_ConnectsInProgress{0};
+        uint64_t                  m_Sent{0};
+        uint64_t                  m_Replies{0};
+        uint64_t                  m_RepliesAtLastProgress{0};
+        uint64_t                  m_Timeouts{0};
+        uint64_t                  m_SendFailures{0};
+        uint64_t                  m_ParseFailures{0};
+        uint64_t                  m_ConnectFailures{0};
+        uint64_t                  m_ReportedErrors{0};
+    };
+
+    void RaiseOpenFileLimit()
+    {
+        rlimit limit{};
+        if (::getrlimit(RLIMIT_NOFILE, &limit) == 0)
+        {
+            limit.rlim_cur = limit.rlim_max;
+            ::setrlimit(RLIMIT_NOFILE, &limit);
+        }
+    }
+} // end of anonymous namespace
+
+int main(int argc, char * argv[])
+{
+    const Options_t options{
+        static_cast<std::size_t>((argc > 1) ? std::max(1, std::atoi(argv[1])) : 1000),
+        (argc > 2) ? std::atof(argv[2]) : 10.0,
+        (argc > 3) ? std::atof(argv[3]) : 1.0,
+        ((argc > 4) && (std::strcmp(argv[4], "udp") == 0)),
+        static_cast<uint64_t>(((argc > 5) ? std::atof(argv[5]) : 0.0) * 1000.0),
+        static_cast<uint16_t>((argc > 6) ? std::atoi(argv[6]) : 7007),
+        ((argc > 7) && (std::atoi(argv[7]) != 0)) ? WireFormat_t::BINARY : WireFormat_t::TEXT};
+
+    RaiseOpenFileLimit();
+
+    Fleet fleet(options);
+    fleet.Run();
+    fleet.Report();
+    return 0;
+}
@@ -0,0 +1,132 @@
+/***********************************************************************
+* @file      FlightRecorderDecoder.cpp
+*
+*    Host-side decoder of LightControl flight recorder images (see
+*    FlightRecorder.h). The input is scanned for the header of an image,
+*    whatever its capacity, so that it may be a debugger's dump of the
+*    RAM of a hung unit (g_FlightRecorderImage, or any range around it),
+*    a console capture of a boot with flight-recorder-dump-on-boot true,
+*    or the image file that LightControlHost writes. Every intact record
+*    of every image found is formatted, oldest first, with the very format
+*    strings of LogCatalog.h; torn ones are counted and skipped.
+*
+* @brief   Usage: FlightRecorderDecoder [image, dump or capture file, else stdin]
+*
+* @note    e.g. pyocd cmd -c "savemem <address of g_FlightRecorderImage> <size> flight.bin",
+*          with the address and size from the map file, then
+*          FlightRecorderDecoder flight.bin.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#include <cstring>
+#include <vector>
+
+#include "../FlightRecorder.h"
+
+namespace
+{
+    using namespace LightControl;
+
+    struct Header_t
+    {
+        uint32_t m_Magic;
+        uint32_t m_Capacity;
+        uint32_t m_BootCount;
+        uint32_t m_HeaderCheck;
+        uint32_t m_Next;
+        uint32_t m_Reserved;
+    };
+
+    static_assert(sizeof(Header_t) == FLIGHT_RECORDER_HEADER_SIZE);
+
+    // The size of the image whose header is at the offset, else 0.
+    std::size_t ImageSizeAt(const std::vector<uint8_t> & input, std::size_t offset, Header_t & header)
+    {
+        if ((input.size() - offset) < sizeof(header))
+        {
+            return 0;
+        }
+        std::memcpy(&header, input.data() + offset, sizeof(header));
+
+        const bool isHeader = (header.m_Magic == FLIGHT_RECORDER_MAGIC) && (header.m_Capacity > 0)
+            && ((header.m_Capacity & (header.m_Capacity - 1)) == 0)
+            && (header.m_HeaderCheck == FlightRecorderHeaderCheck(header.m_Magic, header.m_Capacity,
+                                                                  header.m_BootCount));
+        if (!isHeader || (((input.size() - offset - sizeof(header)) / sizeof(FlightRecord_t)) < header.m_Capacity))
+        {
+            return 0;
+        }
+        return sizeof(header) + (header.m_Capacity * sizeof(FlightRecord_t));
+    }
+} // end of anonymous namespace
+
+int main(int argc, char * argv[])
+{
+    FILE * pInput = (argc > 1) ? fopen(argv[1], "rb") : stdin;
+    if (!pInput)
+    {
+        fprintf(stderr, "Error! Cannot open %s\n", argv[1]);
+        return 1;
+    }
+
+    std::vector<uint8_t> input;
+    uint8_t chunk[4096];
+    std::size_t count;
+    while ((count = fread(chunk, 1, sizeof(chunk), pInput)) > 0)
+    {
+        input.insert(input.end(), chunk, chunk + count);
+    }
+
+    if (pInput != stdin)
+    {
+        fclose(pInput);
+    }
+
+    // Byte by byte, as a console capture need not keep the image aligned.
+    std::size_t images = 0;
+    std::size_t offset = 0;
+    while (offset < input.size())
+    {
+        Header_t header;
+        const auto size = ImageSizeAt(input, offset, header);
+        if (size == 0)
+        {
+            ++offset;
+            continue;
+        }
+
+        std::vector<FlightRecord_t> records(header.m_Capacity);
+        std::memcpy(records.data(), input.data() + offset + sizeof(header), records.size() * sizeof(FlightRecord_t));
+
+        printf("Flight recorder image at offset %zu: boot %u, %u records ever recorded, capacity %u\n",
+            offset, header.m_BootCount, header.m_Next, header.m_Capacity);
+
+        std::size_t decoded = 0;
+        const auto skipped = ForEachFlightRecord(records, header.m_Next, [&decoded](const FlightRecord_t & record)
+        {
+            LogRecord_t logRecord;
+            logRecord.m_ArgumentCount = static_cast<uint8_t>(FLIGHT_RECORD_ARGUMENTS);
+            logRecord.m_LogPoint = record.m_LogPoint;
+            logRecord.m_TimestampMilliseconds = record.m_TimestampMilliseconds;
+            logRecord.m_Arguments[0] = record.m_Arguments[0];
+            logRecord.m_Arguments[1] = record.m_Arguments[1];
+            Print(stdout, logRecord);
+            ++decoded;
+        });
+
+        fprintf(stderr, "%zu flight records decoded, %zu torn or never written skipped.\n", decoded, skipped);
+        ++images;
+        offset += size;
+    }
+
+    if (images == 0)
+    {
+        fprintf(stderr, "Error! No flight recorder image found.\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,224 @@
+/***********************************************************************
+* @file      FramerStress.cpp
+*
+*    Host stress run of LightControlFramer.h: millions of LightControl
+*    messages, of both wire formats and every optional field, are streamed
+*    through a StreamFramer just as recv() does on the device, i.e. written
+*    straight into WritableSpan() and Commit()ed, in pseudo-randomly sized
+*    chunks. Small chunks split messages across several recv()s, and large
+*    ones coalesce dozens into one; the ring wraps around all the while,
+*    and messages straddling its end go through the scratch copy.
+*
+*    Every message pulled out is decoded and compared, field by field,
+*    with the one that was sent in its place. Any message lost, out of
+*    order or misparsed, and any OVERSIZED stall, fails the run.
+*
+*    Runs with the device's receive ring (1024 bytes) and with the host
+*    servers' (256 bytes), and emits one JSON Lines object for each, as
+*    host/Benchmark.cpp does:
+*
+*    {"benchmark":"framer/stress/1024","iterations":N,"ns_per_op":X,"ops_per_second":Y,
+*     "lost":0,"misparsed":0,"oversized":0,"wrapped":W}
+*
+* @brief   Usage: FramerStress [messages=4000000] [seed=1]
+*
+* @note    Exits with 1 should any message be lost or misparsed. Only the
+*          framing and decoding are timed, not the generation of the stream.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "LightControlFramer.h"
+
+namespace
+{
+    using namespace LightControl;
+
+    // Messages generated, and fed, at a time.
+    constexpr std::size_t BLOCK{4096};
+
+    struct Outcome_t
+    {
+        uint64_t m_Received{0};
+        uint64_t m_Misparsed{0};
+        uint64_t m_Oversized{0};
+        uint64_t m_Wrapped{0}; // Straddled the end of the ring.
+        std::chrono::steady_clock::duration m_Elapsed{};
+    };
+
+    Message_t RandomMessage(std::mt19937 & random)
+    {
+        Message_t message;
+        message.m_Group = static_cast<uint16_t>(random() % (MAXIMUM_GROUP_ID + 1));
+        message.m_State = ((random() & 1) != 0);
+        const auto fields = random();
+        if (fields & 0x01)
+        {
+            message.m_Sequence = static_cast<uint8_t>(random());
+        }
+        if (fields & 0x02)
+        {
+            message.m_ExecuteAt = static_cast<uint32_t>(random());
+        }
+        if (fields & 0x04)
+        {
+            message.m_ControllerTime = static_cast<uint32_t>(random());
+        }
+        if (fields & 0x08)
+        {
+            message.m_Level = message.m_State ? static_cast<uint8_t>(1 + (random() % UINT8_MAX)) : 0;
+        }
+        if (fields & 0x10)
+        {
+            message.m_TransitionMilliseconds = static_cast<uint16_t>(random());
+        }
+        return message;
+    }
+
+    bool IsSame(const Message_t & received, const Message_t & sent)
+    {
+        return (received.m_Group == sent.m_Group) && (received.m_State == sent.m_State)
+            && (received.m_Sequence == sent.m_Sequence) && (received.m_ExecuteAt == sent.m_ExecuteAt)
+            && (received.m_ControllerTime == sent.m_ControllerTime) && (received.m_Level == sent.m_Level)
+            && (received.m_TransitionMilliseconds == sent.m_TransitionMilliseconds);
+    }
+
+    // As many bytes as one recv() might hand over: mostly a few, splitting
+    // messages, often a message or two's worth, and now and then as much
+    // as the ring has room for, coalescing many.
+    std::size_t RandomChunk(uint32_t random, std::size_t room)
+    {
+        const auto kind = random % 8;
+        const auto size = random >> 3;
+        const std::size_t chunk = (kind < 3) ? (1 + (size % 8))
+                                : ((kind < 7) ? (1 + (size % (2 * MAXIMUM_ENCODED_SIZE))) : room);
+        return std::min(chunk, room);
+    }
+
+    template <std::size_t CAPACITY>
+    Outcome_t Stress(uint64_t messages, uint32_t seed)
+    {
+        auto pFramer = std::make_unique<StreamFramer<CAPACITY>>();
+        std::mt19937 random(seed);
+        std::deque<Message_t> inFlight;
+        std::vector<char> stream;
+        Outcome_t outcome;
+
+        for (uint64_t generated = 0; generated < messages; )
+        {
+            // A block of the stream, as the peer would send it.
+            stream.clear();
+            const auto count = std::min<uint64_t>(BLOCK, messages - generated);
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                const auto message = RandomMessage(random);
+                const auto format = ((random() & 1) != 0) ? WireFormat_t::BINARY : WireFormat_t::TEXT;
+                char encoded[MAXIMUM_ENCODED_SIZE];
+                const auto length = Encode(format, message, encoded);
+                stream.insert(stream.end(), encoded, encoded + length);
+                if ((format == WireFormat_t::TEXT) && ((random() % 8) == 0))
+                {
+                    stream.push_back('\0'); // A stray extra terminator, to be skipped.
+                }
+                inFlight.push_back(message);
+            }
+            generated += count;
+
+            // Chunk sizes drawn up front, so that they are not timed.
+            std::vector<uint32_t> chunks(stream.size());
+            for (auto & chunk : chunks)
+            {
+                chunk = static_cast<uint32_t>(random());
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            std::size_t fed = 0;
+            std::size_t drawn = 0;
+            while (fed < stream.size())
+            {
+                auto span = pFramer->WritableSpan();
+                if (span.empty())
+                {
+                    ++outcome.m_Oversized;
+                    return outcome;
+                }
+                const auto chunk = RandomChunk(chunks[drawn++], std::min(span.size(), stream.size() - fed));
+                std::copy_n(stream.data() + fed, chunk, span.data());
+                pFramer->Commit(chunk);
+                fed += chunk;
+
+                std::string_view frame;
+                FrameStatus_t status;
+                while ((status = pFramer->Peek(frame)) == FrameStatus_t::FRAME)
+                {
+                    const auto result = Decode(frame);
+                    if (inFlight.empty() || !result || !IsSame(result.m_Message, inFlight.front()))
+                    {
+                        ++outcome.m_Misparsed;
+                        return outcome;
+                    }
+                    if (frame.data() != pFramer->ReadableView().data())
+                    {
+                        ++outcome.m_Wrapped;
+                    }
+                    inFlight.pop_front();
+                    ++outcome.m_Received;
+                    pFramer->Consume(frame.size());
+                }
+                if (status == FrameStatus_t::OVERSIZED)
+                {
+                    ++outcome.m_Oversized;
+                    return outcome;
+                }
+            }
+            outcome.m_Elapsed += std::chrono::steady_clock::now() - start;
+        }
+        return outcome;
+    }
+
+    template <std::size_t CAPACITY>
+    bool Run(uint64_t messages, uint32_t seed)
+    {
+        const auto outcome = Stress<CAPACITY>(messages, seed);
+        const auto lost = messages - outcome.m_Received;
+        const auto nanoseconds = std::chrono::duration<double, std::nano>(outcome.m_Elapsed).count()
+                               / static_cast<double>(std::max<uint64_t>(1, outcome.m_Received));
+
+        printf("{\"benchmark\":\"framer/stress/%zu\",\"iterations\":%llu,\"ns_per_op\":%.2f,\"ops_per_second\":%.0f,"
+               "\"lost\":%llu,\"misparsed\":%llu,\"oversized\":%llu,\"wrapped\":%llu}\n",
+            CAPACITY, static_cast<unsigned long long>(outcome.m_Received), nanoseconds,
+            (nanoseconds > 0.0) ? (1e9 / nanoseconds) : 0.0, static_cast<unsigned long long>(lost),
+            static_cast<unsigned long long>(outcome.m_Misparsed), static_cast<unsigned long long>(outcome.m_Oversized),
+            static_cast<unsigned long long>(outcome.m_Wrapped));
+        fflush(stdout);
+        return (lost == 0) && (outcome.m_Misparsed == 0) && (outcome.m_Oversized == 0);
+    }
+} // end of anonymous namespace
+
+int main(int argc, char * argv[])
+{
+    const auto messages = static_cast<uint64_t>(std::max(1LL, (argc > 1) ? std::atoll(argv[1]) : 4000000LL));
+    const auto seed     = static_cast<uint32_t>((argc > 2) ? std::strtoul(argv[2], nullptr, 0) : 1);
+
+    const bool isDevicePassed = Run<1024>(messages, seed);
+    const bool isHostPassed = Run<256>(messages, seed);
+
+    if (!isDevicePassed || !isHostPassed)
+    {
+        fprintf(stderr, "Error! Messages lost or misparsed.\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,297 @@
+/***********************************************************************
+* @file      LightControlHost.cpp
+*
+*    Linux host build of the LightControl client. Runs the unmodified
+*    LEDLightControl Setup() -> ConnectToSocket() -> Run() loop over the
+*    POSIX socket shims in ./mbed-shim, against a local EchoServer, and
+*    reports messages/second and round-trip latency percentiles.
+*
+*    A probe event is also posted onto the shared event queue every 10 ms,
+*    and how late each one gets dispatched is reported. This shows how
+*    responsive the queue stays, for other events, while traffic flows.
+*
+*    Finally, the per-command switching latency of the LightOutputDriver
+*    is measured against mock GPIO ports, for a node with 64 channels in
+*    64 groups, and compared with switching the same channels one
+*    DigitalOut at a time. As is the hot-path cost of a deferred log
+*    record against that of formatting the same line with printf.
+*
+*    With clock sync, run against host/ControlServer.cpp rather than the
+*    EchoServer, so that replies are stamped; commands pushed through its
+*    control port with an "x:" time are then executed from the timer.
+*
+*    Timed actions are light actions scheduled on the timer wheel, at
+*    random delays over the run, as an application's lighting schedule
+*    would be; with a blocking Run(), they only execute once it returns.
+*
+*    Dimming subscribes to group 002 and maps it onto a PWM channel, out of
+*    the way of the exchange's own commands to group 001, for commands with
+*    a level ("l:") and a transition time ("d:") to fade it from the fade
+*    timer; e.g. pushed to the master group 000, which the ControlServer
+*    fans out to every device, through its control port.
+*
+*    Given a file, the flight recorder image (see FlightRecorder.h) is
+*    written to it at the end, as a debugger would read it off a device,
+*    for host/FlightRecorderDecoder.cpp.
+*
+* @brief   Usage: LightControlHost [seconds=10] [tcp|udp] [pipeline window=1] [blocking|nonblocking|coroutine] [subscribed groups=1]
+*                                    [clock sync=0] [timed actions=0] [dimming=0] [flight recorder image file]
+*
+* @note    Per-message console output goes to stdout and the measurement
+*          report to stderr, so redirect stdout to /dev/null when timing.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#include <thread>
+#include <vector>
+
+#include "LEDLightControl.h"
+
+MCUTarget_t g_MCUTarget{MCUTarget_t::NUCLEO_F767ZI};
+
+LEDLightControl * g_pLEDLightControlManager = new LEDLightControl();
+
+namespace
+{
+    constexpr auto PROBE_PERIOD = 10ms;
+    constexpr uint16_t DIMMED_GROUP{2};
+
+    std::vector<int64_t>                   g_ProbeLatenessMicroseconds;
+    std::chrono::steady_clock::time_point  g_ProbeExpected;
+
+    void ProbeEventQueue()
+    {
+        const auto now = std::chrono::steady_clock::now();
+        g_ProbeLatenessMicroseconds.push_back(
+            std::chrono::duration_cast<std::chrono::microseconds>(now - g_ProbeExpected).count());
+        g_ProbeExpected = now + PROBE_PERIOD;
+        g_pSharedEventQueue->call_in(PROBE_PERIOD, ProbeEventQueue);
+    }
+
+    void ReportProbe(FILE * stream, std::chrono::seconds duration)
+    {
+        auto & lateness = g_ProbeLatenessMicroseconds;
+        std::sort(lateness.begin(), lateness.end());
+        const auto percentile = [&lateness](double p) -> double
+        {
+            return lateness.empty() ? 0.0 
+                : (lateness[static_cast<std::size_t>(p * (lateness.size() - 1))] / 1000.0);
+        };
+        fprintf(stream, "queue probe events: %zu of %lld expected\n", lateness.size(),
+            static_cast<long long>(duration / PROBE_PERIOD));
+        fprintf(stream, "queue lateness p50: %.3f ms\n", percentile(0.50));
+        fprintf(stream, "queue lateness p99: %.3f ms\n", percentile(0.99));
+        fprintf(stream, "queue lateness max: %.3f ms\n", percentile(1.00));
+    }
+
+    void ReportSwitching(FILE * stream)
+    {
+        constexpr uint16_t    GROUPS{64};
+        constexpr std::size_t COMMANDS{100000};
+
+        LightControl::LightOutputDriver outputs;
+        LightControl::GroupSet          subscribed;
+        const auto portA = outputs.AddPort(PortA, 0xFFFFFFFF);
+        const auto portB = outputs.AddPort(PortB, 0xFFFFFFFF);
+
+        std::vector<std::unique_ptr<DigitalOut>> pins;
+        for (uint16_t group = 1; group <= GROUPS; ++group)
+        {
+            subscribed.Subscribe(group);
+            outputs.MapGroup(group, (group <= 32) ? *portA : *portB, 1u << ((group - 1) % 32));
+            pins.push_back(std::make_unique<DigitalOut>(LED1));
+        }
+
+        const auto measure = [stream](const char * pLabel, auto && command)
+        {
+            std::vector<int64_t> latency(COMMANDS);
+            std::size_t writes = 0;
+            for (std::size_t i = 0; i < COMMANDS; ++i)
+            {
+                const auto start = std::chrono::steady_clock::now();
+                writes += command(i);
+                latency[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count();
+            }
+            std::sort(latency.begin(), latency.end());
+            fprintf(stream, "%-34s p50 %5lld ns, p99 %5lld ns, %.1f writes/command\n", pLabel,
+                static_cast<long long>(latency[COMMANDS / 2]),
+                static_cast<long long>(latency[(COMMANDS * 99) / 100]),
+                static_cast<double>(writes) / COMMANDS);
+        };
+
+        measure("switching, one group:", [&](std::size_t i)
+        {
+            return outputs.Apply(static_cast<uint16_t>(1 + (i % GROUPS)), (i & 1), subscribed);
+        });
+        measure("switching, master group broadcast:", [&](std::size_t i)
+        {
+            return outputs.Apply(LightControl::MASTER_GROUP_ID, (i & 1), subscribed);
+        });
+        measure("broadcast, DigitalOut per channel:", [&](std::size_t i)
+        {
+            for (auto & pin : pins)
+            {
+                pin->write(i & 1);
+            }
+            return pins.size();
+        });
+    }
+
+    // All heap, allocated at static initialization on the device.
+    void ReportMemory(FILE * stream)
+    {
+        fprintf(stream, "memory:             LEDLightControl %zu bytes, of which timer wheel %zu (%zu actions), "
+            "datagram reliability %zu\n",
+            sizeof(LEDLightControl), sizeof(LightControl::TimerWheel<uint16_t, TIMER_WHEEL_CAPACITY>),
+            TIMER_WHEEL_CAPACITY, sizeof(LightControl::DatagramReliability<128>));
+    }
+
+    void ReportLogging(FILE * stream)
+    {
+        constexpr std::size_t RECORDS{1000000};
+
+        constexpr std::size_t BATCH{512};
+
+        FILE * pNull = fopen("/dev/null", "w");
+        const auto measure = [stream](const char * pLabel, auto && log, auto && drain)
+        {
+            std::chrono::steady_clock::duration elapsed{};
+            for (std::size_t batch = 0; batch < (RECORDS / BATCH); ++batch)
+            {
+                const auto start = std::chrono::steady_clock::now();
+                for (std::size_t i = 0; i < BATCH; ++i)
+                {
+                    log(static_cast<int>((batch * BATCH) + i));
+                }
+                elapsed += std::chrono::steady_clock::now() - start;
+                drain();
+            }
+            fprintf(stream, "%-34s %6.1f ns/line\n", pLabel,
+                std::chrono::duration<double, std::nano>(elapsed).count() / (RECORDS - (RECORDS % BATCH)));
+        };
+
+        // Drained, to /dev/null, in between batches that fit in the ring,
+        // so that it is the cost of recording, not of dropping, measured.
+        auto pLog = std::make_unique<LightControl::DeferredLog<BATCH>>();
+        measure("logging, deferred record:", [&pLog](int i)
+        {
+            pLog->Record(LightControl::LogPoint_t::LIGHTS_SWITCHED, i % 1000, i & 1, 1);
+        },
+        [&pLog, pNull]() { pLog->Drain(pNull, true); });
+        fprintf(stream, "logging, deferred records dropped: %u\n", pLog->GetDroppedCount());
+
+        measure("logging, printf:", [pNull](int i)
+        {
+            fprintf(pNull, "Successfully parsed LightControl message. Switched \"g:%03d\" to \"s:%d\" in %d port write(s).\r\n",
+                i % 1000, i & 1, 1);
+        },
+        []() {});
+        fclose(pNull);
+    }
+} // end of anonymous namespace
+
+int main(int argc, char * argv[])
+{
+    const auto duration  = std::chrono::seconds((argc > 1) ? std::atoi(argv[1]) : 10);
+    const bool isUdp     = ((argc > 2) && (std::strcmp(argv[2], "udp") == 0));
+    const auto window    = static_cast<std::size_t>((argc > 3) ? std::atoi(argv[3]) : PIPELINE_WINDOW);
+    const bool isNonBlocking = (argc > 4) ? (std::strcmp(argv[4], "nonblocking") == 0) : NON_BLOCKING_SOCKET;
+    const bool isCoroutine = (argc > 4) ? (std::strcmp(argv[4], "coroutine") == 0) : COROUTINE_SESSION;
+    const auto groups    = (argc > 5) ? std::atoi(argv[5]) : 1;
+    const bool isClockSync = (argc > 6) ? (std::atoi(argv[6]) != 0) : CLOCK_SYNC;
+    const auto timedActions = (argc > 7) ? std::max(0, std::atoi(argv[7])) : 0;
+    const bool isDimming = ((argc > 8) && (std::atoi(argv[8]) != 0));
+    const char * pFlightRecorderFile = (argc > 9) ? argv[9] : nullptr;
+
+    fprintf(stderr, "Nuertey-Dragonfly-Cellular-LightControl host build, %s to %s:%d for %lld s, window %zu, %s, %d groups\n",
+        (isUdp ? "UDP" : "TCP"), ECHO_HOSTNAME, ECHO_PORT, static_cast<long long>(duration.count()), window,
+        (isCoroutine ? "coroutine" : (isNonBlocking ? "non-blocking" : "blocking")), groups);
+
+    g_pLEDLightControlManager->SetPipelineWindow(window);
+    g_pLEDLightControlManager->SetNonBlocking(isNonBlocking);
+    g_pLEDLightControlManager->SetCoroutineSession(isCoroutine);
+    g_pLEDLightControlManager->SetClockSync(isClockSync);
+    if (isDimming && !(g_pLEDLightControlManager->SubscribeGroup(DIMMED_GROUP)
+                       && g_pLEDLightControlManager->AddPwmChannel(LED2, DIMMED_GROUP)))
+    {
+        fprintf(stderr, "Error! Could not map group %03d onto a PWM channel.\n", DIMMED_GROUP);
+    }
+
+    // Additional memberships, to show that dispatch cost does not depend
+    // on how many groups the controller belongs to.
+    for (int group = 2; group <= groups; ++group)
+    {
+        g_pLEDLightControlManager->SubscribeGroup(static_cast<uint16_t>(group));
+    }
+
+    // Scheduled from the event queue, as the wheel is only ever touched there.
+    g_pSharedEventQueue->call([duration, timedActions]()
+    {
+        for (int action = 0; action < timedActions; ++action)
+        {
+            const auto delay = std::chrono::milliseconds(std::rand() % std::max<int64_t>(1, (duration.count() * 1000) - 500));
+            g_pLEDLightControlManager->ScheduleLightControl(1, (action % 2) == 0, delay);
+        }
+    });
+
+    g_ProbeExpected = std::chrono::steady_clock::now() + PROBE_PERIOD;
+    g_pSharedEventQueue->call_in(PROBE_PERIOD, ProbeEventQueue);
+
+    // Plays the part of the link going down: ends Run() and then lets
+    // dispatch_forever() return, so that the measurement can be reported.
+    std::thread stopper([duration]()
+    {
+        std::this_thread::sleep_for(duration);
+        g_IsConnected = false;
+        g_pSharedEventQueue->break_dispatch();
+    });
+
+    if (isUdp)
+    {
+        g_pLEDLightControlManager->Setup<TransportScheme_t::ETHERNET, TransportSocket_t::UDP>();
+    }
+    else
+    {
+        g_pLEDLightControlManager->Setup<TransportScheme_t::ETHERNET, TransportSocket_t::TCP>();
+    }
+
+    stopper.join();
+    HostLinkMetrics::Instance().Report(stderr);
+    const auto statistics = g_pLEDLightControlManager->GetStats();
+    statistics.Print(stderr);
+    // Replies acted upon, i.e. net of retransmissions and of duplicates.
+    fprintf(stderr, "goodput:            %.1f messages/s\n",
+        static_cast<double>(statistics.m_MessagesReceived) / static_cast<double>(duration.count()));
+    ReportProbe(stderr, duration);
+    if (isCoroutine)
+    {
+        const auto & arena = CoroutineFrameArena::Instance();
+        fprintf(stderr, "coroutine frames:   %zu of %zu at most, largest %zu of %zu bytes, %lu failed\n",
+            arena.HighWater(), COROUTINE_FRAMES, arena.LargestFrame(), COROUTINE_FRAME_BYTES,
+            static_cast<unsigned long>(arena.Failures()));
+    }
+    ReportSwitching(stderr);
+    ReportLogging(stderr);
+    ReportMemory(stderr);
+
+    if (pFlightRecorderFile)
+    {
+        FILE * pImage = fopen(pFlightRecorderFile, "wb");
+        if (!pImage || (fwrite(&g_FlightRecorder.Image(), sizeof(g_FlightRecorder.Image()), 1, pImage) != 1))
+        {
+            fprintf(stderr, "Error! Cannot write the flight recorder image to %s\n", pFlightRecorderFile);
+        }
+        if (pImage)
+        {
+            fclose(pImage);
+        }
+    }
+
+    delete g_pLEDLightControlManager;
+    return 0;
+}
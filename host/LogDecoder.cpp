@@ -0,0 +1,90 @@
+/***********************************************************************
+* @file      LogDecoder.cpp
+*
+*    Host-side decoder for the raw output of the deferred LightControl
+*    logger (deferred-log-raw true). Formats every LightControl::LogRecord_t
+*    in the input with the very format strings of LogCatalog.h; any bytes
+*    in between, such as the cold-path printf output that shares the
+*    console, are passed through unchanged.
+*
+* @brief   Usage: LogDecoder [raw capture file, else stdin]
+*
+* @note    e.g. LightControlHost 10 tcp | LogDecoder, when built with
+*          -DMBED_CONF_APP_DEFERRED_LOG_RAW=1.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#include <cstring>
+#include <vector>
+
+#include "../LogCatalog.h"
+
+int main(int argc, char * argv[])
+{
+    FILE * pInput = (argc > 1) ? fopen(argv[1], "rb") : stdin;
+    if (!pInput)
+    {
+        fprintf(stderr, "Error! Cannot open %s\n", argv[1]);
+        return 1;
+    }
+
+    std::vector<uint8_t> pending;
+    uint8_t chunk[4096];
+    std::size_t decoded = 0;
+    std::size_t count;
+
+    const auto decode = [&pending, &decoded](bool isFinal)
+    {
+        std::size_t offset = 0;
+        while (offset < pending.size())
+        {
+            if (pending[offset] != LightControl::LOG_RECORD_MAGIC)
+            {
+                fputc(pending[offset++], stdout);
+                continue;
+            }
+            if ((pending.size() - offset) < sizeof(LightControl::LogRecord_t))
+            {
+                if (!isFinal)
+                {
+                    break; // Wait for the rest of the record.
+                }
+                fputc(pending[offset++], stdout);
+                continue;
+            }
+
+            LightControl::LogRecord_t record;
+            std::memcpy(&record, pending.data() + offset, sizeof(record));
+            if (LightControl::IsValid(record))
+            {
+                LightControl::Print(stdout, record);
+                offset += sizeof(record);
+                ++decoded;
+            }
+            else
+            {
+                fputc(pending[offset++], stdout);
+            }
+        }
+        pending.erase(pending.begin(), pending.begin() + offset);
+    };
+
+    while ((count = fread(chunk, 1, sizeof(chunk), pInput)) > 0)
+    {
+        pending.insert(pending.end(), chunk, chunk + count);
+        decode(false);
+    }
+    decode(true);
+
+    fprintf(stderr, "%zu log records decoded.\n", decoded);
+
+    if (pInput != stdin)
+    {
+        fclose(pInput);
+    }
+    return 0;
+}
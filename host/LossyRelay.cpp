@@ -0,0 +1,253 @@
+/***********************************************************************
+* @file      LossyRelay.cpp
+*
+*    UDP relay that impairs the datagrams it forwards the way a poor
+*    cellular link would, so that the datagram reliability layer (see
+*    DatagramReliability.h) can be exercised and measured on a Linux box.
+*
+*    Datagrams received on the listening port from the client are sent
+*    on to the server, and the server's replies back to the client. In
+*    either direction each datagram may be dropped, duplicated, or held
+*    back by an extra random delay so that it arrives out of order.
+*
+* @brief   Usage: LossyRelay [listen port=7008] [server port=7007] [loss %=10]
+*                            [duplicate %=5] [reorder %=5] [delay milliseconds=20]
+*
+* @note    Point LightControlHost at the relay by building it with
+*          -DMBED_CONF_APP_ECHO_SERVER_PORT=7008.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using Clock_t = std::chrono::steady_clock;
+
+    struct Impairment_t
+    {
+        int                       m_LossPercent;
+        int                       m_DuplicatePercent;
+        int                       m_ReorderPercent;
+        std::chrono::milliseconds m_Delay;
+    };
+
+    struct Counters_t
+    {
+        std::atomic<uint32_t> m_Forwarded{0};
+        std::atomic<uint32_t> m_Dropped{0};
+        std::atomic<uint32_t> m_Duplicated{0};
+        std::atomic<uint32_t> m_Reordered{0};
+    };
+
+    // Sends each posted datagram once it is due; those due at the same
+    // time go in posting order.
+    class DelayQueue
+    {
+        struct Pending_t
+        {
+            int               m_Socket;
+            sockaddr_in       m_Destination;
+            std::vector<char> m_Data;
+        };
+
+    public:
+        DelayQueue()
+            : m_Thread([this]() { Drain(); })
+        {
+            m_Thread.detach();
+        }
+
+        void Post(Clock_t::time_point due, int fd, const sockaddr_in & destination, std::vector<char> data)
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Pending.emplace(due, Pending_t{fd, destination, std::move(data)});
+            m_Condition.notify_one();
+        }
+
+    private:
+        [[noreturn]] void Drain()
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            for (;;)
+            {
+                if (m_Pending.empty())
+                {
+                    m_Condition.wait(lock);
+                    continue;
+                }
+                auto earliest = m_Pending.begin();
+                if (Clock_t::now() < earliest->first)
+                {
+                    m_Condition.wait_until(lock, earliest->first);
+                    continue;
+                }
+                auto pending = std::move(earliest->second);
+                m_Pending.erase(earliest);
+                lock.unlock();
+                ::sendto(pending.m_Socket, pending.m_Data.data(), pending.m_Data.size(), 0,
+                         reinterpret_cast<const sockaddr *>(&pending.m_Destination), sizeof(pending.m_Destination));
+                lock.lock();
+            }
+        }
+
+        std::mutex                                   m_Mutex;
+        std::condition_variable                      m_Condition;
+        std::multimap<Clock_t::time_point, Pending_t> m_Pending;
+        std::thread                                  m_Thread;
+    };
+
+    int OpenBoundSocket(uint16_t port)
+    {
+        int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+        int one = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+        sockaddr_in address{};
+        address.sin_family      = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port        = htons(port);
+        if (::bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+        {
+            perror("bind");
+            std::exit(EXIT_FAILURE);
+        }
+        return fd;
+    }
+
+    class Impairer
+    {
+    public:
+        Impairer(const Impairment_t & impairment, DelayQueue & queue, Counters_t & counters, unsigned seed)
+            : m_Impairment(impairment), m_Queue(queue), m_Counters(counters), m_Engine(seed)
+        {
+        }
+
+        void Forward(int fd, const sockaddr_in & destination, const char * pData, ssize_t size)
+        {
+            if (Roll(m_Impairment.m_LossPercent))
+            {
+                ++m_Counters.m_Dropped;
+                return;
+            }
+
+            const auto copies = Roll(m_Impairment.m_DuplicatePercent) ? 2 : 1;
+            m_Counters.m_Duplicated += (copies - 1);
+            for (int copy = 0; copy < copies; ++copy)
+            {
+                auto due = Clock_t::now() + m_Impairment.m_Delay;
+                if (Roll(m_Impairment.m_ReorderPercent))
+                {
+                    // Long enough to be overtaken by whatever follows it.
+                    due += std::chrono::milliseconds(1 + (m_Engine() % (2 * m_Impairment.m_Delay.count() + 50)));
+                    ++m_Counters.m_Reordered;
+                }
+                m_Queue.Post(due, fd, destination, std::vector<char>(pData, pData + size));
+                ++m_Counters.m_Forwarded;
+            }
+        }
+
+    private:
+        bool Roll(int percent) { return static_cast<int>(m_Engine() % 100) < percent; }
+
+        Impairment_t     m_Impairment;
+        DelayQueue &     m_Queue;
+        Counters_t &     m_Counters;
+        std::mt19937     m_Engine;
+    };
+} // end of anonymous namespace
+
+int main(int argc, char * argv[])
+{
+    const auto listenPort = static_cast<uint16_t>((argc > 1) ? std::atoi(argv[1]) : 7008);
+    const auto serverPort = static_cast<uint16_t>((argc > 2) ? std::atoi(argv[2]) : 7007);
+    const Impairment_t impairment{(argc > 3) ? std::atoi(argv[3]) : 10,
+                                  (argc > 4) ? std::atoi(argv[4]) : 5,
+                                  (argc > 5) ? std::atoi(argv[5]) : 5,
+                                  std::chrono::milliseconds((argc > 6) ? std::atoi(argv[6]) : 20)};
+
+    // One socket faces the client, the other the server, so that the
+    // server's replies are told apart from the client's requests.
+    const int clientSide = OpenBoundSocket(listenPort);
+    const int serverSide = OpenBoundSocket(0);
+
+    sockaddr_in server{};
+    server.sin_family      = AF_INET;
+    server.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    server.sin_port        = htons(serverPort);
+
+    static DelayQueue queue;
+    static Counters_t counters;
+    static sockaddr_in client{};
+    static std::atomic<bool> isClientKnown{false};
+    static std::mutex clientMutex;
+
+    printf("LossyRelay forwarding UDP port %u to %u; loss %d%%, duplicate %d%%, reorder %d%%, delay %lld ms ...\n",
+        listenPort, serverPort, impairment.m_LossPercent, impairment.m_DuplicatePercent,
+        impairment.m_ReorderPercent, static_cast<long long>(impairment.m_Delay.count()));
+
+    // Server to client.
+    std::thread([serverSide, clientSide, impairment]()
+    {
+        Impairer impairer(impairment, queue, counters, 11);
+        char buffer[2048];
+        for (;;)
+        {
+            ssize_t received = ::recv(serverSide, buffer, sizeof(buffer), 0);
+            if ((received > 0) && isClientKnown)
+            {
+                std::lock_guard<std::mutex> lock(clientMutex);
+                impairer.Forward(clientSide, client, buffer, received);
+            }
+        }
+    }).detach();
+
+    // Summary once a second, so that a run can be ended at any point.
+    std::thread([]()
+    {
+        for (;;)
+        {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            fprintf(stderr, "LossyRelay: %u forwarded, %u dropped, %u duplicated, %u reordered\n",
+                counters.m_Forwarded.load(), counters.m_Dropped.load(),
+                counters.m_Duplicated.load(), counters.m_Reordered.load());
+        }
+    }).detach();
+
+    // Client to server.
+    Impairer impairer(impairment, queue, counters, 7);
+    char buffer[2048];
+    for (;;)
+    {
+        sockaddr_in peer{};
+        socklen_t length = sizeof(peer);
+        ssize_t received = ::recvfrom(clientSide, buffer, sizeof(buffer), 0,
+                                      reinterpret_cast<sockaddr *>(&peer), &length);
+        if (received > 0)
+        {
+            {
+                std::lock_guard<std::mutex> lock(clientMutex);
+                client = peer;
+            }
+            isClientKnown = true;
+            impairer.Forward(serverSide, server, buffer, received);
+        }
+    }
+}
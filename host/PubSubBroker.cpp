@@ -0,0 +1,276 @@
+/***********************************************************************
+* @file      PubSubBroker.cpp
+*
+*    Local stand-in for an MQTT-SN gateway/broker, for the LightControl
+*    publish/subscribe transport mode (see LightControlPubSub.h). Devices
+*    CONNECT and SUBSCRIBE to the predefined topics of their groups over
+*    UDP; every PUBLISH received, from whichever client, is then fanned
+*    out to every subscriber of its topic.
+*
+*    Subscribers are kept per topic, in one flat array over the whole
+*    000-999 group range, so that the fan-out of a publish is a walk of
+*    its topic's subscriber list and no more.
+*
+* @brief   Usage: PubSubBroker [port=1883]
+*
+* @note    A stand-in, not a broker: no retransmission of QoS 1 publishes
+*          to subscribers, no keep-alive expiry of clients (a client is
+*          only ever forgotten on DISCONNECT, or on CONNECT anew), and no
+*          retained messages.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "LightControlPubSub.h"
+
+namespace
+{
+    using namespace LightControl;
+
+    struct Subscriber_t
+    {
+        sockaddr_in m_Address;
+        uint8_t     m_QoS;
+    };
+
+    uint64_t KeyOf(const sockaddr_in & address)
+    {
+        return (static_cast<uint64_t>(address.sin_addr.s_addr) << 16) | address.sin_port;
+    }
+
+    class Broker
+    {
+    public:
+        explicit Broker(int fd) : m_Socket(fd) {}
+
+        void OnDatagram(const sockaddr_in & from, std::string_view datagram)
+        {
+            const auto packet = DecodePubSub(datagram);
+            if (!packet)
+            {
+                ++m_Malformed;
+                return;
+            }
+
+            switch (packet->m_Type)
+            {
+                case PubSubType_t::CONNECT:
+                    // Clean session, always.
+                    Forget(from);
+                    m_Clients[KeyOf(from)] = std::string(packet->m_Payload);
+                    Send(from, {PubSubType_t::CONNACK});
+                    break;
+
+                case PubSubType_t::SUBSCRIBE:
+                {
+                    PubSubPacket_t suback{PubSubType_t::SUBACK, PubSubQoSFlags(packet->IsQoS1() ? 1 : 0),
+                                          packet->m_TopicId, packet->m_MessageId};
+                    if (((packet->m_Flags & PUBSUB_TOPIC_ID_TYPE_MASK) != PUBSUB_TOPIC_ID_PREDEFINED)
+                        || (packet->m_TopicId > MAXIMUM_GROUP_ID))
+                    {
+                        suback.m_ReturnCode = PubSubReturnCode_t::REJECTED_TOPIC_ID;
+                    }
+                    else
+                    {
+                        Subscribe(from, packet->m_TopicId, packet->IsQoS1() ? 1 : 0);
+                    }
+                    Send(from, suback);
+                    break;
+                }
+
+                case PubSubType_t::UNSUBSCRIBE:
+                    if (packet->m_TopicId <= MAXIMUM_GROUP_ID)
+                    {
+                        Unsubscribe(from, packet->m_TopicId);
+                    }
+                    Send(from, {PubSubType_t::UNSUBACK, 0, 0, packet->m_MessageId});
+                    break;
+
+                case PubSubType_t::PUBLISH:
+                    if (packet->IsQoS1())
+                    {
+                        auto puback = MakePubAck(*packet);
+                        if (packet->m_TopicId > MAXIMUM_GROUP_ID)
+                        {
+                            puback.m_ReturnCode = PubSubReturnCode_t::REJECTED_TOPIC_ID;
+                        }
+                        Send(from, puback);
+                    }
+                    if (packet->m_TopicId <= MAXIMUM_GROUP_ID)
+                    {
+                        FanOut(*packet);
+                    }
+                    break;
+
+                case PubSubType_t::PINGREQ:
+                    Send(from, {PubSubType_t::PINGRESP});
+                    break;
+
+                case PubSubType_t::DISCONNECT:
+                    Forget(from);
+                    m_Clients.erase(KeyOf(from));
+                    Send(from, {PubSubType_t::DISCONNECT});
+                    break;
+
+                default:
+                    // PUBACKs from QoS 1 subscribers; nothing is retransmitted.
+                    break;
+            }
+        }
+
+        void Report(FILE * stream) const
+        {
+            fprintf(stream, "PubSubBroker: %zu clients, %llu publishes received, %llu delivered, %llu malformed\n",
+                m_Clients.size(), static_cast<unsigned long long>(m_Publishes),
+                static_cast<unsigned long long>(m_Deliveries), static_cast<unsigned long long>(m_Malformed));
+        }
+
+    private:
+        void FanOut(const PubSubPacket_t & publish)
+        {
+            ++m_Publishes;
+
+            // Encoded once per QoS, not once per subscriber; only the
+            // message ID differs, and it is the broker's own anyway.
+            char encoded[2][PUBSUB_MAXIMUM_PACKET_SIZE];
+            std::size_t lengths[2]{};
+            for (uint8_t qos = 0; qos < 2; ++qos)
+            {
+                auto forwarded = publish;
+                forwarded.m_Flags = static_cast<uint8_t>(PubSubQoSFlags(qos) | PUBSUB_TOPIC_ID_PREDEFINED);
+                forwarded.m_MessageId = ++m_MessageId;
+                lengths[qos] = EncodePubSub(forwarded, encoded[qos]);
+            }
+
+            const uint8_t published = publish.IsQoS1() ? 1 : 0;
+            for (const auto & subscriber : m_Topics[publish.m_TopicId])
+            {
+                const auto qos = std::min(published, subscriber.m_QoS);
+                ::sendto(m_Socket, encoded[qos], lengths[qos], 0,
+                         reinterpret_cast<const sockaddr *>(&subscriber.m_Address), sizeof(subscriber.m_Address));
+                ++m_Deliveries;
+            }
+        }
+
+        void Subscribe(const sockaddr_in & address, uint16_t topic, uint8_t qos)
+        {
+            auto & subscribers = m_Topics[topic];
+            const auto key = KeyOf(address);
+            auto existing = std::find_if(subscribers.begin(), subscribers.end(),
+                [key](const Subscriber_t & subscriber) { return KeyOf(subscriber.m_Address) == key; });
+            if (existing != subscribers.end())
+            {
+                existing->m_QoS = qos;
+                return;
+            }
+            subscribers.push_back({address, qos});
+            m_TopicsOf[key].push_back(topic);
+        }
+
+        void Unsubscribe(const sockaddr_in & address, uint16_t topic)
+        {
+            const auto key = KeyOf(address);
+            auto & subscribers = m_Topics[topic];
+            std::erase_if(subscribers, [key](const Subscriber_t & subscriber) { return KeyOf(subscriber.m_Address) == key; });
+            std::erase(m_TopicsOf[key], topic);
+        }
+
+        void Forget(const sockaddr_in & address)
+        {
+            const auto key = KeyOf(address);
+            const auto topics = m_TopicsOf.find(key);
+            if (topics == m_TopicsOf.end())
+            {
+                return;
+            }
+            for (const auto topic : topics->second)
+            {
+                std::erase_if(m_Topics[topic], [key](const Subscriber_t & subscriber) { return KeyOf(subscriber.m_Address) == key; });
+            }
+            m_TopicsOf.erase(topics);
+        }
+
+        void Send(const sockaddr_in & to, const PubSubPacket_t & packet)
+        {
+            char encoded[PUBSUB_MAXIMUM_PACKET_SIZE];
+            const auto length = EncodePubSub(packet, encoded);
+            ::sendto(m_Socket, encoded, length, 0, reinterpret_cast<const sockaddr *>(&to), sizeof(to));
+        }
+
+        int                                                  m_Socket;
+        std::array<std::vector<Subscriber_t>, MAXIMUM_GROUP_ID + 1> m_Topics;
+        std::unordered_map<uint64_t, std::vector<uint16_t>>  m_TopicsOf;
+        std::unordered_map<uint64_t, std::string>            m_Clients;
+        uint16_t                                             m_MessageId{0};
+        uint64_t                                             m_Publishes{0};
+        uint64_t                                             m_Deliveries{0};
+        uint64_t                                             m_Malformed{0};
+    };
+} // end of anonymous namespace
+
+int main(int argc, char * argv[])
+{
+    const auto port = static_cast<uint16_t>((argc > 1) ? std::atoi(argv[1]) : 1883);
+
+    int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    int one = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    // Fan-out bursts go out faster than a default send buffer drains.
+    int bufferSize = 8 * 1024 * 1024;
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &bufferSize, sizeof(bufferSize));
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+
+    sockaddr_in address{};
+    address.sin_family      = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port        = htons(port);
+    if (::bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+    {
+        perror("bind");
+        return EXIT_FAILURE;
+    }
+
+    printf("PubSubBroker listening on UDP port %u ...\n", port);
+
+    // Reports once every 5 s, from the receive timeout, so that a run can
+    // be ended at any point.
+    timeval timeout{1, 0};
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    auto nextReport = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+    Broker broker(fd);
+    char buffer[2048];
+    for (;;)
+    {
+        sockaddr_in from{};
+        socklen_t length = sizeof(from);
+        ssize_t received = ::recvfrom(fd, buffer, sizeof(buffer), 0, reinterpret_cast<sockaddr *>(&from), &length);
+        if (received > 0)
+        {
+            broker.OnDatagram(from, std::string_view(buffer, received));
+        }
+
+        if (std::chrono::steady_clock::now() >= nextReport)
+        {
+            broker.Report(stderr);
+            nextReport += std::chrono::seconds(5);
+        }
+    }
+}
@@ -0,0 +1,249 @@
+/***********************************************************************
+* @file      PubSubFanout.cpp
+*
+*    Benchmarks the fan-out latency of the LightControl publish/subscribe
+*    transport mode: N simulated devices, each a UDP socket of its own,
+*    CONNECT to the broker (host/PubSubBroker.cpp, or any MQTT-SN gateway
+*    with predefined topics) and SUBSCRIBE to one group's topic. One
+*    controller then publishes LightControl messages to that group, one at
+*    a time, and the time until each device has it is measured.
+*
+*    Reported are the latency of each single delivery, and that of the
+*    fan-out as a whole, i.e. until the last of the devices has it, which
+*    is what decides how in step a group of lights switches.
+*
+* @brief   Usage: PubSubFanout [subscribers=100] [publishes=200] [broker port=1883]
+*                              [qos=0] [group=1] [binary=1]
+*
+* @note    The devices also ack QoS 1 publishes, as a device would. The
+*          number of devices is bounded by the open file limit, which is
+*          raised as far as it goes.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "LightControlPubSub.h"
+
+namespace
+{
+    using namespace LightControl;
+    using Clock_t = std::chrono::steady_clock;
+
+    // How long the devices are given to receive one publish, or to be
+    // acknowledged a CONNECT or SUBSCRIBE.
+    constexpr auto DELIVERY_TIMEOUT = std::chrono::seconds(1);
+
+    int OpenConnectedSocket(uint16_t port)
+    {
+        int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+        if (fd < 0)
+        {
+            perror("socket");
+            std::exit(EXIT_FAILURE);
+        }
+
+        sockaddr_in broker{};
+        broker.sin_family      = AF_INET;
+        broker.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        broker.sin_port        = htons(port);
+        ::connect(fd, reinterpret_cast<sockaddr *>(&broker), sizeof(broker));
+        return fd;
+    }
+
+    void Send(int fd, const PubSubPacket_t & packet)
+    {
+        char encoded[PUBSUB_MAXIMUM_PACKET_SIZE];
+        const auto length = EncodePubSub(packet, encoded);
+        ::send(fd, encoded, length, 0);
+    }
+
+    // Polls every socket still waiting, until each has received a packet
+    // of the given type or the timeout expires; onPacket() is called for
+    // each such packet, and says whether that socket is done waiting.
+    template <typename OnPacket>
+    std::size_t AwaitAll(std::vector<pollfd> & fds, std::vector<bool> & waiting, PubSubType_t type,
+                         OnPacket && onPacket)
+    {
+        auto remaining = static_cast<std::size_t>(std::count(waiting.begin(), waiting.end(), true));
+        const auto deadline = Clock_t::now() + DELIVERY_TIMEOUT;
+
+        while ((remaining > 0) && (Clock_t::now() < deadline))
+        {
+            const auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock_t::now());
+            if (::poll(fds.data(), fds.size(), static_cast<int>(std::max<int64_t>(timeout.count(), 1))) <= 0)
+            {
+                continue;
+            }
+            const auto now = Clock_t::now();
+            for (std::size_t i = 0; i < fds.size(); ++i)
+            {
+                if (!(fds[i].revents & POLLIN))
+                {
+                    continue;
+                }
+                char buffer[256];
+                ssize_t received;
+                while ((received = ::recv(fds[i].fd, buffer, sizeof(buffer), 0)) > 0)
+                {
+                    const auto packet = DecodePubSub(std::string_view(buffer, received));
+                    if (packet && (packet->m_Type == type) && waiting[i] && onPacket(i, *packet, now))
+                    {
+                        waiting[i] = false;
+                        --remaining;
+                    }
+                }
+            }
+        }
+        return remaining;
+    }
+
+    void RaiseOpenFileLimit()
+    {
+        rlimit limit{};
+        if (::getrlimit(RLIMIT_NOFILE, &limit) == 0)
+        {
+            limit.rlim_cur = limit.rlim_max;
+            ::setrlimit(RLIMIT_NOFILE, &limit);
+        }
+    }
+
+    double Percentile(std::vector<double> & samples, double fraction)
+    {
+        if (samples.empty())
+        {
+            return 0.0;
+        }
+        std::sort(samples.begin(), samples.end());
+        return samples[static_cast<std::size_t>(fraction * (samples.size() - 1))];
+    }
+} // end of anonymous namespace
+
+int main(int argc, char * argv[])
+{
+    const auto subscribers = static_cast<std::size_t>((argc > 1) ? std::max(1, std::atoi(argv[1])) : 100);
+    const auto publishes   = (argc > 2) ? std::max(1, std::atoi(argv[2])) : 200;
+    const auto port        = static_cast<uint16_t>((argc > 3) ? std::atoi(argv[3]) : 1883);
+    const auto qos         = static_cast<uint8_t>((argc > 4) ? std::atoi(argv[4]) : 0);
+    const auto group       = static_cast<uint16_t>((argc > 5) ? std::atoi(argv[5]) : 1);
+    const auto format      = ((argc > 6) && (std::atoi(argv[6]) == 0)) ? WireFormat_t::TEXT : WireFormat_t::BINARY;
+
+    RaiseOpenFileLimit();
+
+    std::vector<pollfd> fds;
+    for (std::size_t i = 0; i < subscribers; ++i)
+    {
+        fds.push_back({OpenConnectedSocket(port), POLLIN, 0});
+    }
+    std::vector<bool> waiting(subscribers, true);
+
+    // Every device connects and subscribes; those not answered are retried.
+    for (int attempt = 0; (attempt < 3) && std::count(waiting.begin(), waiting.end(), true); ++attempt)
+    {
+        for (std::size_t i = 0; i < subscribers; ++i)
+        {
+            if (waiting[i])
+            {
+                const auto clientId = "fanout-" + std::to_string(i);
+                Send(fds[i].fd, {PubSubType_t::CONNECT, PUBSUB_FLAG_CLEAN_SESSION, 0, 0, 60,
+                                 PubSubReturnCode_t::ACCEPTED, clientId});
+            }
+        }
+        AwaitAll(fds, waiting, PubSubType_t::CONNACK, [](std::size_t, const PubSubPacket_t &, Clock_t::time_point) { return true; });
+    }
+    std::fill(waiting.begin(), waiting.end(), true);
+    for (int attempt = 0; (attempt < 3) && std::count(waiting.begin(), waiting.end(), true); ++attempt)
+    {
+        for (std::size_t i = 0; i < subscribers; ++i)
+        {
+            if (waiting[i])
+            {
+                Send(fds[i].fd, MakeSubscribe(group, qos, 1));
+            }
+        }
+        AwaitAll(fds, waiting, PubSubType_t::SUBACK, [](std::size_t, const PubSubPacket_t & suback, Clock_t::time_point)
+        {
+            return (suback.m_ReturnCode == PubSubReturnCode_t::ACCEPTED);
+        });
+    }
+    std::vector<bool> isSubscribed(waiting);
+    isSubscribed.flip();
+    const auto unsubscribed = static_cast<std::size_t>(std::count(waiting.begin(), waiting.end(), true));
+    if (unsubscribed == subscribers)
+    {
+        fprintf(stderr, "Error! No device could subscribe; is the broker listening on UDP port %u?\n", port);
+        return EXIT_FAILURE;
+    }
+
+    const int publisher = OpenConnectedSocket(port);
+    Send(publisher, {PubSubType_t::CONNECT, PUBSUB_FLAG_CLEAN_SESSION, 0, 0, 60,
+                     PubSubReturnCode_t::ACCEPTED, "fanout-controller"});
+
+    std::vector<double> deliveries;
+    std::vector<double> fanouts;
+    std::size_t lost = 0;
+    const auto started = Clock_t::now();
+
+    for (int publish = 0; publish < publishes; ++publish)
+    {
+        for (std::size_t i = 0; i < subscribers; ++i)
+        {
+            waiting[i] = isSubscribed[i];
+        }
+
+        char encoded[PUBSUB_MAXIMUM_PACKET_SIZE];
+        const auto length = EncodePublish(format, Message_t{group, static_cast<bool>(publish & 1)},
+                                          PubSubQoSFlags(qos), static_cast<uint16_t>(publish + 1), encoded);
+        const auto sent = Clock_t::now();
+        ::send(publisher, encoded, length, 0);
+
+        double slowest = 0.0;
+        lost += AwaitAll(fds, waiting, PubSubType_t::PUBLISH, [&](std::size_t i, const PubSubPacket_t & packet, Clock_t::time_point at)
+        {
+            if (packet.IsQoS1())
+            {
+                Send(fds[i].fd, MakePubAck(packet));
+            }
+            const auto latency = std::chrono::duration<double, std::micro>(at - sent).count();
+            deliveries.push_back(latency);
+            slowest = std::max(slowest, latency);
+            return true;
+        });
+        fanouts.push_back(slowest);
+    }
+
+    const auto seconds = std::chrono::duration<double>(Clock_t::now() - started).count();
+
+    printf("%zu subscribers (%zu failed to subscribe), %d publishes at QoS %u, %s payload\n",
+        subscribers, unsubscribed, publishes, qos, ToString(format));
+    printf("deliveries:        %zu of %zu (%zu lost)\n", deliveries.size(),
+        static_cast<std::size_t>(publishes) * (subscribers - unsubscribed), lost);
+    printf("delivery latency:  p50 %.1f us, p99 %.1f us, max %.1f us\n",
+        Percentile(deliveries, 0.50), Percentile(deliveries, 0.99), Percentile(deliveries, 1.00));
+    printf("fan-out complete:  p50 %.1f us, p99 %.1f us, max %.1f us\n",
+        Percentile(fanouts, 0.50), Percentile(fanouts, 0.99), Percentile(fanouts, 1.00));
+    printf("throughput:        %.0f deliveries/s\n", deliveries.size() / seconds);
+
+    for (const auto & fd : fds)
+    {
+        Send(fd.fd, {PubSubType_t::DISCONNECT});
+        ::close(fd.fd);
+    }
+    ::close(publisher);
+    return 0;
+}
@@ -0,0 +1,212 @@
+/***********************************************************************
+* @file      RadioScheduleSimulator.cpp
+*
+*    Simulates hours of LightControl traffic on a simulated clock, and
+*    reports the radio-on (RRC connected) time per hour that it costs, sent
+*    as soon as each command arrives against batched into wake windows by
+*    the very TrafficScheduler that the target uses.
+*
+*    Commands arrive as a Poisson process, each for a random group. The
+*    radio model is the usual one for LTE-M: a radio that is asleep (PSM,
+*    eDRX or idle) first pays for a connection setup; each exchange then
+*    keeps it busy; and after the last one it stays on for the network's
+*    inactivity timer before it may go back to sleep. Exchanges are timed
+*    one after another, i.e. as with a pipeline window of 1.
+*
+* @brief   Usage: RadioScheduleSimulator [commands/hour=60] [window period s=300] [window length s=10]
+*                 [groups=1] [hours=24] [inactivity timer s=10] [setup ms=1500] [exchange ms=300]
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "TrafficScheduler.h"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    using Milliseconds_t = std::chrono::milliseconds;
+
+    // Stands in for Kernel::Clock; it only moves when told to.
+    class SimulatedClock
+    {
+    public:
+        Milliseconds_t Now() const { return m_Now; }
+        void AdvanceTo(Milliseconds_t time) { m_Now = std::max(m_Now, time); }
+
+    private:
+        Milliseconds_t m_Now{0};
+    };
+
+    class RadioModel
+    {
+    public:
+        RadioModel(Milliseconds_t setup, Milliseconds_t exchange, Milliseconds_t inactivityTimer)
+            : m_Setup(setup), m_Exchange(exchange), m_InactivityTimer(inactivityTimer)
+        {
+        }
+
+        // One exchange, started no sooner than at; returns when the reply is in.
+        Milliseconds_t Exchange(Milliseconds_t at)
+        {
+            auto start = std::max(at, m_BusyUntil);
+            if (start >= m_OnUntil)
+            {
+                m_OnTime += (m_OnUntil - m_OnSince);
+                m_OnSince = start;
+                start += m_Setup;
+                ++m_Wakes;
+            }
+            m_BusyUntil = start + m_Exchange;
+            m_OnUntil = m_BusyUntil + m_InactivityTimer;
+            ++m_Exchanges;
+            return m_BusyUntil;
+        }
+
+        Milliseconds_t OnTime() const { return m_OnTime + (m_OnUntil - m_OnSince); }
+        uint32_t Wakes() const { return m_Wakes; }
+        uint32_t Exchanges() const { return m_Exchanges; }
+
+    private:
+        Milliseconds_t m_Setup;
+        Milliseconds_t m_Exchange;
+        Milliseconds_t m_InactivityTimer;
+        Milliseconds_t m_OnSince{0};
+        Milliseconds_t m_OnUntil{0};
+        Milliseconds_t m_BusyUntil{0};
+        Milliseconds_t m_OnTime{0};
+        uint32_t       m_Wakes{0};
+        uint32_t       m_Exchanges{0};
+    };
+
+    struct Command_t
+    {
+        Milliseconds_t m_Arrival;
+        uint16_t       m_Group;
+        bool           m_State;
+    };
+
+    void Report(const char * pPolicy, const RadioModel & radio, std::vector<Milliseconds_t> latency, double hours)
+    {
+        std::sort(latency.begin(), latency.end());
+        const auto seconds = [](Milliseconds_t time) { return std::chrono::duration<double>(time).count(); };
+        const auto at = [&latency](double fraction)
+        {
+            return latency.empty() ? 0ms : latency[static_cast<std::size_t>(fraction * (latency.size() - 1))];
+        };
+        Milliseconds_t total{0};
+        for (const auto & each : latency)
+        {
+            total += each;
+        }
+
+        printf("%-14s %9.1f %7.2f%% %8.1f %11.1f %9.1f %7.1f %7.1f\n", pPolicy,
+            seconds(radio.OnTime()) / hours, (100.0 * seconds(radio.OnTime())) / (hours * 3600.0),
+            radio.Wakes() / hours, radio.Exchanges() / hours,
+            latency.empty() ? 0.0 : (seconds(total) / latency.size()), seconds(at(0.99)), seconds(at(1.0)));
+    }
+} // end of anonymous namespace
+
+int main(int argc, char * argv[])
+{
+    const double rate       = (argc > 1) ? std::atof(argv[1]) : 60.0;
+    const auto   period     = std::chrono::seconds((argc > 2) ? std::atoi(argv[2]) : 300);
+    const auto   length     = std::chrono::seconds((argc > 3) ? std::atoi(argv[3]) : 10);
+    const auto   groups     = (argc > 4) ? std::max(1, std::atoi(argv[4])) : 1;
+    const double hours      = (argc > 5) ? std::atof(argv[5]) : 24.0;
+    const auto   inactivity = std::chrono::seconds((argc > 6) ? std::atoi(argv[6]) : 10);
+    const auto   setup      = Milliseconds_t((argc > 7) ? std::atoi(argv[7]) : 1500);
+    const auto   exchange   = Milliseconds_t((argc > 8) ? std::atoi(argv[8]) : 300);
+
+    printf("%.0f commands/hour over %d group(s) for %.0f h; windows of %lld s every %lld s; "
+           "setup %lld ms, exchange %lld ms, inactivity timer %lld s\n\n",
+        rate, groups, hours, static_cast<long long>(length.count()), static_cast<long long>(period.count()),
+        static_cast<long long>(setup.count()), static_cast<long long>(exchange.count()),
+        static_cast<long long>(inactivity.count()));
+
+    // The same command load for either policy.
+    std::mt19937 engine(7);
+    std::exponential_distribution<double> interArrival(rate / 3600000.0);
+    std::uniform_int_distribution<int> group(1, groups);
+    std::vector<Command_t> commands;
+    const auto horizon = Milliseconds_t(static_cast<int64_t>(hours * 3600000.0));
+    for (auto arrival = Milliseconds_t(static_cast<int64_t>(interArrival(engine))); arrival < horizon;
+         arrival += Milliseconds_t(static_cast<int64_t>(interArrival(engine))))
+    {
+        commands.push_back({arrival, static_cast<uint16_t>(group(engine)), static_cast<bool>(engine() & 1)});
+    }
+
+    printf("%-14s %9s %8s %8s %11s %9s %7s %7s\n", "policy", "radio-on", "duty", "wakes", "exchanges",
+        "latency", "p99", "max");
+    printf("%-14s %9s %8s %8s %11s %9s %7s %7s\n", "", "s/hour", "", "/hour", "/hour", "mean s", "s", "s");
+
+    // Each command on its own, as soon as it arrives.
+    {
+        RadioModel radio(setup, exchange, inactivity);
+        std::vector<Milliseconds_t> latency;
+        for (const auto & command : commands)
+        {
+            latency.push_back(radio.Exchange(command.m_Arrival) - command.m_Arrival);
+        }
+        Report("immediate", radio, std::move(latency), hours);
+    }
+
+    // Queued, and flushed in one burst per wake window.
+    {
+        RadioModel radio(setup, exchange, inactivity);
+        SimulatedClock clock;
+        LightControl::TrafficScheduler<1024> scheduler({period, length});
+        std::map<uint16_t, std::vector<Milliseconds_t>> pending; // Arrivals served by the queued message.
+        std::vector<Milliseconds_t> latency;
+
+        const auto flush = [&]()
+        {
+            while (!scheduler.IsEmpty())
+            {
+                const auto group = scheduler.Front().m_Group;
+                scheduler.Pop();
+                const auto reply = radio.Exchange(clock.Now());
+                for (const auto & arrival : pending[group])
+                {
+                    latency.push_back(reply - arrival);
+                }
+                pending[group].clear();
+            }
+        };
+        const auto flushDueBy = [&](Milliseconds_t time)
+        {
+            for (auto due = scheduler.NextFlush(clock.Now()); due && (*due <= time); due = scheduler.NextFlush(clock.Now()))
+            {
+                clock.AdvanceTo(*due);
+                flush();
+            }
+        };
+
+        for (const auto & command : commands)
+        {
+            flushDueBy(command.m_Arrival);
+            clock.AdvanceTo(command.m_Arrival);
+            scheduler.Enqueue({command.m_Group, command.m_State});
+            pending[command.m_Group].push_back(command.m_Arrival);
+            flushDueBy(clock.Now());
+        }
+        flushDueBy(Milliseconds_t::max() / 2);
+
+        Report("wake windows", radio, std::move(latency), hours);
+        printf("\n%u of %zu commands coalesced into a newer one for the same group.\n",
+            scheduler.CoalescedCount(), commands.size());
+    }
+
+    return 0;
+}
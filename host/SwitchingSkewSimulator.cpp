@@ -0,0 +1,272 @@
+/***********************************************************************
+* @file      SwitchingSkewSimulator.cpp
+*
+*    Simulates one LightControl group of nodes behind cellular links, and
+*    reports how far apart in time its lights switch on one command, when
+*    each node acts on receipt as opposed to at the time the command is
+*    stamped with ("x:"); see ClockSync.h.
+*
+*    Every node has a clock of its own, booted at a random time, and off
+*    by a random drift of up to the given ppm. Every link has a one-way
+*    delay of its own, different uplink and downlink, plus exponentially
+*    distributed jitter, plus the occasional spike of hundreds of ms such
+*    as RRC state changes and HARQ retransmissions cause. Nodes run the
+*    lock-step exchange of LEDLightControl, asking for every reply to be
+*    stamped, and the controller issues commands to the group for the
+*    given lead time ahead. The controller's clock wraps around 2^32 ms
+*    early in the run.
+*
+*    It is a discrete-event simulation, in simulated time: no sockets and
+*    no sleeping, so a run over hundreds of nodes takes a moment. Stamps
+*    and commands go through the very codec (LightControlCodec.h), and
+*    offsets are estimated by the very estimator (ClockSync.h), that the
+*    device uses.
+*
+* @brief   Usage: SwitchingSkewSimulator [nodes=500] [commands=50] [lead ms=1500]
+*                                        [exchange period ms=1000] [drift ppm=50] [seed=1]
+*
+* @note    Skew is the spread, across the group, of when the lights of one
+*          command actually switch; error is how far one node is off the
+*          time the command was stamped with.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "ClockSync.h"
+#include "LightControlCodec.h"
+
+namespace
+{
+    using namespace LightControl;
+
+    constexpr uint16_t GROUP{1};
+
+    // The controller's clock reads this at the start of the run, so that
+    // it wraps around 2^32 ms 30 s in.
+    constexpr uint32_t CONTROLLER_EPOCH_MILLISECONDS{UINT32_MAX - 30000};
+
+    // Commands are only issued once the nodes have had a few exchanges.
+    constexpr int WARM_UP_EXCHANGES{4};
+    constexpr int64_t COMMAND_SPACING_MICROSECONDS{3000000};
+
+    // As the device's MAXIMUM_EXECUTE_AHEAD_MILLISECONDS defaults to.
+    constexpr uint64_t MAXIMUM_EXECUTE_AHEAD_MICROSECONDS{60000000};
+
+    // A cellular-like link, per direction and per node.
+    constexpr double MINIMUM_BASE_DELAY_MICROSECONDS{20000};
+    constexpr double MAXIMUM_BASE_DELAY_MICROSECONDS{60000};
+    constexpr double MEAN_JITTER_MICROSECONDS{15000};
+    constexpr double SPIKE_PROBABILITY{0.05};
+    constexpr double MINIMUM_SPIKE_MICROSECONDS{200000};
+    constexpr double MAXIMUM_SPIKE_MICROSECONDS{1500000};
+
+    std::mt19937_64 g_Random;
+
+    double Uniform(double low, double high)
+    {
+        return std::uniform_real_distribution<double>(low, high)(g_Random);
+    }
+
+    // Controller time, in ms modulo 2^32, at simulated time t.
+    uint32_t ControllerMilliseconds(int64_t t)
+    {
+        return static_cast<uint32_t>(CONTROLLER_EPOCH_MILLISECONDS + static_cast<uint64_t>(t / 1000));
+    }
+
+    struct Exchange_t
+    {
+        int64_t m_SentAt;      // Simulated time, in microseconds.
+        int64_t m_UplinkDelay;
+        int64_t m_DownlinkDelay;
+    };
+
+    class Node
+    {
+    public:
+        Node(double driftPpm, int64_t exchangePeriod)
+            : m_BootOffset(static_cast<uint64_t>(Uniform(0, 86400e6)))
+            , m_Rate(1.0 + (Uniform(-driftPpm, driftPpm) * 1e-6))
+            , m_UplinkBase(Uniform(MINIMUM_BASE_DELAY_MICROSECONDS, MAXIMUM_BASE_DELAY_MICROSECONDS))
+            , m_DownlinkBase(Uniform(MINIMUM_BASE_DELAY_MICROSECONDS, MAXIMUM_BASE_DELAY_MICROSECONDS))
+            , m_ExchangePeriod(exchangePeriod)
+            , m_Pending(Draw(static_cast<int64_t>(Uniform(0, static_cast<double>(exchangePeriod)))))
+        {
+        }
+
+        // The node's own clock, in microseconds, at simulated time t.
+        uint64_t Local(int64_t t) const
+        {
+            return m_BootOffset + static_cast<uint64_t>(std::llround(static_cast<double>(t) * m_Rate));
+        }
+
+        int64_t SimulatedTimeOf(uint64_t local) const
+        {
+            return std::llround(static_cast<double>(static_cast<int64_t>(local - m_BootOffset)) / m_Rate);
+        }
+
+        int64_t DownlinkDelay() { return Delay(m_DownlinkBase); }
+
+        // Completes every exchange whose reply is in by simulated time t.
+        void ExchangeUntil(int64_t t)
+        {
+            while ((m_Pending.m_SentAt + m_Pending.m_UplinkDelay + m_Pending.m_DownlinkDelay) <= t)
+            {
+                const auto stampedAt = m_Pending.m_SentAt + m_Pending.m_UplinkDelay;
+                const auto receivedAt = stampedAt + m_Pending.m_DownlinkDelay;
+
+                // The controller's reply to "c:0000000000", over the wire.
+                char encoded[MAXIMUM_ENCODED_SIZE];
+                const auto length = Encode(WireFormat_t::TEXT,
+                    Message_t{GROUP, false, std::nullopt, std::nullopt, ControllerMilliseconds(stampedAt)}, encoded);
+                const auto reply = Decode(std::string_view(encoded, length));
+
+                m_Estimator.OnExchange(Local(receivedAt),
+                    static_cast<uint32_t>(Local(receivedAt) - Local(m_Pending.m_SentAt)), *reply.m_Message.m_ControllerTime);
+                m_Pending = Draw(receivedAt + m_ExchangePeriod);
+            }
+        }
+
+        const ClockOffsetEstimator & Estimator() const { return m_Estimator; }
+
+    private:
+        int64_t Delay(double base)
+        {
+            auto delay = base + std::exponential_distribution<double>(1.0 / MEAN_JITTER_MICROSECONDS)(g_Random);
+            if (Uniform(0, 1) < SPIKE_PROBABILITY)
+            {
+                delay += Uniform(MINIMUM_SPIKE_MICROSECONDS, MAXIMUM_SPIKE_MICROSECONDS);
+            }
+            return static_cast<int64_t>(delay);
+        }
+
+        Exchange_t Draw(int64_t sentAt)
+        {
+            return Exchange_t{sentAt, Delay(m_UplinkBase), Delay(m_DownlinkBase)};
+        }
+
+        uint64_t             m_BootOffset;
+        double               m_Rate;
+        double               m_UplinkBase;
+        double               m_DownlinkBase;
+        int64_t              m_ExchangePeriod;
+        Exchange_t           m_Pending;
+        ClockOffsetEstimator m_Estimator;
+    };
+
+    double Percentile(std::vector<double> & samples, double fraction)
+    {
+        if (samples.empty())
+        {
+            return 0.0;
+        }
+        std::sort(samples.begin(), samples.end());
+        return samples[static_cast<std::size_t>(fraction * (samples.size() - 1))];
+    }
+
+    double Spread(const std::vector<int64_t> & times)
+    {
+        const auto [earliest, latest] = std::minmax_element(times.begin(), times.end());
+        return static_cast<double>(*latest - *earliest);
+    }
+} // end of anonymous namespace
+
+int main(int argc, char * argv[])
+{
+    const auto nodes     = static_cast<std::size_t>((argc > 1) ? std::max(2, std::atoi(argv[1])) : 500);
+    const auto commands  = (argc > 2) ? std::max(1, std::atoi(argv[2])) : 50;
+    const auto lead      = static_cast<int64_t>((argc > 3) ? std::max(0, std::atoi(argv[3])) : 1500) * 1000;
+    const auto period    = static_cast<int64_t>((argc > 4) ? std::max(1, std::atoi(argv[4])) : 1000) * 1000;
+    const auto driftPpm  = (argc > 5) ? std::atof(argv[5]) : 50.0;
+    g_Random.seed((argc > 6) ? std::strtoull(argv[6], nullptr, 10) : 1);
+
+    std::vector<Node> group;
+    group.reserve(nodes);
+    for (std::size_t i = 0; i < nodes; ++i)
+    {
+        group.emplace_back(driftPpm, period);
+    }
+
+    std::vector<double> immediateSkews;
+    std::vector<double> scheduledSkews;
+    std::vector<double> errors;
+    std::vector<double> dispersions;
+    std::size_t overdue = 0;
+    std::size_t unscheduled = 0;
+
+    std::vector<int64_t> immediate(nodes);
+    std::vector<int64_t> scheduled(nodes);
+
+    for (int command = 0; command < commands; ++command)
+    {
+        const auto issuedAt = (WARM_UP_EXCHANGES * (period + static_cast<int64_t>(MAXIMUM_BASE_DELAY_MICROSECONDS * 2)))
+                            + (command * COMMAND_SPACING_MICROSECONDS);
+
+        // The controller stamps the command with a time lead ahead of now;
+        // the intended instant is whenever its clock reads that.
+        const auto executeAt = ControllerMilliseconds(issuedAt + lead);
+        const auto intendedAt = static_cast<int64_t>(static_cast<uint32_t>(executeAt - CONTROLLER_EPOCH_MILLISECONDS)) * 1000;
+
+        char encoded[MAXIMUM_ENCODED_SIZE];
+        const auto length = Encode(WireFormat_t::TEXT, Message_t{GROUP, (command % 2) == 0, std::nullopt, executeAt}, encoded);
+        const auto received = Decode(std::string_view(encoded, length));
+
+        for (std::size_t i = 0; i < nodes; ++i)
+        {
+            auto & node = group[i];
+            const auto arrivedAt = issuedAt + node.DownlinkDelay();
+            node.ExchangeUntil(arrivedAt);
+
+            immediate[i] = arrivedAt;
+            scheduled[i] = arrivedAt;
+
+            // As LEDLightControl::ExecuteLightControl() decides.
+            const auto now = node.Local(arrivedAt);
+            const auto due = node.Estimator().LocalTimeOf(*received.m_Message.m_ExecuteAt);
+            if (due && (*due <= now))
+            {
+                ++overdue;
+            }
+            else if (due && ((*due - now) <= MAXIMUM_EXECUTE_AHEAD_MICROSECONDS))
+            {
+                scheduled[i] = node.SimulatedTimeOf(*due);
+            }
+            else
+            {
+                ++unscheduled;
+            }
+            errors.push_back(std::abs(static_cast<double>(scheduled[i] - intendedAt)));
+            dispersions.push_back(node.Estimator().DispersionMicroseconds());
+        }
+
+        immediateSkews.push_back(Spread(immediate));
+        scheduledSkews.push_back(Spread(scheduled));
+    }
+
+    const auto executions = nodes * static_cast<std::size_t>(commands);
+
+    printf("%zu nodes, %d commands %.0f ms ahead, exchanges every %.0f ms, drift up to +/-%.0f ppm\n",
+        nodes, commands, lead / 1000.0, period / 1000.0, driftPpm);
+    printf("link, each way:    %.0f-%.0f ms, +%.0f ms mean jitter, %.0f%% spikes of %.0f-%.0f ms\n",
+        MINIMUM_BASE_DELAY_MICROSECONDS / 1000, MAXIMUM_BASE_DELAY_MICROSECONDS / 1000, MEAN_JITTER_MICROSECONDS / 1000,
+        SPIKE_PROBABILITY * 100, MINIMUM_SPIKE_MICROSECONDS / 1000, MAXIMUM_SPIKE_MICROSECONDS / 1000);
+    printf("on receipt:        skew across the group p50 %.1f ms, p99 %.1f ms, max %.1f ms\n",
+        Percentile(immediateSkews, 0.50) / 1000, Percentile(immediateSkews, 0.99) / 1000, Percentile(immediateSkews, 1.00) / 1000);
+    printf("at \"x:\":           skew across the group p50 %.1f ms, p99 %.1f ms, max %.1f ms\n",
+        Percentile(scheduledSkews, 0.50) / 1000, Percentile(scheduledSkews, 0.99) / 1000, Percentile(scheduledSkews, 1.00) / 1000);
+    printf("at \"x:\", per node: error p50 %.2f ms, p99 %.2f ms, max %.2f ms (dispersion p50 %.2f ms, p99 %.2f ms)\n",
+        Percentile(errors, 0.50) / 1000, Percentile(errors, 0.99) / 1000, Percentile(errors, 1.00) / 1000,
+        Percentile(dispersions, 0.50) / 1000, Percentile(dispersions, 0.99) / 1000);
+    printf("fell back to receipt: %zu overdue, %zu unscheduled, of %zu\n", overdue, unscheduled, executions);
+    return 0;
+}
@@ -0,0 +1,32 @@
+/***********************************************************************
+* @file      Callback.h
+*
+*    Host (Linux) stand-in for mbed::Callback, backed by std::function.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <functional>
+
+namespace mbed
+{
+    template <typename F>
+    using Callback = std::function<F>;
+
+    template <typename R, typename... Args>
+    Callback<R(Args...)> callback(R (*func)(Args...))
+    {
+        return Callback<R(Args...)>(func);
+    }
+
+    template <typename T, typename R, typename... Args>
+    Callback<R(Args...)> callback(T * obj, R (T::*method)(Args...))
+    {
+        return [obj, method](Args... args) { return (obj->*method)(args...); };
+    }
+} // end of namespace
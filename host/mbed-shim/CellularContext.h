@@ -0,0 +1,46 @@
+/***********************************************************************
+* @file      CellularContext.h
+*
+*    Host (Linux) stand-in for the Mbed OS cellular framework types that
+*    LEDLightControl.h names. There is no modem on the host, so the
+*    default instances are absent and only the ETHERNET transport scheme
+*    can be instantiated there.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include "NetworkInterface.h"
+
+typedef struct
+{
+    nsapi_error_t error;
+    int           status_data;
+    bool          final_try;
+} cell_callback_data_t;
+
+typedef enum
+{
+    CellularDeviceReady = NSAPI_EVENT_CELLULAR_STATUS_BASE,
+    CellularSIMStatusChanged,
+    CellularRegistrationStatusChanged,
+    CellularRegistrationTypeChanged,
+    CellularCellIDChanged,
+    CellularRadioAccessTechnologyChanged,
+    CellularAttachNetwork,
+    CellularActivatePDPContext,
+    CellularSignalQuality,
+    CellularStateRetryEvent,
+    CellularDeviceTimeout
+} cellular_connection_status_t;
+
+class CellularContext : public NetworkInterface
+{
+public:
+    static CellularContext * get_default_instance() { return nullptr; }
+    static CellularContext * get_default_nonip_instance() { return nullptr; }
+};
@@ -0,0 +1,28 @@
+/***********************************************************************
+* @file      CellularDevice.h
+*
+*    Host (Linux) stand-in for CellularDevice. See CellularContext.h.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include "CellularContext.h"
+
+class CellularDevice
+{
+public:
+    static CellularDevice * get_target_default_instance() { return nullptr; }
+    static CellularDevice * get_default_instance() { return nullptr; }
+
+    virtual ~CellularDevice() = default;
+
+    virtual nsapi_error_t set_power_save_mode([[maybe_unused]] int periodic_time, [[maybe_unused]] int active_time = 0)
+    {
+        return NSAPI_ERROR_UNSUPPORTED;
+    }
+};
@@ -0,0 +1,14 @@
+/***********************************************************************
+* @file      CellularLog.h
+*
+*    Host (Linux) stand-in for the Mbed OS cellular trace hooks.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include "mbed_trace.h"
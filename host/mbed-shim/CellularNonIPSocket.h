@@ -0,0 +1,37 @@
+/***********************************************************************
+* @file      CellularNonIPSocket.h
+*
+*    Host (Linux) stand-in for CellularNonIPSocket. NIDD has no host
+*    equivalent, so every operation reports NSAPI_ERROR_UNSUPPORTED.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include "Socket.h"
+#include "CellularContext.h"
+
+class CellularNonIPSocket : public Socket
+{
+public:
+    nsapi_error_t open(CellularContext *) { return NSAPI_ERROR_UNSUPPORTED; }
+    nsapi_error_t close() override { return NSAPI_ERROR_OK; }
+    nsapi_error_t connect(const SocketAddress &) override { return NSAPI_ERROR_UNSUPPORTED; }
+    nsapi_size_or_error_t send(const void *, nsapi_size_t) override { return NSAPI_ERROR_UNSUPPORTED; }
+    nsapi_size_or_error_t recv(void *, nsapi_size_t) override { return NSAPI_ERROR_UNSUPPORTED; }
+    nsapi_size_or_error_t sendto(const SocketAddress &, const void *, nsapi_size_t) override 
+    { 
+        return NSAPI_ERROR_UNSUPPORTED; 
+    }
+    nsapi_size_or_error_t recvfrom(SocketAddress *, void *, nsapi_size_t) override 
+    { 
+        return NSAPI_ERROR_UNSUPPORTED; 
+    }
+    void set_blocking(bool) override {}
+    void set_timeout(int) override {}
+    void sigio(mbed::Callback<void()>) override {}
+};
@@ -0,0 +1,40 @@
+/***********************************************************************
+* @file      CriticalSectionLock.h
+*
+*    Host (Linux) stand-in for mbed::CriticalSectionLock. Where the
+*    target masks interrupts, the host takes one process-wide recursive
+*    mutex, which the shim of mbed::Timeout holds in turn while it runs
+*    its "ISR"; so the two exclude each other just as they do on target.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <mutex>
+
+namespace mbed
+{
+    class CriticalSectionLock
+    {
+    public:
+        CriticalSectionLock()  { Interrupts().lock(); }
+        ~CriticalSectionLock() { Interrupts().unlock(); }
+
+        CriticalSectionLock(const CriticalSectionLock&) = delete;
+        CriticalSectionLock& operator=(const CriticalSectionLock&) = delete;
+
+        static void enable()  { Interrupts().lock(); }
+        static void disable() { Interrupts().unlock(); }
+
+    private:
+        static std::recursive_mutex & Interrupts()
+        {
+            static std::recursive_mutex s_Interrupts;
+            return s_Interrupts;
+        }
+    };
+} // end of namespace
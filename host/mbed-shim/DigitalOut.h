@@ -0,0 +1,63 @@
+/***********************************************************************
+* @file      DigitalOut.h
+*
+*    Host (Linux) stand-in for mbed::DigitalOut. Pin writes are simply
+*    latched in memory, and counted, so that host tooling can observe
+*    actuation without any hardware.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+enum PinName
+{
+    LED1 = 0,
+    LED2,
+    LED3,
+    NC = -1
+};
+
+namespace mbed
+{
+    class DigitalOut
+    {
+    public:
+        explicit DigitalOut(PinName pin, int value = 0)
+            : m_Pin(pin)
+            , m_Value(value)
+        {
+        }
+
+        void write(int value)
+        {
+            m_Value = value;
+            ++m_WriteCount;
+        }
+
+        int read() const { return m_Value; }
+
+        int is_connected() const { return (m_Pin != NC); }
+
+        DigitalOut & operator=(int value)
+        {
+            write(value);
+            return *this;
+        }
+
+        operator int() const { return read(); }
+
+        uint64_t GetWriteCount() const { return m_WriteCount; } // Host only.
+
+    private:
+        PinName               m_Pin;
+        std::atomic<int>      m_Value;
+        std::atomic<uint64_t> m_WriteCount{0};
+    };
+} // end of namespace
@@ -0,0 +1,201 @@
+/***********************************************************************
+* @file      EventQueue.h
+*
+*    Host (Linux) stand-in for events::EventQueue. Events are kept in a
+*    time-ordered multimap guarded by a mutex/condition variable, which
+*    is sufficient to reproduce the Mbed OS dispatch semantics the
+*    application relies upon: call(), call_in(), call_every(), cancel(),
+*    dispatch_forever(), dispatch_once() and break_dispatch().
+*
+* @note      Like its Mbed OS namesake, the queue has no notion of event
+*            priority; events due at the same time run in posting order.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+namespace events
+{
+    class EventQueue
+    {
+        using Clock_t    = std::chrono::steady_clock;
+        using Duration_t = std::chrono::milliseconds;
+
+        struct Event_t
+        {
+            int                   m_Id;
+            Duration_t            m_Period; // Zero for one-shot events.
+            std::function<void()> m_Function;
+        };
+
+    public:
+        explicit EventQueue([[maybe_unused]] std::size_t size = 0, [[maybe_unused]] unsigned char * buffer = nullptr)
+        {
+        }
+
+        EventQueue(const EventQueue&) = delete;
+        EventQueue& operator=(const EventQueue&) = delete;
+
+        template <typename F>
+        int call(F f)
+        {
+            return Post(Duration_t::zero(), Duration_t::zero(), std::move(f));
+        }
+
+        template <typename T, typename R, typename... Args>
+        int call(T * obj, R (T::*method)(Args...), Args... args)
+        {
+            return call([=]() { (obj->*method)(args...); });
+        }
+
+        template <typename F>
+        int call_in(Duration_t ms, F f)
+        {
+            return Post(ms, Duration_t::zero(), std::move(f));
+        }
+
+        template <typename T, typename R, typename... Args>
+        int call_in(Duration_t ms, T * obj, R (T::*method)(Args...), Args... args)
+        {
+            return call_in(ms, [=]() { (obj->*method)(args...); });
+        }
+
+        template <typename F>
+        int call_every(Duration_t ms, F f)
+        {
+            return Post(ms, ms, std::move(f));
+        }
+
+        template <typename T, typename R, typename... Args>
+        int call_every(Duration_t ms, T * obj, R (T::*method)(Args...), Args... args)
+        {
+            return call_every(ms, [=]() { (obj->*method)(args...); });
+        }
+
+        bool cancel(int id)
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            for (auto iter = m_Events.begin(); iter != m_Events.end(); ++iter)
+            {
+                if (iter->second.m_Id == id)
+                {
+                    m_Events.erase(iter);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Milliseconds until the given event is due, or -1 if not pending.
+        int time_left(int id)
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            for (const auto & [due, event] : m_Events)
+            {
+                if (event.m_Id == id)
+                {
+                    auto left = std::chrono::duration_cast<Duration_t>(due - Clock_t::now());
+                    return (left.count() > 0) ? static_cast<int>(left.count()) : 0;
+                }
+            }
+            return -1;
+        }
+
+        void dispatch_forever()
+        {
+            Dispatch(std::nullopt);
+        }
+
+        void dispatch_once()
+        {
+            Dispatch(Duration_t::zero());
+        }
+
+        void dispatch_for(Duration_t ms)
+        {
+            Dispatch(ms);
+        }
+
+        void break_dispatch()
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_BreakRequested = true;
+            m_Condition.notify_all();
+        }
+
+    private:
+        template <typename F>
+        int Post(Duration_t delay, Duration_t period, F f)
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            const int id = ++m_NextId;
+            m_Events.emplace(Clock_t::now() + delay, Event_t{id, period, std::function<void()>(std::move(f))});
+            m_Condition.notify_all();
+            return id;
+        }
+
+        void Dispatch(std::optional<Duration_t> limit)
+        {
+            const auto deadline = limit ? (Clock_t::now() + *limit) : Clock_t::time_point::max();
+
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            while (!m_BreakRequested)
+            {
+                const auto now = Clock_t::now();
+                if (!m_Events.empty() && (m_Events.begin()->first <= now))
+                {
+                    auto node  = m_Events.extract(m_Events.begin());
+                    auto event = std::move(node.mapped());
+
+                    lock.unlock();
+                    event.m_Function();
+                    lock.lock();
+
+                    if (event.m_Period > Duration_t::zero())
+                    {
+                        m_Events.emplace(node.key() + event.m_Period, std::move(event));
+                    }
+                    continue;
+                }
+
+                if (now >= deadline)
+                {
+                    break;
+                }
+
+                auto wakeup = deadline;
+                if (!m_Events.empty() && (m_Events.begin()->first < wakeup))
+                {
+                    wakeup = m_Events.begin()->first;
+                }
+                if (wakeup == Clock_t::time_point::max())
+                {
+                    m_Condition.wait(lock);
+                }
+                else
+                {
+                    m_Condition.wait_until(lock, wakeup);
+                }
+            }
+            m_BreakRequested = false;
+        }
+
+        std::mutex                             m_Mutex;
+        std::condition_variable                m_Condition;
+        std::multimap<Clock_t::time_point, Event_t> m_Events;
+        int                                    m_NextId{0};
+        bool                                   m_BreakRequested{false};
+    };
+} // end of namespace
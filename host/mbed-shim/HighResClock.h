@@ -0,0 +1,33 @@
+/***********************************************************************
+* @file      HighResClock.h
+*
+*    Host (Linux) stand-in for mbed::HighResClock, the microsecond clock
+*    of the us_ticker, backed by std::chrono::steady_clock.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <chrono>
+
+namespace mbed
+{
+    struct HighResClock
+    {
+        using duration   = std::chrono::microseconds;
+        using rep        = duration::rep;
+        using period     = duration::period;
+        using time_point = std::chrono::time_point<HighResClock>;
+        static constexpr bool is_steady = true;
+
+        static time_point now()
+        {
+            return time_point(std::chrono::duration_cast<duration>(
+                                  std::chrono::steady_clock::now().time_since_epoch()));
+        }
+    };
+} // end of namespace
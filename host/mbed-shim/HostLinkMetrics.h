@@ -0,0 +1,119 @@
+/***********************************************************************
+* @file      HostLinkMetrics.h
+*
+*    Host only. Link level instrumentation for the POSIX socket shims:
+*    every successful send() timestamps a message into a FIFO, and each
+*    message is retired as one round trip once as many bytes as it held
+*    have been received back. As the echo server returns the byte stream
+*    unaltered, this holds even when replies are pipelined, coalesced or
+*    split. That gives messages/second and round-trip latency percentiles
+*    for the unmodified LEDLightControl client loop.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+class HostLinkMetrics
+{
+    using Clock_t = std::chrono::steady_clock;
+
+    struct Outstanding_t
+    {
+        Clock_t::time_point m_SentAt;
+        std::size_t         m_Bytes;
+    };
+
+public:
+    static HostLinkMetrics & Instance()
+    {
+        static HostLinkMetrics theInstance;
+        return theInstance;
+    }
+
+    void OnSend(std::size_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        Start();
+        m_Outstanding.push_back(Outstanding_t{Clock_t::now(), bytes});
+        m_BytesSent += bytes;
+        ++m_Sends;
+    }
+
+    void OnReceive(std::size_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        Start();
+        m_BytesReceived += bytes;
+        ++m_Receives;
+        m_UnmatchedBytes += bytes;
+        const auto now = Clock_t::now();
+        while (!m_Outstanding.empty() && (m_UnmatchedBytes >= m_Outstanding.front().m_Bytes))
+        {
+            m_UnmatchedBytes -= m_Outstanding.front().m_Bytes;
+            m_RoundTripsNanoseconds.push_back(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    now - m_Outstanding.front().m_SentAt).count()));
+            m_Outstanding.pop_front();
+        }
+    }
+
+    void Report(FILE * stream)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        const double seconds = std::chrono::duration<double>(Clock_t::now() - m_StartTime).count();
+        
+        std::sort(m_RoundTripsNanoseconds.begin(), m_RoundTripsNanoseconds.end());
+        const auto percentile = [this](double p) -> double
+        {
+            if (m_RoundTripsNanoseconds.empty())
+            {
+                return 0;
+            }
+            const auto index = static_cast<std::size_t>(p * (m_RoundTripsNanoseconds.size() - 1));
+            return m_RoundTripsNanoseconds[index] / 1000.0;
+        };
+
+        fprintf(stream, "messages sent:      %" PRIu64 " (%" PRIu64 " bytes)\n", m_Sends, m_BytesSent);
+        fprintf(stream, "messages received:  %" PRIu64 " (%" PRIu64 " bytes)\n", m_Receives, m_BytesReceived);
+        fprintf(stream, "elapsed:            %.3f s\n", seconds);
+        fprintf(stream, "throughput:         %.1f round trips/s\n", 
+            (seconds > 0.0) ? (m_RoundTripsNanoseconds.size() / seconds) : 0.0);
+        fprintf(stream, "round trip p50:     %.1f us\n", percentile(0.50));
+        fprintf(stream, "round trip p90:     %.1f us\n", percentile(0.90));
+        fprintf(stream, "round trip p99:     %.1f us\n", percentile(0.99));
+        fprintf(stream, "round trip max:     %.1f us\n", percentile(1.00));
+    }
+
+private:
+    void Start()
+    {
+        if (!m_Started)
+        {
+            m_Started   = true;
+            m_StartTime = Clock_t::now();
+        }
+    }
+
+    std::mutex                    m_Mutex;
+    bool                          m_Started{false};
+    Clock_t::time_point           m_StartTime{};
+    std::deque<Outstanding_t>     m_Outstanding;
+    std::size_t                   m_UnmatchedBytes{0};
+    std::vector<uint64_t>         m_RoundTripsNanoseconds;
+    uint64_t                      m_Sends{0};
+    uint64_t                      m_Receives{0};
+    uint64_t                      m_BytesSent{0};
+    uint64_t                      m_BytesReceived{0};
+};
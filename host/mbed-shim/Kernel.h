@@ -0,0 +1,48 @@
+/***********************************************************************
+* @file      Kernel.h
+*
+*    Host (Linux) stand-in for rtos::Kernel::Clock and rtos::ThisThread,
+*    backed by std::chrono::steady_clock and std::this_thread.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <chrono>
+#include <thread>
+
+namespace rtos
+{
+    namespace Kernel
+    {
+        // Same shape as the Mbed OS clock: a steady, millisecond resolution
+        // clock that starts counting at boot (here, at process start).
+        struct Clock
+        {
+            using duration   = std::chrono::milliseconds;
+            using rep        = duration::rep;
+            using period     = duration::period;
+            using time_point = std::chrono::time_point<Clock>;
+            static constexpr bool is_steady = true;
+
+            static time_point now()
+            {
+                static const auto boot = std::chrono::steady_clock::now();
+                return time_point(std::chrono::duration_cast<duration>(
+                                      std::chrono::steady_clock::now() - boot));
+            }
+        };
+    } // end of namespace
+
+    namespace ThisThread
+    {
+        inline void sleep_for(Kernel::Clock::duration rel_time)
+        {
+            std::this_thread::sleep_for(rel_time);
+        }
+    } // end of namespace
+} // end of namespace
@@ -0,0 +1,159 @@
+/***********************************************************************
+* @file      NetworkInterface.h
+*
+*    Host (Linux) stand-in for NetworkInterface. The "interface" is the
+*    host's own IP stack, so connect() merely reports the usual status
+*    transitions (CONNECTING, then GLOBAL_UP) to the attached callback,
+*    and DNS is delegated to getaddrinfo().
+*
+*    Setting HOST_DNS_DELAY_MS in the environment turns DNS into a local
+*    stub with that much lookup latency, e.g. that of a Cat-M1 link, so
+*    that the cost of DNS on time-to-first-message can be measured.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <netdb.h>
+#include <sys/socket.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include "nsapi_types.h"
+#include "Callback.h"
+#include "SocketAddress.h"
+
+class NetworkInterface
+{
+public:
+    typedef mbed::Callback<void (nsapi_value_or_error_t result, SocketAddress * address)> hostbyname_cb_t;
+
+    virtual ~NetworkInterface() = default;
+
+    static NetworkInterface * get_default_instance();
+
+    virtual void set_default_parameters() {}
+
+    virtual nsapi_error_t set_blocking(bool blocking)
+    {
+        m_Blocking = blocking;
+        return NSAPI_ERROR_OK;
+    }
+
+    virtual nsapi_error_t connect()
+    {
+        SetStatus(NSAPI_STATUS_CONNECTING);
+        SetStatus(NSAPI_STATUS_GLOBAL_UP);
+        return NSAPI_ERROR_OK;
+    }
+
+    virtual nsapi_error_t disconnect()
+    {
+        SetStatus(NSAPI_STATUS_DISCONNECTED);
+        return NSAPI_ERROR_OK;
+    }
+
+    virtual void attach(mbed::Callback<void(nsapi_event_t, intptr_t)> status_cb)
+    {
+        m_StatusCallback = status_cb;
+    }
+
+    virtual nsapi_connection_status_t get_connection_status() const { return m_Status; }
+
+    virtual nsapi_error_t get_ip_address(SocketAddress * address)
+    {
+        address->set_ip_address("127.0.0.1");
+        return NSAPI_ERROR_OK;
+    }
+
+    virtual nsapi_error_t get_netmask(SocketAddress * address)
+    {
+        address->set_ip_address("255.0.0.0");
+        return NSAPI_ERROR_OK;
+    }
+
+    virtual nsapi_error_t get_gateway(SocketAddress * address)
+    {
+        address->set_ip_address("127.0.0.1");
+        return NSAPI_ERROR_OK;
+    }
+
+    virtual const char * get_mac_address() { return "00:00:00:00:00:00"; }
+
+    virtual nsapi_error_t gethostbyname(const char * host, SocketAddress * address,
+                                        [[maybe_unused]] nsapi_version_t version = NSAPI_UNSPEC,
+                                        [[maybe_unused]] const char * interface_name = nullptr)
+    {
+        ++s_DnsLookupCount;
+        if (const char * pDelay = std::getenv("HOST_DNS_DELAY_MS"))
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(std::atoi(pDelay)));
+        }
+
+        addrinfo hints{};
+        hints.ai_family = AF_INET;
+        addrinfo * pResult = nullptr;
+
+        if ((::getaddrinfo(host, nullptr, &hints, &pResult) != 0) || !pResult)
+        {
+            return NSAPI_ERROR_DNS_FAILURE;
+        }
+        *address = SocketAddress(*reinterpret_cast<const sockaddr_in *>(pResult->ai_addr));
+        ::freeaddrinfo(pResult);
+        return NSAPI_ERROR_OK;
+    }
+
+    // As on Mbed OS, the callback runs in another thread's context.
+    virtual nsapi_value_or_error_t gethostbyname_async(const char * host, hostbyname_cb_t callback,
+                                                       [[maybe_unused]] nsapi_version_t version = NSAPI_UNSPEC,
+                                                       [[maybe_unused]] const char * interface_name = nullptr)
+    {
+        static std::atomic<nsapi_value_or_error_t> s_NextId{1};
+        std::thread([this, hostName = std::string(host), callback]()
+        {
+            SocketAddress address;
+            const auto rc = gethostbyname(hostName.c_str(), &address);
+            // As on Mbed OS, a failed lookup hands over no address.
+            callback(rc, (rc < 0) ? nullptr : &address);
+        }).detach();
+        return s_NextId++;
+    }
+
+    // Host only; number of DNS lookups performed so far.
+    static uint32_t GetDnsLookupCount() { return s_DnsLookupCount; }
+
+    // Host only; lets tooling inject link loss/recovery as the modem would.
+    void SetStatus(nsapi_connection_status_t status)
+    {
+        m_Status = status;
+        if (m_StatusCallback)
+        {
+            m_StatusCallback(NSAPI_EVENT_CONNECTION_STATUS_CHANGE, status);
+        }
+    }
+
+protected:
+    bool                                            m_Blocking{true};
+    nsapi_connection_status_t                       m_Status{NSAPI_STATUS_DISCONNECTED};
+    mbed::Callback<void(nsapi_event_t, intptr_t)>   m_StatusCallback;
+
+    static inline std::atomic<uint32_t>             s_DnsLookupCount{0};
+};
+
+inline NetworkInterface * NetworkInterface::get_default_instance()
+{
+    static NetworkInterface theHostInterface;
+    return &theHostInterface;
+}
+
+class EthInterface : public NetworkInterface
+{
+};
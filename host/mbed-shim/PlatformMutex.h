@@ -0,0 +1,25 @@
+/***********************************************************************
+* @file      PlatformMutex.h
+*
+*    Host (Linux) stand-in for PlatformMutex, backed by a recursive
+*    std::mutex just like the RTOS variant is recursive.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <mutex>
+
+class PlatformMutex
+{
+public:
+    void lock()   { m_Mutex.lock(); }
+    void unlock() { m_Mutex.unlock(); }
+
+private:
+    std::recursive_mutex m_Mutex;
+};
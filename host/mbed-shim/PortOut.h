@@ -0,0 +1,69 @@
+/***********************************************************************
+* @file      PortOut.h
+*
+*    Host (Linux) stand-in for mbed::PortOut. Masked port writes are
+*    latched in memory, and counted, so that host tooling can observe,
+*    and time, multi-channel actuation without any hardware.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// As on the STM32 targets.
+enum PortName
+{
+    PortA = 0,
+    PortB,
+    PortC,
+    PortD,
+    PortE,
+    PortF,
+    PortG,
+    PortH
+};
+
+namespace mbed
+{
+    class PortOut
+    {
+    public:
+        explicit PortOut(PortName port, int mask = static_cast<int>(0xFFFFFFFF))
+            : m_Port(port)
+            , m_Mask(static_cast<uint32_t>(mask))
+        {
+        }
+
+        // Like the hardware, only the bits in the mask are ever affected.
+        void write(int value)
+        {
+            m_Value = (m_Value & ~m_Mask) | (static_cast<uint32_t>(value) & m_Mask);
+            ++m_WriteCount;
+        }
+
+        int read() const { return static_cast<int>(m_Value & m_Mask); }
+
+        PortOut & operator=(int value)
+        {
+            write(value);
+            return *this;
+        }
+
+        operator int() const { return read(); }
+
+        PortName GetPort() const { return m_Port; }                 // Host only.
+        uint64_t GetWriteCount() const { return m_WriteCount; }     // Host only.
+
+    private:
+        PortName              m_Port;
+        uint32_t              m_Mask;
+        std::atomic<uint32_t> m_Value{0};
+        std::atomic<uint64_t> m_WriteCount{0};
+    };
+} // end of namespace
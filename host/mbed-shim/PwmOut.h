@@ -0,0 +1,65 @@
+/***********************************************************************
+* @file      PwmOut.h
+*
+*    Host (Linux) stand-in for mbed::PwmOut. Duty cycles are simply
+*    latched in memory, and counted, so that host tooling can observe
+*    dimming and fades without any hardware.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+#include "DigitalOut.h"
+
+namespace mbed
+{
+    class PwmOut
+    {
+    public:
+        explicit PwmOut(PinName pin)
+            : m_Pin(pin)
+        {
+        }
+
+        // Like the hardware, the duty cycle is clamped to 0.0f - 1.0f.
+        void write(float value)
+        {
+            m_DutyCycle = std::clamp(value, 0.0f, 1.0f);
+            ++m_WriteCount;
+        }
+
+        float read() const { return m_DutyCycle; }
+
+        void period_us(int us) { m_PeriodMicroseconds = us; }
+
+        void pulsewidth_us(int us)
+        {
+            write(static_cast<float>(us) / static_cast<float>(std::max(1, m_PeriodMicroseconds.load())));
+        }
+
+        PwmOut & operator=(float value)
+        {
+            write(value);
+            return *this;
+        }
+
+        operator float() const { return read(); }
+
+        PinName GetPin() const { return m_Pin; }                    // Host only.
+        uint64_t GetWriteCount() const { return m_WriteCount; }     // Host only.
+
+    private:
+        PinName               m_Pin;
+        std::atomic<float>    m_DutyCycle{0.0f};
+        std::atomic<int>      m_PeriodMicroseconds{20000}; // Mbed's default.
+        std::atomic<uint64_t> m_WriteCount{0};
+    };
+} // end of namespace
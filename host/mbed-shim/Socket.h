@@ -0,0 +1,299 @@
+/***********************************************************************
+* @file      Socket.h
+*
+*    Host (Linux) stand-in for the abstract Socket class and for the
+*    InternetSocket base of TCPSocket/UDPSocket, backed by a POSIX file
+*    descriptor. Blocking operations honour set_blocking()/set_timeout()
+*    through poll(), returning NSAPI_ERROR_WOULD_BLOCK on expiry exactly
+*    as the Mbed OS sockets do.
+*
+*    sigio() callbacks are raised from a dispatcher thread of their own,
+*    as the network stack would from its own context on the target. They
+*    are edge triggered: one call per change of readiness, so the callee
+*    must keep going until NSAPI_ERROR_WOULD_BLOCK to see it fire again.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <cerrno>
+#include <mutex>
+#include <thread>
+
+#include "nsapi_types.h"
+#include "Callback.h"
+#include "SocketAddress.h"
+#include "NetworkInterface.h"
+#include "HostLinkMetrics.h"
+
+class Socket
+{
+public:
+    virtual ~Socket() = default;
+
+    virtual nsapi_error_t close() = 0;
+    virtual nsapi_error_t connect(const SocketAddress & address) = 0;
+    virtual nsapi_size_or_error_t send(const void * data, nsapi_size_t size) = 0;
+    virtual nsapi_size_or_error_t recv(void * data, nsapi_size_t size) = 0;
+    virtual nsapi_size_or_error_t sendto(const SocketAddress & address, const void * data, nsapi_size_t size) = 0;
+    virtual nsapi_size_or_error_t recvfrom(SocketAddress * address, void * data, nsapi_size_t size) = 0;
+    virtual void set_blocking(bool blocking) = 0;
+    virtual void set_timeout(int timeout) = 0;
+    virtual void sigio(mbed::Callback<void()> func) = 0;
+};
+
+// Host only. Raises the sigio() callbacks of every socket that has one.
+class SigioDispatcher
+{
+public:
+    static SigioDispatcher & Instance()
+    {
+        static SigioDispatcher theInstance;
+        return theInstance;
+    }
+
+    void Register(int fd, mbed::Callback<void()> * pCallback)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        epoll_event event{};
+        event.events   = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.ptr = pCallback;
+        if (::epoll_ctl(m_EpollDescriptor, EPOLL_CTL_MOD, fd, &event) < 0)
+        {
+            ::epoll_ctl(m_EpollDescriptor, EPOLL_CTL_ADD, fd, &event);
+        }
+    }
+
+    void Unregister(int fd)
+    {
+        // Holding the mutex guarantees that no callback of this socket is
+        // running, nor will run, once we return.
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        ::epoll_ctl(m_EpollDescriptor, EPOLL_CTL_DEL, fd, nullptr);
+    }
+
+private:
+    SigioDispatcher()
+        : m_EpollDescriptor(::epoll_create1(EPOLL_CLOEXEC))
+    {
+        std::thread([this]() { Dispatch(); }).detach();
+    }
+
+    void Dispatch()
+    {
+        epoll_event events[16];
+        for (;;)
+        {
+            const int count = ::epoll_wait(m_EpollDescriptor, events, 16, 100);
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            for (int i = 0; i < count; ++i)
+            {
+                auto pCallback = static_cast<mbed::Callback<void()> *>(events[i].data.ptr);
+                if (pCallback && *pCallback)
+                {
+                    (*pCallback)();
+                }
+            }
+        }
+    }
+
+    std::mutex m_Mutex;
+    int        m_EpollDescriptor;
+};
+
+class InternetSocket : public Socket
+{
+public:
+    ~InternetSocket() override
+    {
+        close();
+    }
+
+    nsapi_error_t open([[maybe_unused]] NetworkInterface * stack)
+    {
+        if (m_FileDescriptor >= 0)
+        {
+            return NSAPI_ERROR_PARAMETER;
+        }
+        m_FileDescriptor = ::socket(AF_INET, GetSocketType(), 0);
+        if (m_FileDescriptor < 0)
+        {
+            return NSAPI_ERROR_NO_SOCKET;
+        }
+        if (GetSocketType() == SOCK_STREAM)
+        {
+            int one = 1;
+            ::setsockopt(m_FileDescriptor, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+        ::fcntl(m_FileDescriptor, F_SETFL, ::fcntl(m_FileDescriptor, F_GETFL) | O_NONBLOCK);
+        if (m_SigioCallback)
+        {
+            SigioDispatcher::Instance().Register(m_FileDescriptor, &m_SigioCallback);
+        }
+        return NSAPI_ERROR_OK;
+    }
+
+    nsapi_error_t close() override
+    {
+        if (m_FileDescriptor >= 0)
+        {
+            SigioDispatcher::Instance().Unregister(m_FileDescriptor);
+            ::close(m_FileDescriptor);
+            m_FileDescriptor = -1;
+        }
+        return NSAPI_ERROR_OK;
+    }
+
+    nsapi_error_t connect(const SocketAddress & address) override
+    {
+        if (m_FileDescriptor < 0)
+        {
+            return NSAPI_ERROR_NO_SOCKET;
+        }
+        const auto & sockAddr = address.GetSockAddr();
+        if (::connect(m_FileDescriptor, reinterpret_cast<const sockaddr *>(&sockAddr), sizeof(sockAddr)) == 0)
+        {
+            return NSAPI_ERROR_OK;
+        }
+        // As on Mbed OS, a non-blocking connect() is called again until it
+        // no longer says that it is still under way.
+        if (errno == EALREADY)
+        {
+            return NSAPI_ERROR_ALREADY;
+        }
+        if (errno == EISCONN)
+        {
+            return NSAPI_ERROR_IS_CONNECTED;
+        }
+        if (errno != EINPROGRESS)
+        {
+            return NSAPI_ERROR_NO_CONNECTION;
+        }
+        if (!m_Blocking)
+        {
+            return NSAPI_ERROR_IN_PROGRESS;
+        }
+        if (!WaitFor(POLLOUT))
+        {
+            return NSAPI_ERROR_CONNECTION_TIMEOUT;
+        }
+        int error = 0;
+        socklen_t length = sizeof(error);
+        ::getsockopt(m_FileDescriptor, SOL_SOCKET, SO_ERROR, &error, &length);
+        return (error == 0) ? NSAPI_ERROR_OK : NSAPI_ERROR_NO_CONNECTION;
+    }
+
+    nsapi_size_or_error_t send(const void * data, nsapi_size_t size) override
+    {
+        return Transfer(POLLOUT, [&]() { return ::send(m_FileDescriptor, data, size, MSG_NOSIGNAL); },
+                        &HostLinkMetrics::OnSend);
+    }
+
+    nsapi_size_or_error_t recv(void * data, nsapi_size_t size) override
+    {
+        return Transfer(POLLIN, [&]() { return ::recv(m_FileDescriptor, data, size, 0); },
+                        &HostLinkMetrics::OnReceive);
+    }
+
+    nsapi_size_or_error_t sendto(const SocketAddress & address, const void * data, nsapi_size_t size) override
+    {
+        const auto & sockAddr = address.GetSockAddr();
+        return Transfer(POLLOUT, [&]() { return ::sendto(m_FileDescriptor, data, size, MSG_NOSIGNAL,
+                                                   reinterpret_cast<const sockaddr *>(&sockAddr), sizeof(sockAddr)); },
+                        &HostLinkMetrics::OnSend);
+    }
+
+    nsapi_size_or_error_t recvfrom(SocketAddress * address, void * data, nsapi_size_t size) override
+    {
+        sockaddr_in sockAddr{};
+        socklen_t length = sizeof(sockAddr);
+        auto rc = Transfer(POLLIN, [&]() { return ::recvfrom(m_FileDescriptor, data, size, 0,
+                                                       reinterpret_cast<sockaddr *>(&sockAddr), &length); },
+                           &HostLinkMetrics::OnReceive);
+        if ((rc >= 0) && address)
+        {
+            *address = SocketAddress(sockAddr);
+        }
+        return rc;
+    }
+
+    void set_blocking(bool blocking) override
+    {
+        m_Blocking = blocking;
+    }
+
+    void set_timeout(int timeout) override
+    {
+        m_Blocking = true;
+        m_TimeoutMilliseconds = timeout;
+    }
+
+    void sigio(mbed::Callback<void()> func) override
+    {
+        if (m_FileDescriptor >= 0)
+        {
+            SigioDispatcher::Instance().Unregister(m_FileDescriptor);
+        }
+        m_SigioCallback = func;
+        if ((m_FileDescriptor >= 0) && m_SigioCallback)
+        {
+            SigioDispatcher::Instance().Register(m_FileDescriptor, &m_SigioCallback);
+        }
+    }
+
+    int GetFileDescriptor() const { return m_FileDescriptor; } // Host only.
+
+protected:
+    virtual int GetSocketType() const = 0;
+
+    bool WaitFor(short events)
+    {
+        pollfd descriptor{m_FileDescriptor, events, 0};
+        return (::poll(&descriptor, 1, m_Blocking ? m_TimeoutMilliseconds : 0) > 0);
+    }
+
+    template <typename F>
+    nsapi_size_or_error_t Transfer(short events, F operation, void (HostLinkMetrics::*record)(std::size_t))
+    {
+        if (m_FileDescriptor < 0)
+        {
+            return NSAPI_ERROR_NO_SOCKET;
+        }
+        for (;;)
+        {
+            const auto rc = operation();
+            if (rc >= 0)
+            {
+                if (rc > 0)
+                {
+                    (HostLinkMetrics::Instance().*record)(static_cast<std::size_t>(rc));
+                }
+                return static_cast<nsapi_size_or_error_t>(rc);
+            }
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK))
+            {
+                return ((errno == ECONNRESET) || (errno == EPIPE)) 
+                       ? NSAPI_ERROR_CONNECTION_LOST : NSAPI_ERROR_DEVICE_ERROR;
+            }
+            if (!m_Blocking || !WaitFor(events))
+            {
+                return NSAPI_ERROR_WOULD_BLOCK;
+            }
+        }
+    }
+
+    int                     m_FileDescriptor{-1};
+    bool                    m_Blocking{true};
+    int                     m_TimeoutMilliseconds{-1}; // Unbounded, as per Mbed OS.
+    mbed::Callback<void()>  m_SigioCallback;
+};
@@ -0,0 +1,62 @@
+/***********************************************************************
+* @file      SocketAddress.h
+*
+*    Host (Linux) stand-in for SocketAddress, convertible to and from the
+*    POSIX sockaddr_in it wraps.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <cstring>
+
+#include "nsapi_types.h"
+
+class SocketAddress
+{
+public:
+    SocketAddress(const char * addr = nullptr, uint16_t port = 0)
+    {
+        set_ip_address(addr);
+        set_port(port);
+    }
+
+    explicit SocketAddress(const sockaddr_in & address)
+    {
+        m_Address = address;
+        m_HasAddress = true;
+        ::inet_ntop(AF_INET, &m_Address.sin_addr, m_IpString, sizeof(m_IpString));
+    }
+
+    bool set_ip_address(const char * addr)
+    {
+        m_HasAddress = (addr && (::inet_pton(AF_INET, addr, &m_Address.sin_addr) == 1));
+        if (m_HasAddress)
+        {
+            ::inet_ntop(AF_INET, &m_Address.sin_addr, m_IpString, sizeof(m_IpString));
+        }
+        return m_HasAddress;
+    }
+
+    void set_port(uint16_t port) { m_Address.sin_port = htons(port); }
+
+    const char * get_ip_address() const { return m_HasAddress ? m_IpString : nullptr; }
+
+    uint16_t get_port() const { return ntohs(m_Address.sin_port); }
+
+    explicit operator bool() const { return m_HasAddress; }
+
+    // Host only; for handing over to the POSIX socket calls.
+    const sockaddr_in & GetSockAddr() const { return m_Address; }
+
+private:
+    sockaddr_in m_Address{AF_INET, 0, {INADDR_ANY}, {}};
+    char        m_IpString[INET_ADDRSTRLEN]{};
+    bool        m_HasAddress{false};
+};
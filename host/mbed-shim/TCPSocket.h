@@ -0,0 +1,20 @@
+/***********************************************************************
+* @file      TCPSocket.h
+*
+*    Host (Linux) stand-in for TCPSocket.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include "Socket.h"
+
+class TCPSocket : public InternetSocket
+{
+protected:
+    int GetSocketType() const override { return SOCK_STREAM; }
+};
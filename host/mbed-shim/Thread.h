@@ -0,0 +1,79 @@
+/***********************************************************************
+* @file      Thread.h
+*
+*    Host (Linux) stand-in for rtos::Thread, backed by std::thread. The
+*    priority and stack arguments are accepted, and ignored.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <cstdint>
+#include <thread>
+
+#include "Callback.h"
+
+typedef enum
+{
+    osPriorityIdle        = 1,
+    osPriorityLow         = 8,
+    osPriorityBelowNormal = 16,
+    osPriorityNormal      = 24,
+    osPriorityAboveNormal = 32,
+    osPriorityHigh        = 40,
+    osPriorityRealtime    = 48
+} osPriority_t;
+
+typedef int32_t osStatus;
+
+static constexpr osStatus osOK{0};
+static constexpr osStatus osErrorResource{-3};
+
+namespace rtos
+{
+    class Thread
+    {
+    public:
+        explicit Thread([[maybe_unused]] osPriority_t priority = osPriorityNormal, [[maybe_unused]] uint32_t stack_size = 4096,
+                        [[maybe_unused]] unsigned char * stack_mem = nullptr, [[maybe_unused]] const char * name = nullptr)
+        {
+        }
+
+        Thread(const Thread&) = delete;
+        Thread& operator=(const Thread&) = delete;
+
+        ~Thread()
+        {
+            if (m_Thread.joinable())
+            {
+                m_Thread.detach();
+            }
+        }
+
+        osStatus start(mbed::Callback<void()> task)
+        {
+            if (m_Thread.joinable())
+            {
+                return osErrorResource;
+            }
+            m_Thread = std::thread(std::move(task));
+            return osOK;
+        }
+
+        osStatus join()
+        {
+            if (m_Thread.joinable())
+            {
+                m_Thread.join();
+            }
+            return osOK;
+        }
+
+    private:
+        std::thread m_Thread;
+    };
+} // end of namespace
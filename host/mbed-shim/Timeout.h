@@ -0,0 +1,103 @@
+/***********************************************************************
+* @file      Timeout.h
+*
+*    Host (Linux) stand-in for mbed::Timeout, a one-shot hardware timer
+*    interrupt. Each Timeout has a thread of its own that sleeps until
+*    the deadline, then runs the callback inside a CriticalSectionLock,
+*    i.e. as if in interrupt context. As on target, the callback may
+*    attach the Timeout anew.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "Callback.h"
+#include "CriticalSectionLock.h"
+
+namespace mbed
+{
+    class Timeout
+    {
+        using Clock_t = std::chrono::steady_clock;
+
+    public:
+        Timeout() : m_Thread([this] { Run(); }) {}
+
+        ~Timeout()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_IsStopping = true;
+            }
+            m_Condition.notify_one();
+            m_Thread.join();
+        }
+
+        Timeout(const Timeout&) = delete;
+        Timeout& operator=(const Timeout&) = delete;
+
+        void attach(Callback<void()> func, std::chrono::microseconds t)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_Callback = std::move(func);
+                m_Deadline = Clock_t::now() + t;
+                m_IsArmed = true;
+            }
+            m_Condition.notify_one();
+        }
+
+        void detach()
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_IsArmed = false;
+        }
+
+    private:
+        void Run()
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            while (!m_IsStopping)
+            {
+                if (!m_IsArmed)
+                {
+                    m_Condition.wait(lock);
+                    continue;
+                }
+                if (m_Condition.wait_until(lock, m_Deadline) != std::cv_status::timeout)
+                {
+                    continue; // Re-attached, detached or stopping.
+                }
+                if (!m_IsArmed || (Clock_t::now() < m_Deadline))
+                {
+                    continue;
+                }
+                m_IsArmed = false;
+                auto callback = m_Callback;
+                lock.unlock();
+                {
+                    CriticalSectionLock interrupt;
+                    callback();
+                }
+                lock.lock();
+            }
+        }
+
+        std::mutex              m_Mutex;
+        std::condition_variable m_Condition;
+        Callback<void()>        m_Callback;
+        Clock_t::time_point     m_Deadline{};
+        bool                    m_IsArmed{false};
+        bool                    m_IsStopping{false};
+        std::thread             m_Thread;
+    };
+} // end of namespace
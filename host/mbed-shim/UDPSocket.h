@@ -0,0 +1,20 @@
+/***********************************************************************
+* @file      UDPSocket.h
+*
+*    Host (Linux) stand-in for UDPSocket.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include "Socket.h"
+
+class UDPSocket : public InternetSocket
+{
+protected:
+    int GetSocketType() const override { return SOCK_DGRAM; }
+};
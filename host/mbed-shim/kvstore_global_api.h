@@ -0,0 +1,71 @@
+/***********************************************************************
+* @file      kvstore_global_api.h
+*
+*    Host (Linux) stand-in for the Mbed OS KVStore global API. Each key
+*    is a file in the directory named by HOST_KVSTORE_DIR, by default
+*    /tmp/lightcontrol-kvstore, so that what is stored survives a
+*    "reboot", i.e. a restart of the host process.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <sys/stat.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "mbed_error.h"
+
+namespace HostKVStore
+{
+    inline std::string PathOf(const char * full_name_key)
+    {
+        const char * pDirectory = std::getenv("HOST_KVSTORE_DIR");
+        std::string directory = pDirectory ? pDirectory : "/tmp/lightcontrol-kvstore";
+        ::mkdir(directory.c_str(), 0700);
+
+        // "/kv/<key>" -> "<directory>/<key>"
+        std::string key = full_name_key;
+        const auto separator = key.find_last_of('/');
+        return directory + "/" + ((separator == std::string::npos) ? key : key.substr(separator + 1));
+    }
+} // end of namespace
+
+inline int kv_set(const char * full_name_key, const void * buffer, size_t size, [[maybe_unused]] uint32_t create_flags)
+{
+    FILE * pFile = std::fopen(HostKVStore::PathOf(full_name_key).c_str(), "wb");
+    if (!pFile)
+    {
+        return MBED_ERROR_WRITE_FAILED;
+    }
+    const bool written = (std::fwrite(buffer, 1, size, pFile) == size);
+    std::fclose(pFile);
+    return written ? MBED_SUCCESS : MBED_ERROR_WRITE_FAILED;
+}
+
+inline int kv_get(const char * full_name_key, void * buffer, size_t buffer_size, size_t * actual_size)
+{
+    FILE * pFile = std::fopen(HostKVStore::PathOf(full_name_key).c_str(), "rb");
+    if (!pFile)
+    {
+        return MBED_ERROR_ITEM_NOT_FOUND;
+    }
+    const auto count = std::fread(buffer, 1, buffer_size, pFile);
+    std::fclose(pFile);
+    if (actual_size)
+    {
+        *actual_size = count;
+    }
+    return MBED_SUCCESS;
+}
+
+inline int kv_remove(const char * full_name_key)
+{
+    return (std::remove(HostKVStore::PathOf(full_name_key).c_str()) == 0) ? MBED_SUCCESS : MBED_ERROR_ITEM_NOT_FOUND;
+}
@@ -0,0 +1,48 @@
+/***********************************************************************
+* @file      mbed.h
+*
+*    Host (Linux) stand-in for the Mbed OS umbrella header. Together with
+*    its siblings in this directory it provides thin, POSIX backed shims
+*    of just the Mbed OS APIs that the LightControl application uses, so
+*    that LEDLightControl.h compiles, runs and can be profiled unchanged
+*    on a Linux box. Put this directory first on the include path:
+*
+*    g++ -std=gnu++20 -I host/mbed-shim -I . ...
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+
+#include "mbed_config.h"
+#include "mbed_assert.h"
+#include "mbed_toolchain.h"
+#include "nsapi_types.h"
+#include "Callback.h"
+#include "Kernel.h"
+#include "HighResClock.h"
+#include "Thread.h"
+#include "PlatformMutex.h"
+#include "CriticalSectionLock.h"
+#include "Timeout.h"
+#include "DigitalOut.h"
+#include "PortOut.h"
+#include "PwmOut.h"
+#include "SocketAddress.h"
+#include "NetworkInterface.h"
+#include "Socket.h"
+#include "TCPSocket.h"
+#include "UDPSocket.h"
+#include "mbed_events.h"
+
+using namespace mbed;
+using namespace events;
+using namespace rtos;
+using namespace std::chrono_literals;
@@ -0,0 +1,17 @@
+/***********************************************************************
+* @file      mbed_assert.h
+*
+*    Host (Linux) stand-in for MBED_ASSERT/MBED_STATIC_ASSERT.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <cassert>
+
+#define MBED_ASSERT(expr) assert(expr)
+#define MBED_STATIC_ASSERT(expr, msg) static_assert(expr, msg)
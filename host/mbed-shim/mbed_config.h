@@ -0,0 +1,35 @@
+/***********************************************************************
+* @file      mbed_config.h
+*
+*    Host (Linux) stand-in for the configuration header that Mbed CLI
+*    generates from mbed_app.json. Override any of these on the compiler
+*    command line, e.g. -DMBED_CONF_APP_ECHO_SERVER_PORT=7007.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#ifndef MBED_CONF_APP_ECHO_SERVER_HOSTNAME
+#define MBED_CONF_APP_ECHO_SERVER_HOSTNAME "127.0.0.1"
+#endif
+
+// Port 7 is privileged on Linux; the bundled host EchoServer defaults to 7007.
+#ifndef MBED_CONF_APP_ECHO_SERVER_PORT
+#define MBED_CONF_APP_ECHO_SERVER_PORT 7007
+#endif
+
+#ifndef MBED_CONF_APP_PREFER_BINARY_WIRE_FORMAT
+#define MBED_CONF_APP_PREFER_BINARY_WIRE_FORMAT 0
+#endif
+
+#ifndef MBED_CONF_MBED_TRACE_ENABLE
+#define MBED_CONF_MBED_TRACE_ENABLE 0
+#endif
+
+#ifndef MBED_CONF_APP_DEFERRED_LOG_RAW
+#define MBED_CONF_APP_DEFERRED_LOG_RAW 0
+#endif
@@ -0,0 +1,22 @@
+/***********************************************************************
+* @file      mbed_error.h
+*
+*    Host (Linux) stand-in for the Mbed OS error codes that the
+*    application, and the KVStore global API shim, rely upon.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+typedef int mbed_error_status_t;
+
+// As composed by MBED_MAKE_ERROR(MBED_MODULE_PLATFORM, ...) on Mbed OS.
+#define MBED_SUCCESS                    0
+#define MBED_ERROR_READ_FAILED          (-2147418093)
+#define MBED_ERROR_WRITE_FAILED         (-2147418092)
+#define MBED_ERROR_INVALID_SIZE         (-2147418102)
+#define MBED_ERROR_ITEM_NOT_FOUND       (-2147418065)
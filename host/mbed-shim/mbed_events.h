@@ -0,0 +1,24 @@
+/***********************************************************************
+* @file      mbed_events.h
+*
+*    Host (Linux) stand-in for the Mbed OS events library, including the
+*    shared event queue accessor.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include "EventQueue.h"
+
+namespace mbed
+{
+    inline events::EventQueue * mbed_event_queue()
+    {
+        static events::EventQueue sharedEventQueue;
+        return &sharedEventQueue;
+    }
+} // end of namespace
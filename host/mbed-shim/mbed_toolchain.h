@@ -0,0 +1,16 @@
+/***********************************************************************
+* @file      mbed_toolchain.h
+*
+*    Host (Linux) stand-in for the MBED_SECTION attribute. A process
+*    starts from a fresh image every time, so on the host a no-init
+*    section is merely a section of its own.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#define MBED_SECTION(name) __attribute__((section(name)))
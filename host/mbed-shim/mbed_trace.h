@@ -0,0 +1,21 @@
+/***********************************************************************
+* @file      mbed_trace.h
+*
+*    Host (Linux) stand-in for mbed-trace. Tracing is compiled out on the
+*    host, as it is in the firmware by default ("mbed-trace.enable": 0).
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+inline int  mbed_trace_init() { return 0; }
+inline void mbed_trace_free() {}
+
+#define tr_debug(...) ((void)0)
+#define tr_info(...)  ((void)0)
+#define tr_warn(...)  ((void)0)
+#define tr_error(...) ((void)0)
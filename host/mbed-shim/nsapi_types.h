@@ -0,0 +1,76 @@
+/***********************************************************************
+* @file      nsapi_types.h
+*
+*    Host (Linux) stand-in for the Mbed OS network socket API types.
+*    Error code values mirror mbed-os-6.15.1 so that ToString() and the
+*    application's error handling behave identically on the host.
+*
+* @note      Only what the LightControl application actually uses.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+typedef signed int   nsapi_error_t;
+typedef unsigned int nsapi_size_t;
+typedef signed int   nsapi_size_or_error_t;
+typedef signed int   nsapi_value_or_error_t;
+
+#define NSAPI_IPv4_SIZE 16
+#define NSAPI_IPv6_SIZE 46
+#define NSAPI_IP_SIZE   NSAPI_IPv6_SIZE
+
+enum nsapi_error
+{
+    NSAPI_ERROR_OK                  =  0,
+    NSAPI_ERROR_WOULD_BLOCK         = -3001,
+    NSAPI_ERROR_UNSUPPORTED         = -3002,
+    NSAPI_ERROR_PARAMETER           = -3003,
+    NSAPI_ERROR_NO_CONNECTION       = -3004,
+    NSAPI_ERROR_NO_SOCKET           = -3005,
+    NSAPI_ERROR_NO_ADDRESS          = -3006,
+    NSAPI_ERROR_NO_MEMORY           = -3007,
+    NSAPI_ERROR_NO_SSID             = -3008,
+    NSAPI_ERROR_DNS_FAILURE         = -3009,
+    NSAPI_ERROR_DHCP_FAILURE        = -3010,
+    NSAPI_ERROR_AUTH_FAILURE        = -3011,
+    NSAPI_ERROR_DEVICE_ERROR        = -3012,
+    NSAPI_ERROR_IN_PROGRESS         = -3013,
+    NSAPI_ERROR_ALREADY             = -3014,
+    NSAPI_ERROR_IS_CONNECTED        = -3015,
+    NSAPI_ERROR_CONNECTION_LOST     = -3016,
+    NSAPI_ERROR_CONNECTION_TIMEOUT  = -3017,
+    NSAPI_ERROR_ADDRESS_IN_USE      = -3018,
+    NSAPI_ERROR_TIMEOUT             = -3019,
+    NSAPI_ERROR_BUSY                = -3020
+};
+
+typedef enum nsapi_connection_status
+{
+    NSAPI_STATUS_LOCAL_UP           = 0,
+    NSAPI_STATUS_GLOBAL_UP          = 1,
+    NSAPI_STATUS_DISCONNECTED       = 2,
+    NSAPI_STATUS_CONNECTING         = 3,
+    NSAPI_STATUS_ERROR_UNSUPPORTED  = NSAPI_ERROR_UNSUPPORTED
+} nsapi_connection_status_t;
+
+typedef enum nsapi_event
+{
+    NSAPI_EVENT_CONNECTION_STATUS_CHANGE = 0,
+    NSAPI_EVENT_CELLULAR_STATUS_BASE     = 0x1000,
+    NSAPI_EVENT_CELLULAR_STATUS_END      = 0x1FFF
+} nsapi_event_t;
+
+typedef enum nsapi_version
+{
+    NSAPI_UNSPEC,
+    NSAPI_IPv4,
+    NSAPI_IPv6
+} nsapi_version_t;
@@ -0,0 +1,35 @@
+/***********************************************************************
+* @file      randLIB.h
+*
+*    Host (Linux) stand-in for randLIB, backed by std::mt19937.
+*
+* @author    Nuertey Odzeyem
+*
+* @date      May 7th, 2022
+*
+* @copyright Copyright (c) 2022 Nuertey Odzeyem. All Rights Reserved.
+***********************************************************************/
+#pragma once
+
+#include <cstdint>
+#include <random>
+
+inline std::mt19937 & randLIB_engine()
+{
+    static std::mt19937 theEngine;
+    return theEngine;
+}
+
+inline void randLIB_seed_random()
+{
+    randLIB_engine().seed(std::random_device{}());
+}
+
+inline uint8_t  randLIB_get_8bit()  { return static_cast<uint8_t>(randLIB_engine()()); }
+inline uint16_t randLIB_get_16bit() { return static_cast<uint16_t>(randLIB_engine()()); }
+inline uint32_t randLIB_get_32bit() { return static_cast<uint32_t>(randLIB_engine()()); }
+
+inline uint16_t randLIB_get_random_in_range(uint16_t min, uint16_t max)
+{
+    return std::uniform_int_distribution<uint16_t>(min, max)(randLIB_engine());
+}